@@ -0,0 +1,146 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Memory mapped file support
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "MappedFile.h"
+
+#include "Asserts.h"
+
+#if _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates an object with no file mapped
+//------------------------------------------------------------------------------------------------------------------------------------------
+MappedFile::MappedFile() noexcept
+    : mpData(nullptr)
+    , mSize(0)
+    , mpMapping(nullptr)
+    , mMappingSize(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Transfers a file mapping from one object to another
+//------------------------------------------------------------------------------------------------------------------------------------------
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mpData(other.mpData)
+    , mSize(other.mSize)
+    , mpMapping(other.mpMapping)
+    , mMappingSize(other.mMappingSize)
+{
+    other.mpData = nullptr;
+    other.mSize = 0;
+    other.mpMapping = nullptr;
+    other.mMappingSize = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Unmaps the file if it is mapped
+//------------------------------------------------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile() noexcept {
+    unmap();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Maps the specified region of the given file into memory, unmapping any previously mapped file first.
+// Returns 'false' on failure, in which case nothing will be mapped.
+// The region must lie entirely within the file and must not be empty.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool MappedFile::map(const char* const filePath, const uint64_t fileOffset, const size_t size) noexcept {
+    ASSERT(filePath);
+    unmap();
+
+    if (size == 0)
+        return false;
+
+    #if _WIN32
+        // Open the file and make sure the requested region is within it
+        const HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (hFile == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize = {};
+
+        if ((!GetFileSizeEx(hFile, &fileSize)) || (fileOffset + size > (uint64_t) fileSize.QuadPart)) {
+            CloseHandle(hFile);
+            return false;
+        }
+
+        // Map the region, starting the view at the allocation granularity boundary before the requested offset.
+        // Note: the view keeps the mapping and file alive, so the handles can be closed straight away.
+        SYSTEM_INFO sysInfo = {};
+        GetSystemInfo(&sysInfo);
+
+        const uint64_t mappingOffset = fileOffset - (fileOffset % sysInfo.dwAllocationGranularity);
+        const size_t mappingSize = (size_t)(fileOffset - mappingOffset) + size;
+        const HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        CloseHandle(hFile);
+
+        if (!hMapping)
+            return false;
+
+        void* const pMapping = MapViewOfFile(hMapping, FILE_MAP_COPY, (DWORD)(mappingOffset >> 32), (DWORD) mappingOffset, mappingSize);
+        CloseHandle(hMapping);
+
+        if (!pMapping)
+            return false;
+    #else
+        // Open the file and make sure the requested region is within it
+        const int fd = open(filePath, O_RDONLY);
+
+        if (fd < 0)
+            return false;
+
+        struct stat fileStat = {};
+
+        if ((fstat(fd, &fileStat) != 0) || (fileOffset + size > (uint64_t) fileStat.st_size)) {
+            close(fd);
+            return false;
+        }
+
+        // Map the region, starting the mapping at the page boundary before the requested offset.
+        // Note: the mapping keeps the file alive, so the file descriptor can be closed straight away.
+        const uint64_t pageSize = (uint64_t) sysconf(_SC_PAGESIZE);
+        const uint64_t mappingOffset = fileOffset - (fileOffset % pageSize);
+        const size_t mappingSize = (size_t)(fileOffset - mappingOffset) + size;
+        void* const pMapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, (off_t) mappingOffset);
+        close(fd);
+
+        if (pMapping == MAP_FAILED)
+            return false;
+    #endif
+
+    mpMapping = pMapping;
+    mMappingSize = mappingSize;
+    mpData = (std::byte*) pMapping + (fileOffset - mappingOffset);
+    mSize = size;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Unmaps the currently mapped file, if any.
+// Any pointers to the previously mapped memory are invalid after this call.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void MappedFile::unmap() noexcept {
+    if (mpMapping) {
+        #if _WIN32
+            UnmapViewOfFile(mpMapping);
+        #else
+            munmap(mpMapping, mMappingSize);
+        #endif
+    }
+
+    mpData = nullptr;
+    mSize = 0;
+    mpMapping = nullptr;
+    mMappingSize = 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Maps a region of a file on disk into memory, so that it's contents can be accessed directly without any read calls or copying.
+// The mapping is private and copy-on-write: the mapped memory may be modified but the changes are never written back to the file.
+// Note: the file must not be truncated while it is mapped, since accessing the part of the mapping past the new end of the file will crash.
+// Only map files which are not expected to change while in use, such as disc images and user WADs.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class MappedFile {
+public:
+    MappedFile() noexcept;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile() noexcept;
+
+    bool map(const char* const filePath, const uint64_t fileOffset, const size_t size) noexcept;
+    void unmap() noexcept;
+
+    inline bool isMapped() const noexcept { return (mpData != nullptr); }
+    inline std::byte* getData() const noexcept { return mpData; }
+    inline size_t getSize() const noexcept { return mSize; }
+
+private:
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator = (const MappedFile& other) = delete;
+    MappedFile& operator = (MappedFile&& other) = delete;
+
+    std::byte*  mpData;         // Start of the requested file region in memory or 'nullptr' if nothing is mapped
+    size_t      mSize;          // Size of the requested file region
+    void*       mpMapping;      // Start of the actual mapping, which begins on an allocation granularity boundary
+    size_t      mMappingSize;   // Size of the actual mapping
+};
@@ -338,7 +338,7 @@ void I_LoadAndCacheTexLump(texture_t& tex, const char* const name, int32_t lumpN
         #if PSYDOOM_LIMIT_REMOVING
             // PsyDoom limit removing: temporary buffer can be any size now
             gTmpBuffer.ensureSize(lump.uncompressedSize);
-            decode(pLumpData, gTmpBuffer.bytes());
+            decode(pLumpData, gTmpBuffer.bytes(), gTmpBuffer.size());
             pLumpData = gTmpBuffer.bytes();
         #else
             // PsyDoom: check for buffer overflows and issue an error if we exceed the limits
@@ -351,7 +351,7 @@ static texdata_t TC_CacheTexData(const texture_t& tex) {
 
         #if PSYDOOM_LIMIT_REMOVING
             gTmpBuffer.ensureSize(texSize);
-            decode(pTexBytes, gTmpBuffer.bytes());
+            decode(pTexBytes, gTmpBuffer.bytes(), gTmpBuffer.size());
             pTexBytes = gTmpBuffer.bytes();
         #else
             // PsyDoom: check for buffer overflows and issue an error if we exceed the limits
@@ -9,6 +9,7 @@
 #include "FatalErrors.h"
 #include "i_main.h"
 #include "m_fixed.h"
+#include "PsyDoom/AsyncIo.h"
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/DiscInfo.h"
 #include "PsyDoom/Game.h"
@@ -229,6 +230,64 @@ CdFileId S_GetSoundLcdFileId(const int32_t num) noexcept {
     return lcdFileName;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom helper: returns the id of the sound LCD file that 'S_LoadMapSoundAndMusic' loads for the given map number, or an empty id if none.
+// Note that if we are doing the finale then LCD number max(60, numMaps) is used because Final Doom still uses '60' for the finale LCD.
+//
+// If 'ALLMAPS.LCD' is present in the user data dir (and we are not doing the finale) then that is loaded instead, with the expectation that it
+// will contain all enemy sounds in the game. We can just blank load everything and provide a master LCD with all enemy sounds because of
+// PsyDoom's greatly expanded sound RAM.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static CdFileId S_GetMapSoundLcdFileId(const int32_t mapNum) noexcept {
+    const bool bIsFinale = (mapNum == Game::getNumMaps() + 1);
+
+    if ((!bIsFinale) && (mapNum > 0) && ModMgr::areOverridesAvailableForFile("ALLMAPS.LCD"))
+        return "ALLMAPS.LCD";
+
+    if (mapNum > Game::getNumMaps()) {
+        // Load the finale LCD, which is normally 'MAP60.LCD' for both Doom and Final Doom, but which can now be flexibly specified in MAPINFO.
+        // N.B: need to use the 'gGameMap' field at this point to lookup the cluster because the map number passed in for the finale is NOT valid.
+        const MapInfo::Map* const pGameEndMap = MapInfo::getMap(gGameMap);
+        const MapInfo::Cluster* const pCluster = (pGameEndMap) ? MapInfo::getCluster(pGameEndMap->cluster) : nullptr;
+        return (pCluster) ? pCluster->castLcdFile : CdFileId{};
+    }
+
+    return (mapNum > 0) ? S_GetSoundLcdFileId(mapNum) : CdFileId{};     // Normal map LCD
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom helper: starts reading all of the LCD files that 'S_LoadMapSoundAndMusic' will need to load for the given map in the background.
+// Reads for all the files are issued up front so they can proceed in parallel; the LCD loader later takes the preloaded file data.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void S_PreloadMapSoundAndMusic(const int32_t mapNum) noexcept {
+    if (ProgArgs::gbHeadlessMode || (gLoadedSoundAndMusMapNum == mapNum))
+        return;
+
+    // The main Doom SFX LCD, if not loaded and not doing the finale
+    const bool bIsFinale = (mapNum == Game::getNumMaps() + 1);
+
+    if ((!bIsFinale) && (!gbDidLoadDoomSfxLcd)) {
+        AsyncIo::preloadFile(CdFile::DOOMSFX_LCD);
+    }
+
+    // Music samples, unless there is no music sequence or CD music is being played instead
+    const MapInfo::Map* const pMap = MapInfo::getMap(mapNum);
+    const int32_t mapMusicTrack = (pMap) ? pMap->music : 0;
+    const MapInfo::MusicTrack* const pMusicTrack = MapInfo::getMusicTrack(mapMusicTrack);
+    const bool bPlayCdMusic = (pMap) ? pMap->bPlayCdMusic : false;
+
+    if (pMusicTrack && (pMusicTrack->sequenceNum != 0) && (!bPlayCdMusic)) {
+        AsyncIo::preloadFile(S_GetMusicLcdFileId(mapMusicTrack));
+    }
+
+    // Sound samples for the map
+    const CdFileId mapSoundLcdFileId = S_GetMapSoundLcdFileId(mapNum);
+
+    if (mapSoundLcdFileId != CdFileId{}) {
+        AsyncIo::preloadFile(mapSoundLcdFileId);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Stop the currently playing music track.
 // PsyDoom: this function has been rewritten. For the original version see the 'Old' folder.
@@ -305,6 +364,11 @@ void S_LoadMapSoundAndMusic(const int32_t mapNum) noexcept {
     if (gLoadedSoundAndMusMapNum == mapNum)
         return;
 
+    // PsyDoom: start reading all of the LCD files needed up front, so the reads overlap with each other and with the work below
+    #if PSYDOOM_MODS
+        S_PreloadMapSoundAndMusic(mapNum);
+    #endif
+
     // Stop current map music, free all music sequences and unload map SFX
     if (gLoadedSoundAndMusMapNum != 0) {
         if (gCurMusicSeqIdx != 0) {
@@ -389,42 +453,21 @@ void S_LoadMapSoundAndMusic(const int32_t mapNum) noexcept {
 
     // Load the sound LCD file for the map (if we are on one).
     // Note that if we are doing the finale then load LCD number max(60, numMaps) because Final Doom still uses '60' for the finale LCD.
-    //
-    // PsyDoom: if 'ALLMAPS.LCD' is present in the user data dir (and we are not doing the finale) then load that instead with the expectation
-    // that it will contain all enemy sounds in the game. We can just blank load everything and provide a master LCD with all enemy sounds
-    // because of PsyDoom's greatly expanded sound RAM.
+    // PsyDoom: the choice of LCD file is now done by a helper, which also allows a master 'ALLMAPS.LCD' and finale LCDs specified by MAPINFO.
     #if PSYDOOM_MODS
-        bool bLoadedMapSounds = false;
-
-        if ((!bIsFinale) && (mapNum > 0) && ModMgr::areOverridesAvailableForFile("ALLMAPS.LCD")) {
-            destSpuAddr += wess_dig_lcd_load("ALLMAPS.LCD", destSpuAddr, &gMapSndBlock, false);
-            bLoadedMapSounds = true;
-        }
+        const CdFileId mapSoundLcdFileId = S_GetMapSoundLcdFileId(mapNum);
     #else
-        constexpr bool bLoadedMapSounds = false;
-    #endif
-
-    if (!bLoadedMapSounds) {
         CdFileId mapSoundLcdFileId = {};
 
         if (mapNum > Game::getNumMaps()) {
-            // Load the finale LCD, which is normally 'MAP60.LCD' for both Doom and Final Doom.
-            // PsyDoom: this can now be flexibly specified in MAPINFO.
-            #if PSYDOOM_MODS
-                // N.B: need to use the 'gGameMap' field at this point to lookup the cluster because the map number passed in for the finale is NOT valid
-                const MapInfo::Map* const pGameEndMap = MapInfo::getMap(gGameMap);
-                const MapInfo::Cluster* const pCluster = (pGameEndMap) ? MapInfo::getCluster(pGameEndMap->cluster) : nullptr;
-                mapSoundLcdFileId = (pCluster) ? pCluster->castLcdFile : CdFileId{};
-            #else
-                mapSoundLcdFileId = S_GetSoundLcdFileId(std::max(60, Game::getNumMaps() + 1));
-            #endif
+            mapSoundLcdFileId = S_GetSoundLcdFileId(std::max(60, Game::getNumMaps() + 1));
         } else if (mapNum > 0) {
             mapSoundLcdFileId = S_GetSoundLcdFileId(mapNum);    // Normal map LCD
         }
+    #endif
 
-        if (mapSoundLcdFileId != CdFileId{}) {
-            wess_dig_lcd_load(mapSoundLcdFileId, destSpuAddr, &gMapSndBlock, false);
-        }
+    if (mapSoundLcdFileId != CdFileId{}) {
+        wess_dig_lcd_load(mapSoundLcdFileId, destSpuAddr, &gMapSndBlock, false);
     }
 }
 
@@ -715,25 +758,32 @@ void PsxSoundInit(const int32_t sfxVol, const int32_t musVol, void* const pTmpWm
         wess_set_mute_release(256);     // ~256 MS to fade out
     #endif
 
-    // Read the WMD file into the given buffer (assumes it is big enough)
-    PsxCd_File* const pFile = psxcd_open(CdFile::DOOMSND_WMD);
-
+    // Read the WMD file into the given buffer (assumes it is big enough).
+    // PsyDoom: issue the read for the WMD file and the main SFX LCD (loaded further below) up front so they proceed in parallel in the
+    // background, then wait just once for the WMD file. The 'PsxCd_File' struct has also changed layout & contents.
     #if PSYDOOM_MODS
-        if ((!pFile) || (pFile->size <= 0)) {
-            FatalErrors::raise("Failed to open DOOMSFX.WMD!");
+        AsyncIo::FileSource wmdFileSource;
+
+        if ((!AsyncIo::getFileSource(CdFile::DOOMSND_WMD, wmdFileSource)) || (wmdFileSource.size <= 0)) {
+            FatalErrors::raise("Failed to open DOOMSND.WMD!");
         }
-    #endif
 
-    // PsyDoom: the 'PsxCd_File' struct has changed layout & contents
-    #if PSYDOOM_MODS
-        const int32_t wmdFileSize = pFile->size;
-        psxcd_read(pTmpWmdLoadBuffer, wmdFileSize, *pFile);
+        const int32_t wmdFileSize = wmdFileSource.size;
+        const AsyncIo::Token wmdReadToken = AsyncIo::submitRead(wmdFileSource, 0, wmdFileSize, pTmpWmdLoadBuffer);
+
+        if (!ProgArgs::gbHeadlessMode) {
+            AsyncIo::preloadFile(CdFile::DOOMSFX_LCD);
+        }
+
+        if (!AsyncIo::wait(wmdReadToken)) {
+            FatalErrors::raise("Failed to read DOOMSND.WMD!");
+        }
     #else
+        PsxCd_File* const pFile = psxcd_open(CdFile::DOOMSND_WMD);
         psxcd_read(pTmpWmdLoadBuffer, pFile->file.size, *pFile);
+        psxcd_close(*pFile);
     #endif
 
-    psxcd_close(*pFile);
-
     // Initialize the sample blocks used to keep track what sounds are uploaded to where in SPU RAM
     S_InitSampleBlock(gDoomSndBlock);
     S_InitSampleBlock(gMapSndBlock);
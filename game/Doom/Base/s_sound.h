@@ -52,6 +52,7 @@ void S_SetMusicVolume(const int32_t musVol) noexcept;
 #if PSYDOOM_MODS
     CdFileId S_GetMusicLcdFileId(const int32_t trackNum) noexcept;
     CdFileId S_GetSoundLcdFileId(const int32_t num) noexcept;
+    void S_PreloadMapSoundAndMusic(const int32_t mapNum) noexcept;
 #endif
 
 void S_StopMusic() noexcept;
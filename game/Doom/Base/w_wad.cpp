@@ -212,6 +212,11 @@ void decode(const void* pSrc, void* pDst) noexcept {
     WadUtils::decompressLump(pSrc, pDst);
 }
 
+// PsyDoom: faster decoding when the size of the output buffer is known
+void decode(const void* pSrc, void* pDst, const size_t dstBufferSize) noexcept {
+    WadUtils::decompressLump(pSrc, pDst, dstBufferSize);
+}
+
 uint32_t getDecodedSize(const void* const pSrc) noexcept {
     return WadUtils::getDecompressedLumpSize(pSrc);
 }
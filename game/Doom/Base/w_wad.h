@@ -44,6 +44,7 @@ int32_t W_MapLumpLength(const int32_t lumpIdx) noexcept;
 int32_t W_RawMapLumpLength(const int32_t lumpIdx) noexcept;
 void W_ReadMapLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept;
 void decode(const void* pSrc, void* pDst) noexcept;
+void decode(const void* pSrc, void* pDst, const size_t dstBufferSize) noexcept;
 uint32_t getDecodedSize(const void* const pSrc) noexcept;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
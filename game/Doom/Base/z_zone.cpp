@@ -1,10 +1,12 @@
 #include "z_zone.h"
 
+#include "Asserts.h"
 #include "Doom/psx_main.h"
 #include "EngineLimits.h"
 #include "i_main.h"
 #include "PsyDoom/Config/Config.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 
@@ -20,6 +22,463 @@ static std::unique_ptr<std::byte[]> gZoneHeap;
 // The main (and only) memory zone used by PSX DOOM
 memzone_t* gpMainMemZone;
 
+#if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+    struct zonepool_t;
+
+    // PsyDoom: header for an item allocated from a zone memory pool
+    struct poolitem_t {
+        zonepool_t*     pPool;          // The pool that the item was allocated from, or 'nullptr' if the item is free
+        poolitem_t*     pNextFree;      // The next item in the pool's free list (only used while the item is free)
+    };
+
+    // PsyDoom: a pool of same sized items, carved out of larger 'slab' blocks allocated from the zone.
+    // All of the slabs in a pool share the same tag, so they are freed together by 'Z_FreeTags' just like individually allocated blocks.
+    // Every slab also uses 'pLastSlab' as it's owner pointer; the zone nulls this field when the slabs are freed, which tells the pool
+    // that all of it's items are gone and that it must start afresh.
+    struct zonepool_t {
+        void*           pLastSlab;          // The most recently allocated slab, 'nullptr' if there are no slabs
+        poolitem_t*     pFreeItems;         // Linked list of freed items, available for reuse
+        std::byte*      pNextUnusedItem;    // The next never used item in the last slab
+        std::byte*      pSlabEnd;           // The end of the last slab
+    };
+
+    static constexpr int32_t POOL_SIZE_GRANULARITY  = 16;           // Pooled allocation sizes are rounded up to a multiple of this
+    static constexpr int32_t NUM_POOL_SIZE_CLASSES  = 64;           // Number of allocation size classes: the largest size that can be pooled is 1 KiB
+    static constexpr int32_t NUM_POOL_TAGS          = 4;            // Number of tags that can be pooled: 'PU_STATIC', 'PU_LEVEL', 'PU_LEVSPEC' and 'PU_ANIMATION'
+    static constexpr int32_t POOL_SLAB_SIZE         = 32 * 1024;    // Rough size of each slab allocated by a pool
+
+    // PsyDoom: memory pools for each combination of non purgable tag and allocation size class
+    static zonepool_t gZonePools[NUM_POOL_TAGS][NUM_POOL_SIZE_CLASSES];
+
+    // PsyDoom: the links for the free list that a free block is in.
+    // These are stored in the otherwise unused memory following the header of a free block.
+    struct memfreelinks_t {
+        memblock_t*     pNextFree;
+        memblock_t*     pPrevFree;
+    };
+
+    // PsyDoom: the smallest size allowed for a block, so that every block has room for free list links when it is freed
+    static constexpr int32_t MIN_BLOCK_SIZE = (int32_t)(sizeof(memblock_t) + sizeof(memfreelinks_t));
+
+    // PsyDoom: the number of leftover bytes which must be exceeded to split off a new free block.
+    // 'MINFRAGMENT' alone is not enough on 64-bit platforms, where it is smaller than 'MIN_BLOCK_SIZE'.
+    static constexpr int32_t MIN_SPLIT_FRAGMENT = std::max(MINFRAGMENT, MIN_BLOCK_SIZE);
+#endif
+
+#if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: helpers for maintaining the indexes of free blocks in a memory zone
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memfreelinks_t& Z_GetFreeLinks(memblock_t& block) noexcept {
+    return *(memfreelinks_t*) &(&block)[1];
+}
+
+static int32_t Z_FloorLog2(uint32_t value) noexcept {
+    int32_t log2 = 0;
+
+    for (int32_t shift = 16; shift > 0; shift >>= 1) {
+        if (value >= (1u << shift)) {
+            value >>= shift;
+            log2 += shift;
+        }
+    }
+
+    return log2;
+}
+
+static int32_t Z_LowestSetBit(const uint32_t value) noexcept {
+    int32_t bitIdx = 0;
+
+    while ((value & (1u << bitIdx)) == 0) {
+        ++bitIdx;
+    }
+
+    return bitIdx;
+}
+
+static void Z_GetFreeListIndex(const int32_t size, int32_t& level, int32_t& subLevel) noexcept {
+    if (size < Z_SMALL_BLOCK_SIZE) {
+        level = 0;
+        subLevel = size / (Z_SMALL_BLOCK_SIZE / Z_FREE_LIST_SUB_LEVELS);
+    } else {
+        const int32_t sizeLog2 = Z_FloorLog2((uint32_t) size);
+        level = sizeLog2 - Z_SMALL_BLOCK_SIZE_LOG2 + 1;
+        subLevel = (size >> (sizeLog2 - Z_FREE_LIST_SUB_LEVELS_LOG2)) - Z_FREE_LIST_SUB_LEVELS;
+    }
+}
+
+static void Z_AddFreeBlock(memzone_t& zone, memblock_t& block) noexcept {
+    int32_t level, subLevel;
+    Z_GetFreeListIndex(block.size, level, subLevel);
+
+    memblock_t*& pListHead = zone.freeLists[level][subLevel];
+    memfreelinks_t& links = Z_GetFreeLinks(block);
+    links.pNextFree = pListHead;
+    links.pPrevFree = nullptr;
+
+    if (pListHead) {
+        Z_GetFreeLinks(*pListHead).pPrevFree = &block;
+    }
+
+    pListHead = &block;
+    zone.freeSubLevelMasks[level] |= (uint8_t)(1u << subLevel);
+    zone.freeLevelMask |= 1u << level;
+}
+
+static void Z_RemoveFreeBlock(memzone_t& zone, memblock_t& block) noexcept {
+    // Note: the block size must not have changed since the block was added to the free lists
+    int32_t level, subLevel;
+    Z_GetFreeListIndex(block.size, level, subLevel);
+
+    const memfreelinks_t& links = Z_GetFreeLinks(block);
+
+    if (links.pNextFree) {
+        Z_GetFreeLinks(*links.pNextFree).pPrevFree = links.pPrevFree;
+    }
+
+    if (links.pPrevFree) {
+        Z_GetFreeLinks(*links.pPrevFree).pNextFree = links.pNextFree;
+    } else {
+        zone.freeLists[level][subLevel] = links.pNextFree;
+
+        // Update the masks of non-empty lists if this list is now empty
+        if (!links.pNextFree) {
+            zone.freeSubLevelMasks[level] &= (uint8_t) ~(1u << subLevel);
+
+            if (zone.freeSubLevelMasks[level] == 0) {
+                zone.freeLevelMask &= ~(1u << level);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: helpers for maintaining the lists of used blocks with each tag
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t Z_GetTagListIndex(const int16_t tag) noexcept {
+    const uint32_t tagBits = (uint16_t) tag;
+
+    if ((tagBits == 0) || ((tagBits & (tagBits - 1)) != 0))
+        return Z_OTHER_TAG_LIST;
+
+    return Z_LowestSetBit(tagBits);
+}
+
+static void Z_AddToTagList(memzone_t& zone, memblock_t& block) noexcept {
+    memblock_t*& pListHead = zone.tagLists[Z_GetTagListIndex(block.tag)];
+    block.tagNext = pListHead;
+    block.tagPrev = nullptr;
+
+    if (pListHead) {
+        pListHead->tagPrev = &block;
+    }
+
+    pListHead = &block;
+}
+
+static void Z_RemoveFromTagList(memzone_t& zone, memblock_t& block) noexcept {
+    if (block.tagNext) {
+        block.tagNext->tagPrev = block.tagPrev;
+    }
+
+    if (block.tagPrev) {
+        block.tagPrev->tagNext = block.tagNext;
+    } else {
+        zone.tagLists[Z_GetTagListIndex(block.tag)] = block.tagNext;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: find a free block which is at least the given size using the free lists, without removing it from the lists.
+// May fail to find a block even if one of the right size exists; in that case the caller must fall back to searching the block list.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t* Z_FindFreeBlock(memzone_t& zone, const int32_t size) noexcept {
+    // Round the size up to the start of the next free list, so that every block in the list searched is guaranteed to be big enough
+    const int32_t granularity = (size < Z_SMALL_BLOCK_SIZE) ?
+        Z_SMALL_BLOCK_SIZE / Z_FREE_LIST_SUB_LEVELS :
+        1 << (Z_FloorLog2((uint32_t) size) - Z_FREE_LIST_SUB_LEVELS_LOG2);
+
+    const int64_t roundedSize = (int64_t) size + granularity - 1;
+
+    if (roundedSize > INT32_MAX)
+        return nullptr;
+
+    int32_t level, subLevel;
+    Z_GetFreeListIndex((int32_t) roundedSize, level, subLevel);
+
+    // Look for a non-empty list in the same level first, then the smallest non-empty list in any level above that
+    uint32_t subLevelMask = zone.freeSubLevelMasks[level] & (0xFFu << subLevel);
+
+    if (subLevelMask == 0) {
+        const uint32_t levelMask = (level + 1 < 32) ? zone.freeLevelMask & (0xFFFFFFFFu << (level + 1)) : 0;
+
+        if (levelMask == 0)
+            return nullptr;
+
+        level = Z_LowestSetBit(levelMask);
+        subLevelMask = zone.freeSubLevelMasks[level];
+    }
+
+    return zone.freeLists[level][Z_LowestSetBit(subLevelMask)];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: marks the given block as free, merges it with any adjacent free blocks and adds the result to the free lists.
+// Returns the free block that the given block ended up being part of.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t& Z_FreeBlock(memzone_t& zone, memblock_t& block) noexcept {
+    // Clear the pointer field referencing the memory block (treating very small addresses as not pointers) and mark the block free.
+    // The block is also no longer in the list of used blocks for it's tag.
+    if (block.user > (void*) 0x100) {
+        *block.user = nullptr;
+    }
+
+    Z_RemoveFromTagList(zone, block);
+
+    block.user = nullptr;
+    block.tag = 0;
+    block.id = 0;
+
+    // Merge with the previous block if free
+    memblock_t* pFreeBlock = &block;
+    memblock_t* const pPrevBlock = block.prev;
+
+    if (pPrevBlock && (!pPrevBlock->user)) {
+        Z_RemoveFreeBlock(zone, *pPrevBlock);
+        pPrevBlock->size += block.size;
+        pPrevBlock->next = block.next;
+
+        if (block.next) {
+            block.next->prev = pPrevBlock;
+        }
+
+        if (zone.rover == &block) {
+            zone.rover = pPrevBlock;
+        }
+
+        pFreeBlock = pPrevBlock;
+    }
+
+    // Merge with the next block if free
+    memblock_t* const pNextBlock = pFreeBlock->next;
+
+    if (pNextBlock && (!pNextBlock->user)) {
+        Z_RemoveFreeBlock(zone, *pNextBlock);
+        pFreeBlock->size += pNextBlock->size;
+        pFreeBlock->next = pNextBlock->next;
+
+        if (pNextBlock->next) {
+            pNextBlock->next->prev = pFreeBlock;
+        }
+
+        if (zone.rover == pNextBlock) {
+            zone.rover = pFreeBlock;
+        }
+    }
+
+    Z_AddFreeBlock(zone, *pFreeBlock);
+    return *pFreeBlock;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: purges all purgable blocks in the given run of free or purgable blocks, leaving a single free block covering the entire run.
+// The free block is removed from the free lists and returned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t& Z_PurgeBlockRun(memzone_t& zone, memblock_t& firstBlock, const memblock_t& lastBlock) noexcept {
+    const std::byte* const pRunEnd = (const std::byte*) &lastBlock + lastBlock.size;
+    memblock_t* pBlock = &firstBlock;
+
+    while (true) {
+        // Chuck out this block if it's purgable: this also merges it with the free blocks around it
+        if (pBlock->user) {
+            ASSERT(pBlock->tag >= PU_PURGELEVEL);
+            pBlock = &Z_FreeBlock(zone, *pBlock);
+        }
+
+        if ((const std::byte*) pBlock + pBlock->size >= pRunEnd)
+            break;
+
+        pBlock = pBlock->next;
+    }
+
+    Z_RemoveFreeBlock(zone, *pBlock);
+    return *pBlock;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells if a block is free or can be purged to make room for an allocation
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool Z_IsBlockFreeOrPurgable(const memblock_t& block) noexcept {
+    return ((!block.user) || (block.tag >= PU_PURGELEVEL));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: setup a block which has just been allocated (and removed from the free lists) to hold an allocation of the given size.
+// Any excess space following the allocation is split off into a new free block.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void Z_SetupAllocatedBlock(memzone_t& zone, memblock_t& block, const int32_t allocSize, const int16_t tag, void** const ppUser) noexcept {
+    // If there are enough free bytes following the allocation then make a new free memory block
+    const int32_t numUnusedBytes = block.size - allocSize;
+
+    if (numUnusedBytes > MIN_SPLIT_FRAGMENT) {
+        memblock_t& newBlock = *(memblock_t*)((std::byte*) &block + allocSize);
+        newBlock.prev = &block;
+        newBlock.next = block.next;
+
+        if (block.next) {
+            block.next->prev = &newBlock;
+        }
+
+        block.next = &newBlock;
+        block.size = allocSize;
+
+        newBlock.size = numUnusedBytes;
+        newBlock.user = nullptr;
+        newBlock.tag = 0;
+        Z_AddFreeBlock(zone, newBlock);
+    }
+
+    // Setup the links on the memory block back to the pointer referencing it, and the pointer referencing it (if given)
+    if (ppUser) {
+        block.user = ppUser;
+        *ppUser = &(&block)[1];
+    } else {
+        if (tag >= PU_PURGELEVEL) {
+            I_Error("Z_Malloc: an owner is required for purgable blocks");
+        }
+
+        // Non purgable blocks without any owner are assigned a pointer value of '1'
+        block.user = (void**) 1;
+    }
+
+    block.tag = tag;
+    block.id = ZONEID;
+    Z_AddToTagList(zone, block);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: implementation of 'Z_Malloc' using the free block indexes.
+// The free lists are tried first and if no block is found the block list is searched from the rover for a run of free or purgable blocks
+// which is big enough, exactly like the original 'Z_Malloc'. Purgable blocks are therefore only thrown out when there is no other option.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void* Z_IndexedMalloc(memzone_t& zone, const int32_t allocSize, const int16_t tag, void** const ppUser) noexcept {
+    memblock_t* pBase = Z_FindFreeBlock(zone, allocSize);
+
+    if (pBase) {
+        Z_RemoveFreeBlock(zone, *pBase);
+    } else {
+        // Search from the rover to the end of the block list first, then the entire block list
+        memblock_t* const startBlocks[2] = { zone.rover, &zone.blocklist };
+
+        for (memblock_t* const pStartBlock : startBlocks) {
+            memblock_t* pRunStart = nullptr;
+            int64_t runSize = 0;
+
+            for (memblock_t* pBlock = pStartBlock; pBlock; pBlock = pBlock->next) {
+                if (!Z_IsBlockFreeOrPurgable(*pBlock)) {
+                    pRunStart = nullptr;
+                    runSize = 0;
+                    continue;
+                }
+
+                if (!pRunStart) {
+                    pRunStart = pBlock;
+                }
+
+                runSize += pBlock->size;
+
+                if (runSize >= allocSize) {
+                    pBase = &Z_PurgeBlockRun(zone, *pRunStart, *pBlock);
+                    break;
+                }
+            }
+
+            if (pBase)
+                break;
+        }
+
+        // If we didn't find anything then we're out of RAM :(
+        if (!pBase) {
+            Z_DumpHeap();
+            I_Error("Z_Malloc: failed allocation on %i", allocSize);
+        }
+    }
+
+    Z_SetupAllocatedBlock(zone, *pBase, allocSize, tag, ppUser);
+
+    // Move along the rover to the next block and return the usable memory allocated (past the allocated block header)
+    zone.rover = (pBase->next) ? pBase->next : &zone.blocklist;
+    return &pBase[1];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: implementation of 'Z_EndMalloc' using the free block indexes.
+// Searches backwards from the end of the heap for a run of free or purgable blocks which is big enough, and allocates at the end of that.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void* Z_IndexedEndMalloc(memzone_t& zone, const int32_t allocSize, const int16_t tag, void** const ppUser) noexcept {
+    // Start at the very last block in the list, since we want to alloc at the end of the heap
+    memblock_t* pLastBlock = &zone.blocklist;
+
+    while (pLastBlock->next) {
+        pLastBlock = pLastBlock->next;
+    }
+
+    // Find the last run of free or purgable blocks big enough and purge it
+    memblock_t* pFreeBlock = nullptr;
+    memblock_t* pRunEnd = nullptr;
+    int64_t runSize = 0;
+
+    for (memblock_t* pBlock = pLastBlock; pBlock; pBlock = pBlock->prev) {
+        if (!Z_IsBlockFreeOrPurgable(*pBlock)) {
+            pRunEnd = nullptr;
+            runSize = 0;
+            continue;
+        }
+
+        if (!pRunEnd) {
+            pRunEnd = pBlock;
+        }
+
+        runSize += pBlock->size;
+
+        if (runSize >= allocSize) {
+            pFreeBlock = &Z_PurgeBlockRun(zone, *pBlock, *pRunEnd);
+            break;
+        }
+    }
+
+    if (!pFreeBlock) {
+        I_Error("Z_Malloc: failed allocation on %i", allocSize);
+    }
+
+    // If there are enough free bytes before the allocation then make a new free block there.
+    // Unlike the regular Z_Malloc, the new block is added BEFORE the allocated memory.
+    memblock_t* pBase = pFreeBlock;
+    const int32_t numUnusedBytes = pFreeBlock->size - allocSize;
+
+    if (numUnusedBytes > MIN_SPLIT_FRAGMENT) {
+        pBase = (memblock_t*)((std::byte*) pFreeBlock + numUnusedBytes);
+        pBase->size = allocSize;
+        pBase->prev = pFreeBlock;
+        pBase->next = pFreeBlock->next;
+
+        if (pFreeBlock->next) {
+            pFreeBlock->next->prev = pBase;
+        }
+
+        pFreeBlock->next = pBase;
+        pFreeBlock->size = numUnusedBytes;
+        Z_AddFreeBlock(zone, *pFreeBlock);
+    }
+
+    Z_SetupAllocatedBlock(zone, *pBase, allocSize, tag, ppUser);
+
+    // Set the rover for the zone and return the usable memory allocated (past the allocated block header)
+    zone.rover = &zone.blocklist;
+    return &pBase[1];
+}
+#endif  // #if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the zone memory management system. DOOM doesn't use any PsyQ SDK allocation functions AT ALL (either directly or indirectly)
 // so it just gobbles up the entire of the available heap space on the system for it's own purposes.
@@ -59,6 +518,16 @@ memzone_t* Z_InitZone(void* const pBase, const int32_t size) noexcept {
 
     pZone->blocklist.next = nullptr;
     pZone->blocklist.prev = nullptr;
+
+    // PsyDoom: initialize the free block indexes (which just contain the single initial block) and the lists of used blocks by tag
+    #if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+        pZone->freeLevelMask = 0;
+        std::memset(pZone->freeSubLevelMasks, 0, sizeof(pZone->freeSubLevelMasks));
+        std::memset(pZone->freeLists, 0, sizeof(pZone->freeLists));
+        std::memset(pZone->tagLists, 0, sizeof(pZone->tagLists));
+        Z_AddFreeBlock(*pZone, pZone->blocklist);
+    #endif
+
     return pZone;
 }
 
@@ -75,6 +544,11 @@ void* Z_Malloc(memzone_t& zone, const int32_t size, const int16_t tag, void** co
         const int32_t allocSize = (size + sizeof(memblock_t) + 3) & 0xFFFFFFFC;
     #endif
 
+    // PsyDoom: use the free block indexes to find a free block for limit removing builds, since the heap can be very large
+    #if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+        return Z_IndexedMalloc(zone, std::max(allocSize, MIN_BLOCK_SIZE), tag, ppUser);
+    #else
+
     // Scan through the block list looking for the first free block of sufficient size.
     // Also throw out any purgable blocks along the way.
     memblock_t* pBase = zone.rover;
@@ -169,6 +643,7 @@ void* Z_Malloc(memzone_t& zone, const int32_t size, const int16_t tag, void** co
     // Move along the rover to the next block and return the usable memory allocated (past the allocated block header)
     zone.rover = (pBase->next) ? pBase->next : &zone.blocklist;
     return &pBase[1];
+    #endif  // #if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -184,6 +659,11 @@ void* Z_EndMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void**
         const int32_t allocSize = (size + sizeof(memblock_t) + 3) & 0xFFFFFFFC;
     #endif
 
+    // PsyDoom: use a version that keeps the free block indexes up to date for limit removing builds
+    #if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+        return Z_IndexedEndMalloc(zone, std::max(allocSize, MIN_BLOCK_SIZE), tag, ppUser);
+    #else
+
     // Start at the very last block in the list, since we want to alloc at the end of the heap
     memblock_t* pBase = &zone.blocklist;
 
@@ -279,6 +759,7 @@ void* Z_EndMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void**
     // Set the rover for the zone and return the usable memory allocated (past the allocated block header)
     zone.rover = &zone.blocklist;
     return (void*) &pBase[1];
+    #endif  // #if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -294,21 +775,53 @@ void Z_Free2([[maybe_unused]] memzone_t& zone, void* const ptr) noexcept {
         I_Error("Z_Free: freed a pointer without ZONEID");
     }
 
-    // Clear the pointer field referencing the memory block too.
-    // Treat very small addresses as not pointers also:
-    if (block.user > (void*) 0x100) {
-        *block.user = nullptr;
-    }
+    // PsyDoom: free blocks must be merged and indexed immediately in limit removing builds, to keep the free block indexes valid
+    #if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+        Z_FreeBlock(zone, block);
+    #else
+        // Clear the pointer field referencing the memory block too.
+        // Treat very small addresses as not pointers also:
+        if (block.user > (void*) 0x100) {
+            *block.user = nullptr;
+        }
 
-    block.user = nullptr;
-    block.tag = 0;
-    block.id = 0;
+        block.user = nullptr;
+        block.tag = 0;
+        block.id = 0;
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Free memory blocks that have one or more of the given tag bits
 //------------------------------------------------------------------------------------------------------------------------------------------
 void Z_FreeTags(memzone_t& zone, const int16_t tagBits) noexcept {
+    // PsyDoom: in limit removing builds only visit the blocks being freed, using the lists of used blocks for each tag.
+    // Adjacent free blocks are merged immediately when each block is freed, so there is no need for a merge pass afterwards either.
+    #if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+        for (int32_t tagBitIdx = 0; tagBitIdx < Z_NUM_TAG_BITS; ++tagBitIdx) {
+            if ((tagBits & (1 << tagBitIdx)) == 0)
+                continue;
+
+            // Note: freeing a block removes it from the list
+            while (memblock_t* const pBlock = zone.tagLists[tagBitIdx]) {
+                Z_FreeBlock(zone, *pBlock);
+            }
+        }
+
+        // Blocks with unusual tags must be checked individually
+        memblock_t* pNextBlock;
+
+        for (memblock_t* pBlock = zone.tagLists[Z_OTHER_TAG_LIST]; pBlock; pBlock = pNextBlock) {
+            pNextBlock = pBlock->tagNext;
+
+            if ((pBlock->tag & tagBits) != 0) {
+                Z_FreeBlock(zone, *pBlock);
+            }
+        }
+
+        zone.rover = &zone.blocklist;
+    #else
+
     // Free each block if it is in use and matches one of the given tags
     for (memblock_t* pBlock = &zone.blocklist; pBlock; pBlock = pBlock->next) {
         if (pBlock->user) {
@@ -350,6 +863,7 @@ void Z_FreeTags(memzone_t& zone, const int16_t tagBits) noexcept {
 
     // Reset the rover back to the start of the heap
     zone.rover = &zone.blocklist;
+    #endif  // #if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -407,13 +921,22 @@ void Z_ChangeTag(void* const ptr, const int16_t tagBits) noexcept {
         }
     }
 
-    block.tag = (int16_t) tagBits;
+    // PsyDoom: move the block to the list of used blocks for the new tag in limit removing builds
+    #if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+        Z_RemoveFromTagList(*gpMainMemZone, block);
+        block.tag = (int16_t) tagBits;
+        Z_AddToTagList(*gpMainMemZone, block);
+    #else
+        block.tag = (int16_t) tagBits;
+    #endif
 }
 
 #if PSYDOOM_MODS
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom addition: clear or set the 'user' field for an already allocated memory block.
 // Useful for detaching a block from the lump cache for instance, or for transferring memory ownership.
+// Note: a block with no user must not be purgable, and is assigned the same special user value as ownerless blocks from 'Z_Malloc'.
+// A null user would make the block look free to the allocator.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void Z_SetUser(void* const ptr, void** const ppUser) noexcept {
     memblock_t& block = ((memblock_t*) ptr)[-1];
@@ -423,7 +946,15 @@ void Z_SetUser(void* const ptr, void** const ppUser) noexcept {
         I_Error("Z_SetUser: pointer has incorrect ZONEID");
     }
 
-    block.user = ppUser;
+    if (ppUser) {
+        block.user = ppUser;
+    } else {
+        if (block.tag >= PU_PURGELEVEL) {
+            I_Error("Z_SetUser: an owner is required for purgable blocks");
+        }
+
+        block.user = (void**) 1;
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -434,6 +965,97 @@ void* Z_ZeroedMalloc(memzone_t& zone, const int32_t size, const int16_t tag, voi
     std::memset(pMemory, 0, size);
     return pMemory;
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: allocate a small block of memory with the given (non purgable) tag from a pool of same sized items.
+// This is much cheaper than 'Z_Malloc' for frequently allocated and freed things like map objects and thinkers, and also avoids fragmenting
+// the zone. The memory MUST be freed with 'Z_PoolFree' or released in bulk with 'Z_FreeTags', exactly like a regular zone allocation.
+//
+// Note: pooling is only done for limit removing builds, where heap memory is not as tight. Otherwise this is the same as 'Z_Malloc'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void* Z_PoolMalloc(memzone_t& zone, const int32_t size, const int16_t tag) noexcept {
+    #if PSYDOOM_LIMIT_REMOVING
+        // Figure out which pool to allocate from
+        const int32_t sizeClass = (size + POOL_SIZE_GRANULARITY - 1) / POOL_SIZE_GRANULARITY;
+
+        if ((sizeClass < 0) || (sizeClass >= NUM_POOL_SIZE_CLASSES)) {
+            I_Error("Z_PoolMalloc: can't pool an allocation of size %i", size);
+        }
+
+        int32_t tagIdx = 0;
+
+        while ((tagIdx < NUM_POOL_TAGS) && (tag != (1 << tagIdx))) {
+            ++tagIdx;
+        }
+
+        if (tagIdx >= NUM_POOL_TAGS) {
+            I_Error("Z_PoolMalloc: can't pool an allocation with tag %i", (int32_t) tag);
+        }
+
+        zonepool_t& pool = gZonePools[tagIdx][sizeClass];
+
+        // If the slabs for the pool were freed (via 'Z_FreeTags') then all of the items in the pool are gone too
+        if (!pool.pLastSlab) {
+            pool.pFreeItems = nullptr;
+            pool.pNextUnusedItem = nullptr;
+            pool.pSlabEnd = nullptr;
+        }
+
+        // Reuse a freed item if possible, otherwise use the next unused item in the last slab (allocating a new slab if required)
+        poolitem_t* pItem = pool.pFreeItems;
+
+        if (pItem) {
+            pool.pFreeItems = pItem->pNextFree;
+        } else {
+            const int32_t itemSize = (int32_t) sizeof(poolitem_t) + sizeClass * POOL_SIZE_GRANULARITY;
+
+            if (pool.pSlabEnd - pool.pNextUnusedItem < itemSize) {
+                const int32_t slabSize = std::max(POOL_SLAB_SIZE / itemSize, 1) * itemSize;
+                Z_Malloc(zone, slabSize, tag, &pool.pLastSlab);
+                pool.pNextUnusedItem = (std::byte*) pool.pLastSlab;
+                pool.pSlabEnd = pool.pNextUnusedItem + slabSize;
+            }
+
+            pItem = (poolitem_t*) pool.pNextUnusedItem;
+            pool.pNextUnusedItem += itemSize;
+        }
+
+        pItem->pPool = &pool;
+        pItem->pNextFree = nullptr;
+        return &pItem[1];
+    #else
+        return Z_Malloc(zone, size, tag, nullptr);
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: same as 'Z_PoolMalloc' except the memory returned is zero intialized
+//------------------------------------------------------------------------------------------------------------------------------------------
+void* Z_ZeroedPoolMalloc(memzone_t& zone, const int32_t size, const int16_t tag) noexcept {
+    void* const pMemory = Z_PoolMalloc(zone, size, tag);
+    std::memset(pMemory, 0, size);
+    return pMemory;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: free memory allocated with 'Z_PoolMalloc', returning it to the pool it came from
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Z_PoolFree([[maybe_unused]] memzone_t& zone, void* const ptr) noexcept {
+    #if PSYDOOM_LIMIT_REMOVING
+        poolitem_t& item = ((poolitem_t*) ptr)[-1];
+        zonepool_t* const pPool = item.pPool;
+
+        if (!pPool) {
+            I_Error("Z_PoolFree: freed a pointer which is not an allocated pool item");
+        }
+
+        item.pPool = nullptr;
+        item.pNextFree = pPool->pFreeItems;
+        pPool->pFreeItems = &item;
+    #else
+        Z_Free2(zone, ptr);
+    #endif
+}
 #endif  // #if PSYDOOM_MODS
 
 //------------------------------------------------------------------------------------------------------------------------------------------
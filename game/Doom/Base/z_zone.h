@@ -27,12 +27,40 @@ struct memblock_t {
     int32_t         lockframe;      // Don't purge on this frame
     memblock_t*     next;
     memblock_t*     prev;
+#if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+    memblock_t*     tagNext;        // PsyDoom: intrusive list of all the used blocks with the same tag, so blocks can be freed by tag quickly
+    memblock_t*     tagPrev;
+#endif
 };
 
+#if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+    // PsyDoom: free blocks are kept in segregated lists, indexed by a coarse 'level' (power of two size range) and a finer 'sub level'.
+    // Blocks smaller than 'Z_SMALL_BLOCK_SIZE' all go in level '0', which is divided up linearly.
+    static constexpr int32_t Z_FREE_LIST_SUB_LEVELS_LOG2    = 3;
+    static constexpr int32_t Z_FREE_LIST_SUB_LEVELS         = 1 << Z_FREE_LIST_SUB_LEVELS_LOG2;
+    static constexpr int32_t Z_SMALL_BLOCK_SIZE_LOG2        = 8;
+    static constexpr int32_t Z_SMALL_BLOCK_SIZE             = 1 << Z_SMALL_BLOCK_SIZE_LOG2;
+    static constexpr int32_t Z_FREE_LIST_LEVELS             = 31 - Z_SMALL_BLOCK_SIZE_LOG2 + 1;
+
+    // PsyDoom: used blocks are kept in a list for each tag bit.
+    // Blocks with tags that are not a single bit (not used by the game) go in one extra list which is searched for all tags.
+    static constexpr int32_t Z_NUM_TAG_BITS     = 16;
+    static constexpr int32_t Z_OTHER_TAG_LIST   = Z_NUM_TAG_BITS;
+    static constexpr int32_t Z_NUM_TAG_LISTS    = Z_NUM_TAG_BITS + 1;
+#endif
+
 // Info for a memory allocation zone
 struct memzone_t {
     int32_t         size;           // Total bytes malloced, including header
     memblock_t*     rover;
+#if PSYDOOM_MODS && PSYDOOM_LIMIT_REMOVING
+    // PsyDoom: indexes of all the free blocks in the zone, so that allocations don't need to walk the entire block list.
+    // There is a bit set in the masks for each non-empty free list (sub mask) and for each level with any non-empty free lists (level mask).
+    uint32_t        freeLevelMask;
+    uint8_t         freeSubLevelMasks[Z_FREE_LIST_LEVELS];
+    memblock_t*     freeLists[Z_FREE_LIST_LEVELS][Z_FREE_LIST_SUB_LEVELS];
+    memblock_t*     tagLists[Z_NUM_TAG_LISTS];      // PsyDoom: lists of used blocks for each tag bit
+#endif
     memblock_t      blocklist;      // Start / end cap for linked list
 };
 
@@ -50,6 +78,9 @@ void Z_ChangeTag(void* const ptr, const int16_t tagBits) noexcept;
 #if PSYDOOM_MODS
     void Z_SetUser(void* const ptr, void** const ppUser) noexcept;
     void* Z_ZeroedMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void** const ppUser) noexcept;
+    void* Z_PoolMalloc(memzone_t& zone, const int32_t size, const int16_t tag) noexcept;
+    void* Z_ZeroedPoolMalloc(memzone_t& zone, const int32_t size, const int16_t tag) noexcept;
+    void Z_PoolFree(memzone_t& zone, void* const ptr) noexcept;
 #endif
 
 int32_t Z_FreeMemory(memzone_t& zone) noexcept;
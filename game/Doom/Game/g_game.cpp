@@ -31,6 +31,7 @@
 #include "PsyDoom/Game.h"
 #include "PsyDoom/Input.h"
 #include "PsyDoom/MapInfo/MapInfo.h"
+#include "PsyDoom/MapPrefetcher.h"
 #include "PsyDoom/ProgArgs.h"
 #include "PsyDoom/SaveAndLoad.h"
 #include "PsyDoom/Utils.h"
@@ -148,6 +149,11 @@ void G_DoLoadLevel() noexcept {
     P_SetupLevel(gGameMap, gGameSkill);
     Z_CheckHeap(*gpMainMemZone);
 
+    // PsyDoom: free up any prefetched map files which were not used by level setup (e.g because a different map was loaded)
+    #if PSYDOOM_MODS
+        MapPrefetcher::discard();
+    #endif
+
     // No action set upon starting a level
     gGameAction = ga_nothing;
 
@@ -633,6 +639,14 @@ void G_RunGame() noexcept {
         const bool bNextMapExists = (gNextMap <= Game::getNumMaps());
         const bool bIsGameEndMap = (gGameMap == Game::getNumRegularMaps());
 
+        // PsyDoom: start reading the files for the next map in the background while the intermission and finale are being shown.
+        // This way most of the I/O for the next level is done by the time level setup begins.
+        #if PSYDOOM_MODS
+            if (bNextMapExists) {
+                MapPrefetcher::start(gNextMap);
+            }
+        #endif
+
         // Should we do a finale and which one should we do, one with a cast call (Finale 2) or one without? (Finale 1).
         // 
         // PsyDoom: originally for co-op mode the finale was only done for the last map in the game, but I've changed that to make it behave the same as single player.
@@ -386,6 +386,10 @@ static void PB_UnsetThingPosition(mobj_t& thing) noexcept {
 
     // Remove the thing from the blockmap, if it is added to the blockmap
     if ((gTestFlags & MF_NOBLOCKMAP) == 0) {
+        #if PSYDOOM_MODS
+            P_UnlinkBlockThing(thing);  // PsyDoom: keep the compact blockmap thing arrays in sync
+        #endif
+
         if (thing.bnext) {
             thing.bnext->bprev = thing.bprev;
         }
@@ -457,6 +461,10 @@ static void PB_SetThingPosition(mobj_t& mobj) noexcept {
             mobj.bprev = nullptr;
             mobj.bnext = nullptr;
         }
+
+        #if PSYDOOM_MODS
+            P_LinkBlockThing(mobj);     // PsyDoom: keep the compact blockmap thing arrays in sync
+        #endif
     }
 }
 
@@ -749,6 +757,34 @@ static bool PB_BlockLinesIterator(const int32_t x, const int32_t y) noexcept {
 // Stops when a collision is detected and returns 'false', otherwise returns 'true' for no collision.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static bool PB_BlockThingsIterator(const int32_t x, const int32_t y) noexcept {
+    // PsyDoom: use the compact blockmap thing arrays if possible, so things which are out of range can be skipped without touching them.
+    // Note that the range test here is exactly the same one done by 'PB_CheckThing', and things out of range never cause a collision.
+    #if PSYDOOM_MODS
+        const blockthing_t* pThings;
+        int32_t numThings;
+
+        if (P_GetBlockThings(x, y, pThings, numThings)) {
+            const fixed_t baseThingRadius = gpBaseThing->radius;
+
+            for (int32_t thingIdx = numThings - 1; thingIdx >= 0; --thingIdx) {
+                const blockthing_t& bthing = pThings[thingIdx];
+                ASSERT((bthing.x == bthing.pMobj->x) && (bthing.y == bthing.pMobj->y) && (bthing.radius == bthing.pMobj->radius));
+
+                const fixed_t totalRadius = bthing.radius + baseThingRadius;
+                const fixed_t dx = std::abs(bthing.x - gTestX);
+                const fixed_t dy = std::abs(bthing.y - gTestY);
+
+                if ((dx >= totalRadius) || (dy >= totalRadius))
+                    continue;
+
+                if (!PB_CheckThing(*bthing.pMobj))
+                    return false;
+            }
+
+            return true;
+        }
+    #endif
+
     mobj_t* pmobj = gppBlockLinks[x + y * gBlockmapWidth];
 
     while (pmobj) {
@@ -122,6 +122,10 @@ bool PIT_ChangeSector(mobj_t& mobj) noexcept {
         mobj.height = 0;    // This prevents the height clip test from failing again and triggering more crushing
         mobj.radius = 0;
 
+        #if PSYDOOM_MODS
+            P_SyncBlockThing(mobj);     // PsyDoom: the radius was changed in place, update the thing's compact blockmap entry
+        #endif
+
         // PsyDoom: fix a bug where gibs become blocking if the monster is crushed during it's death sequence 
         #if PSYDOOM_MODS
             if (Game::gSettings.bFixBlockingGibsBug) {
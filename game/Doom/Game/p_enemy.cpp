@@ -890,6 +890,7 @@ void A_SkelMissile(mobj_t& actor) noexcept {
 
     #if PSYDOOM_MODS
         R_SnapMobjInterpolation(missile);   // PsyDoom: snap the motion we just added since the missile is just spawning
+        P_SyncBlockThing(missile);          // PsyDoom: the missile was moved in place, update it's compact blockmap entry
     #endif
 }
 
@@ -1659,8 +1660,10 @@ void A_VileAttack(mobj_t& actor) noexcept {
     pFire->x = pTarget->x - FixedMul(24 * FRACUNIT, gFineCosine[angleIdx]);
     pFire->y = pTarget->y - FixedMul(24 * FRACUNIT, gFineSine[angleIdx]);
 
-    // Need to snap the flame motion since it's basically teleports around the map
+    // Need to snap the flame motion since it's basically teleports around the map.
+    // Also update the compact blockmap entry for the flame (if it has one) since it was moved in place.
     R_SnapMobjInterpolation(*pFire);
+    P_SyncBlockThing(*pFire);
 
     // Do the splash damage at the fire location
     P_RadiusAttack(*pFire, &actor, 70);
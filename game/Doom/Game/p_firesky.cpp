@@ -25,6 +25,8 @@ void P_UpdateFireSky(texture_t& skyTex) noexcept {
 
     // Grab the lump data for the fire sky and the 1st (top) row of fire.
     // PsyDoom: made updates here to work with the new WAD management code.
+    // Note: the lump data might be a view into the memory mapped WAD, in which case the fire written here persists in the WAD's private
+    // mapping even after the lump is purged. That's fine since the fire is regenerated from the bottom row, which is never modified.
     #if PSYDOOM_MODS
         const WadLump& skyTexLump = W_GetLump(skyTex.lumpNum);
         uint8_t* const pLumpData = (uint8_t*) skyTexLump.pCachedData;
@@ -10,6 +10,7 @@
 #include "g_game.h"
 #include "p_change.h"
 #include "p_setup.h"
+#include "p_sight.h"
 #include "p_spec.h"
 #include "p_tick.h"
 #include "PsyDoom/Config/Config.h"
@@ -56,6 +57,11 @@ result_e T_MovePlane(
         }
     #endif
 
+    // PsyDoom: plane movement can change line of sight, so discard any cached sight check results
+    #if PSYDOOM_MODS
+        P_InvalidateSightCache();
+    #endif
+
     // PsyDoom: initially assume no floors or ceilings are being instantly moved.
     // In the code below detect instantly moving floors or ceilings by checking if they are already past their destination before any motion is applied.
     // On finding this situation we disable interpolations for the motion since the intent by the level author is for the action to be instant.
@@ -310,7 +316,11 @@ bool EV_DoFloor(line_t& line, const floor_e floorType) noexcept {
 
         // Found a sector which will be affected by this floor special: create a thinker and link to the sector
         bActivatedAMover = true;
-        floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #if PSYDOOM_MODS
+            floormove_t& floor = *(floormove_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC);
+        #else
+            floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #endif
 
         #if PSYDOOM_MODS
             floor = {};   // PsyDoom: zero-init all fields, including ones unused by this function
@@ -494,7 +504,11 @@ bool EV_BuildStairs(line_t& line, const stair_e stairType) noexcept {
 
         // Found a stairs sector which will be affected by this floor special: create a thinker for the first step and link to the sector
         bActivatedAMover = true;
-        floormove_t& firstFloor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #if PSYDOOM_MODS
+            floormove_t& firstFloor = *(floormove_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC);
+        #else
+            floormove_t& firstFloor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #endif
 
         #if PSYDOOM_MODS
             firstFloor = {};   // PsyDoom: zero-init all fields, including ones unused by this function
@@ -561,7 +575,11 @@ bool EV_BuildStairs(line_t& line, const stair_e stairType) noexcept {
                     continue;
 
                 // Create a thinker for this step's floor mover, link to the sector and populate it's settings
-                floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #if PSYDOOM_MODS
+                    floormove_t& floor = *(floormove_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC);
+                #else
+                    floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #endif
 
                 #if PSYDOOM_MODS
                     floor = {};   // PsyDoom: zero-init all fields, including ones unused by this function
@@ -604,7 +622,11 @@ bool EV_DoCustomFloor(sector_t& sector, const CustomFloorDef& floorDef) noexcept
         return false;
 
     // Allocate the floor mover, zero initialize and set as the sector thinker
-    floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        floormove_t& floor = *(floormove_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC);
+    #else
+        floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+    #endif
     floor = {};
     sector.specialdata = &floor;
 
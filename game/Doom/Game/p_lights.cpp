@@ -36,7 +36,11 @@ void T_FireFlicker(fireflicker_t& flicker) noexcept {
 void P_SpawnFireFlicker(sector_t& sector) noexcept {
     // Clear the current sector special (no hurt for example) and spawn the thinker
     sector.special = 0;
-    fireflicker_t& flicker = *(fireflicker_t*) Z_Malloc(*gpMainMemZone, sizeof(fireflicker_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        fireflicker_t& flicker = *(fireflicker_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(fireflicker_t), PU_LEVSPEC);
+    #else
+        fireflicker_t& flicker = *(fireflicker_t*) Z_Malloc(*gpMainMemZone, sizeof(fireflicker_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(flicker.thinker);
 
     // Setup flicker settings
@@ -73,7 +77,11 @@ void T_LightFlash(lightflash_t& lightFlash) noexcept {
 void P_SpawnLightFlash(sector_t& sector) noexcept {
     // Clear the current sector special (no hurt for example) and spawn the thinker
     sector.special = 0;
-    lightflash_t& lightFlash = *(lightflash_t*) Z_Malloc(*gpMainMemZone, sizeof(lightflash_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        lightflash_t& lightFlash = *(lightflash_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(lightflash_t), PU_LEVSPEC);
+    #else
+        lightflash_t& lightFlash = *(lightflash_t*) Z_Malloc(*gpMainMemZone, sizeof(lightflash_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(lightFlash.thinker);
 
     // Setup flash settings
@@ -111,7 +119,11 @@ void T_StrobeFlash(strobe_t& strobe) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_SpawnStrobeFlash(sector_t& sector, const int32_t darkTime, const bool bInSync) noexcept {
     // Create the strobe thinker and populate it's settings
-    strobe_t& strobe = *(strobe_t*) Z_Malloc(*gpMainMemZone, sizeof(strobe_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        strobe_t& strobe = *(strobe_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(strobe_t), PU_LEVSPEC);
+    #else
+        strobe_t& strobe = *(strobe_t*) Z_Malloc(*gpMainMemZone, sizeof(strobe_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(strobe.thinker);
 
     strobe.thinker.function = (think_t) &T_StrobeFlash;
@@ -142,7 +154,11 @@ void P_SpawnStrobeFlash(sector_t& sector, const int32_t darkTime, const bool bIn
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_SpawnRapidStrobeFlash(sector_t& sector) noexcept {
     // Create the strobe thinker and populate it's settings
-    strobe_t& strobe = *(strobe_t*) Z_Malloc(*gpMainMemZone, sizeof(strobe_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        strobe_t& strobe = *(strobe_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(strobe_t), PU_LEVSPEC);
+    #else
+        strobe_t& strobe = *(strobe_t*) Z_Malloc(*gpMainMemZone, sizeof(strobe_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(strobe.thinker);
 
     strobe.thinker.function = (think_t) &T_StrobeFlash;
@@ -183,7 +199,12 @@ void EV_TurnTagLightsOff(line_t& line) noexcept {
     // Turn 'off' the light for all sectors with a matching tag
     sector_t* const pSectors = gpSectors;
 
-    for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
+    // PsyDoom: use the tag index to visit only the sectors with a matching tag
+    #if PSYDOOM_MODS
+        for (int32_t sectorIdx = P_FindSectorFromLineTag(line, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromLineTag(line, sectorIdx)) {
+    #else
+        for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
+    #endif
         sector_t& sector = pSectors[sectorIdx];
 
         if (sector.tag != line.tag)
@@ -213,7 +234,12 @@ void EV_LightTurnOn(line_t& line, const int32_t onLightLevel) noexcept {
     // Turn 'on' the light for all sectors with a matching tag
     sector_t* const pSectors = gpSectors;
 
-    for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
+    // PsyDoom: use the tag index to visit only the sectors with a matching tag
+    #if PSYDOOM_MODS
+        for (int32_t sectorIdx = P_FindSectorFromLineTag(line, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromLineTag(line, sectorIdx)) {
+    #else
+        for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
+    #endif
         sector_t& sector = pSectors[sectorIdx];
 
         if (sector.tag != line.tag)
@@ -270,7 +296,11 @@ void T_Glow(glow_t& glow) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_SpawnGlowingLight(sector_t& sector, const glowtype_e glowType) noexcept {
     // Create the glow thinker
-    glow_t& glow = *(glow_t*) Z_Malloc(*gpMainMemZone, sizeof(glow_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        glow_t& glow = *(glow_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(glow_t), PU_LEVSPEC);
+    #else
+        glow_t& glow = *(glow_t*) Z_Malloc(*gpMainMemZone, sizeof(glow_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(glow.thinker);
 
     // Configure the glow settings depending on the type
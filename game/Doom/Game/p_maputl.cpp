@@ -9,11 +9,26 @@
 
 #include <algorithm>
 
+#if PSYDOOM_MODS
+    #include <vector>
+#endif
+
 fixed_t gOpenBottom;    // Line opening (floor/ceiling gap) info: bottom Z value of the opening
 fixed_t gOpenTop;       // Line opening (floor/ceiling gap) info: top Z value of the opening
 fixed_t gOpenRange;     // Line opening (floor/ceiling gap) info: Z size of the opening
 fixed_t gLowFloor;      // Line opening (floor/ceiling gap) info: the lowest (front/back sector) floor of the opening
 
+#if PSYDOOM_MODS
+    // PsyDoom: compact arrays of things for each blockmap cell, mirroring the 'gppBlockLinks' linked lists.
+    // The most recently linked thing is at the END of each array, so iterating backwards visits things in the same order as the lists.
+    static std::vector<std::vector<blockthing_t>> gBlockThings;
+
+    // PsyDoom: whether the compact blockmap thing arrays currently mirror the linked lists exactly.
+    // Certain (buggy) original behaviors can corrupt the linked lists in ways the arrays can't represent - such as moving a thing in place
+    // without unlinking it first. When that happens the arrays are abandoned for the rest of the level and the linked lists are used instead.
+    static bool gbBlockThingsValid = false;
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Gives a cheap approximate/estimated length for the given vector
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -150,6 +165,10 @@ void P_UnsetThingPosition(mobj_t& thing) noexcept {
     // Does this thing get added to the blockmap?
     // If so remove it from the blockmap.
     if ((thing.flags & MF_NOBLOCKMAP) == 0) {
+        #if PSYDOOM_MODS
+            P_UnlinkBlockThing(thing);  // PsyDoom: keep the compact blockmap thing arrays in sync
+        #endif
+
         if (thing.bnext) {
             thing.bnext->bprev = thing.bprev;
         }
@@ -220,6 +239,10 @@ void P_SetThingPosition(mobj_t& mobj) noexcept {
             mobj.bprev = nullptr;
             mobj.bnext = nullptr;
         }
+
+        #if PSYDOOM_MODS
+            P_LinkBlockThing(mobj);     // PsyDoom: keep the compact blockmap thing arrays in sync
+        #endif
     }
 }
 
@@ -281,3 +304,132 @@ bool P_BlockThingsIterator(const int32_t x, const int32_t y, bool (*pFunc)(mobj_
 
     return true;
 }
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get the index of the blockmap cell containing the given thing, or '-1' if the thing is outside of the blockmap
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t P_GetBlockThingCellIdx(const mobj_t& mobj) noexcept {
+    const int32_t blockX = d_rshift<MAPBLOCKSHIFT>(mobj.x - gBlockmapOriginX);
+    const int32_t blockY = d_rshift<MAPBLOCKSHIFT>(mobj.y - gBlockmapOriginY);
+
+    if ((blockX >= 0) && (blockY >= 0) && (blockX < gBlockmapWidth) && (blockY < gBlockmapHeight))
+        return blockY * gBlockmapWidth + blockX;
+
+    return -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: clears out and sizes the compact blockmap thing arrays for the current blockmap.
+// Should be called whenever the blockmap thing linked lists ('gppBlockLinks') are reset.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InitBlockThings() noexcept {
+    for (std::vector<blockthing_t>& things : gBlockThings) {
+        things.clear();
+    }
+
+    gBlockThings.resize((size_t) gBlockmapWidth * (size_t) gBlockmapHeight);
+    gbBlockThingsValid = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: adds the given thing to the compact blockmap thing arrays.
+// Must be called whenever the thing is added to the blockmap thing linked lists.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_LinkBlockThing(mobj_t& mobj) noexcept {
+    if (!gbBlockThingsValid)
+        return;
+
+    // If the thing was never removed from the arrays then it is also still threaded through a linked list.
+    // Relinking it now would leave other things in that list pointing to it, which the arrays can't mirror.
+    if (mobj.bcell != 0) {
+        gbBlockThingsValid = false;
+        return;
+    }
+
+    // Things outside the blockmap are not added to any list
+    const int32_t cellIdx = P_GetBlockThingCellIdx(mobj);
+
+    if (cellIdx < 0)
+        return;
+
+    gBlockThings[cellIdx].push_back({ &mobj, mobj.x, mobj.y, mobj.radius });
+    mobj.bcell = cellIdx + 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: removes the given thing from the compact blockmap thing arrays.
+// Must be called whenever the thing is removed from the blockmap thing linked lists, and BEFORE the linked lists are updated.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_UnlinkBlockThing(mobj_t& mobj) noexcept {
+    if (!gbBlockThingsValid)
+        return;
+
+    const int32_t cellIdx = P_GetBlockThingCellIdx(mobj);
+
+    // If the thing is not in any list then removing it is only harmless if there are no stale list links and it's outside the blockmap.
+    // Otherwise the list removal code will overwrite the list head for the cell the thing is currently in.
+    if (mobj.bcell == 0) {
+        if (mobj.bnext || mobj.bprev || (cellIdx >= 0)) {
+            gbBlockThingsValid = false;
+        }
+
+        return;
+    }
+
+    // If the thing is the head of a list then the list head that gets updated is for whatever cell the thing is CURRENTLY in.
+    // If the thing was moved to another cell without being unlinked first then this corrupts the lists, and the arrays can't follow.
+    const int32_t linkedCellIdx = mobj.bcell - 1;
+
+    if ((!mobj.bprev) && (linkedCellIdx != cellIdx)) {
+        gbBlockThingsValid = false;
+        return;
+    }
+
+    // Remove the thing while preserving the order of everything else
+    std::vector<blockthing_t>& things = gBlockThings[linkedCellIdx];
+    const auto thingIter = std::find_if(things.rbegin(), things.rend(), [&](const blockthing_t& bthing) noexcept { return (bthing.pMobj == &mobj); });
+
+    if (thingIter == things.rend()) {
+        gbBlockThingsValid = false;
+        return;
+    }
+
+    ASSERT((mobj.bprev != nullptr) || (thingIter == things.rbegin()));
+    things.erase(std::next(thingIter).base());
+    mobj.bcell = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: updates the compact blockmap thing array entry for a thing after it's position or radius was changed in place.
+// Must be called whenever those fields are modified while the thing is in the blockmap.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_SyncBlockThing(mobj_t& mobj) noexcept {
+    if ((!gbBlockThingsValid) || (mobj.bcell == 0))
+        return;
+
+    for (blockthing_t& bthing : gBlockThings[mobj.bcell - 1]) {
+        if (bthing.pMobj == &mobj) {
+            bthing.x = mobj.x;
+            bthing.y = mobj.y;
+            bthing.radius = mobj.radius;
+            return;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get the compact array of things for the given blockmap cell, which must be in range.
+// Things must be visited from the END of the array backwards to match the order of the blockmap thing linked lists.
+// Returns 'false' if the compact arrays can't be used, in which case the linked lists must be used instead.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool P_GetBlockThings(const int32_t x, const int32_t y, const blockthing_t*& pThings, int32_t& numThings) noexcept {
+    if (!gbBlockThingsValid)
+        return false;
+
+    const std::vector<blockthing_t>& things = gBlockThings[y * gBlockmapWidth + x];
+    pThings = things.data();
+    numThings = (int32_t) things.size();
+    return true;
+}
+#endif  // #if PSYDOOM_MODS
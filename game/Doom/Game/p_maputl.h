@@ -11,6 +11,17 @@ extern fixed_t gOpenTop;
 extern fixed_t gOpenRange;
 extern fixed_t gLowFloor;
 
+#if PSYDOOM_MODS
+    // PsyDoom: a compact copy of the collision related fields for a thing in the blockmap.
+    // These are stored contiguously for each blockmap cell, so that collision tests can reject things without touching the full 'mobj_t'.
+    struct blockthing_t {
+        mobj_t*     pMobj;
+        fixed_t     x;
+        fixed_t     y;
+        fixed_t     radius;
+    };
+#endif
+
 fixed_t P_AproxDistance(const fixed_t dx, const fixed_t dy) noexcept;
 int32_t P_PointOnLineSide(const fixed_t x, const fixed_t y, const line_t& line) noexcept;
 int32_t P_PointOnDivlineSide(const fixed_t x, const fixed_t y, const divline_t& divline) noexcept;
@@ -20,3 +31,11 @@ void P_UnsetThingPosition(mobj_t& thing) noexcept;
 void P_SetThingPosition(mobj_t& thing) noexcept;
 bool P_BlockLinesIterator(const int32_t x, const int32_t y, bool (*pFunc)(line_t&)) noexcept;
 bool P_BlockThingsIterator(const int32_t x, const int32_t y, bool (*pFunc)(mobj_t&)) noexcept;
+
+#if PSYDOOM_MODS
+    void P_InitBlockThings() noexcept;
+    void P_LinkBlockThing(mobj_t& mobj) noexcept;
+    void P_UnlinkBlockThing(mobj_t& mobj) noexcept;
+    void P_SyncBlockThing(mobj_t& mobj) noexcept;
+    bool P_GetBlockThings(const int32_t x, const int32_t y, const blockthing_t*& pThings, int32_t& numThings) noexcept;
+#endif
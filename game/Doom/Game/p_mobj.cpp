@@ -68,9 +68,10 @@ void P_RemoveMobj(mobj_t& mobj) noexcept {
     #if PSYDOOM_MODS
         P_WeakReferencedDestroyed(mobj);    // PsyDoom: weak references to this object are now nulled
         mobj.~mobj_t();                     // PsyDoom: destroy C++ weak pointers
+        Z_PoolFree(*gpMainMemZone, &mobj);  // PsyDoom: map objects are now allocated from a memory pool
+    #else
+        Z_Free2(*gpMainMemZone, &mobj);
     #endif
-
-    Z_Free2(*gpMainMemZone, &mobj);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -206,7 +207,11 @@ void P_ExplodeMissile(mobj_t& mobj) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 mobj_t* P_SpawnMobj(const fixed_t x, const fixed_t y, const fixed_t z, const mobjtype_t type) noexcept {
     // Alloc and zero initialize the map object
-    mobj_t& mobj = *(mobj_t*) Z_Malloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL, nullptr);
+    #if PSYDOOM_MODS
+        mobj_t& mobj = *(mobj_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL);
+    #else
+        mobj_t& mobj = *(mobj_t*) Z_Malloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL, nullptr);
+    #endif
     D_memset(&mobj, std::byte(0), sizeof(mobj_t));
 
     #if PSYDOOM_MODS
@@ -608,6 +613,7 @@ void P_CheckMissileSpawn(mobj_t& mobj) noexcept {
 
                 #if PSYDOOM_MODS
                     R_SnapMobjInterpolation(mobj);  // PsyDoom: snap the motion we just added since the missile is just spawning
+                    P_SyncBlockThing(mobj);         // PsyDoom: the missile was moved in place, update it's compact blockmap entry
                 #endif
 
                 P_ExplodeMissile(mobj);
@@ -622,6 +628,10 @@ void P_CheckMissileSpawn(mobj_t& mobj) noexcept {
     mobj.y += d_rshift<1>(mobj.momy);
     mobj.z += d_rshift<1>(mobj.momz);
 
+    #if PSYDOOM_MODS
+        P_SyncBlockThing(mobj);     // PsyDoom: the missile was moved in place, update it's compact blockmap entry
+    #endif
+
     if (!P_TryMove(mobj, mobj.x, mobj.y)) {
         P_ExplodeMissile(mobj);
     }
@@ -201,6 +201,10 @@ static void PM_UnsetThingPosition(mobj_t& thing) noexcept {
     // Does this thing get added to the blockmap?
     // If so remove it from the blockmap.
     if ((thing.flags & MF_NOBLOCKMAP) == 0) {
+        #if PSYDOOM_MODS
+            P_UnlinkBlockThing(thing);  // PsyDoom: keep the compact blockmap thing arrays in sync
+        #endif
+
         if (thing.bnext) {
             thing.bnext->bprev = thing.bprev;
         }
@@ -271,6 +275,10 @@ static void PM_SetThingPosition(mobj_t& mobj) noexcept {
             mobj.bprev = nullptr;
             mobj.bnext = nullptr;
         }
+
+        #if PSYDOOM_MODS
+            P_LinkBlockThing(mobj);     // PsyDoom: keep the compact blockmap thing arrays in sync
+        #endif
     }
 }
 
@@ -631,6 +639,34 @@ static bool PM_BlockLinesIterator(const int32_t x, const int32_t y) noexcept {
 // In some cases the thing collided with is saved in 'gpMoveThing' for futher interactions like pickups and damaging.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static bool PM_BlockThingsIterator(const int32_t x, const int32_t y) noexcept {
+    // PsyDoom: use the compact blockmap thing arrays if possible, so things which are out of range can be skipped without touching them.
+    // Note that the range test here is exactly the same one done by 'PIT_CheckThing', and things out of range never cause a collision.
+    #if PSYDOOM_MODS
+        const blockthing_t* pThings;
+        int32_t numThings;
+
+        if (P_GetBlockThings(x, y, pThings, numThings)) {
+            const fixed_t tryMoveRadius = gpTryMoveThing->radius;
+
+            for (int32_t thingIdx = numThings - 1; thingIdx >= 0; --thingIdx) {
+                const blockthing_t& bthing = pThings[thingIdx];
+                ASSERT((bthing.x == bthing.pMobj->x) && (bthing.y == bthing.pMobj->y) && (bthing.radius == bthing.pMobj->radius));
+
+                const fixed_t totalRadius = bthing.radius + tryMoveRadius;
+                const fixed_t dx = std::abs(bthing.x - gTryMoveX);
+                const fixed_t dy = std::abs(bthing.y - gTryMoveY);
+
+                if ((dx >= totalRadius) || (dy >= totalRadius))
+                    continue;
+
+                if (!PIT_CheckThing(*bthing.pMobj))
+                    return false;
+            }
+
+            return true;
+        }
+    #endif
+
     for (mobj_t* pmobj = gppBlockLinks[x + y * gBlockmapWidth]; pmobj; pmobj = pmobj->bnext) {
         if (!PIT_CheckThing(*pmobj))
             return false;
@@ -25,6 +25,7 @@
 #include "p_local.h"
 #include "p_maputl.h"
 #include "p_mobj.h"
+#include "p_sight.h"
 #include "p_spec.h"
 #include "p_switch.h"
 #include "p_tick.h"
@@ -32,6 +33,7 @@
 #include "PsyDoom/BuiltInPaletteData.h"
 #include "PsyDoom/DevMapAutoReloader.h"
 #include "PsyDoom/Game.h"
+#include "PsyDoom/LevelCache.h"
 #include "PsyDoom/MapHash.h"
 #include "PsyDoom/MapInfo/GecMapInfo.h"
 #include "PsyDoom/MapInfo/MapInfo.h"
@@ -39,8 +41,10 @@
 #include "PsyDoom/MobjSpritePrecacher.h"
 #include "PsyDoom/ModMgr.h"
 #include "PsyDoom/ScriptingEngine.h"
+#include "PsyDoom/WorkerPool.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <cstring>
 #include <vector>
@@ -96,6 +100,17 @@ mapthing_t*     gpDeathmatchP;                                  // Points past t
     static std::vector<mapthing_t> gAllPlayerStarts;
 #endif
 
+// PsyDoom: map geometry lumps which were already read (and decompressed) to identify the level for the level cache.
+// If the level is not in the cache then the lump loaders use this data instead of reading the same lumps again.
+#if PSYDOOM_MODS
+    struct PreReadMapLump {
+        int32_t                 lumpNum;
+        std::vector<std::byte>  data;
+    };
+
+    static std::vector<PreReadMapLump> gPreReadMapGeometryLumps;
+#endif
+
 // PsyDoom: if not null then issue this warning after the level has started.
 // Can be used to issue non-fatal warnings about bad map conditions to WAD authors.
 #if PSYDOOM_MODS
@@ -132,6 +147,46 @@ void (*gUpdateFireSkyFunc)(texture_t& skyTex) = nullptr;
 #endif
 
 #if PSYDOOM_MODS
+    static void P_InitBlockLinks() noexcept;
+#endif
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom helper: calls the given function for every item index from '0' to 'numItems - 1'.
+// If there are enough items to make it worthwhile then the work is split across the worker pool, so the function must only write to data for
+// the given item and must not depend on the order items are processed in. Used to split up the more expensive parts of level setup.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class ItemFunc>
+static void P_SetupParallelFor(const int32_t numItems, const ItemFunc& itemFunc) noexcept {
+    // Only split up the work if there is at least this many items, not worth it otherwise
+    constexpr int32_t MIN_PARALLEL_ITEMS = 64;
+
+    if ((numItems >= MIN_PARALLEL_ITEMS) && (WorkerPool::getNumWorkers() > 1)) {
+        WorkerPool::parallelFor((uint32_t) numItems, [&](const uint32_t itemIdx, [[maybe_unused]] const uint32_t workerIdx) noexcept {
+            itemFunc((int32_t) itemIdx);
+        });
+    } else {
+        for (int32_t itemIdx = 0; itemIdx < numItems; ++itemIdx) {
+            itemFunc(itemIdx);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom helper: reads the specified (decompressed) map geometry lump into the given buffer.
+// Uses the copy of the lump read when identifying the level for the level cache if available, otherwise reads the lump from the map WAD.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_ReadMapGeometryLump(const int32_t lumpNum, void* const pDest) noexcept {
+    for (const PreReadMapLump& lump : gPreReadMapGeometryLumps) {
+        if (lump.lumpNum == lumpNum) {
+            std::memcpy(pDest, lump.data.data(), lump.data.size());
+            return;
+        }
+    }
+
+    W_ReadMapLump(lumpNum, pDest, true);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom helper: tell if a flat texture index is a sky texture
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -223,7 +278,11 @@ static void P_LoadVertexes(const int32_t lumpNum) noexcept {
     gpVertexes = (vertex_t*) Z_Malloc(*gpMainMemZone, gNumVertexes * sizeof(vertex_t), PU_LEVEL, nullptr);
 
     // Read the WAD vertexes into the temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #if PSYDOOM_MODS
+        P_ReadMapGeometryLump(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #endif
 
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
@@ -268,7 +327,11 @@ static void P_LoadSegs(const int32_t lumpNum) noexcept {
     D_memset(gpSegs, std::byte(0), gNumSegs * sizeof(seg_t));
 
     // Read the map lump containing the segs into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #if PSYDOOM_MODS
+        P_ReadMapGeometryLump(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #endif
 
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
@@ -340,7 +403,11 @@ static void P_LoadSubSectors(const int32_t lumpNum) noexcept {
     D_memset(gpSubsectors, std::byte(0), gNumSubsectors * sizeof(subsector_t));
 
     // Read the map lump containing the subsectors into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #if PSYDOOM_MODS
+        P_ReadMapGeometryLump(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #endif
 
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
@@ -403,7 +470,11 @@ static void P_LoadSectors(const int32_t lumpNum) noexcept {
     D_memset(gpSectors, std::byte(0), gNumSectors * sizeof(sector_t));
 
     // Read the map lump containing the sectors into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #if PSYDOOM_MODS
+        P_ReadMapGeometryLump(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #endif
 
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
@@ -423,6 +494,25 @@ static void P_LoadSectors(const int32_t lumpNum) noexcept {
             const int32_t firstSkyTexPic = W_GetNumForName("F_SKY01") - gFirstFlatLumpNum;
         #endif
 
+        // PsyDoom: looking up flats by name is the most expensive part of loading sectors, so do all the lookups up front using the worker pool.
+        // The results are just ignored for sectors with skies.
+        #if PSYDOOM_MODS
+            std::vector<int32_t> secFlatPics((size_t) gNumSectors * 2);
+
+            P_SetupParallelFor(gNumSectors, [&](const int32_t secIdx) noexcept {
+                const wadsector_t& srcSec = pWadSectors[secIdx];
+                int32_t* const pFlatPics = &secFlatPics[(size_t) secIdx * 2];
+
+                if constexpr (bFinalDoom) {
+                    pFlatPics[0] = R_GetOverrideFlatNum(Endian::littleToHost(srcSec.floorpic));     // Use the overriden version of the flats if there are multiple versions of the same flat
+                    pFlatPics[1] = R_GetOverrideFlatNum(Endian::littleToHost(srcSec.ceilingpic));
+                } else {
+                    pFlatPics[0] = R_FlatNumForName(srcSec.floorpic);
+                    pFlatPics[1] = R_FlatNumForName(srcSec.ceilingpic);
+                }
+            });
+        #endif
+
         // Process the sectors
         const wadsector_t* pSrcSec = pWadSectors;
         sector_t* pDstSec = gpSectors;
@@ -464,10 +554,10 @@ static void P_LoadSectors(const int32_t lumpNum) noexcept {
 
             if constexpr (bFinalDoom) {
                 // Final Doom specific stuff: we have the actual floor and ceiling texture indexes in this case: no lookup needed!
-                // PsyDoom: use the overriden version of the flats if there are multiple versions of the same flat.
+                // PsyDoom: use the overriden version of the flats if there are multiple versions of the same flat (already looked up).
                 #if PSYDOOM_MODS
-                    const int32_t ceilingPic = R_GetOverrideFlatNum(Endian::littleToHost(pSrcSec->ceilingpic));
-                    const int32_t floorPic = R_GetOverrideFlatNum(Endian::littleToHost(pSrcSec->floorpic));
+                    const int32_t ceilingPic = secFlatPics[(size_t) secIdx * 2 + 1];
+                    const int32_t floorPic = secFlatPics[(size_t) secIdx * 2 + 0];
                 #else
                     const int32_t ceilingPic = Endian::littleToHost(pSrcSec->ceilingpic);
                     const int32_t floorPic = Endian::littleToHost(pSrcSec->floorpic);
@@ -526,8 +616,8 @@ static void P_LoadSectors(const int32_t lumpNum) noexcept {
                         skyLumpName[3] = pSrcSec->floorpic[5];
                         skyLumpName[4] = pSrcSec->floorpic[6];
                     } else {
-                        // Normal case: floor has a texture, save it's number
-                        pDstSec->floorpic = R_FlatNumForName(pSrcSec->floorpic);
+                        // Normal case: floor has a texture, save it's number (already looked up)
+                        pDstSec->floorpic = secFlatPics[(size_t) secIdx * 2 + 0];
                         ensureValidFlatPic(pDstSec->floorpic);
                     }
                 #else
@@ -545,8 +635,14 @@ static void P_LoadSectors(const int32_t lumpNum) noexcept {
                     skyLumpName[3] = pSrcSec->ceilingpic[5];
                     skyLumpName[4] = pSrcSec->ceilingpic[6];
                 } else {
-                    // Normal case: ceiling has a texture, save it's number
-                    pDstSec->ceilingpic = R_FlatNumForName(pSrcSec->ceilingpic);
+                    // Normal case: ceiling has a texture, save it's number.
+                    // PsyDoom: the number has already been looked up.
+                    #if PSYDOOM_MODS
+                        pDstSec->ceilingpic = secFlatPics[(size_t) secIdx * 2 + 1];
+                    #else
+                        pDstSec->ceilingpic = R_FlatNumForName(pSrcSec->ceilingpic);
+                    #endif
+
                     ensureValidFlatPic(pDstSec->ceilingpic);
                 }
             }
@@ -607,7 +703,11 @@ static void P_LoadNodes(const int32_t lumpNum) noexcept {
     gpBspNodes = (node_t*) Z_Malloc(*gpMainMemZone, gNumBspNodes * sizeof(node_t), PU_LEVEL, nullptr);
 
     // Read the map lump containing the nodes into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #if PSYDOOM_MODS
+        P_ReadMapGeometryLump(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #endif
 
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
@@ -717,7 +817,11 @@ static void P_LoadLineDefs(const int32_t lumpNum) noexcept {
     D_memset(gpLines, std::byte(0), gNumLines * sizeof(line_t));
 
     // Read the map lump containing the sidedefs into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #if PSYDOOM_MODS
+        P_ReadMapGeometryLump(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #endif
 
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
@@ -828,7 +932,11 @@ static void P_LoadSideDefs(const int32_t lumpNum) noexcept {
     D_memset(gpSides, std::byte(0), gNumSides * sizeof(side_t));
 
     // Read the map lump containing the sidedefs into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #if PSYDOOM_MODS
+        P_ReadMapGeometryLump(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #endif
 
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
@@ -841,6 +949,26 @@ static void P_LoadSideDefs(const int32_t lumpNum) noexcept {
         typedef std::remove_reference_t<decltype(*pWadSidedefs)> wadsidedef_t;
         constexpr bool bFinalDoom = std::is_same_v<wadsidedef_t, mapsidedef_final_t>;
 
+        // PsyDoom: looking up textures by name is the most expensive part of loading sides, so do all the lookups up front using the worker pool
+        #if PSYDOOM_MODS
+            std::vector<int32_t> sideTexNums((size_t) gNumSides * 3);
+
+            P_SetupParallelFor(gNumSides, [&](const int32_t sideIdx) noexcept {
+                const wadsidedef_t& srcSide = pWadSidedefs[sideIdx];
+                int32_t* const pTexNums = &sideTexNums[(size_t) sideIdx * 3];
+
+                if constexpr (bFinalDoom) {
+                    pTexNums[0] = R_GetOverrideTexNum(Endian::littleToHost(srcSide.toptexture));    // Use the overriden version of the textures if there are multiple versions of the same texture
+                    pTexNums[1] = R_GetOverrideTexNum(Endian::littleToHost(srcSide.midtexture));
+                    pTexNums[2] = R_GetOverrideTexNum(Endian::littleToHost(srcSide.bottomtexture));
+                } else {
+                    pTexNums[0] = R_TextureNumForName(srcSide.toptexture);
+                    pTexNums[1] = R_TextureNumForName(srcSide.midtexture);
+                    pTexNums[2] = R_TextureNumForName(srcSide.bottomtexture);
+                }
+            });
+        #endif
+
         const wadsidedef_t* pSrcSide = pWadSidedefs;
         side_t* pDstSide = gpSides;
 
@@ -851,20 +979,27 @@ static void P_LoadSideDefs(const int32_t lumpNum) noexcept {
 
             // For Final Doom we don't need to do any lookup, we have the numbers already...
             if constexpr (bFinalDoom) {
-                // PsyDoom: use the overriden version of the textures if there are multiple versions of the same texture
+                // PsyDoom: use the overriden version of the textures if there are multiple versions of the same texture (already looked up)
                 #if PSYDOOM_MODS
-                    pDstSide->toptexture = R_GetOverrideTexNum(Endian::littleToHost(pSrcSide->toptexture));
-                    pDstSide->midtexture = R_GetOverrideTexNum(Endian::littleToHost(pSrcSide->midtexture));
-                    pDstSide->bottomtexture = R_GetOverrideTexNum(Endian::littleToHost(pSrcSide->bottomtexture));
+                    pDstSide->toptexture = sideTexNums[(size_t) sideIdx * 3 + 0];
+                    pDstSide->midtexture = sideTexNums[(size_t) sideIdx * 3 + 1];
+                    pDstSide->bottomtexture = sideTexNums[(size_t) sideIdx * 3 + 2];
                 #else
                     pDstSide->toptexture = Endian::littleToHost(pSrcSide->toptexture);
                     pDstSide->midtexture = Endian::littleToHost(pSrcSide->midtexture);
                     pDstSide->bottomtexture = Endian::littleToHost(pSrcSide->bottomtexture);
                 #endif
             } else {
-                pDstSide->toptexture = R_TextureNumForName(pSrcSide->toptexture);
-                pDstSide->midtexture = R_TextureNumForName(pSrcSide->midtexture);
-                pDstSide->bottomtexture = R_TextureNumForName(pSrcSide->bottomtexture);
+                // PsyDoom: the texture numbers have already been looked up
+                #if PSYDOOM_MODS
+                    pDstSide->toptexture = sideTexNums[(size_t) sideIdx * 3 + 0];
+                    pDstSide->midtexture = sideTexNums[(size_t) sideIdx * 3 + 1];
+                    pDstSide->bottomtexture = sideTexNums[(size_t) sideIdx * 3 + 2];
+                #else
+                    pDstSide->toptexture = R_TextureNumForName(pSrcSide->toptexture);
+                    pDstSide->midtexture = R_TextureNumForName(pSrcSide->midtexture);
+                    pDstSide->bottomtexture = R_TextureNumForName(pSrcSide->bottomtexture);
+                #endif
 
                 // PsyDoom: level startup warnings if textures are defined but not found.
                 // Note: these warnings may trigger on some original maps! For creating new maps however this can be a useful tool.
@@ -914,7 +1049,12 @@ static void P_LoadBlockMap(const int32_t lumpNum) noexcept {
     // Read the blockmap lump into RAM
     const int32_t lumpSize = W_MapLumpLength(lumpNum);
     gpBlockmapLump = (uint16_t*) Z_Malloc(*gpMainMemZone, lumpSize, PU_LEVEL, nullptr);
-    W_ReadMapLump(lumpNum, gpBlockmapLump, true);
+
+    #if PSYDOOM_MODS
+        P_ReadMapGeometryLump(lumpNum, gpBlockmapLump);
+    #else
+        W_ReadMapLump(lumpNum, gpBlockmapLump, true);
+    #endif
 
     // PsyDoom: add to the hash for the map
     #if PSYDOOM_MODS
@@ -960,23 +1100,141 @@ static void P_LoadBlockMap(const int32_t lumpNum) noexcept {
     gBlockmapOriginX = d_int_to_fixed(blockmapHeader.originx);
     gBlockmapOriginY = d_int_to_fixed(blockmapHeader.originy);
 
-    // Alloc and null initialize the list of map objects for each block
-    const int32_t blockLinksSize = blockmapHeader.width * blockmapHeader.height * (int32_t) sizeof(gppBlockLinks[0]);
+    // Alloc and null initialize the list of map objects for each block.
+    // PsyDoom: this is now split out into a separate function, so it can also be done for levels loaded from the level cache.
+    #if PSYDOOM_MODS
+        P_InitBlockLinks();
+    #else
+        const int32_t blockLinksSize = blockmapHeader.width * blockmapHeader.height * (int32_t) sizeof(gppBlockLinks[0]);
+        gppBlockLinks = (mobj_t**) Z_Malloc(*gpMainMemZone, blockLinksSize, PU_LEVEL, nullptr);
+        D_memset(gppBlockLinks, std::byte(0), blockLinksSize);
+    #endif
+}
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: allocates and null initializes the list of map objects for each blockmap cell.
+// Must be done after the blockmap dimensions have been set.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_InitBlockLinks() noexcept {
+    const int32_t blockLinksSize = gBlockmapWidth * gBlockmapHeight * (int32_t) sizeof(gppBlockLinks[0]);
     gppBlockLinks = (mobj_t**) Z_Malloc(*gpMainMemZone, blockLinksSize, PU_LEVEL, nullptr);
     D_memset(gppBlockLinks, std::byte(0), blockLinksSize);
+    P_InitBlockThings();    // Reset the compact per cell thing arrays which mirror the linked lists
 }
+#endif
 
+#if PSYDOOM_MODS
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Load the reject map from the specified map lump number
+// PsyDoom: builds a conservative reject matrix for maps which ship without one (empty or all zero REJECT lump).
+// Only done for maps which opt in via the 'GenerateReject' MAPINFO setting.
+//
+// Sectors are grouped together if they are joined by a two sided line; sectors in different groups are never able to see each other
+// since any sight line between them would have to pass through a one sided line, which always blocks sight. Marking those sector pairs
+// as rejected lets 'P_CheckSight' skip the BSP traversal entirely for them. Two sided lines are always treated as joining sectors, even
+// if closed, since doors and lifts might later open them.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void P_LoadRejectMap(const int32_t lumpNum) noexcept {
+static void P_BuildConnectivityRejectMap() noexcept {
+    // Group the sectors using a union-find structure
+    std::vector<int32_t> sectorGroups((size_t) gNumSectors);
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        sectorGroups[secIdx] = secIdx;
+    }
+
+    const auto findGroup = [&](int32_t secIdx) noexcept {
+        while (sectorGroups[secIdx] != secIdx) {
+            sectorGroups[secIdx] = sectorGroups[sectorGroups[secIdx]];  // Path halving, to keep the chains short
+            secIdx = sectorGroups[secIdx];
+        }
+
+        return secIdx;
+    };
+
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        const line_t& line = gpLines[lineIdx];
+
+        if ((!line.frontsector) || (!line.backsector))
+            continue;
+
+        const int32_t group1 = findGroup((int32_t)(line.frontsector - gpSectors));
+        const int32_t group2 = findGroup((int32_t)(line.backsector - gpSectors));
+
+        if (group1 != group2) {
+            sectorGroups[std::max(group1, group2)] = std::min(group1, group2);
+        }
+    }
+
+    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+        sectorGroups[secIdx] = findGroup(secIdx);
+    }
+
+    // Reject all sector pairs which are in different groups.
+    // Split the reject matrix up into chunks of bytes which are filled in parallel using the worker pool; rows of the matrix can share bytes.
+    constexpr int32_t CHUNK_SIZE = 256;
+    const int32_t numRejectBits = gNumSectors * gNumSectors;
+    const int32_t numRejectBytes = (numRejectBits + 7) / 8;
+    const int32_t numChunks = (numRejectBytes + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+    P_SetupParallelFor(numChunks, [&](const int32_t chunkIdx) noexcept {
+        const int32_t chunkBegBit = chunkIdx * CHUNK_SIZE * 8;
+        const int32_t chunkEndBit = std::min(chunkBegBit + CHUNK_SIZE * 8, numRejectBits);
+
+        int32_t secIdx1 = chunkBegBit / gNumSectors;
+        int32_t secIdx2 = chunkBegBit - secIdx1 * gNumSectors;
+
+        for (int32_t rejectMapEntry = chunkBegBit; rejectMapEntry < chunkEndBit; ++rejectMapEntry) {
+            if (sectorGroups[secIdx1] != sectorGroups[secIdx2]) {
+                gpRejectMatrix[rejectMapEntry / 8] |= (uint8_t)(1 << (rejectMapEntry & 7));
+            }
+
+            if (++secIdx2 >= gNumSectors) {
+                secIdx2 = 0;
+                ++secIdx1;
+            }
+        }
+    });
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Load the reject map from the specified map lump number.
+// Note: must be done after loading sectors and lines.
+// PsyDoom: if requested then REJECT data is generated for the map if the lump has no useful data (see 'P_BuildConnectivityRejectMap').
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_LoadRejectMap(const int32_t lumpNum, [[maybe_unused]] const bool bGenerateIfEmpty = false) noexcept {
     const int32_t lumpSize = W_MapLumpLength(lumpNum);
-    gpRejectMatrix = (uint8_t*) Z_Malloc(*gpMainMemZone, lumpSize, PU_LEVEL, nullptr);
-    W_ReadMapLump(lumpNum, gpRejectMatrix, true);
 
-    // PsyDoom: add to the hash for the map
+    // PsyDoom: make sure the reject matrix is always big enough for all sector pairs, even if the lump is empty or truncated.
+    // Any part of the matrix not covered by the lump is zero filled (i.e 'sight possible').
+    #if PSYDOOM_MODS
+        const int32_t rejectMatrixSize = (gNumSectors * gNumSectors + 7) / 8;
+        const int32_t allocSize = std::max(lumpSize, rejectMatrixSize);
+        gpRejectMatrix = (uint8_t*) Z_Malloc(*gpMainMemZone, allocSize, PU_LEVEL, nullptr);
+        std::memset(gpRejectMatrix + lumpSize, 0, (size_t)(allocSize - lumpSize));
+    #else
+        gpRejectMatrix = (uint8_t*) Z_Malloc(*gpMainMemZone, lumpSize, PU_LEVEL, nullptr);
+    #endif
+
+    #if PSYDOOM_MODS
+        P_ReadMapGeometryLump(lumpNum, gpRejectMatrix);
+    #else
+        W_ReadMapLump(lumpNum, gpRejectMatrix, true);
+    #endif
+
+    // PsyDoom: add to the hash for the map (original lump data only).
+    // If requested and the map has no useful reject data then generate it, so sight checks can skip sector pairs which can never see each other.
+    // This is opt-in because it can change the outcome of sight checks (and hence demo playback) for maps with unusual geometry.
     #if PSYDOOM_MODS
         MapHash::addData(gpRejectMatrix, lumpSize);
+
+        if (bGenerateIfEmpty) {
+            const bool bIsRejectMapEmpty = std::all_of(gpRejectMatrix, gpRejectMatrix + rejectMatrixSize, [](const uint8_t b) noexcept { return (b == 0); });
+
+            if (bIsRejectMapEmpty) {
+                P_BuildConnectivityRejectMap();
+            }
+        }
     #endif
 }
 
@@ -1000,7 +1258,11 @@ static void P_LoadLeafs(const int32_t lumpNum) noexcept {
     #endif
 
     // Read the map lump containing the leaf edges into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #if PSYDOOM_MODS
+        P_ReadMapGeometryLump(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    #endif
     const std::byte* const pLumpBeg = pTmpBufferBytes;
     const std::byte* const pLumpEnd = pTmpBufferBytes + lumpSize;
 
@@ -1086,6 +1348,131 @@ static void P_LoadLeafs(const int32_t lumpNum) noexcept {
     }
 }
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: adds all of the map lumps used to build the level geometry to the map hash, in the same order they are added when loading them.
+// Used to identify the level for the level cache without having to process any of the lumps.
+// The lump data is kept so that the lumps don't need to be read again if the level is not in the cache.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_AddMapGeometryLumpsToHash() noexcept {
+    constexpr const char* LUMP_NAMES[] = {
+        "BLOCKMAP", "VERTEXES", "SECTORS", "SIDEDEFS", "LINEDEFS", "SSECTORS", "NODES", "SEGS", "LEAFS", "REJECT"
+    };
+
+    gPreReadMapGeometryLumps.clear();
+
+    for (const char* const lumpName : LUMP_NAMES) {
+        const int32_t lumpNum = W_MapGetNumForName(lumpName);
+        const int32_t lumpSize = W_MapLumpLength(lumpNum);
+
+        if (lumpSize > 0) {
+            PreReadMapLump& lump = gPreReadMapGeometryLumps.emplace_back();
+            lump.lumpNum = lumpNum;
+            lump.data.resize((size_t) lumpSize);
+            W_ReadMapLump(lumpNum, lump.data.data(), true);
+            MapHash::addData(lump.data.data(), lumpSize);
+        }
+    }
+}
+#endif  // #if PSYDOOM_MODS
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the line list for a sector, which is written starting at the given line reference and must already be set as the sector line list.
+// Also computes the sector bounding box and sound origin point. Returns 'false' if the number of lines found does not match the sector line count.
+// PsyDoom: this is split out from 'P_GroupLines' so that sectors can be processed in parallel.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_GroupSectorLines(sector_t& sec, line_t** pLineRef) noexcept {
+    sector_t* const pSec = &sec;
+
+    // Clear the bounding box for the sector
+    fixed_t bbox[4];
+    M_ClearBox(bbox);
+
+    // Build up the bounding box and line list for the sector by examining each line in the level against this sector.
+    // Not an efficient algorithm, since it is O(N^2) but works OK given the size of the datasets in DOOM.
+    // This might be a problem if you are planning on making a DOOM open world game however... :P
+    {
+        line_t* pLine = gpLines;
+
+        for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx, ++pLine) {
+            sector_t* const pLineFrontSec = pLine->frontsector;
+            sector_t* const pLineBackSec = pLine->backsector;
+
+            // PsyDoom: rather than crashing gracefully handle orphaned lines with no sectors in the map data - just ignore them...
+            #if PSYDOOM_MODS
+                if (!pLineFrontSec)
+                    continue;
+            #endif
+
+            // Does this line belong to this sector?
+            // If so save the line reference in the sector line list and add to the sector bounding box.
+            if ((pLineFrontSec == pSec) || (pLineBackSec == pSec)) {
+                // PsyDoom: don't write past the end of the sector's line list if it was miscounted, it might belong to another sector
+                #if PSYDOOM_MODS
+                    if (pLineRef - pSec->lines < pSec->linecount) {
+                        *pLineRef = pLine;
+                    }
+                #else
+                    *pLineRef = pLine;
+                #endif
+
+                ++pLineRef;
+
+                M_AddToBox(bbox, pLine->vertex1->x, pLine->vertex1->y);
+                M_AddToBox(bbox, pLine->vertex2->x, pLine->vertex2->y);
+            }
+        }
+    }
+
+    // Sanity check the size of the line list we built is what we would expect.
+    // It should not contradict the line count for the sector.
+    const int32_t actualLineCount = (int32_t)(pLineRef - pSec->lines);
+
+    if (actualLineCount != pSec->linecount)
+        return false;
+
+    // Set the sound origin location for sector sounds and also the subsector.
+    // Use the bounding box center for this.
+    {
+        degenmobj_t& soundorg = pSec->soundorg;
+        soundorg.x = (bbox[BOXLEFT] + bbox[BOXRIGHT]) / 2;
+        soundorg.y = (bbox[BOXTOP] + bbox[BOXBOTTOM]) / 2;
+
+        #if PSYDOOM_MODS && PSYDOOM_FIX_UB
+            // The original code did not appear to initialize the 'z' field!
+            // I'm not sure it's used for sound code but give it a defined value of midway up in the air for good measure.
+            soundorg.z = (pSec->floorheight + pSec->ceilingheight) / 2;
+        #endif
+
+        pSec->soundorg.subsector = R_PointInSubsector(soundorg.x, soundorg.y);
+    }
+
+    // Compute the bounding box for the sector in blockmap units.
+    // Note that if the sector extends the beyond the blockmap then we constrain it's coordinate.
+    {
+        int32_t bmcoord = d_rshift<MAPBLOCKSHIFT>(bbox[BOXTOP] - gBlockmapOriginY + MAXRADIUS);
+        bmcoord = (bmcoord >= gBlockmapHeight) ? gBlockmapHeight - 1 : bmcoord;
+        pSec->blockbox[BOXTOP] = bmcoord;
+    }
+    {
+        int32_t bmcoord = d_rshift<MAPBLOCKSHIFT>(bbox[BOXBOTTOM] - gBlockmapOriginY - MAXRADIUS);
+        bmcoord = (bmcoord < 0) ? 0 : bmcoord;
+        pSec->blockbox[BOXBOTTOM] = bmcoord;
+    }
+    {
+        int32_t bmcoord = d_rshift<MAPBLOCKSHIFT>(bbox[BOXRIGHT] - gBlockmapOriginX + MAXRADIUS);
+        bmcoord = (bmcoord >= gBlockmapWidth) ? gBlockmapWidth - 1 : bmcoord;
+        pSec->blockbox[BOXRIGHT] = bmcoord;
+    }
+    {
+        int32_t bmcoord = d_rshift<MAPBLOCKSHIFT>(bbox[BOXLEFT] - gBlockmapOriginX - MAXRADIUS);
+        bmcoord = (bmcoord < 0) ? 0 : bmcoord;
+        pSec->blockbox[BOXLEFT] = bmcoord;
+    }
+
+    return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Builds the line lists for each sector, bounding boxes as well as sound origin points
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1131,93 +1518,44 @@ static void P_GroupLines() noexcept {
     line_t** const pLineRefBuffer = (line_t**) Z_Malloc(*gpMainMemZone, totalLineRefs * sizeof(line_t*), PU_LEVEL, nullptr);
     line_t** pLineRef = pLineRefBuffer;
 
-    // Build the list of lines for each sector, also bounding boxes and the 'sound origin' point
+    // Build the list of lines for each sector, also bounding boxes and the 'sound origin' point.
+    // PsyDoom: assign each sector it's part of the line refs array up front, so the sectors can be processed in parallel using the worker pool.
     ASSERT(gpSectors);
-    sector_t* pSec = gpSectors;
 
-    for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
-        // Clear the bounding box for the sector and set the line list start
-        fixed_t bbox[4];
-        M_ClearBox(bbox);
-        pSec->lines = pLineRef;
-
-        // Build up the bounding box and line list for the sector by examining each line in the level against this sector.
-        // Not an efficient algorithm, since it is O(N^2) but works OK given the size of the datasets in DOOM.
-        // This might be a problem if you are planning on making a DOOM open world game however... :P
-        {
-            line_t* pLine = gpLines;
-
-            for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx, ++pLine) {
-                sector_t* const pLineFrontSec = pLine->frontsector;
-                sector_t* const pLineBackSec = pLine->backsector;
+    #if PSYDOOM_MODS
+        for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+            gpSectors[secIdx].lines = pLineRef;
+            pLineRef += gpSectors[secIdx].linecount;
+        }
 
-                // PsyDoom: rather than crashing gracefully handle orphaned lines with no sectors in the map data - just ignore them...
-                #if PSYDOOM_MODS
-                    if (!pLineFrontSec)
-                        continue;
-                #endif
+        std::atomic<bool> bMiscounted = false;
 
-                // Does this line belong to this sector?
-                // If so save the line reference in the sector line list and add to the sector bounding box.
-                if ((pLineFrontSec == pSec) || (pLineBackSec == pSec)) {
-                    *pLineRef = pLine;
-                    ++pLineRef;
+        P_SetupParallelFor(gNumSectors, [&](const int32_t secIdx) noexcept {
+            sector_t& sec = gpSectors[secIdx];
 
-                    M_AddToBox(bbox, pLine->vertex1->x, pLine->vertex1->y);
-                    M_AddToBox(bbox, pLine->vertex2->x, pLine->vertex2->y);
-                }
+            if (!P_GroupSectorLines(sec, sec.lines)) {
+                bMiscounted.store(true, std::memory_order_relaxed);
             }
-        }
-
-        // Sanity check the size of the line list we built is what we would expect.
-        // It should not contradict the line count for the sector.
-        const int32_t actualLineCount = (int32_t)(pLineRef - pSec->lines);
+        });
 
-        if (actualLineCount != pSec->linecount) {
+        if (bMiscounted) {
             I_Error("P_GroupLines: miscounted");
         }
+    #else
+        sector_t* pSec = gpSectors;
 
-        // Set the sound origin location for sector sounds and also the subsector.
-        // Use the bounding box center for this.
-        {
-            degenmobj_t& soundorg = pSec->soundorg;
-            soundorg.x = (bbox[BOXLEFT] + bbox[BOXRIGHT]) / 2;
-            soundorg.y = (bbox[BOXTOP] + bbox[BOXBOTTOM]) / 2;
-
-            #if PSYDOOM_MODS && PSYDOOM_FIX_UB
-                // The original code did not appear to initialize the 'z' field!
-                // I'm not sure it's used for sound code but give it a defined value of midway up in the air for good measure.
-                soundorg.z = (pSec->floorheight + pSec->ceilingheight) / 2;
-            #endif
+        for (int32_t secIdx = 0; secIdx < gNumSectors; ++secIdx) {
+            pSec->lines = pLineRef;
 
-            pSec->soundorg.subsector = R_PointInSubsector(soundorg.x, soundorg.y);
-        }
+            // Sanity check the size of the line list we built is what we would expect
+            if (!P_GroupSectorLines(*pSec, pLineRef)) {
+                I_Error("P_GroupLines: miscounted");
+            }
 
-        // Compute the bounding box for the sector in blockmap units.
-        // Note that if the sector extends the beyond the blockmap then we constrain it's coordinate.
-        {
-            int32_t bmcoord = d_rshift<MAPBLOCKSHIFT>(bbox[BOXTOP] - gBlockmapOriginY + MAXRADIUS);
-            bmcoord = (bmcoord >= gBlockmapHeight) ? gBlockmapHeight - 1 : bmcoord;
-            pSec->blockbox[BOXTOP] = bmcoord;
+            pLineRef += pSec->linecount;
+            ++pSec;
         }
-        {
-            int32_t bmcoord = d_rshift<MAPBLOCKSHIFT>(bbox[BOXBOTTOM] - gBlockmapOriginY - MAXRADIUS);
-            bmcoord = (bmcoord < 0) ? 0 : bmcoord;
-            pSec->blockbox[BOXBOTTOM] = bmcoord;
-        }
-        {
-            int32_t bmcoord = d_rshift<MAPBLOCKSHIFT>(bbox[BOXRIGHT] - gBlockmapOriginX + MAXRADIUS);
-            bmcoord = (bmcoord >= gBlockmapWidth) ? gBlockmapWidth - 1 : bmcoord;
-            pSec->blockbox[BOXRIGHT] = bmcoord;
-        }
-        {
-            int32_t bmcoord = d_rshift<MAPBLOCKSHIFT>(bbox[BOXLEFT] - gBlockmapOriginX - MAXRADIUS);
-            bmcoord = (bmcoord < 0) ? 0 : bmcoord;
-            pSec->blockbox[BOXLEFT] = bmcoord;
-        }
-
-        ++pSec;
-    }
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1700,18 +2038,58 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
     // Loading various map lumps.
     // PsyDoom: not using relative indexing anymore to load map lumps, search for the lump names instead.
     // PsyDoom: clear the map hash before starting to load level lumps that will add to the hash.
+    // PsyDoom: try to load the fully processed level geometry from the level cache first, if the map has been loaded before.
+    // The map lumps are added to the map hash in the same order regardless, so the map hash is unaffected by whether the cache is used or not.
     #if PSYDOOM_MODS
         MapHash::clear();
-        P_LoadBlockMap(W_MapGetNumForName("BLOCKMAP"));
-        P_LoadVertexes(W_MapGetNumForName("VERTEXES"));
-        P_LoadSectors(W_MapGetNumForName("SECTORS"));
-        P_LoadSideDefs(W_MapGetNumForName("SIDEDEFS"));
-        P_LoadLineDefs(W_MapGetNumForName("LINEDEFS"));
-        P_LoadSubSectors(W_MapGetNumForName("SSECTORS"));
-        P_LoadNodes(W_MapGetNumForName("NODES"));
-        P_LoadSegs(W_MapGetNumForName("SEGS"));
-        P_LoadLeafs(W_MapGetNumForName("LEAFS"));
-        P_LoadRejectMap(W_MapGetNumForName("REJECT"));
+
+        // Does the map want REJECT data generated if it has none? If so then note that in the map hash (after the REJECT lump) because it
+        // can affect sight checks and hence demo playback. Since generated REJECT data is derived entirely from the map lumps, this also
+        // makes sure the level cache never mixes up the geometry for a map with and without generated REJECT data.
+        const MapInfo::Map* const pMapInfo = MapInfo::getMap(mapNum);
+        const bool bGenerateReject = (pMapInfo && pMapInfo->bGenerateReject);
+
+        const auto addRejectGenerationToHash = [=]() noexcept {
+            if (bGenerateReject) {
+                MapHash::addData(&bGenerateReject, sizeof(bGenerateReject));
+            }
+        };
+
+        const bool bUseLevelCache = LevelCache::isEnabled();
+        LevelCache::Key levelCacheKey = {};
+        bool bLoadedFromLevelCache = false;
+
+        if (bUseLevelCache) {
+            P_AddMapGeometryLumpsToHash();
+            addRejectGenerationToHash();
+            levelCacheKey = LevelCache::makeKey(gbLoadingFinalDoomMap);
+            bLoadedFromLevelCache = LevelCache::load(levelCacheKey);
+
+            // If not in the cache then the lumps will be added to the map hash again as they are loaded below
+            if (!bLoadedFromLevelCache) {
+                MapHash::clear();
+            }
+        }
+
+        if (bLoadedFromLevelCache) {
+            P_InitBlockLinks();
+        } else {
+            P_LoadBlockMap(W_MapGetNumForName("BLOCKMAP"));
+            P_LoadVertexes(W_MapGetNumForName("VERTEXES"));
+            P_LoadSectors(W_MapGetNumForName("SECTORS"));
+            P_LoadSideDefs(W_MapGetNumForName("SIDEDEFS"));
+            P_LoadLineDefs(W_MapGetNumForName("LINEDEFS"));
+            P_LoadSubSectors(W_MapGetNumForName("SSECTORS"));
+            P_LoadNodes(W_MapGetNumForName("NODES"));
+            P_LoadSegs(W_MapGetNumForName("SEGS"));
+            P_LoadLeafs(W_MapGetNumForName("LEAFS"));
+            P_LoadRejectMap(W_MapGetNumForName("REJECT"), bGenerateReject);
+            addRejectGenerationToHash();
+        }
+
+        gPreReadMapGeometryLumps.clear();
+
+        P_InvalidateSightCache();
     #else
         P_LoadBlockMap(mapStartLump + ML_BLOCKMAP);
         P_LoadVertexes(mapStartLump + ML_VERTEXES);
@@ -1726,7 +2104,18 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
     #endif
 
     // Build sector line lists etc.
-    P_GroupLines();
+    // PsyDoom: levels loaded from the level cache already have this done, otherwise save the fully processed level to the cache.
+    #if PSYDOOM_MODS
+        if (!bLoadedFromLevelCache) {
+            P_GroupLines();
+
+            if (bUseLevelCache) {
+                LevelCache::save(levelCacheKey);
+            }
+        }
+    #else
+        P_GroupLines();
+    #endif
 
     // Load and spawn map things; also initialize the next deathmatch start
     gpDeathmatchP = &gDeathmatchStarts[0];
@@ -1737,6 +2126,7 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
         ScriptingEngine::init();                        // PsyDoom: initialize the scripting engine if the map has Lua scripted actions
         MapHash::finalize();                            // PsyDoom: compute the final map hash
         MapPatcher::applyPatches();                     // PsyDoom: apply any patches to original map data that are relevant at this point, once all things have been loaded
+        P_InitTagIndexes();                             // PsyDoom: index sectors and lines by tag, after map patches have made any tag changes
 
         // PsyDoom: forcing open boss triggered doors etc. if appropriate:
         const bool bIsDeathmatch = (gNetGame == gt_deathmatch);
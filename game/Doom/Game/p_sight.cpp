@@ -12,35 +12,251 @@
 #include "p_tick.h"
 #include "PsyDoom/Game.h"
 
+#if PSYDOOM_MODS
+    #include "PsyDoom/WorkerPool.h"
+#endif
+
 #include <algorithm>
 
-static fixed_t      gSightZStart;       // Z position of thing looking
-static fixed_t      gTopSlope;          // Maximum/top unblocked viewing slope (clipped against upper walls)
-static fixed_t      gBottomSlope;       // Minimum/bottom unblocked viewing slope (clipped against lower walls)
-static divline_t    gSTrace;            // The start point and vector for sight checking
-static fixed_t      gT2x;               // End point for sight checking: x
-static fixed_t      gT2y;               // End point for sight checking: y
-static int32_t      gT1xs;              // Sight line start, whole coords: x
-static int32_t      gT1ys;              // Sight line start, whole coords: y
-static int32_t      gT2xs;              // Sight line end, whole coords: x
-static int32_t      gT2ys;              // Sight line end, whole coords: y
+#if PSYDOOM_MODS
+    #include <cstring>
+    #include <vector>
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// State for a single line of sight check.
+// PsyDoom: these were originally file scope globals. They are now kept in a context object so that sight checks can be done in parallel.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct SightContext {
+    fixed_t     sightZStart;        // Z position of thing looking
+    fixed_t     topSlope;           // Maximum/top unblocked viewing slope (clipped against upper walls)
+    fixed_t     bottomSlope;        // Minimum/bottom unblocked viewing slope (clipped against lower walls)
+    divline_t   strace;             // The start point and vector for sight checking
+    fixed_t     t2x;                // End point for sight checking: x
+    fixed_t     t2y;                // End point for sight checking: y
+    int32_t     t1xs;               // Sight line start, whole coords: x
+    int32_t     t1ys;               // Sight line start, whole coords: y
+    int32_t     t2xs;               // Sight line end, whole coords: x
+    int32_t     t2ys;               // Sight line end, whole coords: y
+
+    #if PSYDOOM_MODS
+        // If not null then lines are marked as visited using this array (indexed by line number) and 'validCount' instead of via
+        // 'line_t::validcount' and 'gValidCount'. This allows the sight check to be done without modifying any shared state.
+        int32_t*    pLineValidCounts;
+        int32_t     validCount;
+        int32_t     badSubsecNum;   // Set to a bad subsector number encountered (if any) when not running on the main thread, -1 otherwise
+    #endif
+};
+
+// The context for sight checks done on the main thread
+static SightContext gSightContext;
+
+#if PSYDOOM_MODS
+    // PsyDoom: only do the sight checks in 'P_CheckSights' in parallel if there are at least this many; not worth it otherwise
+    static constexpr uint32_t MIN_PARALLEL_SIGHT_CHECKS = 32;
+
+    // PsyDoom: per worker state for doing sight checks in parallel
+    struct WorkerSightContext {
+        SightContext            sightContext;
+        std::vector<int32_t>    lineValidCounts;
+    };
+
+    static std::vector<WorkerSightContext>  gWorkerSightContexts;
+    static std::vector<mobj_t*>             gSightCheckMobjs;       // Things due a sight check in 'P_CheckSights', in thinker list order
+    static std::vector<uint8_t>             gSightCheckResults;     // Result of the sight check for each thing in 'gSightCheckMobjs'
+
+    // PsyDoom: a cache of recent sight check results, keyed by the pair of things involved.
+    // Each entry also records the position and size of both things so that if either moves the entry is automatically invalid.
+    // All entries are invalidated at once by incrementing the cache epoch; this happens every tic (in 'P_CheckSights') as well as whenever
+    // sector floor or ceiling heights change, since those can also affect line of sight.
+    struct SightCacheEntry {
+        const mobj_t*           pMobj1;
+        const mobj_t*           pMobj2;
+        const subsector_t*      pSubsec1;
+        const subsector_t*      pSubsec2;
+        fixed_t                 x1, y1, z1, height1;
+        fixed_t                 x2, y2, z2, height2;
+        uint32_t                epoch;
+        bool                    bCanSee;
+    };
+
+    static constexpr uint32_t SIGHT_CACHE_SIZE = 4096;      // Note: must be a power of two
+
+    static SightCacheEntry  gSightCache[SIGHT_CACHE_SIZE];
+    static uint32_t         gSightCacheEpoch = 1;           // Entries with a different epoch are invalid; never '0' so zero initialized entries are invalid
+#endif
+
+static bool P_CheckSight(SightContext& ctx, mobj_t& mobj1, mobj_t& mobj2) noexcept;
+static bool PS_CrossBSPNode(SightContext& ctx, const int32_t nodeNum) noexcept;
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells if sight checks against the given thing are forced to fail due to cheats or the external camera being active
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_IsSightForcedToFail(const mobj_t& mobj2) noexcept {
+    // If the target is a player, not a 'Voodoo doll' and has the 'notarget' cheat on then it cannot be seen.
+    // If the external camera is active then don't allow anything to be sighted.
+    if (mobj2.player && (mobj2.player->cheats & CF_NOTARGET) && (mobj2.player->mo == &mobj2))
+        return true;
+
+    return (gExtCameraTicsLeft > 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: invalidates all entries in the sight check cache.
+// Must be called whenever something other than the position of the two things involved might change the result of a sight check.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InvalidateSightCache() noexcept {
+    gSightCacheEpoch++;
+
+    if (gSightCacheEpoch == 0) {
+        gSightCacheEpoch = 1;
+        std::memset(gSightCache, 0, sizeof(gSightCache));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get the entry in the sight check cache for the given pair of things
+//------------------------------------------------------------------------------------------------------------------------------------------
+static SightCacheEntry& P_GetSightCacheEntry(const mobj_t& mobj1, const mobj_t& mobj2) noexcept {
+    const uint64_t ptrHash = (uint64_t)(uintptr_t) &mobj1 * 0x9E3779B97F4A7C15ull + (uint64_t)(uintptr_t) &mobj2 * 0xC2B2AE3D27D4EB4Full;
+    return gSightCache[(uint32_t)(ptrHash >> 40) & (SIGHT_CACHE_SIZE - 1)];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells if the given sight check cache entry holds a valid result for the given pair of things
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_IsSightCacheEntryValid(const SightCacheEntry& entry, const mobj_t& mobj1, const mobj_t& mobj2) noexcept {
+    return (
+        (entry.epoch == gSightCacheEpoch) &&
+        (entry.pMobj1 == &mobj1) && (entry.pMobj2 == &mobj2) &&
+        (entry.pSubsec1 == mobj1.subsector) && (entry.pSubsec2 == mobj2.subsector) &&
+        (entry.x1 == mobj1.x) && (entry.y1 == mobj1.y) && (entry.z1 == mobj1.z) && (entry.height1 == mobj1.height) &&
+        (entry.x2 == mobj2.x) && (entry.y2 == mobj2.y) && (entry.z2 == mobj2.z) && (entry.height2 == mobj2.height)
+    );
+}
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Updates target visibility checking for all map objects that are due an update
+// PsyDoom: save the result of a sight check between the given pair of things to the sight check cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_AddSightCacheEntry(const mobj_t& mobj1, const mobj_t& mobj2, const bool bCanSee) noexcept {
+    SightCacheEntry& entry = P_GetSightCacheEntry(mobj1, mobj2);
+    entry.pMobj1 = &mobj1;
+    entry.pMobj2 = &mobj2;
+    entry.pSubsec1 = mobj1.subsector;
+    entry.pSubsec2 = mobj2.subsector;
+    entry.x1 = mobj1.x;
+    entry.y1 = mobj1.y;
+    entry.z1 = mobj1.z;
+    entry.height1 = mobj1.height;
+    entry.x2 = mobj2.x;
+    entry.y2 = mobj2.y;
+    entry.z2 = mobj2.z;
+    entry.height2 = mobj2.height;
+    entry.epoch = gSightCacheEpoch;
+    entry.bCanSee = bCanSee;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get the per worker sight contexts ready for doing sight checks in parallel for the current map
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_PrepareWorkerSightContexts() noexcept {
+    const uint32_t numWorkers = WorkerPool::getNumWorkers();
+
+    if (gWorkerSightContexts.size() != numWorkers) {
+        gWorkerSightContexts.resize(numWorkers);
+    }
+
+    for (WorkerSightContext& workerCtx : gWorkerSightContexts) {
+        // If the number of lines changed then reset the visitation marks
+        if (workerCtx.lineValidCounts.size() != (size_t) gNumLines) {
+            workerCtx.lineValidCounts.assign((size_t) gNumLines, 0);
+            workerCtx.sightContext.validCount = 0;
+        }
+
+        workerCtx.sightContext.pLineValidCounts = workerCtx.lineValidCounts.data();
+        workerCtx.sightContext.badSubsecNum = -1;
+    }
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Updates target visibility checking for all map objects that are due an update.
+//
+// PsyDoom: the sight checks for each thing are independent of each other and only read the map state, so they are now done in parallel
+// across the worker pool when there are enough of them. The results are then applied afterwards in the original thinker list order.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_CheckSights() noexcept {
+#if PSYDOOM_MODS
+    // A new tic: discard all cached sight check results from the previous tic
+    P_InvalidateSightCache();
+
+    // Gather up all the things that are due a sight check
+    gSightCheckMobjs.clear();
+
     for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
         // Must be killable (enemy) to do sight checking.
         //
         // PsyDoom: extend the sight check to types that include a 'see state' (except the player) in order to allow the reimplemented 'Icon Of Sin' boss to spot the player.
         // This doesn't cause any demo de-sync against original game demos so I've made this update non-optional.
-        #if PSYDOOM_MODS
-            const bool bHasSeeState = (pmobj->info->seestate != S_NULL);
-            const bool bIsNotPlayer = (pmobj->type != MT_PLAYER);
-            const bool bCheckSight = ((pmobj->flags & MF_COUNTKILL) || (bHasSeeState && bIsNotPlayer));
-        #else
-            const bool bCheckSight = (pmobj->flags & MF_COUNTKILL);
-        #endif
+        const bool bHasSeeState = (pmobj->info->seestate != S_NULL);
+        const bool bIsNotPlayer = (pmobj->type != MT_PLAYER);
+        const bool bCheckSight = ((pmobj->flags & MF_COUNTKILL) || (bHasSeeState && bIsNotPlayer));
+
+        // Must also be about to change states for up-to-date sight info to be useful
+        if (bCheckSight && (pmobj->tics == 1)) {
+            gSightCheckMobjs.push_back(pmobj);
+        }
+    }
+
+    // See if each thing can see its target - if any
+    const uint32_t numSightChecks = (uint32_t) gSightCheckMobjs.size();
+    gSightCheckResults.resize(numSightChecks);
+
+    if ((numSightChecks >= MIN_PARALLEL_SIGHT_CHECKS) && (WorkerPool::getNumWorkers() > 1)) {
+        P_PrepareWorkerSightContexts();
+
+        WorkerPool::parallelFor(numSightChecks, [](const uint32_t checkIdx, const uint32_t workerIdx) noexcept {
+            mobj_t& mobj = *gSightCheckMobjs[checkIdx];
+            mobj_t* const pMobjTarget = mobj.target;
+            SightContext& ctx = gWorkerSightContexts[workerIdx].sightContext;
+            gSightCheckResults[checkIdx] = (pMobjTarget && P_CheckSight(ctx, mobj, *pMobjTarget));
+        });
+
+        // If any of the sight checks hit bad map data then report it here, on the main thread
+        for (const WorkerSightContext& workerCtx : gWorkerSightContexts) {
+            if (workerCtx.sightContext.badSubsecNum >= 0) {
+                I_Error("PS_CrossSubsector: ss %i with numss = %i", workerCtx.sightContext.badSubsecNum, gNumSubsectors);
+            }
+        }
+    } else {
+        for (uint32_t checkIdx = 0; checkIdx < numSightChecks; ++checkIdx) {
+            mobj_t& mobj = *gSightCheckMobjs[checkIdx];
+            mobj_t* const pMobjTarget = mobj.target;
+            gSightCheckResults[checkIdx] = (pMobjTarget && P_CheckSight(mobj, *pMobjTarget));
+        }
+    }
+
+    // Add or remove the visibility flag based on the result of each sight check, in thinker list order.
+    // Also save the results to the sight check cache, since they will likely be checked again in the next tic by the enemy AI.
+    for (uint32_t checkIdx = 0; checkIdx < numSightChecks; ++checkIdx) {
+        mobj_t& mobj = *gSightCheckMobjs[checkIdx];
+        mobj_t* const pMobjTarget = mobj.target;
+
+        if (pMobjTarget && (!P_IsSightForcedToFail(*pMobjTarget))) {
+            P_AddSightCacheEntry(mobj, *pMobjTarget, gSightCheckResults[checkIdx]);
+        }
+
+        if (gSightCheckResults[checkIdx]) {
+            mobj.flags |= MF_SEETARGET;
+        } else {
+            mobj.flags &= (~MF_SEETARGET);      // No longer can see target
+        }
+    }
+#else
+    for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
+        // Must be killable (enemy) to do sight checking
+        const bool bCheckSight = (pmobj->flags & MF_COUNTKILL);
 
         if (!bCheckSight)
             continue;
@@ -58,19 +274,38 @@ void P_CheckSights() noexcept {
             }
         }
     }
+#endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tells if 'mobj1' can see 'mobj2'. Returns 'true' if that is the case.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool P_CheckSight(mobj_t& mobj1, mobj_t& mobj2) noexcept {
-    // PsyDoom: if the target is a player, not a 'Voodoo doll' and has the 'notarget' cheat on then it cannot be seen.
-    // PsyDoom: if the external camera is active then don't allow anything to be sighted.
+    // PsyDoom: check for forced sight failures first, then see if the result of this check is already cached
     #if PSYDOOM_MODS
-        if (mobj2.player && (mobj2.player->cheats & CF_NOTARGET) && (mobj2.player->mo == &mobj2))
+        if (P_IsSightForcedToFail(mobj2))
             return false;
 
-        if (gExtCameraTicsLeft > 0)
+        if (const SightCacheEntry& entry = P_GetSightCacheEntry(mobj1, mobj2); P_IsSightCacheEntryValid(entry, mobj1, mobj2))
+            return entry.bCanSee;
+
+        gSightContext.pLineValidCounts = nullptr;
+        const bool bCanSee = P_CheckSight(gSightContext, mobj1, mobj2);
+        P_AddSightCacheEntry(mobj1, mobj2, bCanSee);
+        return bCanSee;
+    #else
+        return P_CheckSight(gSightContext, mobj1, mobj2);
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if 'mobj1' can see 'mobj2' using the given context to hold the state for the sight check
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_CheckSight(SightContext& ctx, mobj_t& mobj1, mobj_t& mobj2) noexcept {
+    // PsyDoom: if the target is a player, not a 'Voodoo doll' and has the 'notarget' cheat on then it cannot be seen.
+    // PsyDoom: if the external camera is active then don't allow anything to be sighted.
+    #if PSYDOOM_MODS
+        if (P_IsSightForcedToFail(mobj2))
             return false;
     #endif
 
@@ -91,35 +326,44 @@ bool P_CheckSight(mobj_t& mobj1, mobj_t& mobj2) noexcept {
     // Note that the coordinates are truncated to be on odd integer coordinates.
     // Not sure why this is done, or what it's trying to avoid - it's in the 3DO and Jag Doom sources but not explained.
     const int32_t COORD_MASK = 0xFFFE0000;
-    gSTrace.x = (mobj1.x & COORD_MASK) | FRACUNIT;
-    gSTrace.y = (mobj1.y & COORD_MASK) | FRACUNIT;
-    gT2x = (mobj2.x & COORD_MASK) | FRACUNIT;
-    gT2y = (mobj2.y & COORD_MASK) | FRACUNIT;
+    ctx.strace.x = (mobj1.x & COORD_MASK) | FRACUNIT;
+    ctx.strace.y = (mobj1.y & COORD_MASK) | FRACUNIT;
+    ctx.t2x = (mobj2.x & COORD_MASK) | FRACUNIT;
+    ctx.t2y = (mobj2.y & COORD_MASK) | FRACUNIT;
 
     // Precalculate the vector for the sight line
-    gSTrace.dx = gT2x - gSTrace.x;
-    gSTrace.dy = gT2y - gSTrace.y;
+    ctx.strace.dx = ctx.t2x - ctx.strace.x;
+    ctx.strace.dy = ctx.t2y - ctx.strace.y;
 
     // Precalculate the truncated start and end points for the sight line for later use
-    gT1xs = d_fixed_to_int(gSTrace.x);
-    gT1ys = d_fixed_to_int(gSTrace.y);
-    gT2xs = d_fixed_to_int(gT2x);
-    gT2ys = d_fixed_to_int(gT2y);
+    ctx.t1xs = d_fixed_to_int(ctx.strace.x);
+    ctx.t1ys = d_fixed_to_int(ctx.strace.y);
+    ctx.t2xs = d_fixed_to_int(ctx.t2x);
+    ctx.t2ys = d_fixed_to_int(ctx.t2y);
 
     // This is how high the sight point is at (eyeball level -1/4 height down from the top)
     const fixed_t sightZStart = mobj1.z + mobj1.height - d_rshift<2>(mobj1.height);
-    gSightZStart = sightZStart;
+    ctx.sightZStart = sightZStart;
 
     // Figure out the initial top and bottom slopes for the the vertical sight range
-    gTopSlope = mobj2.z + mobj2.height - sightZStart;
-    gBottomSlope = mobj2.z - sightZStart;
+    ctx.topSlope = mobj2.z + mobj2.height - sightZStart;
+    ctx.bottomSlope = mobj2.z - sightZStart;
 
-    // Doing a new raycast so update the visitation mark which tells us if stuff has already been processed
-    gValidCount++;
+    // Doing a new raycast so update the visitation mark which tells us if stuff has already been processed.
+    // PsyDoom: if the context has its own visitation marks then update those instead of the global one.
+    #if PSYDOOM_MODS
+        if (ctx.pLineValidCounts) {
+            ctx.validCount++;
+        } else {
+            gValidCount++;
+        }
+    #else
+        gValidCount++;
+    #endif
 
     // Do a raycast against the BSP tree and return if sight is unobstructed.
     // Also narrows the vertical sight range with each lower and upper wall encountered.
-    return PS_CrossBSPNode(gNumBspNodes - 1);
+    return PS_CrossBSPNode(ctx, gNumBspNodes - 1);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -127,16 +371,16 @@ bool P_CheckSight(mobj_t& mobj1, mobj_t& mobj2) noexcept {
 // When the intersect ratio is > 0.0 and < 1.0 then there is a valid intersection with the sight line, otherwise there is no
 // intersection or the intersection occurs beyond the range of the line.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static fixed_t PS_SightCrossLine(line_t& line) noexcept {
+static fixed_t PS_SightCrossLine(const SightContext& ctx, line_t& line) noexcept {
     // Get the integer coordinates of the line and the sight line
     const int32_t lineX1 = d_fixed_to_int(line.vertex1->x);
     const int32_t lineY1 = d_fixed_to_int(line.vertex1->y);
     const int32_t lineX2 = d_fixed_to_int(line.vertex2->x);
     const int32_t lineY2 = d_fixed_to_int(line.vertex2->y);
-    const int32_t sightX1 = gT1xs;
-    const int32_t sightY1 = gT1ys;
-    const int32_t sightX2 = gT2xs;
-    const int32_t sightY2 = gT2ys;
+    const int32_t sightX1 = ctx.t1xs;
+    const int32_t sightY1 = ctx.t1ys;
+    const int32_t sightX2 = ctx.t2xs;
+    const int32_t sightY2 = ctx.t2ys;
 
     // Compute which sides of the sight line the line points are on.
     // Use the same cross product trick found in 'PA_DivlineSide' and 'R_PointOnSide'.
@@ -172,7 +416,7 @@ static fixed_t PS_SightCrossLine(line_t& line) noexcept {
 // Returns 'true' if the sight line is unobstructed, returns 'false' otherwise.
 // This function also updates/narrows the allowed vertical view range.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static bool PS_CrossSubsector(subsector_t& subsec) noexcept {
+static bool PS_CrossSubsector(SightContext& ctx, subsector_t& subsec) noexcept {
     // Check the sight line against the lines for all segs in the subsector
     const int32_t numSegs = subsec.numsegs;
     seg_t* const pSegs = &gpSegs[subsec.firstseg];
@@ -182,16 +426,25 @@ static bool PS_CrossSubsector(subsector_t& subsec) noexcept {
         line_t& line = *seg.linedef;
 
         // Skip past this seg's line if we've already done it this sight check.
-        // Multiple segs might reference the same line, so this saves redundant work:
-        if (line.validcount == gValidCount)
+        // Multiple segs might reference the same line, so this saves redundant work.
+        // PsyDoom: use the visitation marks for the context instead, if it has them.
+        #if PSYDOOM_MODS
+            int32_t& lineValidCount = (ctx.pLineValidCounts) ? ctx.pLineValidCounts[&line - gpLines] : line.validcount;
+            const int32_t validCount = (ctx.pLineValidCounts) ? ctx.validCount : gValidCount;
+        #else
+            int32_t& lineValidCount = line.validcount;
+            const int32_t validCount = gValidCount;
+        #endif
+
+        if (lineValidCount == validCount)
             continue;
 
         // Don't check the line again until the next sight check
-        line.validcount = gValidCount;
+        lineValidCount = validCount;
 
         // If the sight line does not intersect along the actual line points then ignore.
         // Not sure where the magics here came from, probably through hacking/experimentation?
-        const fixed_t intersectFrac = PS_SightCrossLine(line);
+        const fixed_t intersectFrac = PS_SightCrossLine(ctx, line);
 
         if ((intersectFrac < 4) || (intersectFrac > FRACUNIT))
             continue;
@@ -224,7 +477,7 @@ static bool PS_CrossSubsector(subsector_t& subsec) noexcept {
 
         // Narrow the allowed vertical sight range: against bottom wall
         if (fsec.floorheight != bsec.floorheight) {
-            const fixed_t dz = highestFloor - gSightZStart;
+            const fixed_t dz = highestFloor - ctx.sightZStart;
 
             // PsyDoom: use 64-bit ops to avoid overflows in the line of sight calculations, if enabled
             int32_t slope;
@@ -236,14 +489,14 @@ static bool PS_CrossSubsector(subsector_t& subsec) noexcept {
                 slope = d_lshift<8>(d_lshift<6>(dz) / d_rshift<2>(intersectFrac));
             }
 
-            if (slope > gBottomSlope) {
-                gBottomSlope = slope;
+            if (slope > ctx.bottomSlope) {
+                ctx.bottomSlope = slope;
             }
         }
 
         // Narrow the allowed vertical sight range: against top wall
         if (fsec.ceilingheight != bsec.ceilingheight) {
-            const fixed_t dz = lowestCeil - gSightZStart;
+            const fixed_t dz = lowestCeil - ctx.sightZStart;
 
             // PsyDoom: use 64-bit ops to avoid overflows in the line of sight calculations, if enabled
             int32_t slope;
@@ -255,13 +508,13 @@ static bool PS_CrossSubsector(subsector_t& subsec) noexcept {
                 slope = d_lshift<8>(d_lshift<6>(dz) / d_rshift<2>(intersectFrac));
             }
 
-            if (slope < gTopSlope) {
-                gTopSlope = slope;
+            if (slope < ctx.topSlope) {
+                ctx.topSlope = slope;
             }
         }
 
         // If the allowed vertical sight range has become completely closed then sight is blocked
-        if (gTopSlope <= gBottomSlope)
+        if (ctx.topSlope <= ctx.bottomSlope)
             return false;
     }
 
@@ -270,17 +523,25 @@ static bool PS_CrossSubsector(subsector_t& subsec) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Recursive sight checking: tells if the 'gSTrace' line is blocked by the BSP tree halfspace represented by the given node.
+// Recursive sight checking: tells if the context's sight line is blocked by the BSP tree halfspace represented by the given node.
 // Returns 'true' if the sight line is unobstructed.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool PS_CrossBSPNode(const int32_t nodeNum) noexcept {
+static bool PS_CrossBSPNode(SightContext& ctx, const int32_t nodeNum) noexcept {
     // Is this bsp node actually a subsector? (leaf node) If so then do sight checks against that:
     if (nodeNum & NF_SUBSECTOR) {
         const int32_t subsecNum = nodeNum & (~NF_SUBSECTOR);
 
         if (subsecNum < gNumSubsectors) {
-            return PS_CrossSubsector(gpSubsectors[subsecNum]);
+            return PS_CrossSubsector(ctx, gpSubsectors[subsecNum]);
         } else {
+            // PsyDoom: if not on the main thread then the error must be reported later, by the main thread
+            #if PSYDOOM_MODS
+                if (ctx.pLineValidCounts) {
+                    ctx.badSubsecNum = subsecNum;
+                    return false;
+                }
+            #endif
+
             I_Error("PS_CrossSubsector: ss %i with numss = %i", subsecNum, gNumSubsectors);     // Bad subsector number!
             return false;
         }
@@ -288,17 +549,17 @@ bool PS_CrossBSPNode(const int32_t nodeNum) noexcept {
 
     // See what side of the bsp split the point is on: will check to see if the sight line is blocked by that half-space first
     node_t& bspNode = gpBspNodes[nodeNum];
-    const int32_t sideNum = PA_DivlineSide(gSTrace.x, gSTrace.y, bspNode.line);
+    const int32_t sideNum = PA_DivlineSide(ctx.strace.x, ctx.strace.y, bspNode.line);
 
     // If the sight line cannot cross the closest half-space then we are done: sight is obstructed
-    if (!PS_CrossBSPNode(bspNode.children[sideNum]))
+    if (!PS_CrossBSPNode(ctx, bspNode.children[sideNum]))
         return false;
 
     // Check to see what side of the bsp split the end point for sight checking is on.
     // If it's in the same half-space we just raycasted against then we are done - sight is unobstructed.
-    if (sideNum == PA_DivlineSide(gT2x, gT2y, bspNode.line))
+    if (sideNum == PA_DivlineSide(ctx.t2x, ctx.t2y, bspNode.line))
         return true;
 
     // Failing that recurse into the opposite side of the BSP split and raycast against that, returning the result
-    return PS_CrossBSPNode(bspNode.children[sideNum ^ 1]);
+    return PS_CrossBSPNode(ctx, bspNode.children[sideNum ^ 1]);
 }
@@ -31,9 +31,11 @@
 #include "PsyDoom/ParserTokenizer.h"
 #include "PsyDoom/ScriptingEngine.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 // Mask applied to offsets for scrolling walls (wrap every 128 units)
@@ -77,6 +79,15 @@ card_t      gMapRedKeyType;         // What type of red key the map uses (if map
 card_t      gMapYellowKeyType;      // What type of yellow key the map uses (if map has a yellow key)
 int32_t     gMapBossSpecialFlags;   // PSX addition: What types of boss specials (triggers) are active on the current map
 
+// PsyDoom: indexes of the sectors and lines with each tag, in ascending index order.
+// Used to quickly find the sectors or lines affected by a special without searching the entire map.
+#if PSYDOOM_MODS
+    typedef std::unordered_map<int32_t, std::vector<int32_t>> TagIndex;
+
+    static TagIndex gSectorTagIndex;
+    static TagIndex gLineTagIndex;
+#endif
+
 // The list of animated textures.
 // PsyDoom: this list is now allocated dynamically at runtime.
 #if PSYDOOM_MODS
@@ -535,20 +546,119 @@ fixed_t P_FindHighestCeilingSurrounding(sector_t& sector) noexcept {
 // Returns the index of the next matching sector found, or '-1' if there was no next matching sector.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t P_FindSectorFromLineTag(line_t& line, const int32_t searchStart) noexcept {
-    const int32_t lineTag = line.tag;
-    sector_t* const pSectors = gpSectors;
-    const int32_t numSectors = gNumSectors;
+    // PsyDoom: use the sector tag index instead of searching through all the sectors
+    #if PSYDOOM_MODS
+        return P_FindNextSectorWithTag(line.tag, searchStart);
+    #else
+        const int32_t lineTag = line.tag;
+        sector_t* const pSectors = gpSectors;
+        const int32_t numSectors = gNumSectors;
+
+        for (int32_t sectorIdx = searchStart + 1; sectorIdx < numSectors; ++sectorIdx) {
+            sector_t& sector = pSectors[sectorIdx];
+
+            if (sector.tag == lineTag)
+                return sectorIdx;
+        }
+
+        return -1;
+    #endif
+}
 
-    for (int32_t sectorIdx = searchStart + 1; sectorIdx < numSectors; ++sectorIdx) {
-        sector_t& sector = pSectors[sectorIdx];
+#if PSYDOOM_MODS
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tag index helpers.
+// Each list of indexes is kept sorted so that searches visit sectors and lines in the same order as a linear search through the map.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t P_FindNextInTagIndex(const TagIndex& tagIndex, const int32_t tag, const int32_t searchStart) noexcept {
+    const auto listIter = tagIndex.find(tag);
 
-        if (sector.tag == lineTag)
-            return sectorIdx;
+    if (listIter == tagIndex.end())
+        return -1;
+
+    const std::vector<int32_t>& indexes = listIter->second;
+    const auto indexIter = std::upper_bound(indexes.begin(), indexes.end(), searchStart);
+    return (indexIter != indexes.end()) ? *indexIter : -1;
+}
+
+static void P_AddToTagIndex(TagIndex& tagIndex, const int32_t tag, const int32_t index) noexcept {
+    std::vector<int32_t>& indexes = tagIndex[tag];
+    indexes.insert(std::lower_bound(indexes.begin(), indexes.end(), index), index);
+}
+
+static void P_RemoveFromTagIndex(TagIndex& tagIndex, const int32_t tag, const int32_t index) noexcept {
+    const auto listIter = tagIndex.find(tag);
+
+    if (listIter == tagIndex.end())
+        return;
+
+    std::vector<int32_t>& indexes = listIter->second;
+    const auto indexIter = std::lower_bound(indexes.begin(), indexes.end(), index);
+
+    if ((indexIter != indexes.end()) && (*indexIter == index)) {
+        indexes.erase(indexIter);
     }
+}
 
-    return -1;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: builds the indexes of sectors and lines by tag for the current map.
+// Must be called whenever sector or line tags are changed without going through 'P_SetSectorTag' or 'P_SetLineTag'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InitTagIndexes() noexcept {
+    gSectorTagIndex.clear();
+    gLineTagIndex.clear();
+
+    for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
+        gSectorTagIndex[gpSectors[sectorIdx].tag].push_back(sectorIdx);
+    }
+
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        gLineTagIndex[gpLines[lineIdx].tag].push_back(lineIdx);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: find the next sector or line with the given tag, starting the search at the given index + 1.
+// Returns '-1' if there is no next sector or line with the tag.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t P_FindNextSectorWithTag(const int32_t tag, const int32_t searchStart) noexcept {
+    const int32_t sectorIdx = P_FindNextInTagIndex(gSectorTagIndex, tag, searchStart);
+    ASSERT((sectorIdx < 0) || ((sectorIdx < gNumSectors) && (gpSectors[sectorIdx].tag == tag)));
+    return sectorIdx;
+}
+
+int32_t P_FindNextLineWithTag(const int32_t tag, const int32_t searchStart) noexcept {
+    const int32_t lineIdx = P_FindNextInTagIndex(gLineTagIndex, tag, searchStart);
+    ASSERT((lineIdx < 0) || ((lineIdx < gNumLines) && (gpLines[lineIdx].tag == tag)));
+    return lineIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: change the tag of a sector or line and update the tag indexes accordingly
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_SetSectorTag(sector_t& sector, const int32_t tag) noexcept {
+    if (sector.tag == tag)
+        return;
+
+    const int32_t sectorIdx = (int32_t)(&sector - gpSectors);
+    P_RemoveFromTagIndex(gSectorTagIndex, sector.tag, sectorIdx);
+    P_AddToTagIndex(gSectorTagIndex, tag, sectorIdx);
+    sector.tag = tag;
 }
 
+void P_SetLineTag(line_t& line, const int32_t tag) noexcept {
+    if (line.tag == tag)
+        return;
+
+    const int32_t lineIdx = (int32_t)(&line - gpLines);
+    P_RemoveFromTagIndex(gLineTagIndex, line.tag, lineIdx);
+    P_AddToTagIndex(gLineTagIndex, tag, lineIdx);
+    line.tag = tag;
+}
+
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Find the minimum light level in the sectors surrounding the given sector which is less than the given max light level.
 // If there is no light level less than the given max, then the max value is returned.
@@ -1471,7 +1581,11 @@ bool EV_DoDonut(line_t& line) noexcept {
             // This raises the floor to the height of the back sector we just found and changes the texture to that.
             // This is normally used to raise slime and change the slime texture.
             {
-                floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #if PSYDOOM_MODS
+                    floormove_t& floorMove = *(floormove_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC);
+                #else
+                    floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #endif
 
                 #if PSYDOOM_MODS
                     floorMove = {};     // PsyDoom: zero-init all fields to be safe
@@ -1494,7 +1608,11 @@ bool EV_DoDonut(line_t& line) noexcept {
             // Create the mover for the inner part or the 'hole' of the donut.
             // This sector just lowers down to the height of the back sector we just found.
             {
-                floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #if PSYDOOM_MODS
+                    floormove_t& floorMove = *(floormove_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC);
+                #else
+                    floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #endif
 
                 #if PSYDOOM_MODS
                     floorMove = {};     // PsyDoom: zero-init all fields to be safe
@@ -1524,7 +1642,11 @@ bool EV_DoDonut(line_t& line) noexcept {
 // Schedule an action to be invoked after the specified number of tics
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void P_ScheduleDelayedAction(const int32_t delayTics, const delayed_actionfn_t actionFunc) noexcept {
-    delayaction_t& delayed = *(delayaction_t*) Z_Malloc(*gpMainMemZone, sizeof(delayaction_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        delayaction_t& delayed = *(delayaction_t*) Z_PoolMalloc(*gpMainMemZone, sizeof(delayaction_t), PU_LEVSPEC);
+    #else
+        delayaction_t& delayed = *(delayaction_t*) Z_Malloc(*gpMainMemZone, sizeof(delayaction_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(delayed.thinker);
 
     delayed.thinker.function = (think_t) &T_DelayedAction;
@@ -60,6 +60,15 @@ fixed_t P_FindNextHighestFloor(sector_t& sector, const fixed_t baseHeight) noexc
 fixed_t P_FindLowestCeilingSurrounding(sector_t& sector) noexcept;
 fixed_t P_FindHighestCeilingSurrounding(sector_t& sector) noexcept;
 int32_t P_FindSectorFromLineTag(line_t& line, const int32_t searchStart) noexcept;
+
+#if PSYDOOM_MODS
+    void P_InitTagIndexes() noexcept;
+    int32_t P_FindNextSectorWithTag(const int32_t tag, const int32_t searchStart) noexcept;
+    int32_t P_FindNextLineWithTag(const int32_t tag, const int32_t searchStart) noexcept;
+    void P_SetSectorTag(sector_t& sector, const int32_t tag) noexcept;
+    void P_SetLineTag(line_t& line, const int32_t tag) noexcept;
+#endif
+
 int32_t P_FindMinSurroundingLight(sector_t& sector, const int32_t maxLightLevel) noexcept;
 void P_CrossSpecialLine(line_t& line, mobj_t& mobj) noexcept;
 void P_ShootSpecialLine(mobj_t& mobj, line_t& line) noexcept;
@@ -14,6 +14,7 @@
 #include "p_mobj.h"
 #include "p_move.h"
 #include "p_setup.h"
+#include "p_spec.h"
 #include "p_tick.h"
 
 #include <cstdlib>
@@ -69,7 +70,12 @@ bool EV_Teleport(line_t& line, mobj_t& mobj) noexcept {
     // Search for a teleport destination marker in a sector with a tag matching the given line
     sector_t* const pSectors = gpSectors;
 
-    for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
+    // PsyDoom: use the tag index to visit only the sectors with a matching tag
+    #if PSYDOOM_MODS
+        for (int32_t sectorIdx = P_FindSectorFromLineTag(line, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromLineTag(line, sectorIdx)) {
+    #else
+        for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
+    #endif
         // Ignore this sector if it doesn't have the right tag
         sector_t& sector = pSectors[sectorIdx];
 
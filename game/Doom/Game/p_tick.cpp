@@ -141,7 +141,12 @@ void P_RunThinkers() noexcept {
             // Time to remove this thinker, it's function has been zapped
             pThinker->next->prev = pThinker->prev;
             pThinker->prev->next = pThinker->next;
-            Z_Free2(*gpMainMemZone, pThinker);
+
+            #if PSYDOOM_MODS
+                Z_PoolFree(*gpMainMemZone, pThinker);   // PsyDoom: thinkers are now allocated from memory pools
+            #else
+                Z_Free2(*gpMainMemZone, pThinker);
+            #endif
         } else {
             // Run the thinker if it has a think function and increment the active count stat
             if (pThinker->function) {
@@ -6,31 +6,24 @@
 
 #include <vector>
 
-// Weak count internal data.
-// Stores the number of weak references to an object, whether it is alive and a pointer to the object itself.
-struct WeakCount {
-    uint32_t    count;          // How many weak references there are to the object
-    bool        bMobjExists;    // Whether the object is still valid/existing
-    mobj_t*     pMobj;          // The object (weakly) pointed to
+// A slot in the map object handle table.
+// Stores the map object currently occupying the slot and the current generation of the slot.
+struct MobjHandleSlot {
+    mobj_t*     pMobj;          // The object referred to by handles with the current generation, or the last object to occupy the slot
+    uint32_t    generation;     // Incremented whenever the object occupying the slot is destroyed, to invalidate handles to it
+    bool        bMobjExists;    // Whether the object occupying the slot is still valid/existing
 };
 
-static std::vector<WeakCount>   gWeakCounts;            // Weak references to various map objects, some of these slots may be unused
-static std::vector<uint32_t>    gFreeWeakCountIdxs;     // Which weak count slots are currently free (by index)
-
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Tells if the specified weak count is still in use
-//------------------------------------------------------------------------------------------------------------------------------------------
-static bool isWeakCountInUse(const WeakCount& weakCount) noexcept {
-    return (weakCount.bMobjExists || (weakCount.count > 0));
-}
+static std::vector<MobjHandleSlot>  gMobjHandleSlots;           // Handle slots for various map objects, some of these slots may be unused
+static std::vector<uint32_t>        gFreeMobjHandleSlotIdxs;    // Which handle slots are currently free (by index)
 
 #if ASSERTS_ENABLED
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Debug helper: checks to see if any weak counts are still in use
+// Debug helper: checks to see if any handle slots are still occupied by existing map objects
 //------------------------------------------------------------------------------------------------------------------------------------------
-static bool areWeakCountsInUse() noexcept {
-    for (const WeakCount& weakCount : gWeakCounts) {
-        if (isWeakCountInUse(weakCount))
+static bool areMobjHandleSlotsInUse() noexcept {
+    for (const MobjHandleSlot& slot : gMobjHandleSlots) {
+        if (slot.bMobjExists)
             return true;
     }
 
@@ -39,150 +32,116 @@ static bool areWeakCountsInUse() noexcept {
 #endif  // #if ASSERTS_ENABLED
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Allocates a weak count for the specified map object which is assumed to not already have one and returns it by index.
-// The count is not initialized.
+// Allocates a handle slot for the specified map object which is assumed to not already have one and returns it by index.
+// The generation of a reused slot is preserved, so that older handles to the slot remain invalid.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static uint32_t allocWeakCount([[maybe_unused]] mobj_t& mobj) noexcept {
-    // Object must not already have a count allocated
-    ASSERT(mobj.weakCountIdx == MobjWeakPtr::NULL_WEAK_COUNT_IDX);
-
-    // Is there a free count we can use?
-    if (!gFreeWeakCountIdxs.empty()) {
-        const uint32_t idx = gFreeWeakCountIdxs.back();
-        gFreeWeakCountIdxs.pop_back();
-        return idx;
+static uint32_t allocMobjHandleSlot(mobj_t& mobj) noexcept {
+    // Object must not already have a slot allocated
+    ASSERT(mobj.weakSlotIdx == MobjWeakPtr::NULL_SLOT_IDX);
+
+    // Is there a free slot we can use? If there's no free slot then alloc a new one
+    uint32_t slotIdx;
+
+    if (!gFreeMobjHandleSlotIdxs.empty()) {
+        slotIdx = gFreeMobjHandleSlotIdxs.back();
+        gFreeMobjHandleSlotIdxs.pop_back();
+    } else {
+        slotIdx = (uint32_t) gMobjHandleSlots.size();
+        gMobjHandleSlots.emplace_back();
     }
 
-    // If there's no free count then alloc a new one
-    const uint32_t idx = (uint32_t) gWeakCounts.size();
-    gWeakCounts.emplace_back();
-    return idx;
+    MobjHandleSlot& slot = gMobjHandleSlots[slotIdx];
+    slot.pMobj = &mobj;
+    slot.bMobjExists = true;
+    return slotIdx;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the weak reference system: should be called on level setup, prior to creating map objects
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_InitWeakRefs() noexcept {
-    ASSERT(gWeakCounts.empty());
-    ASSERT(gFreeWeakCountIdxs.empty());
-    gWeakCounts.reserve(2048);
-    gWeakCounts.resize(1);              // The first index is unused (the null weak count index)
-    gFreeWeakCountIdxs.reserve(1024);
+    ASSERT(gMobjHandleSlots.empty());
+    ASSERT(gFreeMobjHandleSlotIdxs.empty());
+    gMobjHandleSlots.reserve(2048);
+    gMobjHandleSlots.resize(1);             // The first index is unused (the null slot index)
+    gFreeMobjHandleSlotIdxs.reserve(1024);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Shuts down the weak reference system: should be called on level teardown
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_ShutdownWeakRefs() noexcept {
-    ASSERT_LOG(!areWeakCountsInUse(), "There should be no weak references to objects on shutting down this system!");
-    gWeakCounts.clear();
-    gFreeWeakCountIdxs.clear();
+    ASSERT_LOG(!areMobjHandleSlotsInUse(), "All map objects should be destroyed before shutting down this system!");
+    gMobjHandleSlots.clear();
+    gFreeMobjHandleSlotIdxs.clear();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Adds a weak reference to the specified map object and returns the index of the weak count used to keep track of it.
-// If the object is a null pointer returns 'MobjWeakPtr::NULL_WEAK_COUNT_IDX'.
+// Gets a handle to the specified map object, allocating a handle slot for it if it doesn't already have one.
+// If the object is a null pointer returns a null handle.
 //------------------------------------------------------------------------------------------------------------------------------------------
-uint32_t P_AddWeakRef(mobj_t* const pMobj) noexcept {
-    // Adding a reference to a null object?
+MobjHandle P_GetMobjHandle(mobj_t* const pMobj) noexcept {
+    // Getting a handle to a null object?
     if (!pMobj)
-        return MobjWeakPtr::NULL_WEAK_COUNT_IDX;
+        return { MobjWeakPtr::NULL_SLOT_IDX, 0 };
 
-    // Does the count already exist? If so then just increment that:
-    const uint32_t curCountIdx = pMobj->weakCountIdx;
+    // Allocate a slot if the object doesn't already have one
+    uint32_t slotIdx = pMobj->weakSlotIdx;
 
-    if (curCountIdx != MobjWeakPtr::NULL_WEAK_COUNT_IDX) {
-        ASSERT(curCountIdx < gWeakCounts.size());
-        WeakCount& weakCount = gWeakCounts[curCountIdx];
-        weakCount.count++;
-        return curCountIdx;
+    if (slotIdx == MobjWeakPtr::NULL_SLOT_IDX) {
+        slotIdx = allocMobjHandleSlot(*pMobj);
+        pMobj->weakSlotIdx = slotIdx;
     }
 
-    // If there's no count then make a new one and populate it with a single weak reference
-    const uint32_t newCountIdx = allocWeakCount(*pMobj);
-
-    WeakCount& weakCount = gWeakCounts[newCountIdx];
-    weakCount = {};
-    weakCount.count = 1;
-    weakCount.bMobjExists = true;
-    weakCount.pMobj = pMobj;
-
-    // Assign the map object it's count and return which count is being used
-    pMobj->weakCountIdx = newCountIdx;
-    return newCountIdx;
-}
-
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Adds an extra weak reference to the specified weak count (unless it's the null count index)
-//------------------------------------------------------------------------------------------------------------------------------------------
-void P_AddWeakRef(const uint32_t weakCountIdx) noexcept {
-    if (weakCountIdx == MobjWeakPtr::NULL_WEAK_COUNT_IDX)
-        return;
-
-    ASSERT(weakCountIdx < gWeakCounts.size());
-    WeakCount& weakCount = gWeakCounts[weakCountIdx];
-    weakCount.count++;
-}
-
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Removes a weak reference to the specified weak count (unless it's the null count index)
-//------------------------------------------------------------------------------------------------------------------------------------------
-void P_RemoveWeakRef(const uint32_t weakCountIdx) noexcept {
-    if (weakCountIdx == MobjWeakPtr::NULL_WEAK_COUNT_IDX)
-        return;
-
-    ASSERT(weakCountIdx < gWeakCounts.size());
-    WeakCount& weakCount = gWeakCounts[weakCountIdx];
-    ASSERT(weakCount.count > 0);
-    weakCount.count--;
-
-    // If the weak count is no longer in use then free it
-    if (!isWeakCountInUse(weakCount)) {
-        gFreeWeakCountIdxs.push_back(weakCountIdx);
-    }
+    ASSERT(slotIdx < gMobjHandleSlots.size());
+    return { slotIdx, gMobjHandleSlots[slotIdx].generation };
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Return the pointer to a weakly referenced map object
 //------------------------------------------------------------------------------------------------------------------------------------------
-mobj_t* P_WeakDeref(const uint32_t weakCountIdx) noexcept {
-    if (weakCountIdx == MobjWeakPtr::NULL_WEAK_COUNT_IDX)
+mobj_t* P_WeakDeref(const MobjHandle handle) noexcept {
+    if (handle.slotIdx == MobjWeakPtr::NULL_SLOT_IDX)
         return nullptr;
 
-    ASSERT(weakCountIdx < gWeakCounts.size());
-    WeakCount& weakCount = gWeakCounts[weakCountIdx];
+    ASSERT(handle.slotIdx < gMobjHandleSlots.size());
+    const MobjHandleSlot& slot = gMobjHandleSlots[handle.slotIdx];
 
-    if (weakCount.bMobjExists) {
-        return weakCount.pMobj;
+    if (slot.generation == handle.generation) {
+        return slot.pMobj;
     } else {
         #if PSYDOOM_FIX_UB
             return nullptr;
         #else
             ASSERT_FAIL("Undefined behavior! Referencing a map object that has been destroyed!");
-            return weakCount.pMobj;
+            return slot.pMobj;
         #endif
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Informs the weak reference system that the specified map object is being destroyed.
-// Causes all weak references to the object to be nulled.
+// Causes all weak references to the object to be nulled, and frees up it's handle slot for immediate reuse.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_WeakReferencedDestroyed(mobj_t& mobj) noexcept {
-    // If there's no weak count we can just stop here
-    const uint32_t weakCountIdx = mobj.weakCountIdx;
+    // If there's no handle slot we can just stop here
+    const uint32_t slotIdx = mobj.weakSlotIdx;
 
-    if (weakCountIdx == MobjWeakPtr::NULL_WEAK_COUNT_IDX)
+    if (slotIdx == MobjWeakPtr::NULL_SLOT_IDX)
         return;
 
-    // Otherwise mark the object destroyed and free up the weak count if it's no longer used
-    ASSERT(weakCountIdx < gWeakCounts.size());
-    WeakCount& weakCount = gWeakCounts[weakCountIdx];
-    ASSERT_LOG(weakCount.bMobjExists, "The map object weakly referenced should only be destroyed once!");
-    weakCount.bMobjExists = false;
-
-    if (weakCount.count <= 0) {
-        gFreeWeakCountIdxs.push_back(weakCountIdx);
-    }
+    // Otherwise mark the object destroyed and invalidate all handles to it
+    ASSERT(slotIdx < gMobjHandleSlots.size());
+    MobjHandleSlot& slot = gMobjHandleSlots[slotIdx];
+    ASSERT_LOG(slot.bMobjExists, "The map object weakly referenced should only be destroyed once!");
+    slot.generation++;
+    slot.bMobjExists = false;
+    mobj.weakSlotIdx = MobjWeakPtr::NULL_SLOT_IDX;
+
+    // If not fixing undefined behavior then keep the slot (and the pointer to the destroyed object) around for the rest of the level.
+    // This allows stale weak pointers to behave like raw pointers, as they did originally.
+    #if PSYDOOM_FIX_UB
+        gFreeMobjHandleSlotIdxs.push_back(slotIdx);
+    #endif
 }
 #endif  // #if PSYDOOM_MODS
@@ -79,7 +79,7 @@ void R_DrawSubsectorFlat(leaf_t& leaf, const bool bIsCeiling) noexcept {
 
             #if PSYDOOM_LIMIT_REMOVING
                 gTmpBuffer.ensureSize(getDecodedSize(pCompressedLumpData));
-                decode(pCompressedLumpData, gTmpBuffer.bytes());
+                decode(pCompressedLumpData, gTmpBuffer.bytes(), gTmpBuffer.size());
                 pLumpData = gTmpBuffer.bytes();
             #else
                 // PsyDoom: check for buffer overflows and issue an error if we exceed the limits
@@ -39,7 +39,7 @@ static void R_UploadWallTexToVram(texture_t& tex) noexcept {
             pTexData = (const std::byte*) pLumpData;
         } else {
             gTmpBuffer.ensureSize(texLump.uncompressedSize);
-            decode(pLumpData, gTmpBuffer.bytes());
+            decode(pLumpData, gTmpBuffer.bytes(), gTmpBuffer.size());
             pTexData = gTmpBuffer.bytes();
         }
     #else
@@ -141,7 +141,7 @@ void RV_UploadDirtyTex(texture_t& tex) noexcept {
 
         #if PSYDOOM_LIMIT_REMOVING
             gTmpBuffer.ensureSize(getDecodedSize(pCompressedLumpData));
-            decode(pCompressedLumpData, gTmpBuffer.bytes());
+            decode(pCompressedLumpData, gTmpBuffer.bytes(), gTmpBuffer.size());
             pLumpData = gTmpBuffer.bytes();
         #else
             if (getDecodedSize(pCompressedLumpData) > TMP_BUFFER_SIZE) {
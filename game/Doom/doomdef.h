@@ -238,6 +238,9 @@ struct mobj_t {
     uint32_t        frame;              // Current sprite frame displayed. Must use 'FF_FRAMEMASK' to get the actual frame number.
     mobj_t*         bnext;              // Linked list of things in this blockmap block
     mobj_t*         bprev;
+#if PSYDOOM_MODS
+    int32_t         bcell;              // PsyDoom: '1 + index' of the blockmap cell holding this thing's compact blockmap entry, or '0' if none
+#endif
     fixed_t         floorz;             // Highest floor in contact with map object
     fixed_t         ceilingz;           // Lowest ceiling in contact with map object
     fixed_t         radius;             // For collision detection
@@ -272,7 +275,7 @@ struct mobj_t {
 // These objects can sometimes get destroyed without references to them being cleared.
 #if PSYDOOM_MODS
     MobjWeakPtr     tracer;             // Used by homing missiles
-    uint32_t        weakCountIdx;       // PsyDoom: index of the weak reference counter allocated for this map object ('0' if there are no weak references to it)
+    uint32_t        weakSlotIdx;        // PsyDoom: index of the weak reference handle slot allocated for this map object ('0' if there are no weak references to it)
 #else
     mobj_t*         tracer;             // Used by homing missiles
 #endif
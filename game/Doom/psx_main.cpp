@@ -3,18 +3,24 @@
 #include "Base/i_main.h"
 #include "cdmaptbl.h"
 #include "FatalErrors.h"
+#include "PsyDoom/AsyncIo.h"
 #include "PsyDoom/Cheats.h"
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Controls.h"
+#include "PsyDoom/DiscReader.h"
+#include "PsyDoom/DiskCache.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/Input.h"
 #include "PsyDoom/IntroLogos.h"
+#include "PsyDoom/MapPrefetcher.h"
 #include "PsyDoom/ModMgr.h"
 #include "PsyDoom/PlayerPrefs.h"
 #include "PsyDoom/ProgArgs.h"
 #include "PsyDoom/PsxVm.h"
 #include "PsyDoom/Utils.h"
 #include "PsyDoom/Video.h"
+#include "PsyDoom/WorkerPool.h"
+#include "Wess/psxcd.h"
 
 #if PSYDOOM_MODS
     // PsyDoom: a flag set to 'true' if the result of demo playback is unexpected/wrong (when checking demo results).
@@ -84,11 +90,13 @@ int psx_main(const int argc, const char* const* const argv) noexcept {
         Game::determineGameTypeAndVariant();
         CdMapTbl_Init();
 
-        // Initialize the display, modding manager, cheats and intro logos
+        // Initialize the display, modding manager, cheats, intro logos, worker threads and I/O threads
         Video::initVideo();
         ModMgr::init();
         Cheats::init();
         IntroLogos::init();
+        WorkerPool::init();
+        AsyncIo::init();
     #endif
 
     // Call the original PSX Doom 'main()' function
@@ -102,8 +110,17 @@ int psx_main(const int argc, const char* const* const argv) noexcept {
             PlayerPrefs::save();
         }
 
+        if (ProgArgs::gbPrintDiscStats) {
+            DiscReader::printTotalStats();
+        }
+
+        MapPrefetcher::shutdown();
+        AsyncIo::shutdown();
+        DiskCache::shutdown();
+        WorkerPool::shutdown();
         IntroLogos::shutdown();
         Video::shutdownVideo();
+        psxcd_exit();
         PsxVm::shutdown();
         Cheats::shutdown();
         ModMgr::shutdown();
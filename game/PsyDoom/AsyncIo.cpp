@@ -0,0 +1,409 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Asynchronous file I/O for game files: reads are submitted to a small pool of I/O threads and completion is waited on via a token.
+// This allows loaders to issue all of the reads they need up front, do other work while the data is being read and then wait once.
+//
+// The location of a game file (game disc vs an overriden file on disk) is resolved on the main thread when a read is submitted.
+// I/O threads then only read from their own file handles and disc readers, and never touch 'psxcd' or any other engine state.
+//
+// Whole files can also be 'preloaded': read in the background into a buffer owned by this module, and later taken by whatever loads them.
+// Loaders must still be able to read a file normally, since it might not have been preloaded or the preload might have failed.
+// Preloads which are discarded before they are taken are cancelled, so that discarding never has to wait for large files to be read.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "AsyncIo.h"
+
+#include "Asserts.h"
+#include "Doom/cdmaptbl.h"
+#include "DiscReader.h"
+#include "FileUtils.h"
+#include "Finally.h"
+#include "ModMgr.h"
+#include "PsxVm.h"
+#include "Wess/psxcd.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+BEGIN_NAMESPACE(AsyncIo)
+
+// How many I/O threads to use.
+// Reads are mostly limited by storage rather than CPU, so only a couple are needed to keep requests in flight.
+static constexpr uint32_t NUM_IO_THREADS = 2;
+
+// Files bigger than this are not preloaded, to avoid holding onto large amounts of memory
+static constexpr int32_t MAX_PRELOAD_FILE_SIZE = 64 * 1024 * 1024;
+
+// Reads are done in chunks of this size, with a check for the read being cancelled before each chunk
+static constexpr int32_t READ_CHUNK_SIZE = 1024 * 1024;
+
+// A read which has been submitted
+struct Request {
+    Token           token;
+    FileSource      source;
+    int32_t         offset;
+    int32_t         size;
+    std::byte*      pDst;
+};
+
+// A file which has been preloaded or is being preloaded
+struct PreloadedFile {
+    CdFileId                fileId;
+    Token                   token;
+    std::vector<std::byte>  data;
+};
+
+// The state of a submitted read
+enum class RequestStatus : uint8_t {
+    Pending,
+    Succeeded,
+    Failed
+};
+
+static std::vector<std::thread>                     gThreads;           // The I/O threads
+static std::mutex                                   gMutex;             // Guards the request queue and request status
+static std::condition_variable                      gRequestCond;       // Signalled when a request is submitted or when shutting down
+static std::condition_variable                      gCompletionCond;    // Signalled when a request is completed
+static std::deque<Request>                          gRequestQueue;      // Reads which have not yet been picked up by an I/O thread
+static std::unordered_map<Token, RequestStatus>     gRequestStatus;     // Status of all reads which have not been waited on yet
+static std::unordered_set<Token>                    gCancelledReads;    // Reads in progress on an I/O thread which should be abandoned
+static Token                                        gNextToken;         // Token to assign to the next read
+static bool                                         gbShutdown;         // Set when the I/O threads should exit
+
+// Files being preloaded: only accessed from the main thread.
+// Note: heap allocated so that the data buffer never moves while a read into it is in progress.
+static std::vector<std::unique_ptr<PreloadedFile>>  gPreloadedFiles;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the specified read has been cancelled
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isReadCancelled(const Token token) noexcept {
+    std::lock_guard<std::mutex> lock(gMutex);
+    return (gCancelledReads.count(token) > 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Performs the given read using the specified disc reader (if reading from the game disc); returns 'true' on success.
+// The read is done in chunks and is abandoned (failing) if it is cancelled part way through.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool doRead(const Request& request, DiscReader& discReader) noexcept {
+    const FileSource& source = request.source;
+    FILE* pFile = nullptr;
+
+    auto closeFileOnExit = finally([&]() noexcept {
+        if (pFile) {
+            std::fclose(pFile);
+        }
+    });
+
+    // Seek to the start of the data to be read
+    if (!source.filePath.empty()) {
+        pFile = std::fopen(source.filePath.c_str(), "rb");
+
+        if ((!pFile) || (std::fseek(pFile, request.offset, SEEK_SET) != 0))
+            return false;
+    } else {
+        if ((!discReader.setTrackNum(1)) || (!discReader.trackSeekAbs(source.discStartSector * CDROM_SECTOR_SIZE + request.offset)))
+            return false;
+    }
+
+    // Read all of the data, one chunk at a time
+    for (int32_t bytesRead = 0; bytesRead < request.size;) {
+        if (isReadCancelled(request.token))
+            return false;
+
+        const int32_t chunkSize = std::min(request.size - bytesRead, READ_CHUNK_SIZE);
+        std::byte* const pChunkDst = request.pDst + bytesRead;
+
+        if (pFile) {
+            if (std::fread(pChunkDst, (size_t) chunkSize, 1, pFile) != 1)
+                return false;
+        } else {
+            if (!discReader.read(pChunkDst, chunkSize))
+                return false;
+        }
+
+        bytesRead += chunkSize;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates a token for a new read; the mutex must be locked when calling this
+//------------------------------------------------------------------------------------------------------------------------------------------
+static Token allocToken() noexcept {
+    if (gNextToken == INVALID_TOKEN) {
+        gNextToken++;
+    }
+
+    return gNextToken++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Marks the given request as completed and wakes up anything waiting on it
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void completeRequest(const Token token, const bool bSucceeded) noexcept {
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        gRequestStatus[token] = (bSucceeded) ? RequestStatus::Succeeded : RequestStatus::Failed;
+        gCancelledReads.erase(token);
+    }
+
+    gCompletionCond.notify_all();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Cancels the specified read, which then completes as failed.
+// If the read has not yet been picked up by an I/O thread then it is dropped from the queue, otherwise it is abandoned at the next chunk.
+// The token must still be waited on afterwards.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void cancelRead(const Token token) noexcept {
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        const auto statusIter = gRequestStatus.find(token);
+
+        if ((statusIter == gRequestStatus.end()) || (statusIter->second != RequestStatus::Pending))
+            return;
+
+        const auto requestIter = std::find_if(
+            gRequestQueue.begin(),
+            gRequestQueue.end(),
+            [=](const Request& request) noexcept { return (request.token == token); }
+        );
+
+        if (requestIter == gRequestQueue.end()) {
+            gCancelledReads.insert(token);
+            return;
+        }
+
+        gRequestQueue.erase(requestIter);
+        statusIter->second = RequestStatus::Failed;
+    }
+
+    gCompletionCond.notify_all();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for an I/O thread: services reads until shutdown.
+// Each thread has its own disc reader, so sector caching and file positions are independent of all other threads.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void ioThreadMain() noexcept {
+    DiscReader discReader(PsxVm::gDiscInfo);
+
+    while (true) {
+        Request request;
+
+        {
+            std::unique_lock<std::mutex> lock(gMutex);
+            gRequestCond.wait(lock, []() noexcept { return (gbShutdown || (!gRequestQueue.empty())); });
+
+            if (gRequestQueue.empty())
+                break;
+
+            request = std::move(gRequestQueue.front());
+            gRequestQueue.pop_front();
+        }
+
+        completeRequest(request.token, doRead(request, discReader));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts up the I/O threads.
+// Note: the game disc must be setup before this is called, since the threads read from it.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init() noexcept {
+    ASSERT(gThreads.empty());
+    gbShutdown = false;
+    gNextToken = 1;
+
+    for (uint32_t i = 0; i < NUM_IO_THREADS; ++i) {
+        gThreads.emplace_back(ioThreadMain);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Cancels and frees all preloaded files, waits for all other outstanding reads to finish and stops the I/O threads
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    discardPreloadedFiles();
+
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        gbShutdown = true;
+    }
+
+    gRequestCond.notify_all();
+
+    for (std::thread& thread : gThreads) {
+        thread.join();
+    }
+
+    gThreads.clear();
+    gRequestQueue.clear();
+    gRequestStatus.clear();
+    gCancelledReads.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Figures out where the data for the specified game file can be read from and returns 'false' if the file does not exist.
+// Note: overrides are checked first, same as 'psxcd_open'. This must only be called from the main thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool getFileSource(const CdFileId fileId, FileSource& sourceOut) noexcept {
+    sourceOut = {};
+
+    if (ModMgr::areOverridesAvailableForFile(fileId)) {
+        sourceOut.filePath = ModMgr::getOverridenFilePath(fileId);
+        const int64_t fileSize = FileUtils::getFileSize(sourceOut.filePath.c_str());
+
+        if ((fileSize < 0) || (fileSize > INT32_MAX))
+            return false;
+
+        sourceOut.size = (int32_t) fileSize;
+    } else {
+        const PsxCd_MapTblEntry fileTableEntry = CdMapTbl_GetEntry(fileId);
+
+        if ((fileTableEntry == PsxCd_MapTblEntry{}) || (fileTableEntry.size < 0))
+            return false;
+
+        sourceOut.discStartSector = fileTableEntry.startSector;
+        sourceOut.size = fileTableEntry.size;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Submits a read of the given number of bytes at the specified offset in the file to the given buffer.
+// The buffer must remain valid until the read is waited on. Every token returned must eventually be waited on.
+// If the I/O threads are not running then the read is done immediately on the calling thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+Token submitRead(const FileSource& source, const int32_t offset, const int32_t size, void* const pDst) noexcept {
+    ASSERT(pDst || (size == 0));
+
+    Request request = {};
+    request.source = source;
+    request.offset = offset;
+    request.size = size;
+    request.pDst = (std::byte*) pDst;
+
+    // Reads which are out of bounds fail immediately and empty reads always succeed.
+    // If there are no I/O threads then also do the read immediately.
+    const bool bValidRead = ((offset >= 0) && (size >= 0) && ((int64_t) offset + size <= source.size));
+    const bool bReadNow = ((!bValidRead) || (size == 0) || gThreads.empty());
+
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        request.token = allocToken();
+        gRequestStatus[request.token] = RequestStatus::Pending;
+
+        if (!bReadNow) {
+            gRequestQueue.push_back(request);
+        }
+    }
+
+    if (bReadNow) {
+        bool bSucceeded = bValidRead;
+
+        if (bValidRead && (size > 0)) {
+            DiscReader discReader(PsxVm::gDiscInfo);
+            bSucceeded = doRead(request, discReader);
+        }
+
+        completeRequest(request.token, bSucceeded);
+    } else {
+        gRequestCond.notify_one();
+    }
+
+    return request.token;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits for the specified read to complete and returns 'true' if it succeeded.
+// Once waited on, the token is no longer valid.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool wait(const Token token) noexcept {
+    if (token == INVALID_TOKEN)
+        return false;
+
+    // Note: have to lookup the status again after each wakeup, since other threads may have modified the map (invalidating iterators)
+    std::unique_lock<std::mutex> lock(gMutex);
+
+    if (gRequestStatus.count(token) == 0)
+        return false;
+
+    gCompletionCond.wait(lock, [&]() noexcept { return (gRequestStatus[token] != RequestStatus::Pending); });
+    const bool bSucceeded = (gRequestStatus[token] == RequestStatus::Succeeded);
+    gRequestStatus.erase(token);
+    return bSucceeded;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins reading the entire specified game file into memory in the background, unless it is already preloaded or being preloaded.
+// Does nothing if the file does not exist or is too big to preload.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void preloadFile(const CdFileId fileId) noexcept {
+    for (const std::unique_ptr<PreloadedFile>& pFile : gPreloadedFiles) {
+        if (pFile->fileId == fileId)
+            return;
+    }
+
+    FileSource source;
+
+    if ((!getFileSource(fileId, source)) || (source.size <= 0) || (source.size > MAX_PRELOAD_FILE_SIZE))
+        return;
+
+    std::unique_ptr<PreloadedFile>& pFile = gPreloadedFiles.emplace_back(std::make_unique<PreloadedFile>());
+    pFile->fileId = fileId;
+    pFile->data.resize((size_t) source.size);
+    pFile->token = submitRead(source, 0, source.size, pFile->data.data());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Takes the data for the specified preloaded file, waiting for the read to finish if required, and returns 'true' on success.
+// Returns 'false' if the file was not preloaded or if the preload failed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool takePreloadedFile(const CdFileId fileId, std::vector<std::byte>& fileDataOut) noexcept {
+    for (auto fileIter = gPreloadedFiles.begin(); fileIter != gPreloadedFiles.end(); ++fileIter) {
+        PreloadedFile& file = **fileIter;
+
+        if (file.fileId != fileId)
+            continue;
+
+        const bool bReadOk = wait(file.token);
+
+        if (bReadOk) {
+            fileDataOut = std::move(file.data);
+        }
+
+        gPreloadedFiles.erase(fileIter);
+        return bReadOk;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees up all preloaded files which were not taken.
+// Preloads which have not finished are cancelled; this only has to wait for reads in progress to reach the end of their current chunk.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void discardPreloadedFiles() noexcept {
+    for (const std::unique_ptr<PreloadedFile>& pFile : gPreloadedFiles) {
+        cancelRead(pFile->token);
+    }
+
+    for (const std::unique_ptr<PreloadedFile>& pFile : gPreloadedFiles) {
+        wait(pFile->token);
+    }
+
+    gPreloadedFiles.clear();
+    gPreloadedFiles.shrink_to_fit();
+}
+
+END_NAMESPACE(AsyncIo)
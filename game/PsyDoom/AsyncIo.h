@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct String16;
+typedef String16 CdFileId;
+
+BEGIN_NAMESPACE(AsyncIo)
+
+// Where the data for a file can be read from.
+// This is resolved on the main thread up front so that reads can be done on any thread without touching 'psxcd' or modding state.
+struct FileSource {
+    std::string     filePath;           // If not empty then the data is read from this file on disk, otherwise it is read from the game disc
+    int32_t         discStartSector;    // If the file is on the game disc then this is the sector that it starts at on the data track
+    int32_t         size;               // Size of the file in bytes
+};
+
+// Identifies a read that was submitted, so that it can be waited on
+typedef uint32_t Token;
+static constexpr Token INVALID_TOKEN = 0;
+
+void init() noexcept;
+void shutdown() noexcept;
+bool getFileSource(const CdFileId fileId, FileSource& sourceOut) noexcept;
+Token submitRead(const FileSource& source, const int32_t offset, const int32_t size, void* const pDst) noexcept;
+bool wait(const Token token) noexcept;
+void preloadFile(const CdFileId fileId) noexcept;
+bool takePreloadedFile(const CdFileId fileId, std::vector<std::byte>& fileDataOut) noexcept;
+void discardPreloadedFiles() noexcept;
+
+END_NAMESPACE(AsyncIo)
@@ -4,9 +4,84 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 BEGIN_NAMESPACE(AudioCompressor)
 
+// How many samples 'compressBlock' processes at a time: determines the size of the temporary buffers used on the stack
+static constexpr uint32_t BLOCK_CHUNK_SIZE = 256;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers: reinterpret the bits of a float as an integer and vice versa
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t floatBitsToUint(const float value) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static inline float uintBitsToFloat(const uint32_t bits) noexcept {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Fast approximation of 'log2(x)' for positive, normal (non-denormal) floating point numbers.
+// Splits the number into exponent and mantissa and evaluates a degree 5 polynomial fit of 'log2' over the mantissa range [1, 2).
+// Maximum absolute error is approximately 1.7e-5. Branch free so it can be auto-vectorized by the compiler.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline float fastLog2(const float x) noexcept {
+    const uint32_t bits = floatBitsToUint(x);
+    const float exponent = (float)((int32_t)((bits >> 23) & 0xFF) - 127);
+    const float m = uintBitsToFloat((bits & 0x007FFFFF) | 0x3F800000);
+
+    float poly = +0.043004956f;
+    poly = poly * m - 0.40251338f;
+    poly = poly * m + 1.5894743f;
+    poly = poly * m - 3.4898787f;
+    poly = poly * m + 5.0478554f;
+    poly = poly * m - 2.7879262f;
+    return exponent + poly;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Fast approximation of '2^x' for 'x' in the range [-126, +127].
+// Splits the input into integer and fractional parts and evaluates a degree 4 polynomial fit of '2^x' over the fractional range [0, 1).
+// Maximum relative error is approximately 3.5e-6. Branch free so it can be auto-vectorized by the compiler.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline float fastExp2(const float x) noexcept {
+    const float xFloor = std::floor(x);
+    const float f = x - xFloor;
+
+    float poly = +0.013670309f;
+    poly = poly * f + 0.051744998f;
+    poly = poly * f + 0.24160436f;
+    poly = poly * f + 0.69297290f;
+    poly = poly * f + 1.0000035f;
+
+    const uint32_t scaleBits = (uint32_t)((int32_t) xFloor + 127) << 23;
+    return poly * uintBitsToFloat(scaleBits);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Fast conversion of signal power to decibels (i.e '10 * log10(power)') for the power range used by the compressor (1e-10 to 1e6).
+// The result is accurate to within 'MAX_POWER_TO_DB_ERROR'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+float fastPowerToDB(const float signalPower) noexcept {
+    constexpr float LOG2_TO_DB = 3.0102999566f;     // 10 * log10(2)
+    return fastLog2(signalPower) * LOG2_TO_DB;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Fast conversion of a gain in decibels to a linear gain multiplier (i.e '10^(dB / 20)').
+// The result is accurate to within a relative error of 'MAX_DB_TO_GAIN_REL_ERROR'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+float fastDBToLinearGain(const float gainDB) noexcept {
+    constexpr float DB_TO_LOG2 = 0.1660964047f;     // log2(10) / 20
+    return fastExp2(std::clamp(gainDB * DB_TO_LOG2, -126.0f, 127.0f));
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the audio compressor state with the specified settings.
 //
@@ -53,58 +128,82 @@ void init(
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Perform dynamic range compression on a single audio sample.
-// 
+// Perform dynamic range compression on a block of interleaved stereo samples (in-place).
+//
 // References for this implementation:
 //      https://openaudio.blogspot.com/2017/01/basic-dynamic-range-compressor.html
 //      https://github.com/chipaudette/OpenAudio_ArduinoLibrary/blob/master/AudioEffectCompressor_F32.h
 //      https://github.com/chipaudette/OpenAudio_ArduinoLibrary/blob/81492cc5aca290d95cd6b681729302148cb7e109/AudioEffectCompressor_F32.h
+//
+// The work is split into a series of passes over chunks of samples so that the parts which have no dependency on the previous sample
+// (signal power, dB conversions, applying the gain) can be vectorized by the compiler. Only the low pass filter and the attack/release
+// envelope smoothing must be done sequentially, and those passes are just a few multiply-adds per sample.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void compress(State& state, float& sampleL, float& sampleR) noexcept {
-    // Safety check: recover from input NaN values
-    sampleL = (!std::isnan(sampleL)) ? sampleL : 0.0f;
-    sampleR = (!std::isnan(sampleR)) ? sampleR : 0.0f;
+void compressBlock(State& state, float* const pSamples, const uint32_t numSamples) noexcept {
+    float signalPower[BLOCK_CHUNK_SIZE];
+    float gainDB[BLOCK_CHUNK_SIZE];
 
-    // Compute the instantaneous signal power of the current sample by squaring the signal (Ohm's law).
-    // Take the max power of both channels and clamp to within a reasonable range:
-    const float signalPower = std::min(std::max(sampleL * sampleL, sampleR * sampleR), 1000000.0f);
-
-    // Smooth this power with the previous sample and save as the new smoothed sample.
-    // Note: prevent smoothed signal power from dropping below -100 dBFS to prevent negative infinity when calculating signal power.
     const float lpfLerp = state.lpfLerpFactor;
-    const float smoothedSignalPower = std::max(signalPower * lpfLerp + state.lpfPrevSignalPower * (1.0f - lpfLerp), 1.0e-10f);
-    ASSERT((!std::isnan(smoothedSignalPower)) && (!std::isinf(smoothedSignalPower)));
+    const float thresholdDB = state.thresholdDB;
+    const float kneeWidthDB = state.kneeWidthDB;
+    const float compressionRatio = state.compressionRatio;
+    const float postGainDB = state.postGainDB;
+    const float attackLerp = state.attackLerpFactor;
+    const float releaseLerp = state.releaseLerpFactor;
+    const float invKneeWidthDB = (kneeWidthDB > 0) ? 1.0f / kneeWidthDB : 0.0f;
 
-    state.lpfPrevSignalPower = smoothedSignalPower;
+    for (uint32_t chunkBeg = 0; chunkBeg < numSamples; chunkBeg += BLOCK_CHUNK_SIZE) {
+        const uint32_t chunkSize = std::min(numSamples - chunkBeg, BLOCK_CHUNK_SIZE);
+        float* const pChunk = pSamples + (size_t) chunkBeg * 2;
 
-    // Compute the signal power in decibels.
-    // Note: normally the formula to convert is 'dB = 20 * log10(amplitude)' but we've already squared the signal so instead the multiply is by '10' instead.
-    const float signalPowerDB = std::clamp(10.0f * std::log10(smoothedSignalPower), -100.0f, +100.0f);
-    ASSERT((!std::isnan(signalPowerDB)) && (!std::isinf(signalPowerDB)));
+        // Pass 1: recover from input NaN values and compute the instantaneous signal power (max of both channels, clamped)
+        for (uint32_t i = 0; i < chunkSize; ++i) {
+            const float sampleL = (pChunk[i * 2 + 0] == pChunk[i * 2 + 0]) ? pChunk[i * 2 + 0] : 0.0f;
+            const float sampleR = (pChunk[i * 2 + 1] == pChunk[i * 2 + 1]) ? pChunk[i * 2 + 1] : 0.0f;
+            pChunk[i * 2 + 0] = sampleL;
+            pChunk[i * 2 + 1] = sampleR;
+            signalPower[i] = std::min(std::max(sampleL * sampleL, sampleR * sampleR), 1000000.0f);
+        }
 
-    // Compute the instantaneous/non-smoothed gain in decibels.
-    // Don't allow a positive gain, only negative!
-    const float aboveThresholdDB = signalPowerDB - state.thresholdDB;
-    const float goalAboveThresholdDB = aboveThresholdDB * state.compressionRatio;
-    const float kneeWidthDB = state.kneeWidthDB;
-    const float compressionStrength = std::clamp((kneeWidthDB > 0) ? aboveThresholdDB / kneeWidthDB : 1.0f, 0.0f, 1.0f);
-    ASSERT((!std::isnan(compressionStrength)) && (!std::isinf(compressionStrength)));
-
-    const float smoothedGoalAboveThresholdDB = goalAboveThresholdDB * compressionStrength + (1.0f - compressionStrength) * aboveThresholdDB;
-    const float instantGainDB = std::clamp(smoothedGoalAboveThresholdDB - aboveThresholdDB, -100.0f, 0.0f);
-
-    // Compute the smoothed gain in decibels and save as the new smoothed sample
-    const float prevGainDB = state.prevSampleGainDB;
-    const float gainLerp = (instantGainDB < prevGainDB) ? state.attackLerpFactor : state.releaseLerpFactor;
-    const float smoothedGainDB = instantGainDB * gainLerp + prevGainDB * (1.0f - gainLerp);
-    state.prevSampleGainDB = smoothedGainDB;
-
-    // Convert the gain to linear gain and apply it to the sample.
-    // Also apply the post gain at this point...
-    const float finalGainDB = smoothedGainDB + state.postGainDB;
-    const float linearGain = std::pow(10.0f, finalGainDB * (1.0f / 20.0f));
-    sampleL *= linearGain;
-    sampleR *= linearGain;
+        // Pass 2: low pass filter the signal power (sequential)
+        float lpfPrevSignalPower = state.lpfPrevSignalPower;
+
+        for (uint32_t i = 0; i < chunkSize; ++i) {
+            lpfPrevSignalPower = std::max(signalPower[i] * lpfLerp + lpfPrevSignalPower * (1.0f - lpfLerp), 1.0e-10f);
+            signalPower[i] = lpfPrevSignalPower;
+        }
+
+        state.lpfPrevSignalPower = lpfPrevSignalPower;
+
+        // Pass 3: compute the instantaneous/non-smoothed gain in decibels for each sample; don't allow a positive gain, only negative!
+        for (uint32_t i = 0; i < chunkSize; ++i) {
+            const float signalPowerDB = std::clamp(fastPowerToDB(signalPower[i]), -100.0f, +100.0f);
+            const float aboveThresholdDB = signalPowerDB - thresholdDB;
+            const float goalAboveThresholdDB = aboveThresholdDB * compressionRatio;
+            const float compressionStrength = std::clamp((kneeWidthDB > 0) ? aboveThresholdDB * invKneeWidthDB : 1.0f, 0.0f, 1.0f);
+            const float smoothedGoalAboveThresholdDB = goalAboveThresholdDB * compressionStrength + (1.0f - compressionStrength) * aboveThresholdDB;
+            gainDB[i] = std::clamp(smoothedGoalAboveThresholdDB - aboveThresholdDB, -100.0f, 0.0f);
+        }
+
+        // Pass 4: attack and release envelope smoothing of the gain (sequential)
+        float prevGainDB = state.prevSampleGainDB;
+
+        for (uint32_t i = 0; i < chunkSize; ++i) {
+            const float instantGainDB = gainDB[i];
+            const float gainLerp = (instantGainDB < prevGainDB) ? attackLerp : releaseLerp;
+            prevGainDB = instantGainDB * gainLerp + prevGainDB * (1.0f - gainLerp);
+            gainDB[i] = prevGainDB;
+        }
+
+        state.prevSampleGainDB = prevGainDB;
+
+        // Pass 5: convert the gain to linear gain (including the post gain) and apply it to the samples
+        for (uint32_t i = 0; i < chunkSize; ++i) {
+            const float linearGain = fastDBToLinearGain(gainDB[i] + postGainDB);
+            pChunk[i * 2 + 0] *= linearGain;
+            pChunk[i * 2 + 1] *= linearGain;
+        }
+    }
 }
 
 END_NAMESPACE(AudioCompressor)
@@ -2,8 +2,17 @@
 
 #include "Macros.h"
 
+#include <cstdint>
+
 BEGIN_NAMESPACE(AudioCompressor)
 
+// Accuracy bounds for the fast (polynomial) dB conversions used by 'compressBlock', versus the exact 'log10' and 'pow' based conversions.
+// These are verified for the input ranges used by the compressor by the 'AudioCompressorCheck' tool.
+//  MAX_POWER_TO_DB_ERROR:      Maximum absolute error (in dB) when converting signal power to decibels, for powers in the range used by the compressor.
+//  MAX_DB_TO_GAIN_REL_ERROR:   Maximum relative error when converting a gain in decibels to a linear gain multiplier.
+static constexpr float MAX_POWER_TO_DB_ERROR    = 1.0e-4f;
+static constexpr float MAX_DB_TO_GAIN_REL_ERROR = 1.0e-5f;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Holds settings and state for the audio compressor
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -30,6 +39,8 @@ void init(
     const float releaseTime
 ) noexcept;
 
-void compress(State& state, float& sampleL, float& sampleR) noexcept;
+void compressBlock(State& state, float* const pSamples, const uint32_t numSamples) noexcept;
+float fastPowerToDB(const float signalPower) noexcept;
+float fastDBToLinearGain(const float gainDB) noexcept;
 
 END_NAMESPACE(AudioCompressor)
@@ -0,0 +1,186 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// An on-disk cache of decompressed WAD lumps, stored in the user data folder.
+// Lets compressed lumps be loaded without having to run them through the LZSS decompressor again on subsequent loads and launches.
+//
+// Each cached lump is stored in a file named after the contents of the WAD it came from and the lump index.
+// The file header records the size and checksum of the original compressed data, so stale cache entries are detected and ignored.
+// Cache files are written to a temporary file first and then renamed into place, so a partially written cache file is never read.
+// The cache is purely an optimization: any failure just means the lump is decompressed as normal.
+//
+// The cached lumps for each WAD are stored in a single 'DiskCache' entry (a directory), so the least recently used WADs have all of their
+// cached lumps removed together when the on-disk caches are pruned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "DecompressedLumpCache.h"
+
+#include "DiskCache.h"
+#include "Finally.h"
+#include "ProgArgs.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+BEGIN_NAMESPACE(DecompressedLumpCache)
+
+// Lumps smaller than this are quicker to decompress than to load from the cache
+static constexpr int32_t MIN_CACHED_LUMP_SIZE = 16 * 1024;
+
+// Name of the cache directory within the on-disk caches
+static constexpr const char* const CACHE_NAME = "Lumps";
+
+// Header for a file in the decompressed lump cache, followed by the decompressed lump data
+struct CacheFileHdr {
+    char        fileId[4];                  // Should be 'PDLC'
+    uint32_t    version;                    // Version of the cache file format
+    uint32_t    compressedSize;             // Size of the original compressed data in the WAD
+    uint32_t    uncompressedSize;           // Size of the decompressed data following this header
+    uint64_t    compressedChecksum;         // Checksum of the original compressed data in the WAD
+};
+
+static_assert(sizeof(CacheFileHdr) == 24);
+
+static constexpr char CACHE_FILE_ID[4] = { 'P', 'D', 'L', 'C' };
+static constexpr uint32_t CACHE_FILE_VERSION = 2;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes a fast (non cryptographic) 64-bit checksum of the given data.
+// Processes the data 8 bytes at a time so it is much quicker than decompressing the data.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t getChecksum(const void* const pData, const size_t size) noexcept {
+    const std::byte* pBytes = (const std::byte*) pData;
+    const std::byte* const pEndBytes = pBytes + size;
+    uint64_t checksum = 0xCBF29CE484222325ull ^ size;
+
+    for (; pBytes + 8 <= pEndBytes; pBytes += 8) {
+        uint64_t word;
+        std::memcpy(&word, pBytes, 8);
+        checksum = (checksum ^ word) * 0x100000001B3ull;
+        checksum ^= checksum >> 29;
+    }
+
+    for (; pBytes < pEndBytes; ++pBytes) {
+        checksum = (checksum ^ (uint64_t) *pBytes) * 0x100000001B3ull;
+    }
+
+    return checksum;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the path to the cache file for the specified lump in the given cache directory
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getCacheFilePath(const std::string& cacheDirPath, const int32_t lumpIdx) noexcept {
+    char lumpFileName[32];
+    std::snprintf(lumpFileName, C_ARRAY_SIZE(lumpFileName), "/%d.lmp", lumpIdx);
+    return cacheDirPath + lumpFileName;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a compressed lump with the given decompressed size should be stored in and loaded from the cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool shouldCacheLump(const int32_t uncompressedSize) noexcept {
+    return ((!ProgArgs::gbNoLumpCache) && (uncompressedSize >= MIN_CACHED_LUMP_SIZE));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to read the decompressed data for the specified lump from the cache into the given buffer, which must be big enough to hold it.
+// The original compressed data for the lump must be supplied so the cache entry can be validated against it.
+// Returns 'false' if there is no valid cache entry for the lump, in which case the contents of the output buffer are undefined.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool readLump(
+    const WadContentHash& wadHash,
+    const int32_t lumpIdx,
+    const void* const pCompressedData,
+    const int32_t compressedSize,
+    void* const pDst,
+    const int32_t uncompressedSize
+) noexcept {
+    const std::string cacheDirName = DiskCache::getEntryName(wadHash.md5, "");
+    const std::string cacheDirPath = DiskCache::getEntryPath(CACHE_NAME, cacheDirName);
+    const std::string cacheFilePath = getCacheFilePath(cacheDirPath, lumpIdx);
+    std::FILE* const pFile = std::fopen(cacheFilePath.c_str(), "rb");
+
+    if (!pFile)
+        return false;
+
+    auto closeFile = finally([&]() noexcept {
+        std::fclose(pFile);
+    });
+
+    // Verify the cache file is for this exact lump data.
+    // Note: no need to verify the decompressed data itself, since cache files are never left partially written.
+    // Checksumming only the compressed data makes a cache hit roughly 5x faster than decompressing, versus roughly 3x with both checked.
+    CacheFileHdr hdr = {};
+
+    if (std::fread(&hdr, sizeof(hdr), 1, pFile) != 1)
+        return false;
+
+    const bool bValidHeader = (
+        (std::memcmp(hdr.fileId, CACHE_FILE_ID, sizeof(hdr.fileId)) == 0) &&
+        (hdr.version == CACHE_FILE_VERSION) &&
+        (hdr.compressedSize == (uint32_t) compressedSize) &&
+        (hdr.uncompressedSize == (uint32_t) uncompressedSize) &&
+        (hdr.compressedChecksum == getChecksum(pCompressedData, (size_t) compressedSize))
+    );
+
+    if (!bValidHeader)
+        return false;
+
+    if (std::fread(pDst, (size_t) uncompressedSize, 1, pFile) != 1)
+        return false;
+
+    DiskCache::markEntryUsed(CACHE_NAME, cacheDirName);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the decompressed data for the specified lump to the cache.
+// Failure to save is not an error; the lump will just be decompressed again next time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void writeLump(
+    const WadContentHash& wadHash,
+    const int32_t lumpIdx,
+    const void* const pCompressedData,
+    const int32_t compressedSize,
+    const void* const pDecompressedData,
+    const int32_t uncompressedSize
+) noexcept {
+    CacheFileHdr hdr = {};
+    std::memcpy(hdr.fileId, CACHE_FILE_ID, sizeof(hdr.fileId));
+    hdr.version = CACHE_FILE_VERSION;
+    hdr.compressedSize = (uint32_t) compressedSize;
+    hdr.uncompressedSize = (uint32_t) uncompressedSize;
+    hdr.compressedChecksum = getChecksum(pCompressedData, (size_t) compressedSize);
+
+    const std::string cacheDirName = DiskCache::getEntryName(wadHash.md5, "");
+    const std::string cacheDirPath = DiskCache::getEntryPath(CACHE_NAME, cacheDirName);
+    const std::string cacheFilePath = getCacheFilePath(cacheDirPath, lumpIdx);
+    const std::string tmpFilePath = cacheFilePath + ".tmp";
+    std::error_code errorCode;
+    std::filesystem::create_directories(cacheDirPath, errorCode);
+    DiskCache::markEntryUsed(CACHE_NAME, cacheDirName);
+
+    // Write to a temporary file first and only move it into place if the entire file was written successfully
+    std::FILE* const pFile = std::fopen(tmpFilePath.c_str(), "wb");
+
+    if (!pFile)
+        return;
+
+    const bool bWroteFile = (
+        (std::fwrite(&hdr, sizeof(hdr), 1, pFile) == 1) &&
+        (std::fwrite(pDecompressedData, (size_t) uncompressedSize, 1, pFile) == 1)
+    );
+
+    const bool bClosedFile = (std::fclose(pFile) == 0);
+
+    if (bWroteFile && bClosedFile) {
+        std::filesystem::rename(tmpFilePath, cacheFilePath, errorCode);
+
+        if (!errorCode)
+            return;
+    }
+
+    std::filesystem::remove(tmpFilePath, errorCode);
+}
+
+END_NAMESPACE(DecompressedLumpCache)
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Identifies the contents of a WAD file for the purposes of the decompressed lump cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct WadContentHash {
+    uint8_t md5[16];
+};
+
+BEGIN_NAMESPACE(DecompressedLumpCache)
+
+bool shouldCacheLump(const int32_t uncompressedSize) noexcept;
+
+bool readLump(
+    const WadContentHash& wadHash,
+    const int32_t lumpIdx,
+    const void* const pCompressedData,
+    const int32_t compressedSize,
+    void* const pDst,
+    const int32_t uncompressedSize
+) noexcept;
+
+void writeLump(
+    const WadContentHash& wadHash,
+    const int32_t lumpIdx,
+    const void* const pCompressedData,
+    const int32_t compressedSize,
+    const void* const pDecompressedData,
+    const int32_t uncompressedSize
+) noexcept;
+
+END_NAMESPACE(DecompressedLumpCache)
@@ -8,6 +8,10 @@
 //  (4) The file has been modified since we last checked.
 //  (5) The platform is Windows. This feature is currently not supported on MacOS due to the '<filesystem>'
 //      API not being available until later OS versions.
+//
+// Changes to the map file are detected via the 'FileWatcher', which watches the user data dir, so the filesystem isn't queried every frame.
+// Reloads are debounced, since editors may save a map file in several steps (e.g truncate and write, or write a temp file and rename).
+// If the data dir is not being watched for some reason then this falls back to checking the map file's timestamp on every update.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "DevMapAutoReloader.h"
 
@@ -15,9 +19,12 @@
 #include "Config/Config.h"
 #include "Doom/cdmaptbl.h"
 #include "Doom/Game/g_game.h"
+#include "FileWatcher.h"
 #include "ModMgr.h"
 #include "ProgArgs.h"
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 
 // Is the auto reloader available on this platform?
@@ -31,8 +38,15 @@
 BEGIN_NAMESPACE(DevMapAutoReloader)
 
 #if ENABLE_MAP_AUTO_RELOADER
-    static std::filesystem::path            gMapFilePath;
-    static std::filesystem::file_time_type  gLastMapFileModifiedTime;
+    // How long to wait after the last change to the map file before reloading it
+    static constexpr std::chrono::milliseconds RELOAD_DEBOUNCE_TIME = std::chrono::milliseconds(250);
+
+    static std::filesystem::path                    gMapFilePath;
+    static CdFileId                                 gMapFileId;                 // Uppercased, for case insensitive comparison
+    static std::filesystem::file_time_type          gLastMapFileModifiedTime;
+    static bool                                     gbUsingFileWatcher;         // If 'true' then changes are detected via the file watcher
+    static bool                                     gbMapFileChanged;           // Set by the file watcher when the map file (may have) changed
+    static std::chrono::steady_clock::time_point    gLastMapFileChangeTime;     // When the file watcher last reported a change to the map file
 #endif
 
 #if ENABLE_MAP_AUTO_RELOADER
@@ -47,6 +61,25 @@ static std::filesystem::file_time_type queryMapFileModifiedTime() noexcept {
         return {};
     }
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the given file id uppercased
+//------------------------------------------------------------------------------------------------------------------------------------------
+static CdFileId makeUppercaseFileId(CdFileId fileId) noexcept {
+    std::transform(fileId.chars, fileId.chars + CdFileId::MAX_LEN, fileId.chars, [](char c) noexcept { return (char) ::toupper(c); });
+    return fileId;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Called by the file watcher when a file in the user data dir is added, modified or removed.
+// Note the time of the change if it might be the map file, so the reload can be triggered once the file stops changing.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void onDataDirFileChanged(const char* const fileName) noexcept {
+    if ((!fileName) || (makeUppercaseFileId(fileName) == gMapFileId)) {
+        gbMapFileChanged = true;
+        gLastMapFileChangeTime = std::chrono::steady_clock::now();
+    }
+}
 #endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -73,7 +106,16 @@ void init([[maybe_unused]] const CdFileId mapWadFile) noexcept {
         gMapFilePath.append(mapWadFileName.data());
 
         // Get the current modified timestamp
+        gMapFileId = makeUppercaseFileId(mapWadFile);
         gLastMapFileModifiedTime = queryMapFileModifiedTime();
+
+        // Listen for changes to the map file if the data dir is being watched
+        gbMapFileChanged = false;
+        gbUsingFileWatcher = FileWatcher::isWatching();
+
+        if (gbUsingFileWatcher) {
+            FileWatcher::addListener(onDataDirFileChanged);
+        }
     #endif
 }
 
@@ -83,8 +125,12 @@ void init([[maybe_unused]] const CdFileId mapWadFile) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void shutdown() noexcept {
     #if ENABLE_MAP_AUTO_RELOADER
+        FileWatcher::removeListener(onDataDirFileChanged);
         gMapFilePath.clear();
+        gMapFileId = {};
         gLastMapFileModifiedTime = {};
+        gbUsingFileWatcher = false;
+        gbMapFileChanged = false;
     #endif
 }
 
@@ -98,6 +144,24 @@ void update() noexcept {
         if (gMapFilePath.empty())
             return;
 
+        // If the file watcher stopped watching (e.g because the data dir was moved or deleted) then fallback to checking the map file's
+        // timestamp on every update, once any changes it reported before stopping have been handled.
+        if (gbUsingFileWatcher && (!gbMapFileChanged) && (!FileWatcher::isWatching())) {
+            FileWatcher::removeListener(onDataDirFileChanged);
+            gbUsingFileWatcher = false;
+        }
+
+        // If using the file watcher then only check the map file once it has reported a change and the file has stopped changing
+        if (gbUsingFileWatcher) {
+            if (!gbMapFileChanged)
+                return;
+
+            if (std::chrono::steady_clock::now() - gLastMapFileChangeTime < RELOAD_DEBOUNCE_TIME)
+                return;
+
+            gbMapFileChanged = false;
+        }
+
         // Check for the map file being modified and start an in-place reload of the map if it's changed
         const std::filesystem::file_time_type modifiedTime = queryMapFileModifiedTime();
 
@@ -4,8 +4,60 @@
 #include "DiscInfo.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <cstring>
 
+// How many sectors are held in the sector cache for each disc reader
+static constexpr int32_t NUM_CACHE_SECTORS = 64;
+
+// The minimum and maximum number of sectors to read into the cache on a cache miss.
+// The amount read grows while access is sequential and drops back to the minimum on random access.
+static constexpr int32_t MIN_READ_AHEAD_SECTORS = 2;
+static constexpr int32_t MAX_READ_AHEAD_SECTORS = 32;
+
+// Reads of at least this many whole sectors skip the cache and are read straight into the destination buffer
+static constexpr int32_t MIN_BULK_READ_SECTORS = 8;
+
+// Statistics for all disc readers: these are updated from multiple threads, hence atomic
+static std::atomic<uint64_t> gNumSectorsRequested;
+static std::atomic<uint64_t> gNumSectorCacheHits;
+static std::atomic<uint64_t> gNumFileReads;
+static std::atomic<uint64_t> gNumBytesReadFromFile;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns statistics for reads performed by all disc readers
+//------------------------------------------------------------------------------------------------------------------------------------------
+DiscReader::Stats DiscReader::getTotalStats() noexcept {
+    Stats stats = {};
+    stats.numSectorsRequested = gNumSectorsRequested.load(std::memory_order_relaxed);
+    stats.numSectorCacheHits = gNumSectorCacheHits.load(std::memory_order_relaxed);
+    stats.numFileReads = gNumFileReads.load(std::memory_order_relaxed);
+    stats.numBytesReadFromFile = gNumBytesReadFromFile.load(std::memory_order_relaxed);
+    return stats;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Prints statistics for reads performed by all disc readers to standard out
+//------------------------------------------------------------------------------------------------------------------------------------------
+void DiscReader::printTotalStats() noexcept {
+    const Stats stats = getTotalStats();
+    const double hitRate = (stats.numSectorsRequested > 0) ? (double) stats.numSectorCacheHits * 100.0 / (double) stats.numSectorsRequested : 0.0;
+
+    std::printf("PsyDoom: disc reader stats:\n");
+    std::printf(
+        "  %llu sectors requested, %llu sector cache hits (%.1f%% hit rate)\n",
+        (unsigned long long) stats.numSectorsRequested,
+        (unsigned long long) stats.numSectorCacheHits,
+        hitRate
+    );
+    std::printf(
+        "  %llu file reads, %llu bytes read from disc images\n",
+        (unsigned long long) stats.numFileReads,
+        (unsigned long long) stats.numBytesReadFromFile
+    );
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initialize the disc reader: the reference to the disc info must remain valid for the lifetime of this object
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -14,7 +66,18 @@ DiscReader::DiscReader(const DiscInfo& discInfo) noexcept
     , mpCurTrack(nullptr)
     , mCurTrackIdx(-1)
     , mCurOffset(0)
+    , mCurTrackSize(0)
     , mpOpenFile(nullptr)
+    , mFilePos(-1)
+    , mCacheSectorSize(0)
+    , mReadBufferSize(0)
+    , mCacheUseCounter(0)
+    , mNextReadAheadSectorIdx(-1)
+    , mNumReadAheadSectors(MIN_READ_AHEAD_SECTORS)
+    , mCacheSectorIdxs()
+    , mCacheSectorLastUse()
+    , mCacheData()
+    , mReadBuffer()
 {
 }
 
@@ -54,21 +117,17 @@ bool DiscReader::setTrackNum(int32_t trackNum) noexcept {
 
         if (!mpOpenFile)
             return false;
+
+        mFilePos = 0;
     }
 
     // Success - save the current track number and track!
+    // Sectors cached for the previous track are no longer valid, since sector numbers are relative to the track.
     mpCurTrack = pTrack;
     mCurTrackIdx = trackNum - 1;
-
-    // Seek to where we should be in the track data
-    mCurOffset = -1;
-
-    if (!trackSeekAbs(0)) {
-        closeTrack();
-        return false;
-    }
-
-    // All good if we've got to here
+    mCurOffset = 0;
+    mCurTrackSize = getExactTrackSize(*pTrack);
+    invalidateSectorCache();
     return true;
 }
 
@@ -90,13 +149,17 @@ void DiscReader::closeTrack() noexcept {
         mpOpenFile = nullptr;
     }
 
+    mFilePos = -1;
     mCurOffset = 0;
+    mCurTrackSize = 0;
     mCurTrackIdx = -1;
     mpCurTrack = nullptr;
+    invalidateSectorCache();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Seek to the given absolute data offset in the track's actual payload data
+// Seek to the given absolute data offset in the track's actual payload data.
+// Note: the track file itself is only seeked when data actually needs to be read from it.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool DiscReader::trackSeekAbs(const int32_t offsetAbs) noexcept {
     // Validate that there is a valid open track and that the offset is in range
@@ -105,17 +168,7 @@ bool DiscReader::trackSeekAbs(const int32_t offsetAbs) noexcept {
 
     ASSERT(mpOpenFile);
 
-    if ((offsetAbs < 0) || (offsetAbs > mpCurTrack->trackPayloadSize))
-        return false;
-
-    // If we are already at this offset then there is nothing we need do
-    if (mCurOffset == offsetAbs)
-        return true;
-
-    // Do the seek and save the result if successful
-    const int32_t physicalOffset = dataOffsetToPhysical(offsetAbs);
-
-    if (std::fseek((FILE*) mpOpenFile, physicalOffset, SEEK_SET) != 0)
+    if ((offsetAbs < 0) || (offsetAbs > mCurTrackSize))
         return false;
 
     mCurOffset = offsetAbs;
@@ -133,17 +186,7 @@ bool DiscReader::trackSeekRel(const int32_t offsetRel) noexcept {
     ASSERT(mpOpenFile);
     const int32_t newOffset = mCurOffset + offsetRel;
 
-    if ((newOffset < 0) || (newOffset > mpCurTrack->trackPayloadSize))
-        return false;
-
-    // If we are already at this offset then there is nothing we need do
-    if (mCurOffset == newOffset)
-        return true;
-
-    // Do the seek and save the result if successful
-    const int32_t physicalOffset = dataOffsetToPhysical(newOffset);
-
-    if (std::fseek((FILE*) mpOpenFile, physicalOffset, SEEK_SET) != 0)
+    if ((newOffset < 0) || (newOffset > mCurTrackSize))
         return false;
 
     mCurOffset = newOffset;
@@ -154,13 +197,15 @@ bool DiscReader::trackSeekRel(const int32_t offsetRel) noexcept {
 // Try to read the specified number of bytes into the given buffer.
 // If the read fails for some reason then all bytes are zeroed.
 // If the read succeeds then the current offset in the track is advanced.
+//
+// Runs of whole sectors are read in bulk straight into the output buffer, everything else goes through the sector cache.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool DiscReader::read(void* const pBuffer, const int32_t numBytes) noexcept {
     ASSERT(pBuffer);
     ASSERT(numBytes >= 0);
 
-    // If there is no track open then the read fails
-    if (!mpCurTrack) {
+    // If there is no track open or the read goes past the end of the track then the read fails
+    if ((!mpCurTrack) || (mCurOffset + numBytes > mCurTrackSize)) {
         std::memset(pBuffer, 0, (size_t) numBytes);
         return false;
     }
@@ -172,24 +217,41 @@ bool DiscReader::read(void* const pBuffer, const int32_t numBytes) noexcept {
     int32_t bytesLeft = numBytes;
 
     while (bytesLeft > 0) {
-        // How many bytes are left in this sector? Try and read as much as we can or need from the sector:
-        const int32_t sectorBytesLeft = blockPayloadSize - (mCurOffset % blockPayloadSize);
-        const int32_t thisReadSize = std::min(bytesLeft, sectorBytesLeft);
-
-        if (std::fread(pDstBytes, thisReadSize, 1, (FILE*) mpOpenFile) != 1) {
-            std::memset(pBuffer, 0, (size_t) numBytes);
-            return false;
+        const int32_t sectorIdx = mCurOffset / blockPayloadSize;
+        const int32_t sectorOffset = mCurOffset % blockPayloadSize;
+
+        // If we are at the start of a sector and reading a lot of whole sectors then read them directly
+        if ((sectorOffset == 0) && (bytesLeft >= MIN_BULK_READ_SECTORS * blockPayloadSize)) {
+            const int32_t numSectors = bytesLeft / blockPayloadSize;
+            const int32_t thisReadSize = numSectors * blockPayloadSize;
+            gNumSectorsRequested.fetch_add((uint64_t) numSectors, std::memory_order_relaxed);
+
+            if (!readSectors(sectorIdx, numSectors, pDstBytes)) {
+                std::memset(pBuffer, 0, (size_t) numBytes);
+                return false;
+            }
+
+            mNextReadAheadSectorIdx = sectorIdx + numSectors;
+            mCurOffset += thisReadSize;
+            pDstBytes += thisReadSize;
+            bytesLeft -= thisReadSize;
+            continue;
         }
 
-        // Read succeeded: seek to the next sector if we have consumed all of this sector's bytes
-        bytesLeft -= thisReadSize;
-        pDstBytes += thisReadSize;
+        // Otherwise get the sector from the cache and copy as much as we can or need from it
+        const std::byte* const pSectorData = getCachedSector(sectorIdx);
 
-        // Try to seek past what we just read and issue an error if that fails
-        if (!trackSeekRel(thisReadSize)) {
+        if (!pSectorData) {
             std::memset(pBuffer, 0, (size_t) numBytes);
             return false;
         }
+
+        const int32_t thisReadSize = std::min(bytesLeft, blockPayloadSize - sectorOffset);
+        std::memcpy(pDstBytes, pSectorData + sectorOffset, (size_t) thisReadSize);
+
+        mCurOffset += thisReadSize;
+        pDstBytes += thisReadSize;
+        bytesLeft -= thisReadSize;
     }
 
     return true;
@@ -203,15 +265,199 @@ int32_t DiscReader::tell() const noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Get the actual offset in the current track's file for the given data offset.
-// This offset includes raw CD sector framing and so on, if present.
+// Get the exact size of the actual data in the given track.
+// The track's payload size only counts whole sectors, so this also counts the data in any partial sector at the end of the file.
+// Only the last track in a file can end with a partial sector, since the other tracks end where the next track in the file starts.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t DiscReader::getExactTrackSize(const DiscTrack& track) noexcept {
+    const int32_t fileBytesAfterTrack = track.sourceFileTotalSize - track.fileOffset - track.trackPhysicalSize;
+
+    if ((fileBytesAfterTrack <= 0) || (fileBytesAfterTrack >= track.blockSize))
+        return track.trackPayloadSize;
+
+    const int32_t partialSectorPayloadSize = std::clamp(fileBytesAfterTrack - track.blockPayloadOffset, 0, track.blockPayloadSize);
+    return track.trackPayloadSize + partialSectorPayloadSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the number of sectors in the currently open track, including any partial sector at the end
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t DiscReader::getNumTrackSectors() const noexcept {
+    return (mpCurTrack) ? (mCurTrackSize + mpCurTrack->blockPayloadSize - 1) / mpCurTrack->blockPayloadSize : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates the sector cache and temporary read buffer for the current track, if not already allocated with the right sizes
+//------------------------------------------------------------------------------------------------------------------------------------------
+void DiscReader::allocBuffers() noexcept {
+    ASSERT(mpCurTrack);
+
+    if (mCacheSectorSize != mpCurTrack->blockPayloadSize) {
+        mCacheSectorSize = mpCurTrack->blockPayloadSize;
+        mCacheSectorIdxs = std::make_unique<int32_t[]>(NUM_CACHE_SECTORS);
+        mCacheSectorLastUse = std::make_unique<uint32_t[]>(NUM_CACHE_SECTORS);
+        mCacheData = std::make_unique<std::byte[]>((size_t) NUM_CACHE_SECTORS * mCacheSectorSize);
+        invalidateSectorCache();
+    }
+
+    const int32_t readBufferSize = MAX_READ_AHEAD_SECTORS * mpCurTrack->blockSize;
+
+    if (mReadBufferSize < readBufferSize) {
+        mReadBufferSize = readBufferSize;
+        mReadBuffer = std::make_unique<std::byte[]>((size_t) mReadBufferSize);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the specified run of sectors from the track file in a single read, including the framing (sync, header, error correction etc.)
+// in between sectors. The payload for each sector is located at a multiple of the track's block size in the output buffer, starting at
+// offset '0' for the first sector. If the run includes a partial sector at the end of the file then the missing bytes are zeroed.
+// Returns 'false' on failure.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DiscReader::readRawSectors(const int32_t firstSectorIdx, const int32_t numSectors, std::byte* const pDst) noexcept {
+    ASSERT(mpCurTrack);
+    ASSERT(mpOpenFile);
+    ASSERT((firstSectorIdx >= 0) && (numSectors > 0) && (firstSectorIdx + numSectors <= getNumTrackSectors()));
+
+    // Note: start at the payload of the first sector and end at the end of the payload for the last sector.
+    // Don't need to read any framing outside of that.
+    const DiscTrack& track = *mpCurTrack;
+    const int64_t fileOffset = (int64_t) track.fileOffset + (int64_t) firstSectorIdx * track.blockSize + track.blockPayloadOffset;
+    const size_t fullReadSize = (size_t)(numSectors - 1) * track.blockSize + track.blockPayloadSize;
+    const size_t readSize = (size_t) std::min<int64_t>((int64_t) fullReadSize, (int64_t) track.sourceFileTotalSize - fileOffset);
+    FILE* const pFile = (FILE*) mpOpenFile;
+
+    if (readSize < fullReadSize) {
+        std::memset(pDst + readSize, 0, fullReadSize - readSize);
+    }
+
+    if (mFilePos != fileOffset) {
+        if (std::fseek(pFile, (long) fileOffset, SEEK_SET) != 0) {
+            mFilePos = -1;
+            return false;
+        }
+    }
+
+    if (std::fread(pDst, readSize, 1, pFile) != 1) {
+        mFilePos = -1;
+        return false;
+    }
+
+    mFilePos = fileOffset + (int64_t) readSize;
+    gNumFileReads.fetch_add(1, std::memory_order_relaxed);
+    gNumBytesReadFromFile.fetch_add(readSize, std::memory_order_relaxed);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the payload data for the specified run of sectors into the given buffer, bypassing the sector cache.
+// If the track has no sector framing then the data is read straight into the buffer, otherwise sectors are read in large batches and the
+// framing is stripped out while copying. Returns 'false' on failure.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool DiscReader::readSectors(const int32_t firstSectorIdx, const int32_t numSectors, std::byte* const pDst) noexcept {
+    ASSERT(mpCurTrack);
+    const int32_t blockSize = mpCurTrack->blockSize;
+    const int32_t blockPayloadSize = mpCurTrack->blockPayloadSize;
+
+    if (blockSize == blockPayloadSize)
+        return readRawSectors(firstSectorIdx, numSectors, pDst);
+
+    allocBuffers();
+
+    for (int32_t batchStartIdx = 0; batchStartIdx < numSectors; batchStartIdx += MAX_READ_AHEAD_SECTORS) {
+        const int32_t batchSize = std::min(numSectors - batchStartIdx, MAX_READ_AHEAD_SECTORS);
+
+        if (!readRawSectors(firstSectorIdx + batchStartIdx, batchSize, mReadBuffer.get()))
+            return false;
+
+        std::byte* const pBatchDst = pDst + (size_t) batchStartIdx * blockPayloadSize;
+
+        for (int32_t i = 0; i < batchSize; ++i) {
+            std::memcpy(pBatchDst + (size_t) i * blockPayloadSize, mReadBuffer.get() + (size_t) i * blockSize, (size_t) blockPayloadSize);
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the payload data for the specified sector in the current track, reading it into the sector cache if not already present.
+// On a cache miss the following sectors are also read into the cache and the amount read ahead grows for sequential access patterns.
+// Returns 'nullptr' on failure.
 //------------------------------------------------------------------------------------------------------------------------------------------
-int32_t DiscReader::dataOffsetToPhysical(const int32_t dataOffset) const noexcept {
-    if (mpCurTrack) {
-        const int32_t lba = dataOffset / mpCurTrack->blockPayloadSize;
-        const int32_t payloadOffset = dataOffset % mpCurTrack->blockPayloadSize;
-        return mpCurTrack->fileOffset + lba * mpCurTrack->blockSize + mpCurTrack->blockPayloadOffset + payloadOffset;
+const std::byte* DiscReader::getCachedSector(const int32_t sectorIdx) noexcept {
+    ASSERT(mpCurTrack);
+    allocBuffers();
+
+    gNumSectorsRequested.fetch_add(1, std::memory_order_relaxed);
+    const uint32_t useCounter = ++mCacheUseCounter;
+
+    // Is the sector already cached?
+    for (int32_t slotIdx = 0; slotIdx < NUM_CACHE_SECTORS; ++slotIdx) {
+        if (mCacheSectorIdxs[slotIdx] == sectorIdx) {
+            gNumSectorCacheHits.fetch_add(1, std::memory_order_relaxed);
+            mCacheSectorLastUse[slotIdx] = useCounter;
+            return mCacheData.get() + (size_t) slotIdx * mCacheSectorSize;
+        }
+    }
+
+    // Cache miss: read more sectors ahead of time if the access pattern is sequential, otherwise just do the minimum
+    if (sectorIdx == mNextReadAheadSectorIdx) {
+        mNumReadAheadSectors = std::min(mNumReadAheadSectors * 2, MAX_READ_AHEAD_SECTORS);
     } else {
-        return 0;
+        mNumReadAheadSectors = MIN_READ_AHEAD_SECTORS;
+    }
+
+    const int32_t numSectors = std::min(mNumReadAheadSectors, getNumTrackSectors() - sectorIdx);
+
+    if ((numSectors <= 0) || (!readRawSectors(sectorIdx, numSectors, mReadBuffer.get())))
+        return nullptr;
+
+    mNextReadAheadSectorIdx = sectorIdx + numSectors;
+
+    // Strip the sector framing while copying each sector into the cache.
+    // Replace either the existing copy of the sector (if cached already) or the least recently used sector.
+    const int32_t blockSize = mpCurTrack->blockSize;
+    std::byte* pRequestedSector = nullptr;
+
+    for (int32_t i = 0; i < numSectors; ++i) {
+        const int32_t thisSectorIdx = sectorIdx + i;
+        int32_t destSlotIdx = 0;
+
+        for (int32_t slotIdx = 0; slotIdx < NUM_CACHE_SECTORS; ++slotIdx) {
+            if (mCacheSectorIdxs[slotIdx] == thisSectorIdx) {
+                destSlotIdx = slotIdx;
+                break;
+            }
+
+            if (mCacheSectorLastUse[slotIdx] < mCacheSectorLastUse[destSlotIdx]) {
+                destSlotIdx = slotIdx;
+            }
+        }
+
+        std::byte* const pSlotData = mCacheData.get() + (size_t) destSlotIdx * mCacheSectorSize;
+        std::memcpy(pSlotData, mReadBuffer.get() + (size_t) i * blockSize, (size_t) mCacheSectorSize);
+        mCacheSectorIdxs[destSlotIdx] = thisSectorIdx;
+        mCacheSectorLastUse[destSlotIdx] = useCounter;
+
+        if (i == 0) {
+            pRequestedSector = pSlotData;
+        }
     }
+
+    return pRequestedSector;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Removes all sectors from the sector cache and resets read-ahead
+//------------------------------------------------------------------------------------------------------------------------------------------
+void DiscReader::invalidateSectorCache() noexcept {
+    if (mCacheSectorIdxs) {
+        std::fill_n(mCacheSectorIdxs.get(), NUM_CACHE_SECTORS, -1);
+        std::fill_n(mCacheSectorLastUse.get(), NUM_CACHE_SECTORS, 0u);
+    }
+
+    mCacheUseCounter = 0;
+    mNextReadAheadSectorIdx = -1;
+    mNumReadAheadSectors = MIN_READ_AHEAD_SECTORS;
 }
@@ -3,15 +3,28 @@
 #include "Macros.h"
 
 #include <cstdint>
+#include <memory>
 
 struct DiscInfo;
 struct DiscTrack;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Provides access to the data in CD image
+// Provides access to the data in CD image.
+// Recently read sectors are kept in a small LRU cache and sequential access patterns trigger larger read-ahead from the image file.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class DiscReader {
 public:
+    // Statistics on reads performed by all disc readers
+    struct Stats {
+        uint64_t    numSectorsRequested;        // How many sectors were requested by reads (each partial or full sector counts once)
+        uint64_t    numSectorCacheHits;         // How many of those sector requests were satisfied by the sector cache
+        uint64_t    numFileReads;               // How many reads were issued to the disc image files
+        uint64_t    numBytesReadFromFile;       // How many bytes were read from the disc image files, including sector framing
+    };
+
+    static Stats getTotalStats() noexcept;
+    static void printTotalStats() noexcept;
+
     DiscReader(const DiscInfo& discInfo) noexcept;
     ~DiscReader() noexcept;
 
@@ -28,11 +41,31 @@ public:
     int32_t tell() const noexcept;
 
 private:
-    int32_t dataOffsetToPhysical(const int32_t dataOffset) const noexcept;
+    DiscReader(const DiscReader& other) = delete;
+    DiscReader& operator = (const DiscReader& other) = delete;
+
+    static int32_t getExactTrackSize(const DiscTrack& track) noexcept;
+    int32_t getNumTrackSectors() const noexcept;
+    void allocBuffers() noexcept;
+    bool readRawSectors(const int32_t firstSectorIdx, const int32_t numSectors, std::byte* const pDst) noexcept;
+    bool readSectors(const int32_t firstSectorIdx, const int32_t numSectors, std::byte* const pDst) noexcept;
+    const std::byte* getCachedSector(const int32_t sectorIdx) noexcept;
+    void invalidateSectorCache() noexcept;
 
-    const DiscInfo&     mDiscInfo;      // Information for the disc being read from
-    const DiscTrack*    mpCurTrack;     // Pointer to the current track open for the disc reader
-    int32_t             mCurTrackIdx;   // Current track index in the disc that is open for reading or '-1' if none
-    int32_t             mCurOffset;     // Current byte offset in the actual track data we are at (NOT physical offset in the file)
-    void*               mpOpenFile;     // Handle to the open file for the current track
+    const DiscInfo&                 mDiscInfo;                  // Information for the disc being read from
+    const DiscTrack*                mpCurTrack;                 // Pointer to the current track open for the disc reader
+    int32_t                         mCurTrackIdx;               // Current track index in the disc that is open for reading or '-1' if none
+    int32_t                         mCurOffset;                 // Current byte offset in the actual track data we are at (NOT physical offset in the file)
+    int32_t                         mCurTrackSize;              // Exact size of the actual data in the current track, including any partial sector at the end of the file
+    void*                           mpOpenFile;                 // Handle to the open file for the current track
+    int64_t                         mFilePos;                   // Current position in the open file or '-1' if unknown, used to skip redundant seeks
+    int32_t                         mCacheSectorSize;           // Size of each sector in the sector cache (the track's block payload size) or '0' if not allocated
+    int32_t                         mReadBufferSize;            // Size of the temporary buffer used for raw sector reads
+    uint32_t                        mCacheUseCounter;           // Incremented on each cache access, used to find the least recently used sector
+    int32_t                         mNextReadAheadSectorIdx;    // The sector following the last one read into the cache, used to detect sequential access
+    int32_t                         mNumReadAheadSectors;       // How many sectors to read into the cache on the next cache miss
+    std::unique_ptr<int32_t[]>      mCacheSectorIdxs;           // Which sector is held in each cache slot, or '-1' if the slot is empty
+    std::unique_ptr<uint32_t[]>     mCacheSectorLastUse;        // When each cache slot was last used (value of the use counter)
+    std::unique_ptr<std::byte[]>    mCacheData;                 // The payload data for each cache slot
+    std::unique_ptr<std::byte[]>    mReadBuffer;                // Temporary buffer used for raw sector reads and cache fills
 };
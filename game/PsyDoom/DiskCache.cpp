@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Shared management for the on-disk caches stored in the user data folder (decompressed lumps, processed levels, compiled scripts etc.).
+// Each cache gets it's own directory within the cache root directory, and that directory holds one 'entry' (a file or directory) for each
+// item cached. Entries are usually named after the MD5 hash of whatever data they were built from.
+//
+// All of the caches share a single size limit: on shutdown the least recently used entries across all caches are removed until the total
+// size of the caches is small enough. An entry's modified time is it's last used time, and entries used in the current session are never
+// removed. Nothing is pruned if no cache entries were used during the session, since the caches cannot have grown.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "DiskCache.h"
+
+#include "Utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+BEGIN_NAMESPACE(DiskCache)
+
+// The caches are pruned on shutdown (where possible) so that their combined size is no bigger than this
+static constexpr uint64_t MAX_TOTAL_CACHE_SIZE = 256 * 1024 * 1024;
+
+// The entries which have been used this session, identified by '<cache name>/<entry name>'.
+// Guarded by a lock since cache users are not required to be on the main thread.
+static std::mutex                       gUsedEntriesMutex;
+static std::unordered_set<std::string>  gUsedEntries;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the path to the root directory containing all of the caches
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getCacheRootDirPath() noexcept {
+    std::string path = Utils::getOrCreateUserDataFolder();
+    path += "Cache";
+    return path;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the key used to identify the given cache entry in the set of used entries
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getUsedEntryKey(const std::string& cacheName, const std::string& entryName) noexcept {
+    return cacheName + '/' + entryName;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the path to the directory for the cache with the specified name.
+// Note: the directory is not created by this call.
+//------------------------------------------------------------------------------------------------------------------------------------------
+std::string getCacheDirPath(const char* const cacheName) noexcept {
+    return getCacheRootDirPath() + '/' + cacheName;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the name of the cache entry for the given MD5 hash: the hash in hex followed by the specified extension (which may be empty)
+//------------------------------------------------------------------------------------------------------------------------------------------
+std::string getEntryName(const uint8_t md5[16], const char* const extension) noexcept {
+    std::string name;
+
+    for (int32_t i = 0; i < 16; ++i) {
+        char hexDigits[3];
+        std::snprintf(hexDigits, C_ARRAY_SIZE(hexDigits), "%02x", (uint32_t) md5[i]);
+        name += hexDigits;
+    }
+
+    name += extension;
+    return name;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the path to the entry with the given name in the specified cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+std::string getEntryPath(const char* const cacheName, const std::string& entryName) noexcept {
+    return getCacheDirPath(cacheName) + '/' + entryName;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records that the given cache entry has been used (read or written) this session, so it won't be pruned.
+// The first time this happens in a session the entry's modified time is also updated, since that is what determines eviction order.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void markEntryUsed(const char* const cacheName, const std::string& entryName) noexcept {
+    {
+        std::lock_guard<std::mutex> lock(gUsedEntriesMutex);
+
+        if (!gUsedEntries.insert(getUsedEntryKey(cacheName, entryName)).second)
+            return;
+    }
+
+    std::error_code errorCode;
+    std::filesystem::last_write_time(getEntryPath(cacheName, entryName), std::filesystem::file_time_type::clock::now(), errorCode);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Prunes the caches if they have grown too big.
+// The least recently used entries are removed first and the entries used in this session are always kept.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    std::lock_guard<std::mutex> lock(gUsedEntriesMutex);
+
+    // Ignore if no cache was used
+    if (gUsedEntries.empty())
+        return;
+
+    // Gather up the size and last used time of every entry in every cache.
+    // Note: any errors here just mean that the caches won't be pruned.
+    struct CacheEntry {
+        std::filesystem::path               path;
+        std::filesystem::file_time_type     lastUsedTime;
+        uint64_t                            size;
+        bool                                bUsedThisSession;
+    };
+
+    std::vector<CacheEntry> cacheEntries;
+    uint64_t totalSize = 0;
+
+    try {
+        const std::filesystem::path cacheRootDirPath = getCacheRootDirPath();
+
+        if (std::filesystem::is_directory(cacheRootDirPath)) {
+            for (const std::filesystem::directory_entry& cacheDirEntry : std::filesystem::directory_iterator(cacheRootDirPath)) {
+                if (!cacheDirEntry.is_directory())
+                    continue;
+
+                const std::string cacheName = cacheDirEntry.path().filename().string();
+
+                for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(cacheDirEntry.path())) {
+                    CacheEntry& cacheEntry = cacheEntries.emplace_back();
+                    cacheEntry.path = entry.path();
+                    cacheEntry.lastUsedTime = entry.last_write_time();
+                    cacheEntry.size = 0;
+                    cacheEntry.bUsedThisSession = (gUsedEntries.count(getUsedEntryKey(cacheName, cacheEntry.path.filename().string())) > 0);
+
+                    if (entry.is_directory()) {
+                        for (const std::filesystem::directory_entry& fileEntry : std::filesystem::recursive_directory_iterator(entry.path())) {
+                            if (fileEntry.is_regular_file()) {
+                                cacheEntry.size += fileEntry.file_size();
+                            }
+                        }
+                    }
+                    else if (entry.is_regular_file()) {
+                        cacheEntry.size = entry.file_size();
+                    }
+
+                    totalSize += cacheEntry.size;
+                }
+            }
+        }
+    } catch (...) {
+        cacheEntries.clear();
+        totalSize = 0;
+    }
+
+    gUsedEntries.clear();
+
+    // Remove the least recently used entries until the caches are small enough
+    std::sort(cacheEntries.begin(), cacheEntries.end(), [](const CacheEntry& entry1, const CacheEntry& entry2) noexcept {
+        return (entry1.lastUsedTime < entry2.lastUsedTime);
+    });
+
+    for (const CacheEntry& cacheEntry : cacheEntries) {
+        if (totalSize <= MAX_TOTAL_CACHE_SIZE)
+            break;
+
+        if (cacheEntry.bUsedThisSession)
+            continue;
+
+        std::error_code errorCode;
+        std::filesystem::remove_all(cacheEntry.path, errorCode);
+
+        if (!errorCode) {
+            totalSize -= cacheEntry.size;
+        }
+    }
+}
+
+END_NAMESPACE(DiskCache)
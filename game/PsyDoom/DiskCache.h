@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+#include <string>
+
+BEGIN_NAMESPACE(DiskCache)
+
+std::string getCacheDirPath(const char* const cacheName) noexcept;
+std::string getEntryName(const uint8_t md5[16], const char* const extension) noexcept;
+std::string getEntryPath(const char* const cacheName, const std::string& entryName) noexcept;
+void markEntryUsed(const char* const cacheName, const std::string& entryName) noexcept;
+void shutdown() noexcept;
+
+END_NAMESPACE(DiskCache)
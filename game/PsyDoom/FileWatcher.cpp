@@ -0,0 +1,406 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Watches a single directory (non recursively) for files being added, modified or removed and notifies listeners on the main thread.
+// Used to keep the mod manager's index of overriden files up to date and to tell the dev map auto-reloader when a map file changes,
+// without the game having to repeatedly query the filesystem itself.
+//
+// On Linux the directory is watched using 'inotify', with a background thread blocking until change events arrive.
+// On other platforms (except MacOS) a background thread instead periodically scans the directory, if polling is allowed.
+// MacOS is currently not supported due to the '<filesystem>' API not being available until later OS versions.
+//
+// The background thread only gathers the names of changed files. Listeners are invoked from 'update' on the main thread, which is very
+// cheap to call every frame since it just checks an atomic flag unless there are actually changes to report.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "FileWatcher.h"
+
+#include "Asserts.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#if __linux__
+    #define FILE_WATCHER_USE_INOTIFY 1
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#else
+    #define FILE_WATCHER_USE_INOTIFY 0
+#endif
+
+#if __APPLE__
+    #define FILE_WATCHER_USE_POLLING 0
+#else
+    #define FILE_WATCHER_USE_POLLING 1
+    #include <chrono>
+    #include <condition_variable>
+    #include <filesystem>
+    #include <unordered_map>
+#endif
+
+BEGIN_NAMESPACE(FileWatcher)
+
+#if FILE_WATCHER_USE_POLLING
+    // How often the directory is scanned for changes when polling
+    static constexpr std::chrono::milliseconds POLL_INTERVAL = std::chrono::milliseconds(500);
+#endif
+
+static std::string                      gDirPath;               // The directory being watched
+static std::thread                      gThread;                // Background thread gathering changes
+static std::atomic<bool>                gbShutdownRequested;    // Set when the background thread should exit
+static std::mutex                       gMutex;                 // Guards the pending changes
+static std::unordered_set<std::string>  gChangedFiles;          // Names of files which have changed since the last update
+static bool                             gbChangesMissed;        // Set if some changes might have been missed (e.g due to an event queue overflow)
+static std::atomic<bool>                gbHaveChanges;          // Set when there are changes for 'update' to report
+static std::vector<FileChangedFn>       gListeners;             // Who to notify of changes
+static std::atomic<bool>                gbWatching;             // Cleared if the background thread stops watching (e.g because the directory is gone)
+
+#if FILE_WATCHER_USE_INOTIFY
+    static int  gInotifyFd = -1;                    // The 'inotify' instance
+    static int  gWatchDesc = -1;                    // The 'inotify' watch for the directory
+    static int  gWakePipeFds[2] = { -1, -1 };       // Written to by the main thread to wake the background thread when shutting down
+#endif
+
+#if FILE_WATCHER_USE_POLLING
+    static std::mutex               gPollMutex;     // Used with the condition variable below
+    static std::condition_variable  gPollWakeCond;  // Signalled to wake the polling thread when shutting down
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records that the specified file has changed; a null file name means that some changes might have been missed.
+// Called by the background thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addChange(const char* const fileName) noexcept {
+    std::lock_guard<std::mutex> lock(gMutex);
+
+    if (fileName) {
+        gChangedFiles.emplace(fileName);
+    } else {
+        gbChangesMissed = true;
+    }
+
+    gbHaveChanges.store(true, std::memory_order_release);
+}
+
+#if FILE_WATCHER_USE_INOTIFY
+// What events to watch for on the directory
+static constexpr uint32_t INOTIFY_WATCH_MASK = (
+    IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF
+);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts watching the directory using 'inotify' and returns 'false' on failure
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool initInotify() noexcept {
+    gInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (gInotifyFd < 0)
+        return false;
+
+    gWatchDesc = inotify_add_watch(gInotifyFd, gDirPath.c_str(), INOTIFY_WATCH_MASK);
+    const bool bStarted = ((gWatchDesc >= 0) && (pipe2(gWakePipeFds, O_CLOEXEC) == 0));
+
+    if (!bStarted) {
+        close(gInotifyFd);
+        gInotifyFd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops watching the directory using 'inotify', once the background thread has exited
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void shutdownInotify() noexcept {
+    for (int& fd : gWakePipeFds) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    if (gInotifyFd >= 0) {
+        close(gInotifyFd);
+        gInotifyFd = -1;
+    }
+
+    gWatchDesc = -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the background thread when using 'inotify': blocks until events arrive, then records which files they are for.
+//
+// If the directory is moved then the watch (which follows the directory, not the path) is removed. Once the watch is gone, for that
+// reason or because the directory was deleted, the watch is re-armed on the directory path if something exists there again.
+// Otherwise the thread stops watching, since there is nothing left to watch.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void inotifyThreadMain() noexcept {
+    alignas(inotify_event) char eventsBuffer[16 * 1024];
+    bool bStopWatching = false;
+
+    while ((!bStopWatching) && (!gbShutdownRequested.load(std::memory_order_relaxed))) {
+        pollfd pollFds[2] = {};
+        pollFds[0].fd = gInotifyFd;
+        pollFds[0].events = POLLIN;
+        pollFds[1].fd = gWakePipeFds[0];
+        pollFds[1].events = POLLIN;
+
+        // If waiting fails for any reason other than being interrupted by a signal then it will most likely keep failing.
+        // In that case give up on the watch rather than spinning, and let users of the watcher fall back to checking for changes themselves.
+        if (poll(pollFds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+
+            inotify_rm_watch(gInotifyFd, gWatchDesc);
+            addChange(nullptr);
+            break;
+        }
+
+        if (pollFds[1].revents != 0)
+            break;
+
+        // Read and process all available events
+        while (!bStopWatching) {
+            const ssize_t bytesRead = read(gInotifyFd, eventsBuffer, sizeof(eventsBuffer));
+
+            if (bytesRead <= 0)
+                break;
+
+            for (ssize_t offset = 0; offset < bytesRead;) {
+                const inotify_event& event = *(const inotify_event*)(eventsBuffer + offset);
+                offset += (ssize_t) sizeof(inotify_event) + event.len;
+
+                // Ignore events for any watch other than the current one (e.g for a watch that was just replaced)
+                if ((event.wd != gWatchDesc) && (!(event.mask & IN_Q_OVERFLOW)))
+                    continue;
+
+                if (event.mask & IN_MOVE_SELF) {
+                    // Directory moved: stop watching it at its new location and (on getting 'IN_IGNORED') try to re-arm on the path
+                    inotify_rm_watch(gInotifyFd, gWatchDesc);
+                    addChange(nullptr);
+                }
+                else if (event.mask & IN_IGNORED) {
+                    // The watch is gone: try to re-arm it, otherwise stop
+                    gWatchDesc = inotify_add_watch(gInotifyFd, gDirPath.c_str(), INOTIFY_WATCH_MASK);
+                    bStopWatching = (gWatchDesc < 0);
+                    addChange(nullptr);
+                }
+                else if (event.mask & (IN_Q_OVERFLOW | IN_DELETE_SELF)) {
+                    // Events were dropped or the directory was deleted: anything might have changed
+                    addChange(nullptr);
+                }
+                else if ((event.len > 0) && event.name[0]) {
+                    addChange(event.name);
+                }
+            }
+        }
+    }
+
+    gbWatching = false;
+}
+#endif  // #if FILE_WATCHER_USE_INOTIFY
+
+#if FILE_WATCHER_USE_POLLING
+// Details for a file seen while polling, used to detect changes
+struct PolledFileInfo {
+    std::filesystem::file_time_type     modifiedTime;
+    uintmax_t                           size;
+
+    bool operator == (const PolledFileInfo& other) const noexcept {
+        return ((modifiedTime == other.modifiedTime) && (size == other.size));
+    }
+};
+
+typedef std::unordered_map<std::string, PolledFileInfo> PolledFiles;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Scans the watched directory and returns the details for all files in it.
+// If the directory cannot be scanned then it is treated as being empty.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static PolledFiles scanDirectory() noexcept {
+    PolledFiles files;
+
+    try {
+        for (const std::filesystem::directory_entry& dirEntry : std::filesystem::directory_iterator(gDirPath)) {
+            std::error_code errorCode;
+            PolledFileInfo fileInfo = {};
+            fileInfo.modifiedTime = dirEntry.last_write_time(errorCode);
+            fileInfo.size = (dirEntry.is_regular_file(errorCode)) ? dirEntry.file_size(errorCode) : 0;
+            files[dirEntry.path().filename().u8string()] = fileInfo;
+        }
+    }
+    catch (...) {
+        files.clear();
+    }
+
+    return files;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the background thread when polling: periodically scans the directory and records which files have changed.
+// The initial state of the directory is scanned before the thread starts, so that no changes made after initialization are missed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void pollingThreadMain(PolledFiles prevFiles) noexcept {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(gPollMutex);
+            gPollWakeCond.wait_for(lock, POLL_INTERVAL, []() noexcept { return gbShutdownRequested.load(); });
+        }
+
+        if (gbShutdownRequested)
+            break;
+
+        // Report files which were added, modified or removed since the last scan
+        PolledFiles curFiles = scanDirectory();
+
+        for (const auto& [fileName, fileInfo] : curFiles) {
+            const auto prevFileIter = prevFiles.find(fileName);
+
+            if ((prevFileIter == prevFiles.end()) || (!(prevFileIter->second == fileInfo))) {
+                addChange(fileName.c_str());
+            }
+        }
+
+        for (const auto& [fileName, fileInfo] : prevFiles) {
+            if (curFiles.count(fileName) == 0) {
+                addChange(fileName.c_str());
+            }
+        }
+
+        prevFiles = std::move(curFiles);
+    }
+}
+#endif  // #if FILE_WATCHER_USE_POLLING
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts watching the specified directory for changes.
+// If native change notifications are not available then the directory is periodically scanned instead, but only if polling is allowed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init([[maybe_unused]] const char* const dirPath, [[maybe_unused]] const bool bAllowPolling) noexcept {
+    ASSERT(dirPath);
+    shutdown();
+
+    gDirPath = dirPath;
+    gbShutdownRequested = false;
+
+    #if FILE_WATCHER_USE_INOTIFY
+        if (initInotify()) {
+            gbWatching = true;
+            gThread = std::thread(inotifyThreadMain);
+            return;
+        }
+    #endif
+
+    #if FILE_WATCHER_USE_POLLING
+        if (bAllowPolling) {
+            gbWatching = true;
+            gThread = std::thread(pollingThreadMain, scanDirectory());
+            return;
+        }
+    #endif
+
+    gDirPath.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops watching the current directory (if any) and discards all unreported changes.
+// Note: listeners are NOT removed, they are expected to remove themselves.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    if (gThread.joinable()) {
+        gbShutdownRequested = true;
+
+        #if FILE_WATCHER_USE_INOTIFY
+            if (gWakePipeFds[1] >= 0) {
+                const char wakeByte = 0;
+                [[maybe_unused]] const ssize_t bytesWritten = write(gWakePipeFds[1], &wakeByte, 1);
+            }
+        #endif
+
+        #if FILE_WATCHER_USE_POLLING
+            {
+                std::lock_guard<std::mutex> lock(gPollMutex);
+                gPollWakeCond.notify_all();
+            }
+        #endif
+
+        gThread.join();
+    }
+
+    #if FILE_WATCHER_USE_INOTIFY
+        shutdownInotify();
+    #endif
+
+    gbWatching = false;
+    gDirPath.clear();
+    gChangedFiles.clear();
+    gbChangesMissed = false;
+    gbHaveChanges = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a directory is currently being watched.
+// Note that watching may stop by itself, for example if the directory is deleted or moved and nothing replaces it.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isWatching() noexcept {
+    return gbWatching.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Notifies listeners of any changes gathered since the last update: should be called periodically on the main thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+void update() noexcept {
+    if (!gbHaveChanges.load(std::memory_order_acquire))
+        return;
+
+    // Grab the list of changes
+    std::unordered_set<std::string> changedFiles;
+    bool bChangesMissed;
+
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        changedFiles.swap(gChangedFiles);
+        bChangesMissed = gbChangesMissed;
+        gbChangesMissed = false;
+        gbHaveChanges = false;
+    }
+
+    // Notify all listeners: note that a copy of the listener list is used in case listeners add or remove themselves
+    const std::vector<FileChangedFn> listeners = gListeners;
+
+    for (const FileChangedFn listener : listeners) {
+        if (bChangesMissed) {
+            listener(nullptr);
+        }
+
+        for (const std::string& fileName : changedFiles) {
+            listener(fileName.c_str());
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds a listener to be notified of file changes, if not already added
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addListener(const FileChangedFn listener) noexcept {
+    ASSERT(listener);
+
+    if (std::find(gListeners.begin(), gListeners.end(), listener) == gListeners.end()) {
+        gListeners.push_back(listener);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Removes a listener which was previously added
+//------------------------------------------------------------------------------------------------------------------------------------------
+void removeListener(const FileChangedFn listener) noexcept {
+    gListeners.erase(std::remove(gListeners.begin(), gListeners.end(), listener), gListeners.end());
+}
+
+END_NAMESPACE(FileWatcher)
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Macros.h"
+
+BEGIN_NAMESPACE(FileWatcher)
+
+// Called on the main thread when the specified file in the watched directory may have been added, modified or removed.
+// If the file name is null then some changes may have been missed, and any file in the directory should be assumed to have changed.
+typedef void (*FileChangedFn)(const char* const fileName) noexcept;
+
+void init(const char* const dirPath, const bool bAllowPolling) noexcept;
+void shutdown() noexcept;
+bool isWatching() noexcept;
+void update() noexcept;
+void addListener(const FileChangedFn listener) noexcept;
+void removeListener(const FileChangedFn listener) noexcept;
+
+END_NAMESPACE(FileWatcher)
@@ -6,6 +6,7 @@
 #include "DiscReader.h"
 #include "Endian.h"
 
+#include <cctype>
 #include <cstring>
 #include <queue>
 
@@ -149,6 +150,32 @@ static bool isPathSeparator(const char c) noexcept {
     return ((c == '\\') || (c == '/'));
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: skips past any leading root separators ('/', '\\' or './') in the given path, in the same way as the directory walk does
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const char* skipRootSeparators(const char* path) noexcept {
+    while (true) {
+        if ((path[0] == '.') && isPathSeparator(path[1])) {
+            path += 2;
+        } else if (isPathSeparator(path[0])) {
+            path += 1;
+        } else {
+            return path;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: adds a character to a case folded hash of a path (64-bit FNV-1a).
+// Characters are upper cased and all path separators are treated as '/'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t addToPathHash(const uint64_t hash, const char c) noexcept {
+    const char foldedChar = (isPathSeparator(c)) ? '/' : (char) std::toupper(c);
+    return (hash ^ (uint8_t) foldedChar) * 0x100000001B3ull;
+}
+
+static constexpr uint64_t PATH_HASH_INIT = 0xCBF29CE484222325ull;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sets up the file system and disc reader for the process of reading files and directories.
 // Reads the volume descriptor for the filesystem and creates the root filesystem entry.
@@ -159,6 +186,7 @@ static bool initFileSystemForReading(IsoFileSys& fs, std::queue<DirToRead>& dirs
     fs.logicalBlockSize = 0;
     fs.entries.clear();
     fs.entries.reserve(2048);
+    fs.pathIndex.clear();
 
     // Make sure the disc is open on the data track (01)
     if (!discReader.setTrackNum(1))
@@ -319,23 +347,21 @@ static bool readFileSystemDir(IsoFileSys& fs, std::queue<DirToRead>& dirsToRead,
     ASSERT(dir.parentDirIndex < fs.entries.size());
     fs.entries[dir.parentDirIndex].firstChildIdx = (uint16_t) fs.entries.size();
 
-    // Seek to where the records for this directory are located
+    // Read all the sectors of filesystem entries for this directory in one go
     if (!discReader.trackSeekAbs(dir.lba * fs.logicalBlockSize))
         return false;
 
-    // Read all the sectors of filesystem entries for this directory
-    DirReaderContext dirReaderCtx = { fs, dir, dirsToRead, dir.xaRecordSize, 0 };
+    std::vector<std::byte> dirData(dir.size);
 
-    for (uint32_t sectorsLeft = dir.size / fs.logicalBlockSize; sectorsLeft > 0; --sectorsLeft) {
-        // Get the raw sector bytes first
-        std::byte sectorData[IsoFileSys::MAX_LOGICAL_BLOCK_SIZE];
+    if (!discReader.read(dirData.data(), (int32_t) dir.size))
+        return false;
 
-        if (!discReader.read(sectorData, fs.logicalBlockSize))
-            return false;
+    // Read filesystem entries from each sector
+    DirReaderContext dirReaderCtx = { fs, dir, dirsToRead, dir.xaRecordSize, 0 };
 
-        // Read filesystem entries from this sector
+    for (uint32_t sectorOffset = 0; sectorOffset < dir.size; sectorOffset += fs.logicalBlockSize) {
         try {
-            ByteInputStream byteStream(sectorData, fs.logicalBlockSize);
+            ByteInputStream byteStream(dirData.data() + sectorOffset, fs.logicalBlockSize);
             readFSDirSector(dirReaderCtx, byteStream);
         } catch (...) {
             return false;
@@ -362,15 +388,123 @@ bool IsoFileSys::build(DiscReader& discReader) noexcept {
             return false;
     }
 
+    // Build the index used to quickly lookup entries by path
+    buildPathIndex();
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the index used to lookup file system entries by their full path (case insensitive) relative to the root of the filesystem.
+// Paths are hashed in the form 'DIR/SUBDIR/FILE.EXT'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void IsoFileSys::buildPathIndex() noexcept {
+    pathIndex.clear();
+
+    if (entries.empty())
+        return;
+
+    // Note: parent entries are always read before their children, so the hash for the parent's path will always be available
+    std::vector<uint64_t> entryPathHashes(entries.size());
+    entryPathHashes[0] = PATH_HASH_INIT;
+    pathIndex.reserve(entries.size());
+
+    for (uint32_t entryIdx = 1; entryIdx < entries.size(); ++entryIdx) {
+        const IsoFileSysEntry& entry = entries[entryIdx];
+        ASSERT(entry.parentIdx < entryIdx);
+        uint64_t pathHash = entryPathHashes[entry.parentIdx];
+
+        if (entry.parentIdx != 0) {
+            pathHash = addToPathHash(pathHash, '/');
+        }
+
+        for (uint32_t charIdx = 0; charIdx < entry.nameLen; ++charIdx) {
+            pathHash = addToPathHash(pathHash, entry.name[charIdx]);
+        }
+
+        entryPathHashes[entryIdx] = pathHash;
+        pathIndex.emplace(pathHash, (int32_t) entryIdx);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: tells if the specified file system entry has the given full path, case insensitive.
+// The path must not have any leading separators. Used to verify that a path index lookup is not a hash collision.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool doesEntryHavePath(const IsoFileSys& fs, int32_t entryIdx, const char* const path, const int32_t pathLen) noexcept {
+    int32_t pathEnd = pathLen;
+
+    while (entryIdx != 0) {
+        // Match the name of this entry against the end of the path
+        const IsoFileSysEntry& entry = fs.entries[entryIdx];
+        const int32_t nameStart = pathEnd - entry.nameLen;
+
+        if (nameStart < 0)
+            return false;
+
+        for (int32_t charIdx = 0; charIdx < entry.nameLen; ++charIdx) {
+            if (std::toupper(entry.name[charIdx]) != std::toupper(path[nameStart + charIdx]))
+                return false;
+        }
+
+        // Move onto the parent: expect a separator before the name unless the parent is the root
+        entryIdx = entry.parentIdx;
+
+        if (entryIdx != 0) {
+            if ((nameStart < 1) || (!isPathSeparator(path[nameStart - 1])))
+                return false;
+
+            pathEnd = nameStart - 1;
+        } else {
+            pathEnd = nameStart;
+        }
+    }
+
+    return (pathEnd == 0);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Lookup the index of the file system entry for the given path (case insensitive), relative to the root of the filesystem.
 // Returns '-1' if the file system entry is not found.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t IsoFileSys::getEntryIndex(const char* const path) const noexcept {
-    return (!entries.empty()) ? getEntryIndex(entries[0], path) : -1;
+    if (entries.empty())
+        return -1;
+
+    // If there is no path index (filesystem not built via 'build') then just walk the directory tree
+    if (pathIndex.empty())
+        return getEntryIndex(entries[0], path);
+
+    // Hash the path and look it up in the path index.
+    // While doing that check for empty or '.' path components, which the directory walk allows but which are not in the path index.
+    const char* const pathStart = skipRootSeparators(path);
+    uint64_t pathHash = PATH_HASH_INIT;
+    bool bIsCanonicalPath = true;
+    int32_t pathLen = 0;
+
+    for (; pathStart[pathLen] != 0; ++pathLen) {
+        const char c = pathStart[pathLen];
+
+        if (isPathSeparator(c)) {
+            const char prevChar = (pathLen > 0) ? pathStart[pathLen - 1] : 0;
+            const char prevPrevChar = (pathLen > 1) ? pathStart[pathLen - 2] : 0;
+            const bool bEmptyComponent = isPathSeparator(prevChar);
+            const bool bDotComponent = ((prevChar == '.') && ((pathLen == 1) || isPathSeparator(prevPrevChar)));
+            bIsCanonicalPath &= ((!bEmptyComponent) && (!bDotComponent));
+        }
+
+        pathHash = addToPathHash(pathHash, c);
+    }
+
+    if (const auto indexIter = pathIndex.find(pathHash); indexIter != pathIndex.end()) {
+        if (doesEntryHavePath(*this, indexIter->second, pathStart, pathLen))
+            return indexIter->second;
+
+        bIsCanonicalPath = false;   // Hash collision (extremely unlikely): fallback to walking the directory tree to be safe
+    }
+
+    // Not in the path index: if the path is in canonical form then the entry definitely does not exist.
+    // Otherwise fallback to walking the directory tree, since the path might still resolve to an entry.
+    return (bIsCanonicalPath) ? -1 : getEntryIndex(entries[0], path);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -3,6 +3,7 @@
 #include "Macros.h"
 
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 class DiscReader;
@@ -32,10 +33,12 @@ struct IsoFileSys {
     static constexpr uint32_t MIN_LOGICAL_BLOCK_SIZE = 2048;    // Minimum allowed logical sector size
     static constexpr uint32_t MAX_LOGICAL_BLOCK_SIZE = 2352;    // Maximum allowed logical sector size
 
-    uint32_t                        logicalBlockSize;   // Size of a logical sector for the CD-ROM's data track: normally 2,048 bytes
-    std::vector<IsoFileSysEntry>    entries;            // All the entries in the file system: the root entry is the first
+    uint32_t                                logicalBlockSize;   // Size of a logical sector for the CD-ROM's data track: normally 2,048 bytes
+    std::vector<IsoFileSysEntry>            entries;            // All the entries in the file system: the root entry is the first
+    std::unordered_map<uint64_t, int32_t>   pathIndex;          // Maps from the hash of a case folded full path to the index of the entry for it
 
     bool build(DiscReader& discReader) noexcept;
+    void buildPathIndex() noexcept;
     int32_t getEntryIndex(const char* const path) const noexcept;
     int32_t getEntryIndex(const IsoFileSysEntry& root, const char* const path) const noexcept;
     const IsoFileSysEntry* getEntry(const char* const path) const noexcept;
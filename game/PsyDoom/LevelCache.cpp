@@ -0,0 +1,533 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A cache of fully processed level geometry, stored in the user data folder.
+// After a map's lumps have been converted to their runtime format and grouped (sector line lists, bounding boxes, reject matrix etc.) a
+// relocatable snapshot of all the level data is saved. On subsequent loads of the same map the snapshot is read back with a single bulk read
+// and only a quick pass to fix up pointers is required, instead of processing all of the map lumps again.
+//
+// Pointers within the snapshot are stored as 1-based indexes into the array they point into, with '0' meaning null.
+// Cache files are named after a key which identifies the map data, engine version and main WAD lumps the level was processed with.
+// A cache file that is missing, stale or fails validation is simply ignored and the level is built from it's lumps instead.
+// Each level is a single 'DiskCache' entry and is subject to the size limit shared by all of the on-disk caches.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "LevelCache.h"
+
+#include "Doom/Base/w_wad.h"
+#include "Doom/Base/z_zone.h"
+#include "Doom/Game/p_setup.h"
+#include "Doom/Renderer/r_data.h"
+#include "Doom/Renderer/r_local.h"
+#include "DiskCache.h"
+#include "Endian.h"
+#include "FileUtils.h"
+#include "Finally.h"
+#include "MapHash.h"
+#include "ProgArgs.h"
+#include "Utils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <md5.h>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(LevelCache)
+
+// Version of the cache file format.
+// Must be bumped whenever the runtime map data structures or the processing done to build them from the map lumps changes.
+static constexpr uint32_t CACHE_FILE_VERSION = 1;
+
+// Sanity limit for the number of elements in any of the cached level data arrays
+static constexpr int32_t MAX_ARRAY_SIZE = 0x1000000;
+
+// Name of the cache directory within the on-disk caches
+static constexpr const char* const CACHE_NAME = "Levels";
+
+// Header for a file in the level cache, followed by the level data
+struct CacheFileHdr {
+    char        fileId[4];                  // Should be 'PDLV'
+    uint32_t    version;                    // Version of the cache file format
+    uint8_t     key[16];                    // The key for the level which this data is for
+    int32_t     numVertexes;
+    int32_t     numSectors;
+    int32_t     numSides;
+    int32_t     numLines;
+    int32_t     numSubsectors;
+    int32_t     numBspNodes;
+    int32_t     numSegs;
+    int32_t     numLeafEdges;
+    int32_t     numLineRefs;                // Total number of line references in all sector line lists
+    int32_t     blockmapLumpSize;           // Size of the blockmap lump in bytes (including header)
+    int32_t     rejectMatrixSize;           // Size of the reject matrix in bytes
+    int32_t     blockmapWidth;
+    int32_t     blockmapHeight;
+    fixed_t     blockmapOriginX;
+    fixed_t     blockmapOriginY;
+    int32_t     skyTexIdx;                  // Index of the sky texture or '-1' if the level has no sky
+    uint32_t    dataSize;                   // Size of the level data following this header
+    uint8_t     dataMd5[16];                // MD5 hash of the level data, to detect corrupted cache files
+    char        levelStartupWarning[64];    // Any warning issued while processing the map lumps
+};
+
+static constexpr char CACHE_FILE_ID[4] = { 'P', 'D', 'L', 'V' };
+
+// Where each array of level data is located in the cached data
+struct DataLayout {
+    size_t  vertexesOffset;
+    size_t  sectorsOffset;
+    size_t  sidesOffset;
+    size_t  linesOffset;
+    size_t  subsectorsOffset;
+    size_t  bspNodesOffset;
+    size_t  segsOffset;
+    size_t  leafEdgesOffset;
+    size_t  lineRefsOffset;
+    size_t  blockmapLumpOffset;
+    size_t  rejectMatrixOffset;
+    size_t  totalSize;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Figures out where each array of level data goes in the cached data, given the array sizes in the header.
+// Each array is 8-byte aligned, which is the alignment the zone memory allocator provides.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static DataLayout getDataLayout(const CacheFileHdr& hdr) noexcept {
+    size_t offset = 0;
+
+    const auto addArray = [&](const int32_t count, const size_t elemSize) noexcept {
+        const size_t arrayOffset = offset;
+        offset += (size_t) count * elemSize;
+        offset = (offset + 7) & ~(size_t) 7;
+        return arrayOffset;
+    };
+
+    DataLayout layout = {};
+    layout.vertexesOffset = addArray(hdr.numVertexes, sizeof(vertex_t));
+    layout.sectorsOffset = addArray(hdr.numSectors, sizeof(sector_t));
+    layout.sidesOffset = addArray(hdr.numSides, sizeof(side_t));
+    layout.linesOffset = addArray(hdr.numLines, sizeof(line_t));
+    layout.subsectorsOffset = addArray(hdr.numSubsectors, sizeof(subsector_t));
+    layout.bspNodesOffset = addArray(hdr.numBspNodes, sizeof(node_t));
+    layout.segsOffset = addArray(hdr.numSegs, sizeof(seg_t));
+    layout.leafEdgesOffset = addArray(hdr.numLeafEdges, sizeof(leafedge_t));
+    layout.lineRefsOffset = addArray(hdr.numLineRefs, sizeof(line_t*));
+    layout.blockmapLumpOffset = addArray(hdr.blockmapLumpSize, 1);
+    layout.rejectMatrixOffset = addArray(hdr.rejectMatrixSize, 1);
+    layout.totalSize = offset;
+    return layout;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a pointer into an array to a 1-based index stored in place of the pointer (or '0' for null).
+// Returns 'false' if the pointer does not point into the array.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class T>
+static bool encodePtr(T*& pDst, const T* const pSrc, const T* const pArray, const int32_t arraySize) noexcept {
+    if (!pSrc) {
+        pDst = nullptr;
+        return true;
+    }
+
+    const uintptr_t byteOffset = (uintptr_t) pSrc - (uintptr_t) pArray;
+    const uintptr_t idx = byteOffset / sizeof(T);
+
+    if ((byteOffset % sizeof(T) != 0) || (idx >= (uintptr_t) arraySize))
+        return false;
+
+    pDst = reinterpret_cast<T*>(idx + 1);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a 1-based index stored by 'encodePtr' back into a pointer into the given array.
+// Returns 'false' if the index is out of range for the array.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class T>
+static bool decodePtr(T*& ptr, T* const pArray, const int32_t arraySize) noexcept {
+    const uintptr_t idxPlus1 = reinterpret_cast<uintptr_t>(ptr);
+
+    if (idxPlus1 == 0)
+        return true;
+
+    if (idxPlus1 > (uintptr_t) arraySize)
+        return false;
+
+    ptr = pArray + (idxPlus1 - 1);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the level cache should be used
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isEnabled() noexcept {
+    return (!ProgArgs::gbNoLevelCache);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes the level cache key for the map currently being loaded.
+// Must be called after all of the map lumps relating to level geometry have been added to the map hash, and before any others.
+//------------------------------------------------------------------------------------------------------------------------------------------
+Key makeKey(const bool bFinalDoomMapFormat) noexcept {
+    MD5 md5Hasher;
+
+    // The map geometry lumps and the format they are in
+    uint8_t mapDataMd5[16] = {};
+    MapHash::getCurrentHash(mapDataMd5);
+    md5Hasher.add(mapDataMd5, sizeof(mapDataMd5));
+    md5Hasher.add(&bFinalDoomMapFormat, sizeof(bFinalDoomMapFormat));
+
+    // The engine version and the layout of the runtime map data structures
+    const char* const gameVersionStr = Utils::getGameVersionString();
+    md5Hasher.add(gameVersionStr, std::strlen(gameVersionStr));
+
+    const uint32_t layoutInfo[] = {
+        CACHE_FILE_VERSION,
+        (uint32_t) Endian::isLittle(),
+        (uint32_t) sizeof(void*),
+        (uint32_t) sizeof(vertex_t),
+        (uint32_t) sizeof(sector_t),
+        (uint32_t) sizeof(side_t),
+        (uint32_t) sizeof(line_t),
+        (uint32_t) sizeof(subsector_t),
+        (uint32_t) sizeof(node_t),
+        (uint32_t) sizeof(seg_t),
+        (uint32_t) sizeof(leafedge_t),
+    };
+
+    md5Hasher.add(layoutInfo, sizeof(layoutInfo));
+
+    // Sides and sectors reference textures and flats by number, and these numbers depend on the lumps in the main WAD list (including user WADs)
+    const int32_t numLumps = W_NumLumps();
+    const int32_t texInfo[] = { gNumTexLumps, gNumFlatLumps, numLumps };
+    md5Hasher.add(texInfo, sizeof(texInfo));
+
+    for (int32_t lumpIdx = 0; lumpIdx < numLumps; ++lumpIdx) {
+        const WadLumpName lumpName = W_GetLumpName(lumpIdx);
+        md5Hasher.add(&lumpName, sizeof(lumpName));
+    }
+
+    Key key = {};
+    md5Hasher.getHash(key.md5);
+    return key;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to load the processed level data for the level with the specified key from the cache.
+// On success all of the map data globals (vertexes, sectors, lines, blockmap etc.) are setup, with the exception of the blockmap links.
+// Returns 'false' if there is no valid cache entry for the level, in which case nothing is changed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool load(const Key& key) noexcept {
+    const std::string cacheFileName = DiskCache::getEntryName(key.md5, ".lvl");
+    const std::string cacheFilePath = DiskCache::getEntryPath(CACHE_NAME, cacheFileName);
+    std::FILE* const pFile = std::fopen(cacheFilePath.c_str(), "rb");
+
+    if (!pFile)
+        return false;
+
+    auto closeFile = finally([&]() noexcept {
+        std::fclose(pFile);
+    });
+
+    // Verify the cache file is for this exact level and has sensible array sizes
+    CacheFileHdr hdr = {};
+
+    if (std::fread(&hdr, sizeof(hdr), 1, pFile) != 1)
+        return false;
+
+    const auto isValidSize = [](const int32_t size) noexcept {
+        return ((size >= 0) && (size <= MAX_ARRAY_SIZE));
+    };
+
+    const bool bValidHeader = (
+        (std::memcmp(hdr.fileId, CACHE_FILE_ID, sizeof(hdr.fileId)) == 0) &&
+        (hdr.version == CACHE_FILE_VERSION) &&
+        (std::memcmp(hdr.key, key.md5, sizeof(hdr.key)) == 0) &&
+        isValidSize(hdr.numVertexes) &&
+        isValidSize(hdr.numSectors) &&
+        isValidSize(hdr.numSides) &&
+        isValidSize(hdr.numLines) &&
+        isValidSize(hdr.numSubsectors) &&
+        isValidSize(hdr.numBspNodes) &&
+        isValidSize(hdr.numSegs) &&
+        isValidSize(hdr.numLeafEdges) &&
+        isValidSize(hdr.numLineRefs) &&
+        isValidSize(hdr.blockmapLumpSize) &&
+        isValidSize(hdr.rejectMatrixSize) &&
+        (hdr.blockmapLumpSize >= 8) &&
+        (hdr.rejectMatrixSize >= ((int64_t) hdr.numSectors * hdr.numSectors + 7) / 8) &&
+        (hdr.skyTexIdx >= -1) &&
+        (hdr.skyTexIdx < gNumTexLumps)
+    );
+
+    if (!bValidHeader)
+        return false;
+
+    const DataLayout layout = getDataLayout(hdr);
+
+    if ((layout.totalSize != hdr.dataSize) || (layout.totalSize > INT32_MAX))
+        return false;
+
+    // Read all of the level data in one go, straight into the memory block which will hold it for the duration of the level
+    std::byte* const pData = (std::byte*) Z_Malloc(*gpMainMemZone, (int32_t) layout.totalSize, PU_LEVEL, nullptr);
+    bool bLoadedOk = false;
+
+    auto freeDataOnFailure = finally([&]() noexcept {
+        if (!bLoadedOk) {
+            Z_Free2(*gpMainMemZone, pData);
+        }
+    });
+
+    if (std::fread(pData, layout.totalSize, 1, pFile) != 1)
+        return false;
+
+    uint8_t dataMd5[16] = {};
+    MD5 md5Hasher;
+    md5Hasher.add(pData, layout.totalSize);
+    md5Hasher.getHash(dataMd5);
+
+    if (std::memcmp(hdr.dataMd5, dataMd5, sizeof(dataMd5)) != 0)
+        return false;
+
+    // Fix up all the pointers within the level data
+    vertex_t* const pVertexes = (vertex_t*)(pData + layout.vertexesOffset);
+    sector_t* const pSectors = (sector_t*)(pData + layout.sectorsOffset);
+    side_t* const pSides = (side_t*)(pData + layout.sidesOffset);
+    line_t* const pLines = (line_t*)(pData + layout.linesOffset);
+    subsector_t* const pSubsectors = (subsector_t*)(pData + layout.subsectorsOffset);
+    seg_t* const pSegs = (seg_t*)(pData + layout.segsOffset);
+    leafedge_t* const pLeafEdges = (leafedge_t*)(pData + layout.leafEdgesOffset);
+    line_t** const pLineRefs = (line_t**)(pData + layout.lineRefsOffset);
+    bool bValidPtrs = true;
+
+    for (int32_t i = 0; i < hdr.numSectors; ++i) {
+        sector_t& sec = pSectors[i];
+        sec.soundtarget = nullptr;
+        sec.thinglist = nullptr;
+        sec.specialdata = nullptr;
+
+        // N.B: the line list can point to the end of the line references if the sector has no lines
+        bValidPtrs &= decodePtr(sec.lines, pLineRefs, hdr.numLineRefs + 1);
+        bValidPtrs &= decodePtr(sec.soundorg.subsector, pSubsectors, hdr.numSubsectors);
+        bValidPtrs &= ((sec.lines) && (sec.linecount >= 0) && (sec.linecount <= hdr.numLineRefs - (int32_t)(sec.lines - pLineRefs)));
+    }
+
+    for (int32_t i = 0; i < hdr.numSides; ++i) {
+        bValidPtrs &= decodePtr(pSides[i].sector, pSectors, hdr.numSectors);
+    }
+
+    for (int32_t i = 0; i < hdr.numLines; ++i) {
+        line_t& line = pLines[i];
+        line.specialdata = nullptr;
+        bValidPtrs &= decodePtr(line.vertex1, pVertexes, hdr.numVertexes);
+        bValidPtrs &= decodePtr(line.vertex2, pVertexes, hdr.numVertexes);
+        bValidPtrs &= decodePtr(line.frontsector, pSectors, hdr.numSectors);
+        bValidPtrs &= decodePtr(line.backsector, pSectors, hdr.numSectors);
+    }
+
+    for (int32_t i = 0; i < hdr.numSubsectors; ++i) {
+        bValidPtrs &= decodePtr(pSubsectors[i].sector, pSectors, hdr.numSectors);
+    }
+
+    for (int32_t i = 0; i < hdr.numSegs; ++i) {
+        seg_t& seg = pSegs[i];
+        bValidPtrs &= decodePtr(seg.vertex1, pVertexes, hdr.numVertexes);
+        bValidPtrs &= decodePtr(seg.vertex2, pVertexes, hdr.numVertexes);
+        bValidPtrs &= decodePtr(seg.sidedef, pSides, hdr.numSides);
+        bValidPtrs &= decodePtr(seg.linedef, pLines, hdr.numLines);
+        bValidPtrs &= decodePtr(seg.frontsector, pSectors, hdr.numSectors);
+        bValidPtrs &= decodePtr(seg.backsector, pSectors, hdr.numSectors);
+    }
+
+    for (int32_t i = 0; i < hdr.numLeafEdges; ++i) {
+        bValidPtrs &= decodePtr(pLeafEdges[i].vertex, pVertexes, hdr.numVertexes);
+        bValidPtrs &= decodePtr(pLeafEdges[i].seg, pSegs, hdr.numSegs);
+    }
+
+    for (int32_t i = 0; i < hdr.numLineRefs; ++i) {
+        bValidPtrs &= decodePtr(pLineRefs[i], pLines, hdr.numLines);
+    }
+
+    if (!bValidPtrs)
+        return false;
+
+    // Success! Point all the map data globals at the loaded level data:
+    bLoadedOk = true;
+
+    gNumVertexes = hdr.numVertexes;
+    gpVertexes = pVertexes;
+    gNumSectors = hdr.numSectors;
+    gpSectors = pSectors;
+    gNumSides = hdr.numSides;
+    gpSides = pSides;
+    gNumLines = hdr.numLines;
+    gpLines = pLines;
+    gNumSubsectors = hdr.numSubsectors;
+    gpSubsectors = pSubsectors;
+    gNumBspNodes = hdr.numBspNodes;
+    gpBspNodes = (node_t*)(pData + layout.bspNodesOffset);
+    gNumSegs = hdr.numSegs;
+    gpSegs = pSegs;
+    gTotalNumLeafEdges = hdr.numLeafEdges;
+    gpLeafEdges = pLeafEdges;
+    gpBlockmapLump = (uint16_t*)(pData + layout.blockmapLumpOffset);
+    gpBlockmap = gpBlockmapLump + 4;    // The offsets to each blocklist start after the 8 byte header
+    gBlockmapWidth = hdr.blockmapWidth;
+    gBlockmapHeight = hdr.blockmapHeight;
+    gBlockmapOriginX = hdr.blockmapOriginX;
+    gBlockmapOriginY = hdr.blockmapOriginY;
+    gpRejectMatrix = (uint8_t*)(pData + layout.rejectMatrixOffset);
+    gpSkyTexture = (hdr.skyTexIdx >= 0) ? &gpTextures[hdr.skyTexIdx] : nullptr;
+
+    if (hdr.levelStartupWarning[0]) {
+        std::memcpy(gLevelStartupWarning, hdr.levelStartupWarning, sizeof(gLevelStartupWarning));
+        gLevelStartupWarning[C_ARRAY_SIZE(gLevelStartupWarning) - 1] = 0;
+    }
+
+    DiskCache::markEntryUsed(CACHE_NAME, cacheFileName);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the processed level data for the level currently loaded to the cache.
+// Must be called after the level geometry has been loaded and grouped, but before any things are spawned.
+// Nothing is saved if the level data can't be snapshotted (e.g due to malformed map data) or if the cache file can't be written.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void save(const Key& key) noexcept {
+    // The sector line lists are all stored in a single buffer, starting with the list for the first sector
+    line_t** const pSrcLineRefs = (gNumSectors > 0) ? gpSectors[0].lines : nullptr;
+    int32_t numLineRefs = 0;
+
+    for (int32_t i = 0; i < gNumSectors; ++i) {
+        numLineRefs += gpSectors[i].linecount;
+    }
+
+    // Fill in the header and figure out where everything goes
+    static_assert(sizeof(CacheFileHdr::levelStartupWarning) == sizeof(gLevelStartupWarning));
+
+    CacheFileHdr hdr = {};
+    std::memcpy(hdr.fileId, CACHE_FILE_ID, sizeof(hdr.fileId));
+    hdr.version = CACHE_FILE_VERSION;
+    std::memcpy(hdr.key, key.md5, sizeof(hdr.key));
+    hdr.numVertexes = gNumVertexes;
+    hdr.numSectors = gNumSectors;
+    hdr.numSides = gNumSides;
+    hdr.numLines = gNumLines;
+    hdr.numSubsectors = gNumSubsectors;
+    hdr.numBspNodes = gNumBspNodes;
+    hdr.numSegs = gNumSegs;
+    hdr.numLeafEdges = gTotalNumLeafEdges;
+    hdr.numLineRefs = numLineRefs;
+    hdr.blockmapLumpSize = W_MapLumpLength(W_MapGetNumForName("BLOCKMAP"));
+    hdr.rejectMatrixSize = (int32_t)(((int64_t) gNumSectors * gNumSectors + 7) / 8);
+    hdr.blockmapWidth = gBlockmapWidth;
+    hdr.blockmapHeight = gBlockmapHeight;
+    hdr.blockmapOriginX = gBlockmapOriginX;
+    hdr.blockmapOriginY = gBlockmapOriginY;
+    hdr.skyTexIdx = (gpSkyTexture) ? (int32_t)(gpSkyTexture - gpTextures) : -1;
+    std::memcpy(hdr.levelStartupWarning, gLevelStartupWarning, sizeof(hdr.levelStartupWarning));
+
+    const DataLayout layout = getDataLayout(hdr);
+    hdr.dataSize = (uint32_t) layout.totalSize;
+
+    // Copy all of the level data into the file data
+    std::vector<std::byte> fileData(sizeof(CacheFileHdr) + layout.totalSize);
+    std::byte* const pData = fileData.data() + sizeof(CacheFileHdr);
+
+    vertex_t* const pVertexes = (vertex_t*)(pData + layout.vertexesOffset);
+    sector_t* const pSectors = (sector_t*)(pData + layout.sectorsOffset);
+    side_t* const pSides = (side_t*)(pData + layout.sidesOffset);
+    line_t* const pLines = (line_t*)(pData + layout.linesOffset);
+    subsector_t* const pSubsectors = (subsector_t*)(pData + layout.subsectorsOffset);
+    seg_t* const pSegs = (seg_t*)(pData + layout.segsOffset);
+    leafedge_t* const pLeafEdges = (leafedge_t*)(pData + layout.leafEdgesOffset);
+    line_t** const pLineRefs = (line_t**)(pData + layout.lineRefsOffset);
+
+    const auto copyArray = [](void* const pDst, const void* const pSrc, const size_t size) noexcept {
+        if (size > 0) {
+            std::memcpy(pDst, pSrc, size);
+        }
+    };
+
+    copyArray(pVertexes, gpVertexes, (size_t) gNumVertexes * sizeof(vertex_t));
+    copyArray(pSectors, gpSectors, (size_t) gNumSectors * sizeof(sector_t));
+    copyArray(pSides, gpSides, (size_t) gNumSides * sizeof(side_t));
+    copyArray(pLines, gpLines, (size_t) gNumLines * sizeof(line_t));
+    copyArray(pSubsectors, gpSubsectors, (size_t) gNumSubsectors * sizeof(subsector_t));
+    copyArray(pData + layout.bspNodesOffset, gpBspNodes, (size_t) gNumBspNodes * sizeof(node_t));
+    copyArray(pSegs, gpSegs, (size_t) gNumSegs * sizeof(seg_t));
+    copyArray(pLeafEdges, gpLeafEdges, (size_t) gTotalNumLeafEdges * sizeof(leafedge_t));
+    copyArray(pData + layout.blockmapLumpOffset, gpBlockmapLump, (size_t) hdr.blockmapLumpSize);
+    copyArray(pData + layout.rejectMatrixOffset, gpRejectMatrix, (size_t) hdr.rejectMatrixSize);
+
+    // Convert all the pointers in the copied data to indexes.
+    // If any pointer doesn't point where it should (possible with malformed map data) then don't cache the level.
+    bool bValidPtrs = true;
+
+    for (int32_t i = 0; i < gNumSectors; ++i) {
+        const sector_t& srcSec = gpSectors[i];
+        sector_t& dstSec = pSectors[i];
+        dstSec.soundtarget = nullptr;
+        dstSec.thinglist = nullptr;
+        dstSec.specialdata = nullptr;
+        bValidPtrs &= encodePtr(dstSec.lines, srcSec.lines, pSrcLineRefs, numLineRefs + 1);
+        bValidPtrs &= encodePtr(dstSec.soundorg.subsector, srcSec.soundorg.subsector, gpSubsectors, gNumSubsectors);
+    }
+
+    for (int32_t i = 0; i < gNumSides; ++i) {
+        bValidPtrs &= encodePtr(pSides[i].sector, gpSides[i].sector, gpSectors, gNumSectors);
+    }
+
+    for (int32_t i = 0; i < gNumLines; ++i) {
+        const line_t& srcLine = gpLines[i];
+        line_t& dstLine = pLines[i];
+        dstLine.specialdata = nullptr;
+        bValidPtrs &= encodePtr(dstLine.vertex1, srcLine.vertex1, gpVertexes, gNumVertexes);
+        bValidPtrs &= encodePtr(dstLine.vertex2, srcLine.vertex2, gpVertexes, gNumVertexes);
+        bValidPtrs &= encodePtr(dstLine.frontsector, srcLine.frontsector, gpSectors, gNumSectors);
+        bValidPtrs &= encodePtr(dstLine.backsector, srcLine.backsector, gpSectors, gNumSectors);
+    }
+
+    for (int32_t i = 0; i < gNumSubsectors; ++i) {
+        bValidPtrs &= encodePtr(pSubsectors[i].sector, gpSubsectors[i].sector, gpSectors, gNumSectors);
+    }
+
+    for (int32_t i = 0; i < gNumSegs; ++i) {
+        const seg_t& srcSeg = gpSegs[i];
+        seg_t& dstSeg = pSegs[i];
+        bValidPtrs &= encodePtr(dstSeg.vertex1, srcSeg.vertex1, gpVertexes, gNumVertexes);
+        bValidPtrs &= encodePtr(dstSeg.vertex2, srcSeg.vertex2, gpVertexes, gNumVertexes);
+        bValidPtrs &= encodePtr(dstSeg.sidedef, srcSeg.sidedef, gpSides, gNumSides);
+        bValidPtrs &= encodePtr(dstSeg.linedef, srcSeg.linedef, gpLines, gNumLines);
+        bValidPtrs &= encodePtr(dstSeg.frontsector, srcSeg.frontsector, gpSectors, gNumSectors);
+        bValidPtrs &= encodePtr(dstSeg.backsector, srcSeg.backsector, gpSectors, gNumSectors);
+    }
+
+    for (int32_t i = 0; i < gTotalNumLeafEdges; ++i) {
+        bValidPtrs &= encodePtr(pLeafEdges[i].vertex, gpLeafEdges[i].vertex, gpVertexes, gNumVertexes);
+        bValidPtrs &= encodePtr(pLeafEdges[i].seg, gpLeafEdges[i].seg, gpSegs, gNumSegs);
+    }
+
+    for (int32_t i = 0; i < numLineRefs; ++i) {
+        bValidPtrs &= encodePtr(pLineRefs[i], pSrcLineRefs[i], gpLines, gNumLines);
+    }
+
+    if (!bValidPtrs)
+        return;
+
+    // Hash the level data, then write the file
+    MD5 md5Hasher;
+    md5Hasher.add(pData, layout.totalSize);
+    md5Hasher.getHash(hdr.dataMd5);
+    std::memcpy(fileData.data(), &hdr, sizeof(hdr));
+
+    const std::string cacheFileName = DiskCache::getEntryName(key.md5, ".lvl");
+    const std::string cacheFilePath = DiskCache::getEntryPath(CACHE_NAME, cacheFileName);
+    std::error_code errorCode;
+    std::filesystem::create_directories(DiskCache::getCacheDirPath(CACHE_NAME), errorCode);
+
+    if (FileUtils::writeDataToFile(cacheFilePath.c_str(), fileData.data(), fileData.size())) {
+        DiskCache::markEntryUsed(CACHE_NAME, cacheFileName);
+    }
+}
+
+END_NAMESPACE(LevelCache)
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+
+BEGIN_NAMESPACE(LevelCache)
+
+// Identifies the map data and everything else which affects how level geometry is processed on load (engine version, main WAD lumps etc.)
+struct Key {
+    uint8_t md5[16];
+};
+
+bool isEnabled() noexcept;
+Key makeKey(const bool bFinalDoomMapFormat) noexcept;
+bool load(const Key& key) noexcept;
+void save(const Key& key) noexcept;
+
+END_NAMESPACE(LevelCache)
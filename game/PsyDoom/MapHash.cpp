@@ -58,4 +58,12 @@ void finalize() noexcept {
     );
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the MD5 hash of all the map data added so far, without finalizing the hash.
+// More data can still be added to the hash afterwards.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void getCurrentHash(uint8_t md5[16]) noexcept {
+    gMD5Hasher.getHash(md5);
+}
+
 END_NAMESPACE(MapHash)
@@ -14,5 +14,6 @@ extern uint64_t     gWord2;
 void clear() noexcept;
 void addData(const void* const pData, const int32_t dataSize) noexcept;
 void finalize() noexcept;
+void getCurrentHash(uint8_t md5[16]) noexcept;
 
 END_NAMESPACE(MapHash)
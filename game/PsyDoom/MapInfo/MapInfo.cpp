@@ -340,6 +340,7 @@ static void readMap(const Block& block) noexcept {
     map.skyPaletteOverride = block.getSingleIntValue("SkyPal", map.skyPaletteOverride);
     map.bPlayCdMusic = (block.getSingleIntValue("PlayCdMusic", map.bPlayCdMusic) > 0);
     map.bNoIntermission = (block.getSingleIntValue("NoIntermission", map.bNoIntermission) > 0);
+    map.bGenerateReject = (block.getSingleIntValue("GenerateReject", map.bGenerateReject) > 0);
     map.reverbMode = (SpuReverbMode) block.getSingleIntValue("ReverbMode", map.reverbMode);
     map.reverbDepthL = (int16_t) std::clamp<int32_t>(block.getSingleIntValue("ReverbDepthL", map.reverbDepthL), INT16_MIN, INT16_MAX);
     map.reverbDepthR = (int16_t) std::clamp<int32_t>(block.getSingleIntValue("ReverbDepthR", map.reverbDepthR), INT16_MIN, INT16_MAX);
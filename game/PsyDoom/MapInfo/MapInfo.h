@@ -141,6 +141,7 @@ struct Map {
     int32_t         skyPaletteOverride;     // Overrides the sky palette to use for the map ('-1' if no override)
     bool            bPlayCdMusic;           // If 'true' then 'music' indicates a CDDA track to play, instead of a sequencer track
     bool            bNoIntermission;        // If 'true' then skip the intermission for this map
+    bool            bGenerateReject;        // If 'true' then generate REJECT data for the map if its REJECT lump is empty or all zero
     SpuReverbMode   reverbMode;             // Which reverb mode to use
     int16_t         reverbDepthL;           // Reverb effect depth for most reverb modes (left)
     int16_t         reverbDepthR;           // Reverb effect depth for most reverb modes (right)
@@ -156,6 +157,7 @@ struct Map {
         , skyPaletteOverride(-1)        // No override
         , bPlayCdMusic(false)
         , bNoIntermission(false)
+        , bGenerateReject(false)
         , reverbMode(SpuReverbMode{})
         , reverbDepthL(0)
         , reverbDepthR(0)
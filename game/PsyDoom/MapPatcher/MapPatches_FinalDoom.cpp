@@ -6,6 +6,7 @@
 #include "Doom/d_main.h"
 #include "Doom/Game/g_game.h"
 #include "Doom/Game/info.h"
+#include "Doom/Game/p_maputl.h"
 #include "Doom/Game/p_mobj.h"
 #include "Doom/Renderer/r_data.h"
 #include "MapPatcherUtils.h"
@@ -389,6 +390,8 @@ static void patchMap_Ballistyx() noexcept {
                 } else if (sectorIdx == 163) {
                     mobj.x -= 16 * FRACUNIT;
                 }
+
+                P_SyncBlockThing(mobj);     // Moved in place: update the thing's compact blockmap entry
             }
         );
 
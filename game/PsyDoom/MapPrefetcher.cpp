@@ -0,0 +1,62 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Prefetches the files for the next map in the background while the intermission and finale screens are being shown.
+// This lets the disc and file I/O for the map WAD and the map's sound and music (LCD) files overlap with the time the player spends on
+// those screens, instead of stalling level setup. Once level setup begins the file data is handed over to the WAD and LCD loaders.
+//
+// The actual reading is done by the 'AsyncIo' module, which preloads the files; this module just decides which files the next map needs.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "MapPrefetcher.h"
+
+#include "AsyncIo.h"
+#include "Doom/Base/s_sound.h"
+#include "Doom/cdmaptbl.h"
+#include "ModMgr.h"
+
+#include <cstdio>
+
+BEGIN_NAMESPACE(MapPrefetcher)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins preloading the map WAD for the specified map.
+// Mirrors the logic used by 'P_SetupLevel' to decide between a Doom format (.WAD) and Final Doom format (.ROM) map file.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void preloadMapWadFile(const int32_t mapNum) noexcept {
+    char name[64];
+    std::snprintf(name, C_ARRAY_SIZE(name), "MAP%02d.WAD", mapNum);
+    const CdFileId mapWadFile_doom = name;
+    std::snprintf(name, C_ARRAY_SIZE(name), "MAP%02d.ROM", mapNum);
+    const CdFileId mapWadFile_finalDoom = name;
+
+    const bool bIsFinalDoomMap = ((CdMapTbl_GetEntry(mapWadFile_doom) == PsxCd_MapTblEntry{}) && (!ModMgr::areOverridesAvailableForFile(mapWadFile_doom)));
+    AsyncIo::preloadFile((bIsFinalDoomMap) ? mapWadFile_finalDoom : mapWadFile_doom);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees up all prefetched data
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    discard();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins prefetching the files for the specified map in the background.
+// Any files previously prefetched but not taken are discarded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void start(const int32_t mapNum) noexcept {
+    discard();
+
+    if (mapNum <= 0)
+        return;
+
+    preloadMapWadFile(mapNum);
+    S_PreloadMapSoundAndMusic(mapNum);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees up all prefetched data that was not taken, waiting for any reads in progress to finish first
+//------------------------------------------------------------------------------------------------------------------------------------------
+void discard() noexcept {
+    AsyncIo::discardPreloadedFiles();
+}
+
+END_NAMESPACE(MapPrefetcher)
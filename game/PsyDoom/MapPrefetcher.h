@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+
+BEGIN_NAMESPACE(MapPrefetcher)
+
+void shutdown() noexcept;
+void start(const int32_t mapNum) noexcept;
+void discard() noexcept;
+
+END_NAMESPACE(MapPrefetcher)
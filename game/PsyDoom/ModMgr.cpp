@@ -4,7 +4,9 @@
 #include "ModMgr.h"
 
 #include "Asserts.h"
+#include "Config/Config.h"
 #include "FileUtils.h"
+#include "FileWatcher.h"
 #include "IsoFileSys.h"
 #include "ProgArgs.h"
 #include "PsxVm.h"
@@ -71,49 +73,34 @@ static void makeUppercase(char* const pStr, const size_t len) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Determines what files in the game are overriden with files in a user supplied 'data directory', if any.
+// Searches the user supplied 'data directory' for files which override game files and adds their (uppercased) names to the given set.
+// Returns 'false' if the directory could not be searched.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void determineFileOverridesInUserDataDir() noexcept {
-    // If there is no data dir then there are no overrides
-    gOverridenFileNames.clear();
-
-    if (!ProgArgs::gDataDirPath[0])
-        return;
-
-    // Prealloc memory for the overriden filenames set
-    const IsoFileSys& fileSys = PsxVm::gIsoFileSys;
-    gOverridenFileNames.reserve(fileSys.entries.size() * 8);
-
+static bool findFileOverridesInUserDataDir(std::unordered_set<CdFileId>& overridenFileNames) noexcept {
     // MacOS: the C++ 17 '<filesystem>' header requires MacOS Catalina as a minimum target.
     // That's a bit too much for now, so use standard POSIX stuff instead as a workaround.
     // Eventually however this code path can be removed...
     #if __APPLE__
-        do {
-            DIR* const pDir = opendir(ProgArgs::gDataDirPath);
-
-            if (!pDir) {
-                FatalErrors::raiseF("Failed to search the given data/file overrides directory '%s'! Does this directory exist?", ProgArgs::gDataDirPath);
-                break;
-            }
+        DIR* const pDir = opendir(ProgArgs::gDataDirPath);
 
-            errno = 0;
+        if (!pDir)
+            return false;
 
-            while (dirent* const pDirEnt = readdir(pDir)) {
-                // Mark this file as overridden. Note that we don't bother checking if the file originally existed on the game disc since this
-                // allows us to add new files to variants of the game that might not have originally had them. An example of this would be
-                // allowing 'MAP01.WAD' (Doom format map) to override 'MAP01.ROM' (Final Doom format map) when the Final Doom game is loaded.
-                // This functionality is desirable since the Doom format is more modding friendly and doesn't contain baked-in texture numbers.
-                CdFileId fileId = pDirEnt->d_name;
-                makeUppercase(fileId.chars, CdFileId::MAX_LEN);
-                gOverridenFileNames.insert(fileId);
-            }
+        errno = 0;
 
-            closedir(pDir);
+        while (dirent* const pDirEnt = readdir(pDir)) {
+            // Mark this file as overridden. Note that we don't bother checking if the file originally existed on the game disc since this
+            // allows us to add new files to variants of the game that might not have originally had them. An example of this would be
+            // allowing 'MAP01.WAD' (Doom format map) to override 'MAP01.ROM' (Final Doom format map) when the Final Doom game is loaded.
+            // This functionality is desirable since the Doom format is more modding friendly and doesn't contain baked-in texture numbers.
+            CdFileId fileId = pDirEnt->d_name;
+            makeUppercase(fileId.chars, CdFileId::MAX_LEN);
+            overridenFileNames.insert(fileId);
+        }
 
-            if (errno) {
-                FatalErrors::raiseF("Failed to search the given data/file overrides directory '%s'! Does this directory exist?", ProgArgs::gDataDirPath);
-            }
-        } while (false);
+        const bool bSearchedOk = (errno == 0);
+        closedir(pDir);
+        return bSearchedOk;
     #else
         // Next search the data dir for overrides.
         // Iterate through all files and try to match them with game files:
@@ -130,17 +117,65 @@ static void determineFileOverridesInUserDataDir() noexcept {
                 // This functionality is desirable since the Doom format is more modding friendly and doesn't contain baked-in texture numbers.
                 CdFileId fileId = dirIter->path().filename().u8string().c_str();
                 makeUppercase(fileId.chars, CdFileId::MAX_LEN);
-                gOverridenFileNames.insert(fileId);
+                overridenFileNames.insert(fileId);
 
                 ++dirIter;
             }
         }
         catch (...) {
-            FatalErrors::raiseF("Failed to search the given data/file overrides directory '%s'! Does this directory exist?", ProgArgs::gDataDirPath);
+            return false;
         }
+
+        return true;
     #endif
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Determines what files in the game are overriden with files in a user supplied 'data directory', if any.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void determineFileOverridesInUserDataDir() noexcept {
+    // If there is no data dir then there are no overrides
+    gOverridenFileNames.clear();
+
+    if (!ProgArgs::gDataDirPath[0])
+        return;
+
+    // Prealloc memory for the overriden filenames set
+    const IsoFileSys& fileSys = PsxVm::gIsoFileSys;
+    gOverridenFileNames.reserve(fileSys.entries.size() * 8);
+
+    if (!findFileOverridesInUserDataDir(gOverridenFileNames)) {
+        FatalErrors::raiseF("Failed to search the given data/file overrides directory '%s'! Does this directory exist?", ProgArgs::gDataDirPath);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Called when a file in the user data directory is added, modified or removed: updates the set of overriden files accordingly.
+// If some changes might have been missed then the entire data directory is searched again. If that fails (e.g because the directory was
+// renamed or deleted while the game is running) then the current set of overriden files is kept, rather than raising a fatal error.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void onDataDirFileChanged(const char* const fileName) noexcept {
+    if (!fileName) {
+        std::unordered_set<CdFileId> overridenFileNames;
+        overridenFileNames.reserve(gOverridenFileNames.size());
+
+        if (findFileOverridesInUserDataDir(overridenFileNames)) {
+            gOverridenFileNames.swap(overridenFileNames);
+        }
+
+        return;
+    }
+
+    CdFileId fileId = fileName;
+    makeUppercase(fileId.chars, CdFileId::MAX_LEN);
+
+    if (FileUtils::fileExists(getDataDirFilePath(fileName).c_str())) {
+        gOverridenFileNames.insert(fileId);
+    } else {
+        gOverridenFileNames.erase(fileId);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // The index of a free open file slot, or fail with a fatal error if there are no more slots available
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -170,7 +205,7 @@ static bool isValidOverridenFile(const PsxCd_File& file) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Get the path to an overriden file
 //------------------------------------------------------------------------------------------------------------------------------------------
-static std::string getOverridenFilePath(const CdFileId discFile) noexcept {
+std::string getOverridenFilePath(const CdFileId discFile) noexcept {
     std::string filePath;
     filePath.reserve(255);
     filePath = ProgArgs::gDataDirPath;
@@ -182,9 +217,20 @@ static std::string getOverridenFilePath(const CdFileId discFile) noexcept {
 
 void init() noexcept {
     determineFileOverridesInUserDataDir();
+
+    // Watch the data dir so that the set of overriden files stays up to date if files are added or removed while the game is running.
+    // Only fallback to periodically scanning the data dir if the dev map auto-reloader (which relies on this) is enabled, since that is costly.
+    if (ProgArgs::gDataDirPath[0] && (!ProgArgs::gbHeadlessMode)) {
+        FileWatcher::init(ProgArgs::gDataDirPath, Config::gbEnableDevMapAutoReload);
+        FileWatcher::addListener(onDataDirFileChanged);
+    }
 }
 
 void shutdown() noexcept {
+    // Stop watching the data dir
+    FileWatcher::removeListener(onDataDirFileChanged);
+    FileWatcher::shutdown();
+
     // Close all open files
     for (std::FILE*& pFile : gOpenFileSlots) {
         if (pFile) {
@@ -4,6 +4,8 @@
 #include "Macros.h"
 #include "Wess/psxcd.h"
 
+#include <string>
+
 class WadList;
 
 BEGIN_NAMESPACE(ModMgr)
@@ -21,5 +23,6 @@ int32_t readFromOverridenFile(void* const pDest, int32_t numBytes, PsxCd_File& f
 int32_t seekForOverridenFile(PsxCd_File& file, int32_t offset, const PsxCd_SeekMode mode) noexcept;
 int32_t tellForOverridenFile(const PsxCd_File& file) noexcept;
 int32_t getOverridenFileSize(const CdFileId discFile) noexcept;
+std::string getOverridenFilePath(const CdFileId discFile) noexcept;
 
 END_NAMESPACE(ModMgr)
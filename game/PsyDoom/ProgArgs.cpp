@@ -52,6 +52,18 @@ bool gbPistolStart = false;
 // Doors and platforms also move 2x faster.
 bool gbTurboMode = false;
 
+// If true then print statistics on the number of calls and time spent for each script action when a level ends
+bool gbPrintScriptStats = false;
+
+// If true then print statistics on disc image reads (sector cache hit rate, bytes read etc.) when the game exits
+bool gbPrintDiscStats = false;
+
+// If true then don't load or save decompressed lumps in the on-disk lump cache in the user data folder
+bool gbNoLumpCache = false;
+
+// If true then don't load or save preprocessed level geometry in the on-disk level cache in the user data folder
+bool gbNoLevelCache = false;
+
 // The map number and skill to use if warping on startup straight to a map.
 int32_t gWarpMap = 0;
 skill_t gWarpSkill = sk_hard;
@@ -168,6 +180,42 @@ static int parseArg_turbo(const int argc, const char* const* const argv) {
     return 0;
 }
 
+static int parseArg_scriptstats(const int argc, const char* const* const argv) {
+    if ((argc >= 1) && (std::strcmp(argv[0], "-scriptstats") == 0)) {
+        gbPrintScriptStats = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int parseArg_discstats(const int argc, const char* const* const argv) {
+    if ((argc >= 1) && (std::strcmp(argv[0], "-discstats") == 0)) {
+        gbPrintDiscStats = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int parseArg_nolumpcache(const int argc, const char* const* const argv) {
+    if ((argc >= 1) && (std::strcmp(argv[0], "-nolumpcache") == 0)) {
+        gbNoLumpCache = true;
+        return 1;
+    }
+
+    return 0;
+}
+
+static int parseArg_nolevelcache(const int argc, const char* const* const argv) {
+    if ((argc >= 1) && (std::strcmp(argv[0], "-nolevelcache") == 0)) {
+        gbNoLevelCache = true;
+        return 1;
+    }
+
+    return 0;
+}
+
 static int parseArg_server([[maybe_unused]] const int argc, const char* const* const argv) {
     if (std::strcmp(argv[0], "-server") == 0) {
         gbIsNetServer = true;
@@ -286,6 +334,10 @@ static constexpr ArgParser ARG_PARSERS[] = {
     parseArg_nmbossfixup,
     parseArg_pistolstart,
     parseArg_turbo,
+    parseArg_scriptstats,
+    parseArg_discstats,
+    parseArg_nolumpcache,
+    parseArg_nolevelcache,
     parseArg_server,
     parseArg_client,
     parseArg_file,
@@ -383,6 +435,10 @@ void shutdown() noexcept {
     gbNoMonstersBossFixup = false;
     gbPistolStart = false;
     gbTurboMode = false;
+    gbPrintScriptStats = false;
+    gbPrintDiscStats = false;
+    gbNoLumpCache = false;
+    gbNoLevelCache = false;
     gUserWadFiles.clear();
 }
 
@@ -22,6 +22,10 @@ extern bool         gbNoMonsters;
 extern bool         gbNoMonstersBossFixup;
 extern bool         gbPistolStart;
 extern bool         gbTurboMode;
+extern bool         gbPrintScriptStats;
+extern bool         gbPrintDiscStats;
+extern bool         gbNoLumpCache;
+extern bool         gbNoLevelCache;
 extern int32_t      gWarpMap;
 extern skill_t      gWarpSkill;
 
@@ -43,33 +43,32 @@ static void SdlAudioCallback([[maybe_unused]] void* userData, Uint8* pOutput, in
     // How many samples are to be output?
     const uint32_t numSamples = (uint32_t) outputSize / (sizeof(float) * 2);
 
-    // Lock the SPU and generate the requested number of samples
-    float* pOutputF = reinterpret_cast<float*>(pOutput);
-    PsxVm::LockSpu spuLock;
-
-    for (uint32_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
-        // Get this sample in floating point format
-        const Spu::StereoSample sample = Spu::stepCore(gSpu);
-
-        #if SIMPLE_SPU_FLOAT_SPU
-            float sampleL = sample.left;
-            float sampleR = sample.right;
-        #else
-            float sampleL = Spu::toFloatSample(sample.left);
-            float sampleR = Spu::toFloatSample(sample.right);
-        #endif
-
-        // If using the floating point SPU apply audio compression.
-        // When using floating point sound the audio can get EXTREMELY loud (and painful to listen to) if not capped.
-        // When using the original 16-bit SPU the sound will also clip/distort if too loud, so no point in using compression in that case.
-        #if SIMPLE_SPU_FLOAT_SPU
-            AudioCompressor::compress(gAudioCompState, sampleL, sampleR);
-        #endif
-
-        pOutputF[0] = sampleL;
-        pOutputF[1] = sampleR;
-        pOutputF += 2;
+    // Lock the SPU and generate the requested number of samples, converting to floating point format directly into the output buffer
+    float* const pOutputF = reinterpret_cast<float*>(pOutput);
+
+    {
+        PsxVm::LockSpu spuLock;
+
+        for (uint32_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
+            const Spu::StereoSample sample = Spu::stepCore(gSpu);
+
+            #if SIMPLE_SPU_FLOAT_SPU
+                pOutputF[sampleIdx * 2 + 0] = sample.left;
+                pOutputF[sampleIdx * 2 + 1] = sample.right;
+            #else
+                pOutputF[sampleIdx * 2 + 0] = Spu::toFloatSample(sample.left);
+                pOutputF[sampleIdx * 2 + 1] = Spu::toFloatSample(sample.right);
+            #endif
+        }
     }
+
+    // If using the floating point SPU apply audio compression to the whole output buffer.
+    // When using floating point sound the audio can get EXTREMELY loud (and painful to listen to) if not capped.
+    // When using the original 16-bit SPU the sound will also clip/distort if too loud, so no point in using compression in that case.
+    // Note: the compressor state is only used by this callback, so the SPU lock does not need to be held while compressing.
+    #if SIMPLE_SPU_FLOAT_SPU
+        AudioCompressor::compressBlock(gAudioCompState, pOutputF, numSamples);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
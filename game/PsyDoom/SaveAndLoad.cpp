@@ -14,6 +14,7 @@
 #include "Doom/Game/p_mobj.h"
 #include "Doom/Game/p_plats.h"
 #include "Doom/Game/p_setup.h"
+#include "Doom/Game/p_sight.h"
 #include "Doom/Game/p_spec.h"
 #include "Doom/Game/p_switch.h"
 #include "Doom/Game/p_tick.h"
@@ -83,7 +84,7 @@ static void removeAllThinkers() noexcept {
 
     while (pThinker != &gThinkerCap) {
         thinker_t* const pNextThinker = pThinker->next;
-        Z_Free2(*gpMainMemZone, pThinker);
+        Z_PoolFree(*gpMainMemZone, pThinker);
         pThinker = pNextThinker;
     }
 
@@ -134,7 +135,7 @@ static void allocMobjsToLoad() noexcept {
 
     for (uint32_t i = 0; i < numMobjs; ++i) {
         // Alloc the map object and zero init
-        mobj_t& mobj = *(mobj_t*) Z_ZeroedMalloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL, nullptr);
+        mobj_t& mobj = *(mobj_t*) Z_ZeroedPoolMalloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL);
 
         #if PSYDOOM_MODS
             new (&mobj) mobj_t();   // PsyDoom: construct C++ weak pointers
@@ -162,7 +163,7 @@ static void allocThinkersToLoad(std::vector<ThinkerT*>& outputList, const uint32
     outputList.reserve(amt);
 
     for (uint32_t i = 0; i < amt; ++i) {
-        ThinkerT& thinker = *(ThinkerT*) Z_ZeroedMalloc(*gpMainMemZone, sizeof(ThinkerT), PU_LEVSPEC, nullptr);
+        ThinkerT& thinker = *(ThinkerT*) Z_ZeroedPoolMalloc(*gpMainMemZone, sizeof(ThinkerT), PU_LEVSPEC);
         P_AddThinker(thinker.thinker);
         outputList.push_back(&thinker);
     }
@@ -631,7 +632,9 @@ LoadSaveResult load() noexcept {
 
     saveData.globals.deserializeToGlobals();
     deserializeObjects(saveData.sectors, gpSectors, hdr.numSectors);
+    P_InvalidateSightCache();
     deserializeObjects(saveData.lines, gpLines, hdr.numLines);
+    P_InitTagIndexes();
     deserializeObjects(saveData.sides, gpSides, hdr.numSides);
     deserializeObjects(saveData.mobjs, gMobjList);
     deserializeObjects(saveData.vlDoors, gVlDoors);
@@ -646,6 +649,7 @@ LoadSaveResult load() noexcept {
     deserializeObjects(saveData.delayedExits, gDelayedExits);
     deserializeObjects(saveData.buttons, pButtons, hdr.numButtons);
     deserializeObjects(saveData.scheduledActions, ScriptingEngine::gScheduledActions.data(), hdr.numScheduledActions);
+    ScriptingEngine::rebuildScheduledActionIndexes();
 
     // Post load actions: update skill based game settings, adding map objects into the blockmap and sector lists, and associating thinkers with their sectors
     G_UpdateMobjInfoForSkill(gGameSkill);
@@ -1181,7 +1181,7 @@ void SavedScheduledAction::byteSwap() noexcept {
 
 void SavedScheduledAction::serializeFrom(const ScriptingEngine::ScheduledAction& action) noexcept {
     actionNum = action.actionNum;
-    delayTics = action.delayTics;
+    delayTics = ScriptingEngine::getScheduledActionDelayTics(action);
     executionsLeft = action.executionsLeft;
     repeatDelay = action.repeatDelay;
     tag = action.tag;
@@ -408,7 +408,7 @@ struct SavedButtonT {
 static_assert(sizeof(SavedButtonT) == 16);
 
 // Saved state for a scheduled script action.
-// This is presently identical to the runtime struct but we keep the types separate in case they need to differ.
+// This is presently identical to the runtime struct (minus the runtime only due tic) but we keep the types separate in case they need to differ.
 struct SavedScheduledAction {
     int32_t     actionNum;              // Which action function to execute with
     int32_t     delayTics;              // Game tics left until the action executes
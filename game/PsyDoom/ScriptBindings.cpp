@@ -303,17 +303,8 @@ static sector_t* GetSector(const int32_t index) noexcept {
 }
 
 static sector_t* FindSectorWithTag(const int32_t tag) noexcept {
-    const int32_t numSectors = gNumSectors;
-    sector_t* const pSectors = gpSectors;
-
-    for (int32_t i = 0; i < numSectors; ++i) {
-        sector_t& sector = pSectors[i];
-
-        if (sector.tag == tag)
-            return &sector;
-    }
-
-    return nullptr;
+    const int32_t sectorIdx = P_FindNextSectorWithTag(tag, -1);
+    return (sectorIdx >= 0) ? gpSectors + sectorIdx : nullptr;
 }
 
 static void ForEachSector(const std::function<void (sector_t& sector)>& callback) noexcept {
@@ -332,15 +323,9 @@ static void ForEachSectorWithTag(const int32_t tag, const std::function<void (se
     if (!callback)
         return;
 
-    const int32_t numSectors = gNumSectors;
-    sector_t* const pSectors = gpSectors;
-
-    for (int32_t i = 0; i < numSectors; ++i) {
-        sector_t& sector = pSectors[i];
-
-        if (sector.tag == tag) {
-            callback(sector);
-        }
+    // Note: the next sector is looked up after each callback, in case the callback changes sector tags
+    for (int32_t i = P_FindNextSectorWithTag(tag, -1); i >= 0; i = P_FindNextSectorWithTag(tag, i)) {
+        callback(gpSectors[i]);
     }
 }
 
@@ -450,17 +435,8 @@ static line_t* GetLine(const int32_t index) noexcept {
 }
 
 static line_t* FindLineWithTag(const int32_t tag) noexcept {
-    const int32_t numLines = gNumLines;
-    line_t* const pLines = gpLines;
-
-    for (int32_t i = 0; i < numLines; ++i) {
-        line_t& line = pLines[i];
-
-        if (line.tag == tag)
-            return &line;
-    }
-
-    return nullptr;
+    const int32_t lineIdx = P_FindNextLineWithTag(tag, -1);
+    return (lineIdx >= 0) ? gpLines + lineIdx : nullptr;
 }
 
 static void ForEachLine(const std::function<void (line_t& line)>& callback) noexcept {
@@ -479,15 +455,9 @@ static void ForEachLineWithTag(const int32_t tag, const std::function<void (line
     if (!callback)
         return;
 
-    const int32_t numLines = gNumLines;
-    line_t* const pLines = gpLines;
-
-    for (int32_t i = 0; i < numLines; ++i) {
-        line_t& line = pLines[i];
-
-        if (line.tag == tag) {
-            callback(line);
-        }
+    // Note: the next line is looked up after each callback, in case the callback changes line tags
+    for (int32_t i = P_FindNextLineWithTag(tag, -1); i >= 0; i = P_FindNextLineWithTag(tag, i)) {
+        callback(gpLines[i]);
     }
 }
 
@@ -796,6 +766,36 @@ void S_PlaySoundAtPosition(const float x, const float y, const uint32_t soundId)
         }\
     )
 
+// Register a sector floor or ceiling height, which is interpolated if sector interpolation is enabled.
+// Setting the height also discards cached sight check results, since sector heights can affect line of sight.
+#define SOL_SECTOR_HEIGHT_PROPERTY(FieldName)\
+    sol::property(\
+        [](const sector_t& sector) noexcept { return sector.FieldName; },\
+        [](sector_t& sector, const fixed_t value) noexcept {\
+            sector.FieldName = value;\
+            P_InvalidateSightCache();\
+            \
+            if (!Config::gbInterpolateSectors) {\
+                sector.FieldName.snap();\
+            }\
+        }\
+    )
+
+// Register a sector floor or ceiling height (exposed as a float), which is interpolated if sector interpolation is enabled.
+// Setting the height also discards cached sight check results, since sector heights can affect line of sight.
+#define SOL_SECTOR_HEIGHT_PROPERTY_AS_FLOAT(FieldName)\
+    sol::property(\
+        [](const sector_t& sector) noexcept { return FixedToFloat(sector.FieldName); },\
+        [](sector_t& sector, const float value) noexcept {\
+            sector.FieldName = FloatToFixed(value);\
+            P_InvalidateSightCache();\
+            \
+            if (!Config::gbInterpolateSectors) {\
+                sector.FieldName.snap();\
+            }\
+        }\
+    )
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Type registration functions
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -803,16 +803,19 @@ static void registerType_sector_t(sol::state& lua) noexcept {
     sol::usertype<sector_t> type = lua.new_usertype<sector_t>("sector_t", sol::no_constructor);
 
     type["index"] = sol::readonly_property([](const sector_t& s) noexcept { return &s - gpSectors; });
-    type["floorheight"] = SOL_LERPED_SECTOR_FIXED_PROPERTY_AS_FLOAT(sector_t, floorheight);
-    type["floorheight_fixed"] = SOL_LERPED_SECTOR_FIXED_PROPERTY(sector_t, floorheight);
-    type["ceilingheight"] = SOL_LERPED_SECTOR_FIXED_PROPERTY_AS_FLOAT(sector_t, ceilingheight);
-    type["ceilingheight_fixed"] = SOL_LERPED_SECTOR_FIXED_PROPERTY(sector_t, ceilingheight);
+    type["floorheight"] = SOL_SECTOR_HEIGHT_PROPERTY_AS_FLOAT(floorheight);
+    type["floorheight_fixed"] = SOL_SECTOR_HEIGHT_PROPERTY(floorheight);
+    type["ceilingheight"] = SOL_SECTOR_HEIGHT_PROPERTY_AS_FLOAT(ceilingheight);
+    type["ceilingheight_fixed"] = SOL_SECTOR_HEIGHT_PROPERTY(ceilingheight);
     type["floorpic"] = &sector_t::floorpic;
     type["ceilingpic"] = &sector_t::ceilingpic;
     type["colorid"] = SOL_BYTE_PROPERTY(sector_t, colorid);
     type["lightlevel"] = SOL_BYTE_PROPERTY(sector_t, lightlevel);
     type["special"] = &sector_t::special;
-    type["tag"] = &sector_t::tag;
+    type["tag"] = sol::property(
+        [](const sector_t& sector) noexcept { return sector.tag; },
+        [](sector_t& sector, const int32_t tag) noexcept { P_SetSectorTag(sector, tag); }
+    );
     type["flags"] = &sector_t::flags;
     type["ceil_colorid"] = SOL_BYTE_PROPERTY(sector_t, ceilColorid);
     type["floor_tex_offset_x"] = SOL_LERPED_SECTOR_FIXED_PROPERTY_AS_FLOAT(sector_t, floorTexOffsetX);
@@ -854,7 +857,10 @@ static void registerType_line_t(sol::state& lua) noexcept {
     type["angle"] = sol::readonly_property([](const line_t& line) noexcept { return AngleToDegrees((angle_t) line.fineangle << ANGLETOFINESHIFT); });
     type["flags"] = &line_t::flags;
     type["special"] = &line_t::special;
-    type["tag"] = &line_t::tag;
+    type["tag"] = sol::property(
+        [](const line_t& line) noexcept { return line.tag; },
+        [](line_t& line, const int32_t tag) noexcept { P_SetLineTag(line, tag); }
+    );
     type["frontside"] = sol::readonly_property([](const line_t& line) noexcept { return GetSide(line.sidenum[0]); });
     type["backside"] = sol::readonly_property([](const line_t& line) noexcept { return GetSide(line.sidenum[1]); });
     type["frontsector"] = sol::readonly(&line_t::frontsector);
@@ -9,10 +9,18 @@
 #include "Doom/Game/p_setup.h"
 #include "Doom/Game/p_tick.h"
 #include "Doom/UI/st_main.h"
+#include "DiskCache.h"
+#include "FileUtils.h"
 #include "MapHash.h"
+#include "ProgArgs.h"
 #include "ScriptBindings.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <md5.h>
 #include <memory>
 #include <sol/sol.hpp>
 
@@ -21,9 +29,37 @@ BEGIN_NAMESPACE(ScriptingEngine)
 // The main Lua VM, managed and wrapped by the 'Sol2' library
 static std::unique_ptr<sol::state> gpLuaState;
 
+// An action registered with the scripting engine, along with statistics on how often it is called and how long it takes
+struct ScriptAction {
+    sol::protected_function     func;
+    uint32_t                    numCalls;
+    uint64_t                    totalTimeUsec;
+};
+
+// The largest action number which can be stored in the dense actions list
+static constexpr int32_t MAX_DENSE_ACTION_NUM = UINT16_MAX;
+
 // A table of actions registered with the scripting engine.
 // Each action has an integer identifier associated with it that is referenced by line tags.
-static std::unordered_map<int32_t, sol::protected_function> gScriptActions;
+// Actions are looked up directly by action number, except for negative or very large action numbers which go in a sparse table.
+static std::vector<ScriptAction>                    gScriptActions;
+static std::unordered_map<int32_t, ScriptAction>    gSparseScriptActions;
+
+// Name of the script bytecode cache directory within the on-disk caches
+static constexpr const char* const SCRIPT_CACHE_NAME = "Scripts";
+
+// Header for a file in the script bytecode cache.
+// Cache files are named after the MD5 hash of the script source, and the header identifies the exact source and Lua version used.
+struct ScriptCacheHeader {
+    char        fileId[4];          // Should be 'PDSC'
+    uint32_t    luaVersion;         // Which version of Lua compiled the bytecode
+    uint8_t     sourceMd5[16];      // MD5 hash of the script source code
+    uint32_t    sourceSize;         // Size of the script source code
+    uint32_t    bytecodeSize;       // Size of the bytecode following this header
+    uint8_t     bytecodeMd5[16];    // MD5 hash of the bytecode, to detect corrupted cache files
+};
+
+static constexpr char SCRIPT_CACHE_FILE_ID[4] = { 'P', 'D', 'S', 'C' };
 
 // How many 'doAction' calls are currently active?
 // Scripts might invoke other scripts, so the 'doAction' calls can be nested.
@@ -33,6 +69,31 @@ static int32_t gNumExecutingScripts = 0;
 // This is so we preserve the relative order of actions scheduled to occur on the same tic - they should happen in the same order they were scheduled in.
 std::vector<ScheduledAction> gScheduledActions;
 
+// An entry in the queue of scheduled actions waiting to execute.
+// Entries are not removed when an action is stopped, paused or rescheduled; instead they are ignored when popped if they are found to be stale.
+struct ScheduledActionQueueEntry {
+    int64_t     dueTic;         // Which scheduler tic the action is due to execute on
+    int32_t     actionIdx;      // Index of the action in the scheduled actions list
+};
+
+// The current scheduler tic, which is incremented on every call to 'runScheduledActions'.
+// Unpaused scheduled actions are due to execute on a particular scheduler tic, rather than counting down a delay every tic.
+static int64_t gScheduleTic;
+
+// A min-heap of scheduled actions ordered by due tic and then by action index.
+// Actions due on the same tic are therefore executed in list order, the same as if the entire list was checked every tic.
+static std::vector<ScheduledActionQueueEntry> gScheduledActionQueue;
+
+// Indexes of the actions which are due to execute on the current scheduler tic
+static std::vector<int32_t> gDueScheduledActionIdxs;
+
+// A min-heap of the indexes of free slots in the scheduled actions list, so the lowest free slot can be reused quickly.
+// Entries may be stale and are validated when popped.
+static std::vector<int32_t> gFreeScheduledActionIdxs;
+
+// The indexes of all active (not stopped or finished) scheduled actions with each tag
+static std::unordered_map<int32_t, std::vector<int32_t>> gScheduledActionIdxsByTag;
+
 // Context for the current script action being executed.
 // Which linedef, sector and thing triggered the action, all of which are optional.
 // All, some or none of these might be specified depending on the context in which the script action is executed.
@@ -69,7 +130,7 @@ static void showStatusBarError(const char* const formatStr, Args&&... args) noex
 // Reads the the script for the current map (if any) and returns the string containing the entire script.
 // Note: the script data contributes towards the hash for the map also, so a slight change in the script might invalidate the hash.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static std::unique_ptr<char[]> readCurrentMapScript() noexcept {
+static std::unique_ptr<char[]> readCurrentMapScript(int32_t& scriptLen) noexcept {
     // See if there is a scripts lump available for the current map; if there is none then don't bother initializing the scripting engine
     const int32_t scriptsLumpIdx = W_MapCheckNumForName("SCRIPTS");
 
@@ -84,9 +145,148 @@ static std::unique_ptr<char[]> readCurrentMapScript() noexcept {
 
     // The script counts towards the map hash: count it before returning
     MapHash::addData(mapScript.get(), scriptsLumpLen);
+    scriptLen = scriptsLumpLen;
     return mapScript;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to load a previously compiled version of the map script from the bytecode cache.
+// Returns an invalid function if there is no valid cached bytecode for the script.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static sol::protected_function loadCachedMapScript(const std::string& cacheFileName, const uint8_t sourceMd5[16], const int32_t scriptLen) noexcept {
+    const std::string cacheFilePath = DiskCache::getEntryPath(SCRIPT_CACHE_NAME, cacheFileName);
+    const FileData fileData = FileUtils::getContentsOfFile(cacheFilePath.c_str());
+
+    if ((!fileData.bytes) || (fileData.size < sizeof(ScriptCacheHeader)))
+        return {};
+
+    // Verify the cache file is for this exact script and version of Lua, and that the bytecode is intact
+    ScriptCacheHeader hdr = {};
+    std::memcpy(&hdr, fileData.bytes.get(), sizeof(hdr));
+
+    const std::byte* const pBytecode = fileData.bytes.get() + sizeof(ScriptCacheHeader);
+    uint8_t bytecodeMd5[16] = {};
+    MD5 md5Hasher;
+
+    const bool bValidHeader = (
+        (std::memcmp(hdr.fileId, SCRIPT_CACHE_FILE_ID, sizeof(hdr.fileId)) == 0) &&
+        (hdr.luaVersion == LUA_VERSION_RELEASE_NUM) &&
+        (std::memcmp(hdr.sourceMd5, sourceMd5, sizeof(hdr.sourceMd5)) == 0) &&
+        (hdr.sourceSize == (uint32_t) scriptLen) &&
+        (hdr.bytecodeSize == fileData.size - sizeof(ScriptCacheHeader))
+    );
+
+    if (!bValidHeader)
+        return {};
+
+    md5Hasher.add(pBytecode, hdr.bytecodeSize);
+    md5Hasher.getHash(bytecodeMd5);
+
+    if (std::memcmp(hdr.bytecodeMd5, bytecodeMd5, sizeof(bytecodeMd5)) != 0)
+        return {};
+
+    // Load the bytecode: note that the chunk name used for error messages is saved within the bytecode
+    const sol::load_result loadResult = gpLuaState->load(
+        std::string_view((const char*) pBytecode, hdr.bytecodeSize),
+        sol::detail::default_chunk_name(),
+        sol::load_mode::binary
+    );
+
+    if (!loadResult.valid())
+        return {};
+
+    DiskCache::markEntryUsed(SCRIPT_CACHE_NAME, cacheFileName);
+    return loadResult.get<sol::protected_function>();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the bytecode for a compiled map script to the bytecode cache.
+// Saving is best effort: the compiled script is used for the current map regardless, and an unsaved script is just recompiled from source.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void saveMapScriptToCache(
+    const std::string& cacheFileName,
+    const sol::protected_function& compiledScript,
+    const uint8_t sourceMd5[16],
+    const int32_t scriptLen
+) noexcept {
+    try {
+        const sol::bytecode bytecode = compiledScript.dump();
+
+        ScriptCacheHeader hdr = {};
+        std::memcpy(hdr.fileId, SCRIPT_CACHE_FILE_ID, sizeof(hdr.fileId));
+        hdr.luaVersion = LUA_VERSION_RELEASE_NUM;
+        std::memcpy(hdr.sourceMd5, sourceMd5, sizeof(hdr.sourceMd5));
+        hdr.sourceSize = (uint32_t) scriptLen;
+        hdr.bytecodeSize = (uint32_t) bytecode.size();
+
+        MD5 md5Hasher;
+        md5Hasher.add(bytecode.data(), bytecode.size());
+        md5Hasher.getHash(hdr.bytecodeMd5);
+
+        std::vector<std::byte> fileData(sizeof(ScriptCacheHeader) + bytecode.size());
+        std::memcpy(fileData.data(), &hdr, sizeof(hdr));
+        std::memcpy(fileData.data() + sizeof(hdr), bytecode.data(), bytecode.size());
+
+        const std::string cacheFilePath = DiskCache::getEntryPath(SCRIPT_CACHE_NAME, cacheFileName);
+        std::error_code errorCode;
+        std::filesystem::create_directories(DiskCache::getCacheDirPath(SCRIPT_CACHE_NAME), errorCode);
+
+        if (FileUtils::writeDataToFile(cacheFilePath.c_str(), fileData.data(), fileData.size())) {
+            DiskCache::markEntryUsed(SCRIPT_CACHE_NAME, cacheFileName);
+        }
+    }
+    catch (const std::exception& e) {
+        std::printf("PsyDoom: failed to save the map script to the bytecode cache! Details follow:\n%s\n", e.what());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compiles the given map script, or loads a previously compiled version of it from the bytecode cache in the user data folder.
+// Returns an invalid function if the script failed to compile.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static sol::protected_function compileMapScript(const char* const mapScript, const int32_t scriptLen) noexcept {
+    // Try the cache first
+    uint8_t sourceMd5[16] = {};
+
+    {
+        MD5 md5Hasher;
+        md5Hasher.add(mapScript, (size_t) scriptLen);
+        md5Hasher.getHash(sourceMd5);
+    }
+
+    const std::string cacheFileName = DiskCache::getEntryName(sourceMd5, ".luac");
+
+    if (sol::protected_function cachedScript = loadCachedMapScript(cacheFileName, sourceMd5, scriptLen); cachedScript.valid())
+        return cachedScript;
+
+    // Otherwise compile the script from source and cache the result
+    const sol::load_result loadResult = gpLuaState->load(std::string_view(mapScript, (size_t) scriptLen), sol::detail::default_chunk_name(), sol::load_mode::text);
+
+    if (!loadResult.valid()) {
+        const sol::error error = loadResult;
+        std::printf("PsyDoom: error compiling the map script! Details follow:\n%s\n", error.what());
+        showStatusBarError("Script error! See stdout.");
+        return {};
+    }
+
+    sol::protected_function compiledScript = loadResult.get<sol::protected_function>();
+    saveMapScriptToCache(cacheFileName, compiledScript, sourceMd5, scriptLen);
+    return compiledScript;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds the registered script action with the specified number, returning 'nullptr' if there is no such action
+//------------------------------------------------------------------------------------------------------------------------------------------
+static ScriptAction* findScriptAction(const int32_t actionNum) noexcept {
+    if ((actionNum >= 0) && (actionNum < (int32_t) gScriptActions.size())) {
+        ScriptAction& action = gScriptActions[actionNum];
+        return (action.func.valid()) ? &action : nullptr;
+    }
+
+    const auto actionIter = gSparseScriptActions.find(actionNum);
+    return (actionIter != gSparseScriptActions.end()) ? &actionIter->second : nullptr;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Helper: makes a lua table readonly as much as possible
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -164,7 +364,15 @@ static void setupActionRegisterLuaEnv() noexcept {
 
     // Provide a function to register script actions with
     lua["SetAction"] = [](const int32_t actionNumber, const sol::protected_function func) noexcept {
-        gScriptActions[actionNumber] = func;
+        if ((actionNumber >= 0) && (actionNumber <= MAX_DENSE_ACTION_NUM)) {
+            if (actionNumber >= (int32_t) gScriptActions.size()) {
+                gScriptActions.resize((size_t) actionNumber + 1);
+            }
+
+            gScriptActions[actionNumber] = { func, 0, 0 };
+        } else {
+            gSparseScriptActions[actionNumber] = { func, 0, 0 };
+        }
     };
 
     // Register all scripting bindings
@@ -211,19 +419,87 @@ static void doMobjGC() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Allocates and zero initializes a 'ScheduledAction' structure.
-// Tries to find a free one in the list first, otherwise adds a new one to the end of the list.
+// Heap ordering for the scheduled action queue: puts the earliest due action (and lowest index for the same due tic) on top
 //------------------------------------------------------------------------------------------------------------------------------------------
-static ScheduledAction& allocScheduledAction() noexcept {
-    for (ScheduledAction& action : gScheduledActions) {
-        // If there are no more executions left then it is free
-        if (action.executionsLeft == 0) {
-            action = {};
-            return action;
+static bool isScheduledActionQueueEntryAfter(const ScheduledActionQueueEntry& entry1, const ScheduledActionQueueEntry& entry2) noexcept {
+    return (entry1.dueTic != entry2.dueTic) ? (entry1.dueTic > entry2.dueTic) : (entry1.actionIdx > entry2.actionIdx);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Schedules the specified action to execute after the given number of scheduler tics have elapsed ('0' means on the next tic).
+// Adds a new entry for it in the queue of actions waiting to execute.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void queueScheduledAction(const int32_t actionIdx, const int32_t delayTics) noexcept {
+    ScheduledAction& action = gScheduledActions[actionIdx];
+    action.dueTic = gScheduleTic + 1 + delayTics;
+
+    gScheduledActionQueue.push_back({ action.dueTic, actionIdx });
+    std::push_heap(gScheduledActionQueue.begin(), gScheduledActionQueue.end(), isScheduledActionQueueEntryAfter);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds or removes the specified action to/from the list of active actions with it's tag
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addToScheduledActionTagIndex(const int32_t actionIdx) noexcept {
+    gScheduledActionIdxsByTag[gScheduledActions[actionIdx].tag].push_back(actionIdx);
+}
+
+static void removeFromScheduledActionTagIndex(const int32_t actionIdx) noexcept {
+    const auto tagIter = gScheduledActionIdxsByTag.find(gScheduledActions[actionIdx].tag);
+
+    if (tagIter == gScheduledActionIdxsByTag.end())
+        return;
+
+    std::vector<int32_t>& actionIdxs = tagIter->second;
+    const auto idxIter = std::find(actionIdxs.begin(), actionIdxs.end(), actionIdx);
+
+    if (idxIter != actionIdxs.end()) {
+        *idxIter = actionIdxs.back();
+        actionIdxs.pop_back();
+    }
+
+    if (actionIdxs.empty()) {
+        gScheduledActionIdxsByTag.erase(tagIter);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Marks the specified action as having no more executions left and frees up it's slot in the list for reuse
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void releaseScheduledAction(const int32_t actionIdx) noexcept {
+    ScheduledAction& action = gScheduledActions[actionIdx];
+    ASSERT(action.executionsLeft != 0);
+
+    removeFromScheduledActionTagIndex(actionIdx);
+    action.executionsLeft = 0;
+    action.bPendingExecute = false;
+
+    gFreeScheduledActionIdxs.push_back(actionIdx);
+    std::push_heap(gFreeScheduledActionIdxs.begin(), gFreeScheduledActionIdxs.end(), std::greater<int32_t>());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates and zero initializes a 'ScheduledAction' structure and returns it's index.
+// Tries to find the lowest free one in the list first, otherwise adds a new one to the end of the list.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t allocScheduledAction() noexcept {
+    const int32_t numActions = (int32_t) gScheduledActions.size();
+
+    while (!gFreeScheduledActionIdxs.empty()) {
+        std::pop_heap(gFreeScheduledActionIdxs.begin(), gFreeScheduledActionIdxs.end(), std::greater<int32_t>());
+        const int32_t actionIdx = gFreeScheduledActionIdxs.back();
+        gFreeScheduledActionIdxs.pop_back();
+
+        // The free slot might have since been reused or removed from the end of the list.
+        // If there are no more executions left then it is free:
+        if ((actionIdx < numActions) && (gScheduledActions[actionIdx].executionsLeft == 0)) {
+            gScheduledActions[actionIdx] = {};
+            return actionIdx;
         }
     }
 
-    return gScheduledActions.emplace_back();
+    gScheduledActions.emplace_back();
+    return numActions;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -250,19 +526,32 @@ void init() noexcept {
     ASSERT(gNumExecutingScripts == 0);
 
     // Read the current map script (if any)
-    std::unique_ptr<char[]> mapScript = readCurrentMapScript();
+    int32_t mapScriptLen = 0;
+    std::unique_ptr<char[]> mapScript = readCurrentMapScript(mapScriptLen);
 
     if (!mapScript)
         return;
 
     // Prealloc some memory
     gScheduledActions.reserve(64);
+    gScheduledActionQueue.reserve(64);
+    gDueScheduledActionIdxs.reserve(64);
 
     // If a script exists then setup a Lua environment for registering script actions and then execute the map script to register them
     setupActionRegisterLuaEnv();
 
     try {
-        gpLuaState->script(mapScript.get());
+        const sol::protected_function compiledScript = compileMapScript(mapScript.get(), mapScriptLen);
+
+        if (compiledScript.valid()) {
+            const sol::protected_function_result result = compiledScript();
+
+            if (!result.valid()) {
+                const sol::error error = result;
+                std::printf("PsyDoom: error executing the map script! Details follow:\n%s\n", error.what());
+                showStatusBarError("Script error! See stdout.");
+            }
+        }
     }
     catch (const std::exception& e) {
         std::printf("PsyDoom: error executing the map script! Details follow:\n%s\n", e.what());
@@ -279,8 +568,19 @@ void init() noexcept {
 void shutdown() noexcept {
     ASSERT_LOG(gNumExecutingScripts == 0, "Shutdown should only be done when no scripts are executing!");
 
+    // Print per action statistics for the level if requested, before any state is cleared
+    if (ProgArgs::gbPrintScriptStats) {
+        printScriptActionStats();
+    }
+
     gScheduledActions.clear();
+    gScheduleTic = 0;
+    gScheduledActionQueue.clear();
+    gDueScheduledActionIdxs.clear();
+    gFreeScheduledActionIdxs.clear();
+    gScheduledActionIdxsByTag.clear();
     gScriptActions.clear();
+    gSparseScriptActions.clear();
     gpLuaState.reset();
 }
 
@@ -288,45 +588,60 @@ void shutdown() noexcept {
 // Runs all actions that are scheduled for execution
 //------------------------------------------------------------------------------------------------------------------------------------------
 void runScheduledActions() noexcept {
-    // Flag which actions are pending execution for this frame.
+    // Flag which actions are pending execution for this frame, by popping all the actions due on this tic from the queue.
     // If any actions schedule any other actions then they will be delayed by 1 frame at least.
+    gScheduleTic++;
+    gDueScheduledActionIdxs.clear();
+
     const int32_t numActions = (int32_t) gScheduledActions.size();
 
-    for (int32_t i = 0; i < numActions; ++i) {
-        // Skip the action if paused or if there are no more executions left (stopped)
-        ScheduledAction& action = gScheduledActions[i];
+    while ((!gScheduledActionQueue.empty()) && (gScheduledActionQueue.front().dueTic <= gScheduleTic)) {
+        std::pop_heap(gScheduledActionQueue.begin(), gScheduledActionQueue.end(), isScheduledActionQueueEntryAfter);
+        const ScheduledActionQueueEntry entry = gScheduledActionQueue.back();
+        gScheduledActionQueue.pop_back();
 
-        if (action.bPaused || (action.executionsLeft == 0))
+        // Ignore stale queue entries: the action might have since been removed, paused, stopped or rescheduled.
+        // The same action might also be queued twice for the same tic, in which case it is already pending execution.
+        if (entry.actionIdx >= numActions)
             continue;
 
-        // Reduce the time until the action executes or schedule it to execute if executing now
-        const int32_t delayTics = action.delayTics;
+        ScheduledAction& action = gScheduledActions[entry.actionIdx];
 
-        if (delayTics > 0) {
-            action.delayTics = delayTics - 1;
-        } else {
-            action.bPendingExecute = true;
-        }
+        if (action.bPaused || (action.executionsLeft == 0) || (action.dueTic != entry.dueTic) || action.bPendingExecute)
+            continue;
+
+        action.bPendingExecute = true;
+        gDueScheduledActionIdxs.push_back(entry.actionIdx);
     }
 
-    // Execute all pending actions and ignore any new ones that have been added
-    for (int32_t i = 0; i < numActions; ++i) {
-        // Only execute the action if it's pending execution
-        ScheduledAction& action = gScheduledActions[i];
+    // Execute all pending actions and ignore any new ones that have been added.
+    // Note: the queue gives these in list order since they are all due on the same tic.
+    for (const int32_t actionIdx : gDueScheduledActionIdxs) {
+        // Only execute the action if it's still pending execution (might have been stopped or paused by a previous action)
+        ScheduledAction& action = gScheduledActions[actionIdx];
 
         if (!action.bPendingExecute)
             continue;
 
         // Otherwise setup the next repeat (if any) and execute the action
         const int32_t executionsLeft = action.executionsLeft;
+        const int32_t actionNum = action.actionNum;
+        const int32_t actionTag = action.tag;
+        const int32_t actionUserdata = action.userdata;
 
-        if (executionsLeft > 0) {
-            action.executionsLeft = executionsLeft - 1;     // Finite number of repeats
+        action.bPendingExecute = false;
+
+        if (executionsLeft == 1) {
+            releaseScheduledAction(actionIdx);      // Last execution: the slot can be reused by any actions scheduled by this one
+        } else {
+            if (executionsLeft > 0) {
+                action.executionsLeft = executionsLeft - 1;     // Finite number of repeats
+            }
+
+            queueScheduledAction(actionIdx, action.repeatDelay);
         }
 
-        action.delayTics = action.repeatDelay;
-        action.bPendingExecute = false;
-        doAction(action.actionNum, nullptr, nullptr, nullptr, action.tag, action.userdata);
+        doAction(actionNum, nullptr, nullptr, nullptr, actionTag, actionUserdata);
     }
 
     // Compact the actions list as much as possible if there's stuff on the end that can be removed
@@ -357,12 +672,15 @@ bool doAction(
     // Assume the current action is allowed until scripts indicate otherwise
     gbCurActionAllowed = true;
 
-    // Try and execute the action
-    const auto actionIter = gScriptActions.find(actionNum);
+    // Try and execute the action, timing how long it takes
+    ScriptAction* const pAction = findScriptAction(actionNum);
+
+    if (pAction) {
+        pAction->numCalls++;
+        const auto startTime = std::chrono::steady_clock::now();
 
-    if (actionIter != gScriptActions.end()) {
         try {
-            const sol::protected_function_result result = actionIter->second();
+            const sol::protected_function_result result = pAction->func();
 
             if (!result.valid()) {
                 const sol::error error = result;
@@ -374,6 +692,13 @@ bool doAction(
             showStatusBarError("Script #%d error! See stdout.", actionNum);
             std::printf("PsyDoom: error executing map script action #%d! Details follow:\n%s\n", actionNum, e.what());
         }
+
+        // Note: the action is looked up again in case the list of actions was modified while executing (only possible during level startup)
+        const auto endTime = std::chrono::steady_clock::now();
+
+        if (ScriptAction* const pExecutedAction = findScriptAction(actionNum); pExecutedAction) {
+            pExecutedAction->totalTimeUsec += (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+        }
     } else {
         showStatusBarError("No script action #%d!", actionNum);
         std::printf("PsyDoom: no scripting action #%d is available to execute!\n", actionNum);
@@ -409,12 +734,16 @@ void scheduleAction(
     const int32_t tag,
     const int32_t userdata
 ) noexcept {
-    ScheduledAction& action = allocScheduledAction();
+    const int32_t actionIdx = allocScheduledAction();
+    ScheduledAction& action = gScheduledActions[actionIdx];
     action.actionNum = actionNum;
     action.delayTics = std::max(delayTics, 0);
     action.executionsLeft = 1;
     action.tag = tag;
     action.userdata = userdata;
+
+    addToScheduledActionTagIndex(actionIdx);
+    queueScheduledAction(actionIdx, action.delayTics);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -429,13 +758,38 @@ void scheduleRepeatingAction(
     const int32_t tag,
     const int32_t userdata
 ) noexcept {
-    ScheduledAction& action = allocScheduledAction();
+    const int32_t actionIdx = allocScheduledAction();
+    ScheduledAction& action = gScheduledActions[actionIdx];
     action.actionNum = actionNum;
     action.delayTics = std::max(initialDelayTics, 0);
     action.executionsLeft = (numRepeats < 0) ? -1 : numRepeats + 1;    // Note: use '-1' always for infinite
     action.repeatDelay = std::max(repeatDelay, 0);
     action.tag = tag;
     action.userdata = userdata;
+
+    addToScheduledActionTagIndex(actionIdx);
+    queueScheduledAction(actionIdx, action.delayTics);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Pauses or unpauses the specified scheduled action.
+// The remaining delay is remembered while paused, and the action is requeued when unpaused.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void pauseScheduledAction(const int32_t actionIdx, const bool bPause) noexcept {
+    ScheduledAction& action = gScheduledActions[actionIdx];
+    const bool bWasPaused = action.bPaused;
+    const int64_t oldDueTic = action.dueTic;
+
+    action.delayTics = getScheduledActionDelayTics(action);
+    action.bPaused = bPause;
+    action.bPendingExecute = false;     // Action must wait another frame if it is unpaused
+
+    // Only requeue if needed; if an action is still due on the same tic then it's current queue entry remains valid
+    if (!bPause) {
+        if (bWasPaused || (gScheduleTic + 1 + action.delayTics != oldDueTic)) {
+            queueScheduledAction(actionIdx, action.delayTics);
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -444,9 +798,12 @@ void scheduleRepeatingAction(
 void stopAllScheduledActions() noexcept {
     // Note: this can be called while executing and iterating through the scheduled action list.
     // Therefore just flag the action as stopped rather than trying to cleanup or compact the list.
-    for (ScheduledAction& action : gScheduledActions) {
-        action.executionsLeft = 0;
-        action.bPendingExecute = false;
+    const int32_t numActions = (int32_t) gScheduledActions.size();
+
+    for (int32_t i = 0; i < numActions; ++i) {
+        if (gScheduledActions[i].executionsLeft != 0) {
+            releaseScheduledAction(i);
+        }
     }
 }
 
@@ -456,11 +813,16 @@ void stopAllScheduledActions() noexcept {
 void stopScheduledActionsWithTag(const int32_t tag) noexcept {
     // Note: this can be called while executing and iterating through the scheduled action list.
     // Therefore just flag the action as stopped rather than trying to cleanup or compact the list.
-    for (ScheduledAction& action : gScheduledActions) {
-        if (action.tag == tag) {
-            action.executionsLeft = 0;
-            action.bPendingExecute = false;
-        }
+    // Also make a copy of the indexes of actions to stop, since stopping them removes them from the tag index.
+    const auto tagIter = gScheduledActionIdxsByTag.find(tag);
+
+    if (tagIter == gScheduledActionIdxsByTag.end())
+        return;
+
+    const std::vector<int32_t> actionIdxs = tagIter->second;
+
+    for (const int32_t actionIdx : actionIdxs) {
+        releaseScheduledAction(actionIdx);
     }
 }
 
@@ -468,9 +830,12 @@ void stopScheduledActionsWithTag(const int32_t tag) noexcept {
 // Pauses or unpaused all scheduled actions
 //------------------------------------------------------------------------------------------------------------------------------------------
 void pauseAllScheduledActions(const bool bPause) noexcept {
-    for (ScheduledAction& action : gScheduledActions) {
-        action.bPaused = bPause;
-        action.bPendingExecute = false;     // Action must wait another frame if it is unpaused
+    const int32_t numActions = (int32_t) gScheduledActions.size();
+
+    for (int32_t i = 0; i < numActions; ++i) {
+        if (gScheduledActions[i].executionsLeft != 0) {
+            pauseScheduledAction(i, bPause);
+        }
     }
 }
 
@@ -478,10 +843,11 @@ void pauseAllScheduledActions(const bool bPause) noexcept {
 // Pauses or unpaused all scheduled actions with the specified tag
 //------------------------------------------------------------------------------------------------------------------------------------------
 void pauseScheduledActionsWithTag(const int32_t tag, const bool bPause) noexcept {
-    for (ScheduledAction& action : gScheduledActions) {
-        if (action.tag == tag) {
-            action.bPaused = bPause;
-            action.bPendingExecute = false;     // Action must wait another frame if it is unpaused
+    const auto tagIter = gScheduledActionIdxsByTag.find(tag);
+
+    if (tagIter != gScheduledActionIdxsByTag.end()) {
+        for (const int32_t actionIdx : tagIter->second) {
+            pauseScheduledAction(actionIdx, bPause);
         }
     }
 }
@@ -491,15 +857,99 @@ void pauseScheduledActionsWithTag(const int32_t tag, const bool bPause) noexcept
 // This count includes any actions that have been paused, but not actions that are stopped/finished.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t getNumScheduledActionsWithTag(const int32_t tag) noexcept {
-    int32_t actionCount = 0;
+    const auto tagIter = gScheduledActionIdxsByTag.find(tag);
+    return (tagIter != gScheduledActionIdxsByTag.end()) ? (int32_t) tagIter->second.size() : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the number of game tics left until the specified scheduled action executes.
+// Unpaused actions do not count down their delay every tic, so it must be computed from the tic the action is due on.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t getScheduledActionDelayTics(const ScheduledAction& action) noexcept {
+    if (action.bPaused || (action.executionsLeft == 0))
+        return action.delayTics;
+
+    return (int32_t) std::max<int64_t>(action.dueTic - gScheduleTic - 1, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Rebuilds the queue of scheduled actions and the other lookup structures from the scheduled actions list.
+// Must be called after the list is replaced wholesale, such as when loading a saved game.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void rebuildScheduledActionIndexes() noexcept {
+    gScheduledActionQueue.clear();
+    gDueScheduledActionIdxs.clear();
+    gFreeScheduledActionIdxs.clear();
+    gScheduledActionIdxsByTag.clear();
+
+    const int32_t numActions = (int32_t) gScheduledActions.size();
+
+    for (int32_t i = 0; i < numActions; ++i) {
+        ScheduledAction& action = gScheduledActions[i];
+        action.bPendingExecute = false;
 
-    for (ScheduledAction& action : gScheduledActions) {
-        if ((action.tag == tag) && (action.executionsLeft != 0)) {
-            actionCount++;
+        if (action.executionsLeft == 0) {
+            gFreeScheduledActionIdxs.push_back(i);      // Note: ascending order is a valid min-heap
+            continue;
         }
+
+        addToScheduledActionTagIndex(i);
+
+        if (!action.bPaused) {
+            queueScheduledAction(i, action.delayTics);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets statistics for all script actions which have been called at least once on the current level, ordered by action number
+//------------------------------------------------------------------------------------------------------------------------------------------
+std::vector<ScriptActionStats> getScriptActionStats() noexcept {
+    std::vector<ScriptActionStats> stats;
+
+    const auto addStats = [&](const int32_t actionNum, const ScriptAction& action) noexcept {
+        if (action.numCalls > 0) {
+            stats.push_back({ actionNum, action.numCalls, action.totalTimeUsec });
+        }
+    };
+
+    for (int32_t actionNum = 0; actionNum < (int32_t) gScriptActions.size(); ++actionNum) {
+        addStats(actionNum, gScriptActions[actionNum]);
+    }
+
+    for (const auto& [actionNum, action] : gSparseScriptActions) {
+        addStats(actionNum, action);
     }
 
-    return actionCount;
+    std::sort(stats.begin(), stats.end(), [](const ScriptActionStats& s1, const ScriptActionStats& s2) noexcept {
+        return (s1.actionNum < s2.actionNum);
+    });
+
+    return stats;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Prints the statistics for all script actions called on the current level to standard out
+//------------------------------------------------------------------------------------------------------------------------------------------
+void printScriptActionStats() noexcept {
+    const std::vector<ScriptActionStats> stats = getScriptActionStats();
+
+    if (stats.empty())
+        return;
+
+    std::printf("PsyDoom: script action stats for the level:\n");
+
+    for (const ScriptActionStats& actionStats : stats) {
+        const double avgUsec = (double) actionStats.totalTimeUsec / (double) actionStats.numCalls;
+
+        std::printf(
+            "  Action #%d: %u calls, %llu usec total, %.1f usec avg\n",
+            actionStats.actionNum,
+            actionStats.numCalls,
+            (unsigned long long) actionStats.totalTimeUsec,
+            avgUsec
+        );
+    }
 }
 
 END_NAMESPACE(ScriptingEngine)
@@ -15,13 +15,21 @@ BEGIN_NAMESPACE(ScriptingEngine)
 // Note that delayed actions have no triggering line, sector or thing associated with them.
 struct ScheduledAction {
     int32_t     actionNum;          // Which action function to execute with
-    int32_t     delayTics;          // Game tics left until the action executes
+    int32_t     delayTics;          // Game tics left until the action executes. Only kept up to date while paused: use 'getScheduledActionDelayTics' to read.
     int32_t     executionsLeft;     // The number of action executions left; '0' if the action will not execute again, or '-1' if infinitely repeating.
     int32_t     repeatDelay;        // The delay in tics between repeats ('0' means execute every tic)
     int32_t     tag;                // User defined tag associated with the action
     int32_t     userdata;           // User defined data associated with the action
     bool        bPaused;            // If 'true' then the action is paused, otherwise it's unpaused
     bool        bPendingExecute;    // If 'true' then the action is pending execution this frame
+    int64_t     dueTic;             // Which scheduler tic the action executes on when not paused (not serialized)
+};
+
+// Statistics for a script action: how many times it was called on the current level and the total time spent executing it
+struct ScriptActionStats {
+    int32_t     actionNum;
+    uint32_t    numCalls;
+    uint64_t    totalTimeUsec;
 };
 
 extern std::vector<ScheduledAction>     gScheduledActions;
@@ -67,5 +75,9 @@ void stopScheduledActionsWithTag(const int32_t tag) noexcept;
 void pauseAllScheduledActions(const bool bPause) noexcept;
 void pauseScheduledActionsWithTag(const int32_t tag, const bool bPause) noexcept;
 int32_t getNumScheduledActionsWithTag(const int32_t tag) noexcept;
+int32_t getScheduledActionDelayTics(const ScheduledAction& action) noexcept;
+void rebuildScheduledActionIndexes() noexcept;
+std::vector<ScriptActionStats> getScriptActionStats() noexcept;
+void printScriptActionStats() noexcept;
 
 END_NAMESPACE(ScriptingEngine)
@@ -7,6 +7,7 @@
 #include "Doom/Game/p_tick.h"
 #include "Doom/UI/st_main.h"
 #include "FatalErrors.h"
+#include "FileWatcher.h"
 #include "Input.h"
 #include "IsoFileSys.h"
 #include "Network.h"
@@ -121,6 +122,7 @@ void doPlatformUpdates() noexcept {
     gLastPlatformUpdateTime = now;
     Network::doUpdates();
     Input::update();
+    FileWatcher::update();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1,12 +1,19 @@
 #include "WadFile.h"
 
+#include "AsyncIo.h"
 #include "Doom/Base/i_main.h"
 #include "Doom/Base/z_zone.h"
 #include "Doom/d_main.h"
+#include "DiscInfo.h"
 #include "FileUtils.h"
+#include "ModMgr.h"
+#include "PsxVm.h"
 #include "WadUtils.h"
 
 #include <cctype>
+#include <md5.h>
+#include <cstring>
+#include <string>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Header for a WAD file: constains high level information about the contents of the WAD
@@ -19,6 +26,9 @@ struct WadHdr {
 
 static_assert(sizeof(WadHdr) == 12);
 
+// WADs on the game disc which cannot be memory mapped are read into memory in their entirety when opened, provided they are no bigger than this
+static constexpr int32_t MAX_IN_MEMORY_WAD_SIZE = 64 * 1024 * 1024;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Header for a lump in a WAD file
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -36,9 +46,13 @@ static_assert(sizeof(WadLumpHdr) == 16);
 WadFile::WadFile() noexcept
     : mNumLumps(0)
     , mSizeInBytes(0)
+    , mContentHash{}
     , mLumpNames{}
     , mLumps{}
     , mFileReader()
+    , mMappedFile()
+    , mFileData()
+    , mLumpNameIndex()
 {
 }
 
@@ -48,9 +62,13 @@ WadFile::WadFile() noexcept
 WadFile::WadFile(WadFile&& other) noexcept 
     : mNumLumps(other.mNumLumps)
     , mSizeInBytes(other.mSizeInBytes)
+    , mContentHash(other.mContentHash)
     , mLumpNames(std::move(other.mLumpNames))
     , mLumps(std::move(other.mLumps))
     , mFileReader(std::move(other.mFileReader))
+    , mMappedFile(std::move(other.mMappedFile))
+    , mFileData(std::move(other.mFileData))
+    , mLumpNameIndex(std::move(other.mLumpNameIndex))
 {
     other.mNumLumps = 0;
     other.mSizeInBytes = 0;
@@ -70,8 +88,13 @@ void WadFile::close() noexcept {
     purgeAllLumps();
 
     mFileReader.close();
+    mMappedFile.unmap();
+    mFileData.clear();
+    mFileData.shrink_to_fit();
+    mLumpNameIndex.clear();
     mLumps.reset();
     mLumpNames.reset();
+    mContentHash = {};
     mSizeInBytes = 0;
     mNumLumps = 0;
 }
@@ -92,9 +115,15 @@ void WadFile::open(const char* const filePath, const RemapWadLumpNameFn lumpName
     if (fileSize > INT32_MAX)
         FatalErrors::raiseF("WadFile::open: file '%s' is too big!", filePath);
 
-    // Open the WAD file and perform all other initialization
+    // Open the WAD file and perform all other initialization.
+    // Also try to map the WAD into memory so that lumps can be accessed directly; if that fails then lumps are read via the file reader.
+    //
+    // Note: user WADs are mapped on the assumption that they are not modified while the game is running. Unlike files in the user data
+    // dir, they are not watched for changes or auto-reloaded. Truncating a file while it's mapped can crash the game when the missing part
+    // of the mapping is accessed.
     mSizeInBytes = (int32_t) fileSize;
     mFileReader.open(filePath);
+    mMappedFile.map(filePath, 0, (size_t) fileSize);
     initAfterOpen(lumpNameRemapFn);
 }
 
@@ -113,8 +142,49 @@ void WadFile::open(const CdFileId fileId, const RemapWadLumpNameFn lumpNameRemap
     
     mSizeInBytes = file.size;
 
-    // Perform all other initialization
+    // If the entire WAD was already preloaded in the background (e.g by the map prefetcher while the intermission was shown) then use that data.
+    // Discard the data if it somehow doesn't match the size of the file being opened.
+    const bool bUsePreloadedData = (AsyncIo::takePreloadedFile(fileId, mFileData) && (mFileData.size() == (size_t) file.size));
+    AsyncIo::Token fileDataReadToken = AsyncIo::INVALID_TOKEN;
+
+    if (!bUsePreloadedData) {
+        mFileData.clear();
+        mFileData.shrink_to_fit();
+
+        // If the WAD is in a disc image with plain 2,048 byte sectors then the WAD data is stored contiguously in a file on disk.
+        // In that case try to map the WAD into memory so that lumps can be accessed directly.
+        // Images with raw 2,352 byte sectors interleave sector headers and error correction data with the WAD data, so they can't be mapped.
+        //
+        // Note: WADs overriden by files in the user data dir are NOT mapped, since they might be edited or replaced while the game is running
+        // (e.g for map auto-reload). Truncating a file while it's mapped can crash the game when the missing part of the mapping is accessed.
+        // Those WADs are read into memory once instead below.
+        if (!ModMgr::isFileOverriden(file)) {
+            const DiscTrack* const pDataTrack = PsxVm::gDiscInfo.getTrack(1);
+
+            if (pDataTrack && (pDataTrack->blockSize == CDROM_SECTOR_SIZE) && (pDataTrack->blockPayloadSize == CDROM_SECTOR_SIZE)) {
+                const uint64_t fileOffset = (uint64_t) pDataTrack->fileOffset + pDataTrack->blockPayloadOffset + (uint64_t) file.startSector * CDROM_SECTOR_SIZE;
+                mMappedFile.map(pDataTrack->sourceFilePath.c_str(), fileOffset, (size_t) file.size);
+            }
+        }
+
+        // If the WAD could not be mapped then read all of it into memory in the background with a single request, instead of reading each
+        // lump separately later. The lump directory is read while that is in progress, and the read is waited on once at the end.
+        AsyncIo::FileSource fileSource;
+
+        if ((!mMappedFile.isMapped()) && (file.size <= MAX_IN_MEMORY_WAD_SIZE) && AsyncIo::getFileSource(fileId, fileSource)) {
+            mFileData.resize((size_t) file.size);
+            fileDataReadToken = AsyncIo::submitRead(fileSource, 0, file.size, mFileData.data());
+        }
+    }
+
+    // Perform all other initialization and wait for the WAD data to be read (if reading).
+    // If the read fails for some reason then fallback to reading lumps individually via the file reader.
     initAfterOpen(lumpNameRemapFn);
+
+    if ((fileDataReadToken != AsyncIo::INVALID_TOKEN) && (!AsyncIo::wait(fileDataReadToken))) {
+        mFileData.clear();
+        mFileData.shrink_to_fit();
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -123,15 +193,7 @@ void WadFile::open(const CdFileId fileId, const RemapWadLumpNameFn lumpNameRemap
 // Note: when searching the 'compressed' flag bit in the 1st byte of candidate lump names is ignored.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t WadFile::findLumpIdx(const WadLumpName lumpName, const int32_t searchStartIdx) const noexcept {
-    const int32_t numLumps = mNumLumps;
-    const WadLumpName* const pLumpNames = mLumpNames.get();
-
-    for (int32_t i = searchStartIdx; i < numLumps; ++i) {
-        if ((pLumpNames[i].word() & WAD_LUMPNAME_MASK) == lumpName.word())
-            return i;
-    }
-
-    return -1;
+    return mLumpNameIndex.findLumpIdx(lumpName, searchStartIdx);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -143,7 +205,13 @@ void WadFile::purgeCachedLump(const int32_t lumpIdx) noexcept {
     WadLump& lump = mLumps[lumpIdx];
     void* const pCachedData = lump.pCachedData;
 
-    if (pCachedData) {
+    if (lump.bIsMappedView) {
+        // Views into the memory mapped WAD file don't own any memory, just forget about the view
+        lump.pCachedData = nullptr;
+        lump.bIsUncompressed = false;
+        lump.bIsMappedView = false;
+    }
+    else if (pCachedData) {
         Z_Free2(*gpMainMemZone, pCachedData);
         ASSERT_LOG(!lump.pCachedData, "Z_Free2 should clear the pointer field pointing to the freed memory block!");
         lump.bIsUncompressed = false;
@@ -161,7 +229,12 @@ void WadFile::purgeAllLumps() noexcept {
     for (int32_t i = 0; i < numLumps; ++i) {
         void* const pCachedData = pLumps[i].pCachedData;
 
-        if (pCachedData) {
+        if (pLumps[i].bIsMappedView) {
+            pLumps[i].pCachedData = nullptr;
+            pLumps[i].bIsUncompressed = false;
+            pLumps[i].bIsMappedView = false;
+        }
+        else if (pCachedData) {
             Z_Free2(mainMemZone, pCachedData);
             ASSERT_LOG(!pLumps[i].pCachedData, "Z_Free2 should clear the pointer field pointing to the freed memory block!");
             pLumps[i].bIsUncompressed = false;
@@ -174,7 +247,7 @@ void WadFile::purgeAllLumps() noexcept {
 // If the lump is uncompressed then this will be the actual lump size.
 // If the lump is compressed then this will be the compressed size.
 //------------------------------------------------------------------------------------------------------------------------------------------
-int32_t WadFile::getRawSize(const int32_t lumpIdx) noexcept {
+int32_t WadFile::getRawSize(const int32_t lumpIdx) const noexcept {
     ASSERT(isValidLumpIdx(lumpIdx));
 
     // In most cases use the distance between the specified lump and the next one to tell the raw size.
@@ -207,11 +280,22 @@ const WadLump& WadFile::cacheLump(const int32_t lumpIdx, const int16_t allocTag,
         // The original game did not trigger this case but now with PsyDoom it's possible, so we must fix.
         if (bDecompress && (!lump.bIsUncompressed)) {
             void* const pCompressedLump = lump.pCachedData;
-            
-            Z_SetUser(pCompressedLump, nullptr); // N.B: Doing this to avoid wiping the cache entry on 'Z_Free'
-            Z_Malloc(*gpMainMemZone, lump.uncompressedSize, allocTag, &lump.pCachedData);
-            WadUtils::decompressLump(pCompressedLump, lump.pCachedData);
-            Z_Free2(*gpMainMemZone, pCompressedLump);
+
+            if (lump.bIsMappedView) {
+                // The compressed data is a view into the memory mapped WAD file: can decompress straight from it
+                lump.pCachedData = nullptr;
+                lump.bIsMappedView = false;
+                Z_Malloc(*gpMainMemZone, lump.uncompressedSize, allocTag, &lump.pCachedData);
+                decompressLumpData(lumpIdx, pCompressedLump, lump.pCachedData);
+            } else {
+                // N.B: detaching the block to avoid wiping the cache entry on 'Z_Free'.
+                // Also make sure it can't be purged by the allocation below since it no longer has an owner.
+                Z_ChangeTag(pCompressedLump, PU_STATIC);
+                Z_SetUser(pCompressedLump, nullptr);
+                Z_Malloc(*gpMainMemZone, lump.uncompressedSize, allocTag, &lump.pCachedData);
+                decompressLumpData(lumpIdx, pCompressedLump, lump.pCachedData);
+                Z_Free2(*gpMainMemZone, pCompressedLump);
+            }
 
             lump.bIsUncompressed = true;
         }
@@ -222,6 +306,27 @@ const WadLump& WadFile::cacheLump(const int32_t lumpIdx, const int16_t allocTag,
     // If we get to here then the lump is not cached and will have to be loaded.
     // Note that originally the PSX engine disallowed loading lumps during gameplay due to slow CD-ROM I/O, but PsyDoom waives this restriction.
     // This change means that levels no longer need to ship with 'MAPSPR--.IMG' and 'MAPTEX--.IMG' files and can load resources on the fly.
+    //
+    // If the WAD is memory mapped however and no decompression is needed then the lump can just be a view into the mapped file.
+    // This avoids a read, copy and zone allocation and the data can never be purged from the zone as a result.
+    //
+    // Note: some code modifies cached lump data in place (e.g the fire sky animation in 'p_firesky.cpp', which is cached in 'ti_main.cpp').
+    // For a view into the WAD data those writes go to the private copy-on-write mapping (or in-memory copy) of the WAD and never to the
+    // file itself. Unlike a zone allocation the modified data is NOT discarded when the lump is purged, so re-caching the lump later on
+    // returns the modified data rather than the original. This is fine for the fire sky, which regenerates from its unmodified bottom row.
+    const bool bIsLumpCompressed = ((uint8_t) mLumpNames[lumpIdx].chars[0] & 0x80);
+
+    if ((!bDecompress) || (!bIsLumpCompressed)) {
+        const std::byte* const pMappedData = getMappedLumpData(lumpIdx);
+
+        if (pMappedData) {
+            lump.pCachedData = (void*) pMappedData;
+            lump.bIsUncompressed = (!bIsLumpCompressed);
+            lump.bIsMappedView = true;
+            return lump;
+        }
+    }
+
     int32_t sizeToRead;
 
     if (bDecompress) {
@@ -233,10 +338,11 @@ const WadLump& WadFile::cacheLump(const int32_t lumpIdx, const int16_t allocTag,
     // Alloc RAM for the lump and read it
     Z_Malloc(*gpMainMemZone, sizeToRead, allocTag, &lump.pCachedData);
     readLump(lumpIdx, lump.pCachedData, bDecompress);
+    lump.bIsMappedView = false;
 
     // Save whether the lump is compressed or not.
     // If the lump is compressed then the highest bit of the first character in the name will be set:
-    if ((uint8_t) mLumpNames[lumpIdx].chars[0] & 0x80) {
+    if (bIsLumpCompressed) {
         lump.bIsUncompressed = bDecompress;
     } else {
         lump.bIsUncompressed = true;
@@ -261,14 +367,26 @@ void WadFile::readLump(const int32_t lumpIdx, void* const pDest, const bool bDec
     const uint32_t sizeToRead = getRawSize(lumpIdx);
     const bool bIsLumpCompressed = ((uint8_t) lumpName.chars[0] & 0x80u);
 
+    // If the WAD is memory mapped then copy or decompress straight from the mapped file
+    const std::byte* const pMappedData = getMappedLumpData(lumpIdx);
+
+    if (pMappedData) {
+        if (bDecompress && bIsLumpCompressed) {
+            decompressLumpData(lumpIdx, pMappedData, pDest);
+        } else {
+            std::memcpy(pDest, pMappedData, sizeToRead);
+        }
+
+        return;
+    }
+
     if (bDecompress && bIsLumpCompressed) {
         // Decompression needed, must alloc a temp buffer for the compressed data before reading and decompressing!
         void* const pTmpBuffer = Z_EndMalloc(*gpMainMemZone, sizeToRead, PU_STATIC, nullptr);
 
         mFileReader.seekAbsolute(lump.wadFileOffset);
         mFileReader.read(pTmpBuffer, sizeToRead);
-        ASSERT(WadUtils::getDecompressedLumpSize(pTmpBuffer) == lump.uncompressedSize);   // Sanity check the WAD data in debug mode
-        WadUtils::decompressLump(pTmpBuffer, pDest);
+        decompressLumpData(lumpIdx, pTmpBuffer, pDest);
 
         Z_Free2(*gpMainMemZone, pTmpBuffer);
     } else {
@@ -278,6 +396,61 @@ void WadFile::readLump(const int32_t lumpIdx, void* const pDest, const bool bDec
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// If the WAD file is memory mapped (or read entirely into memory) then this returns a pointer to the raw data for the given lump within the file data.
+// Returns 'nullptr' if the WAD is not in memory, if the lump is not within the file or if it's data is not suitably aligned for direct use.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::byte* WadFile::getMappedLumpData(const int32_t lumpIdx) const noexcept {
+    ASSERT(isValidLumpIdx(lumpIdx));
+
+    const std::byte* pFileData = nullptr;
+    uint64_t fileDataSize = 0;
+
+    if (!mFileData.empty()) {
+        pFileData = mFileData.data();
+        fileDataSize = mFileData.size();
+    } else if (mMappedFile.isMapped()) {
+        pFileData = mMappedFile.getData();
+        fileDataSize = mMappedFile.getSize();
+    } else {
+        return nullptr;
+    }
+
+    // Note: require the same 4-byte alignment that the original PSX zone allocator gave lumps, since lump data is often cast to structs
+    const int32_t lumpOffset = mLumps[lumpIdx].wadFileOffset;
+    const int32_t rawSize = getRawSize(lumpIdx);
+
+    if ((lumpOffset < 0) || ((uint64_t) lumpOffset + (uint64_t) rawSize > fileDataSize))
+        return nullptr;
+
+    const std::byte* const pLumpData = pFileData + lumpOffset;
+    return ((uintptr_t) pLumpData % 4 == 0) ? pLumpData : nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses the given compressed data for the specified lump into the given buffer, which must be big enough for the decompressed lump.
+// Larger lumps are loaded from the on-disk decompressed lump cache if possible, and saved to it after decompression otherwise.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadFile::decompressLumpData(const int32_t lumpIdx, const void* const pCompressedData, void* const pDest) noexcept {
+    ASSERT(isValidLumpIdx(lumpIdx));
+
+    const int32_t compressedSize = getRawSize(lumpIdx);
+    const int32_t uncompressedSize = mLumps[lumpIdx].uncompressedSize;
+    const bool bUseLumpCache = DecompressedLumpCache::shouldCacheLump(uncompressedSize);
+
+    if (bUseLumpCache) {
+        if (DecompressedLumpCache::readLump(mContentHash, lumpIdx, pCompressedData, compressedSize, pDest, uncompressedSize))
+            return;
+    }
+
+    ASSERT(WadUtils::getDecompressedLumpSize(pCompressedData) == uncompressedSize);   // Sanity check the WAD data in debug mode
+    WadUtils::decompressLump(pCompressedData, pDest, (size_t) uncompressedSize);
+
+    if (bUseLumpCache) {
+        DecompressedLumpCache::writeLump(mContentHash, lumpIdx, pCompressedData, compressedSize, pDest, uncompressedSize);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Performs WAD initialization after the file has been opened
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -306,6 +479,16 @@ void WadFile::readLumpInfo(const RemapWadLumpNameFn lumpNameRemapFn) noexcept {
     mFileReader.seekAbsolute(wadHdr.lumpHdrsOffset);
     mFileReader.read(lumpHdrs.get(), wadHdr.numLumps * sizeof(WadLumpHdr));
 
+    // Identify the WAD contents for the decompressed lump cache by hashing the header, lump directory and file size.
+    // Any cached lump data is also checked against the actual compressed data in the WAD, so this doesn't need to be a full hash of the file.
+    {
+        MD5 md5Hasher;
+        md5Hasher.add(&wadHdr, sizeof(wadHdr));
+        md5Hasher.add(lumpHdrs.get(), wadHdr.numLumps * sizeof(WadLumpHdr));
+        md5Hasher.add(&mSizeInBytes, sizeof(mSizeInBytes));
+        md5Hasher.getHash(mContentHash.md5);
+    }
+
     // Setup the list of lump names and lumps using the lump headers
     mNumLumps = wadHdr.numLumps;
     mLumpNames.reset(new WadLumpName[wadHdr.numLumps]);
@@ -332,4 +515,13 @@ void WadFile::readLumpInfo(const RemapWadLumpNameFn lumpNameRemapFn) noexcept {
         lump.wadFileOffset = lumpHdr.wadFileOffset;
         lump.uncompressedSize = lumpHdr.uncompressedSize;
     }
+
+    // Build the index used to find lumps by name: the 'compressed' flag bit is ignored when searching
+    std::unique_ptr<WadLumpName[]> searchLumpNames(new WadLumpName[wadHdr.numLumps]);
+
+    for (int32_t i = 0; i < wadHdr.numLumps; ++i) {
+        searchLumpNames[i] = mLumpNames[i].word() & WAD_LUMPNAME_MASK;
+    }
+
+    mLumpNameIndex.build(searchLumpNames.get(), wadHdr.numLumps);
 }
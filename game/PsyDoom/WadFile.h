@@ -1,11 +1,15 @@
 #pragma once
 
 #include "Asserts.h"
+#include "DecompressedLumpCache.h"
 #include "Endian.h"
 #include "GameFileReader.h"
+#include "MappedFile.h"
 #include "SmallString.h"
+#include "WadLumpNameIndex.h"
 
 #include <memory>
+#include <vector>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Holds details about one lump in a wad file (except for the name)
@@ -13,6 +17,7 @@
 struct WadLump {
     void*       pCachedData;            // The data for the lump cached into memory, if 'nullptr' then the lump has not been loaded yet.
     bool        bIsUncompressed;        // Only has meaning if the lump is cached. If 'true' then the cached data is uncompressed, otherwise it is compressed.
+    bool        bIsMappedView;          // Only has meaning if the lump is cached. If 'true' then the cached data points into the memory mapped WAD file and is not a zone allocation.
     int32_t     wadFileOffset;          // Offset of the lump in the WAD file.
     int32_t     uncompressedSize;       // Original size of the lump in bytes, before any compression.
 };
@@ -72,7 +77,7 @@ public:
 
     void purgeCachedLump(const int32_t lumpIdx) noexcept;
     void purgeAllLumps() noexcept;
-    int32_t getRawSize(const int32_t lumpIdx) noexcept;
+    int32_t getRawSize(const int32_t lumpIdx) const noexcept;
     const WadLump& cacheLump(const int32_t lumpIdx, const int16_t allocTag, const bool bDecompress) noexcept;
     void readLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept;
 
@@ -83,10 +88,16 @@ private:
 
     void initAfterOpen(const RemapWadLumpNameFn lumpNameRemapFn) noexcept;
     void readLumpInfo(const RemapWadLumpNameFn lumpNameRemapFn) noexcept;
+    const std::byte* getMappedLumpData(const int32_t lumpIdx) const noexcept;
+    void decompressLumpData(const int32_t lumpIdx, const void* const pCompressedData, void* const pDest) noexcept;
 
     int32_t                         mNumLumps;          // The number of lumps in the WAD
     int32_t                         mSizeInBytes;       // The total size (in bytes) of the entire WAD file
+    WadContentHash                  mContentHash;       // Hash of the WAD header and lump directory, identifies the WAD in the decompressed lump cache
     std::unique_ptr<WadLumpName[]>  mLumpNames;         // Store names in their own list for cache-friendly search
     std::unique_ptr<WadLump[]>      mLumps;             // The details and data for each lump
     GameFileReader                  mFileReader;        // Responsible for reading from the WAD file
+    MappedFile                      mMappedFile;        // If the WAD is a user WAD file or is stored contiguously in a disc image then this maps it into memory for direct access
+    std::vector<std::byte>          mFileData;          // If the entire WAD was read into memory (preloaded, or because it could not be mapped) then this holds its data
+    WadLumpNameIndex                mLumpNameIndex;     // Used to quickly find lumps by name
 };
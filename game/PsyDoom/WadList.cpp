@@ -6,6 +6,7 @@
 WadList::WadList() noexcept
     : mWadFiles()
     , mLumpHandles()
+    , mLumpNameIndex()
 {
 }
 
@@ -59,12 +60,23 @@ void WadList::finalize() noexcept {
             mLumpHandles.push_back({ wadFileIndex, lumpIdx, lumpName.word() & WAD_LUMPNAME_MASK });     // Note: remove the special 'compressed' flag bit to make later search a bit faster
         }
     }
+
+    // Build the index used to find lumps by name
+    std::vector<WadLumpName> lumpNames;
+    lumpNames.reserve(totalLumps);
+
+    for (const LumpHandle& lumpHandle : mLumpHandles) {
+        lumpNames.push_back(lumpHandle.name);
+    }
+
+    mLumpNameIndex.build(lumpNames.data(), (int32_t) lumpNames.size());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Clears the WAD list and unloads all WADs
 //------------------------------------------------------------------------------------------------------------------------------------------
 void WadList::clear() noexcept {
+    mLumpNameIndex.clear();
     mLumpHandles.clear();
     mWadFiles.clear();
 }
@@ -75,15 +87,7 @@ void WadList::clear() noexcept {
 // Note: when searching the 'compressed' flag bit in the 1st byte of candidate lump names is ignored.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t WadList::findLumpIdx(const WadLumpName lumpName, const int32_t searchStartIdx) const noexcept {
-    const int32_t numLumps = (int32_t) mLumpHandles.size();
-    const LumpHandle* const pLumpHandles = mLumpHandles.data();
-
-    for (int32_t i = searchStartIdx; i < numLumps; ++i) {
-        if (pLumpHandles[i].name.word() == lumpName.word())
-            return i;
-    }
-
-    return -1;
+    return mLumpNameIndex.findLumpIdx(lumpName, searchStartIdx);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -45,4 +45,5 @@ private:
 
     std::vector<WadFile>        mWadFiles;
     std::vector<LumpHandle>     mLumpHandles;
+    WadLumpNameIndex            mLumpNameIndex;     // Used to quickly find lumps by name
 };
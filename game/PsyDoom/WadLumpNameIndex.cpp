@@ -0,0 +1,129 @@
+#include "WadLumpNameIndex.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates an empty index
+//------------------------------------------------------------------------------------------------------------------------------------------
+WadLumpNameIndex::WadLumpNameIndex() noexcept
+    : mHashShift(64)
+    , mHashSlots()
+    , mNameEntries()
+    , mChainLumpIdxs()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the index for the given list of lump names.
+// The names are expected to have the special 'compressed' flag bit removed already.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadLumpNameIndex::build(const String8* const pLumpNames, const int32_t numLumps) noexcept {
+    clear();
+
+    if (numLumps <= 0)
+        return;
+
+    // Use a power of two number of hash slots that is at least twice the number of lumps, to keep probe sequences short
+    uint32_t numHashSlots = 16;
+    mHashShift = 60;
+
+    while (numHashSlots < (uint32_t) numLumps * 2) {
+        numHashSlots *= 2;
+        mHashShift--;
+    }
+
+    mHashSlots.resize(numHashSlots, -1);
+    mNameEntries.reserve(numLumps);
+    mChainLumpIdxs.resize(numLumps);
+
+    // Assign each lump to the entry for it's name and count how many lumps use each name
+    std::vector<int32_t> lumpNameEntryIdxs(numLumps);
+
+    for (int32_t lumpIdx = 0; lumpIdx < numLumps; ++lumpIdx) {
+        const String8 lumpName = pLumpNames[lumpIdx];
+        uint32_t slotIdx = getHashSlotIdx(lumpName);
+
+        while ((mHashSlots[slotIdx] >= 0) && (mNameEntries[mHashSlots[slotIdx]].name.word() != lumpName.word())) {
+            slotIdx = (slotIdx + 1) & (numHashSlots - 1);
+        }
+
+        if (mHashSlots[slotIdx] < 0) {
+            mHashSlots[slotIdx] = (int32_t) mNameEntries.size();
+            mNameEntries.push_back({ lumpName, 0, 0 });
+        }
+
+        const int32_t entryIdx = mHashSlots[slotIdx];
+        lumpNameEntryIdxs[lumpIdx] = entryIdx;
+        mNameEntries[entryIdx].chainLength++;
+    }
+
+    // Figure out where each chain starts and then fill in the chains.
+    // Lumps are visited in order, so the lump indexes in each chain will be in ascending order.
+    int32_t nextChainStartIdx = 0;
+
+    for (NameEntry& entry : mNameEntries) {
+        entry.chainStartIdx = nextChainStartIdx;
+        nextChainStartIdx += entry.chainLength;
+        entry.chainLength = 0;
+    }
+
+    for (int32_t lumpIdx = 0; lumpIdx < numLumps; ++lumpIdx) {
+        NameEntry& entry = mNameEntries[lumpNameEntryIdxs[lumpIdx]];
+        mChainLumpIdxs[entry.chainStartIdx + entry.chainLength] = lumpIdx;
+        entry.chainLength++;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clears the index
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadLumpNameIndex::clear() noexcept {
+    mHashShift = 64;
+    mHashSlots.clear();
+    mNameEntries.clear();
+    mChainLumpIdxs.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the index of the first lump with the specified name at or after the specified lump index.
+// If not found then '-1' will be returned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t WadLumpNameIndex::findLumpIdx(const String8 lumpName, const int32_t searchStartIdx) const noexcept {
+    if (mHashSlots.empty())
+        return -1;
+
+    // Find the entry for the lump name, if there is one
+    const uint32_t slotMask = (uint32_t) mHashSlots.size() - 1;
+    uint32_t slotIdx = getHashSlotIdx(lumpName);
+
+    while (true) {
+        const int32_t entryIdx = mHashSlots[slotIdx];
+
+        if (entryIdx < 0)
+            return -1;
+
+        const NameEntry& entry = mNameEntries[entryIdx];
+
+        if (entry.name.word() == lumpName.word()) {
+            // Found the name: return the first lump in the chain at or after the search start index
+            const int32_t* const pChainBeg = mChainLumpIdxs.data() + entry.chainStartIdx;
+            const int32_t* const pChainEnd = pChainBeg + entry.chainLength;
+
+            if (searchStartIdx <= *pChainBeg)
+                return *pChainBeg;
+
+            const int32_t* const pLumpIdx = std::lower_bound(pChainBeg, pChainEnd, searchStartIdx);
+            return (pLumpIdx != pChainEnd) ? *pLumpIdx : -1;
+        }
+
+        slotIdx = (slotIdx + 1) & slotMask;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns which hash slot to start searching at for the given lump name
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t WadLumpNameIndex::getHashSlotIdx(const String8 lumpName) const noexcept {
+    // Fibonacci hashing: use the top bits of the name multiplied by 2^64 divided by the golden ratio
+    return (uint32_t)((lumpName.word() * 0x9E3779B97F4A7C15ull) >> mHashShift);
+}
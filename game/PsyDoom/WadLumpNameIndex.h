@@ -0,0 +1,35 @@
+#pragma once
+
+#include "SmallString.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A hash index used to quickly find lumps by name in a WAD file or list of WAD files.
+// Uses open addressing to map each unique lump name to a chain of the lump indexes using that name, in ascending order.
+// This allows searches to start from any lump index and still return the same result as a linear search through the lump names.
+// Note: lump names are 'String8' (i.e 'WadLumpName') and are expected to have the special 'compressed' flag bit removed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class WadLumpNameIndex {
+public:
+    WadLumpNameIndex() noexcept;
+
+    void build(const String8* const pLumpNames, const int32_t numLumps) noexcept;
+    void clear() noexcept;
+    int32_t findLumpIdx(const String8 lumpName, const int32_t searchStartIdx) const noexcept;
+
+private:
+    // Details for a unique lump name: where it's chain of lump indexes is located
+    struct NameEntry {
+        String8         name;
+        int32_t         chainStartIdx;
+        int32_t         chainLength;
+    };
+
+    uint32_t getHashSlotIdx(const String8 lumpName) const noexcept;
+
+    uint32_t                mHashShift;         // How much to shift a 64-bit hash by to get a slot index
+    std::vector<int32_t>    mHashSlots;         // Index of the name entry in each hash slot, or '-1' if the slot is empty
+    std::vector<NameEntry>  mNameEntries;       // Details for each unique lump name
+    std::vector<int32_t>    mChainLumpIdxs;     // The chains of lump indexes for each lump name, stored one after the other
+};
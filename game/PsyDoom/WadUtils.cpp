@@ -3,59 +3,136 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "WadUtils.h"
 
+#include <cstring>
+
 BEGIN_NAMESPACE(WadUtils)
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses LZSS data starting at an id byte until the end of stream marker is reached.
+// Only ever writes the exact bytes of decompressed output.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decompressLumpExact(const uint8_t* pSrcByte, uint8_t* pDstByte) noexcept {
+    while (true) {
+        // Each id byte controls the next 8 runs of data: a '0' bit means a literal byte and a '1' bit means a run of repeated data.
+        // If there are 8 literal bytes in a row (common for noisy texture data) then copy them all at once.
+        uint32_t idByte = *pSrcByte;
+        ++pSrcByte;
+
+        if (idByte == 0) {
+            std::memcpy(pDstByte, pSrcByte, 8);
+            pSrcByte += 8;
+            pDstByte += 8;
+            continue;
+        }
+
+        for (uint32_t bitsLeft = 8; bitsLeft > 0; --bitsLeft, idByte >>= 1) {
+            if ((idByte & 1) == 0) {
+                // Uncompressed data: just copy the input byte
+                *pDstByte = *pSrcByte;
+                ++pSrcByte;
+                ++pDstByte;
+                continue;
+            }
+
+            // Compressed data ahead: the first 12-bits tells where to take repeated data from.
+            // The remaining 4-bits tell how many bytes of repeated data to take.
+            const uint32_t srcByte1 = pSrcByte[0];
+            const uint32_t srcByte2 = pSrcByte[1];
+            pSrcByte += 2;
+
+            const uint32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
+            const uint32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
+
+            // A value of '1' is a special value and means we have reached the end of the compressed stream
+            if (numRepeatedBytes == 1)
+                return;
+
+            // Note: if the repeated bytes overlap the output then they must be copied one at a time, since they repeat a pattern
+            const uint8_t* const pRepeatedBytes = pDstByte - srcOffset;
+
+            if (srcOffset >= numRepeatedBytes) {
+                std::memcpy(pDstByte, pRepeatedBytes, numRepeatedBytes);
+            } else {
+                for (uint32_t i = 0; i < numRepeatedBytes; ++i) {
+                    pDstByte[i] = pRepeatedBytes[i];
+                }
+            }
+
+            pDstByte += numRepeatedBytes;
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Decompresses the given compressed lump data into the given output buffer.
 // The compression algorithm used is a form of LZSS.
 // Assumes the output buffer is sized big enough to hold all of the decompressed data.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void decompressLump(const void* const pSrc, void* const pDst) noexcept {
+    decompressLumpExact((const uint8_t*) pSrc, (uint8_t*) pDst);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Faster version of 'decompressLump' for when the size of the output buffer is known, which must be big enough for the decompressed data.
+// Knowing the buffer size allows runs of repeated data to be copied in fixed 16 byte chunks while far enough away from the end of the buffer,
+// writing some garbage bytes past the end of the run which are overwritten by later output.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void decompressLump(const void* const pSrc, void* const pDst, const size_t dstBufferSize) noexcept {
+    // Chunked copies are safe while there is room for 8 runs of 16 bytes, plus the 16 byte overshoot from chunked copying the last run
+    constexpr size_t SAFETY_MARGIN = 8 * 16 + 16;
+
     const uint8_t* pSrcByte = (const uint8_t*) pSrc;
     uint8_t* pDstByte = (uint8_t*) pDst;
+    const uint8_t* const pDstSafeEnd = pDstByte + ((dstBufferSize > SAFETY_MARGIN) ? dstBufferSize - SAFETY_MARGIN : 0);
 
-    uint32_t idByte = 0;        // Controls whether there is compressed or uncompressed data ahead
-    uint32_t haveIdByte = 0;    // Controls when to read an id byte, when '0' we need to read another one
+    while (pDstByte < pDstSafeEnd) {
+        uint32_t idByte = *pSrcByte;
+        ++pSrcByte;
 
-    while (true) {
-        // Read the id byte if required.
-        // We need 1 id byte for every 8 bytes of uncompressed output, or every 8 runs of compressed data.
-        if (haveIdByte == 0) {
-            idByte = *pSrcByte;
-            ++pSrcByte;
+        if (idByte == 0) {
+            std::memcpy(pDstByte, pSrcByte, 8);
+            pSrcByte += 8;
+            pDstByte += 8;
+            continue;
         }
 
-        haveIdByte = (haveIdByte + 1) & 7;
+        for (uint32_t bitsLeft = 8; bitsLeft > 0; --bitsLeft, idByte >>= 1) {
+            if ((idByte & 1) == 0) {
+                *pDstByte = *pSrcByte;
+                ++pSrcByte;
+                ++pDstByte;
+                continue;
+            }
 
-        if (idByte & 1) {
-            // Compressed data ahead: the first 12-bits tells where to take repeated data from.
-            // The remaining 4-bits tell how many bytes of repeated data to take.
             const uint32_t srcByte1 = pSrcByte[0];
             const uint32_t srcByte2 = pSrcByte[1];
             pSrcByte += 2;
 
-            const int32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
-            const int32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
+            const uint32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
+            const uint32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
 
-            // A value of '1' is a special value and means we have reached the end of the compressed stream
             if (numRepeatedBytes == 1)
-                break;
+                return;
 
+            // Runs are at most 16 bytes, so two 8 byte copies will always cover them.
+            // This also works for overlapping runs which repeat a pattern, provided the pattern is at least 8 bytes long.
             const uint8_t* const pRepeatedBytes = pDstByte - srcOffset;
 
-            for (int32_t i = 0; i < numRepeatedBytes; ++i) {
-                *pDstByte = pRepeatedBytes[i];
-                ++pDstByte;
+            if (srcOffset >= 8) {
+                std::memcpy(pDstByte, pRepeatedBytes, 8);
+                std::memcpy(pDstByte + 8, pRepeatedBytes + 8, 8);
+            } else {
+                for (uint32_t i = 0; i < numRepeatedBytes; ++i) {
+                    pDstByte[i] = pRepeatedBytes[i];
+                }
             }
-        } else {
-            // Uncompressed data: just copy the input byte
-            *pDstByte = *pSrcByte;
-            ++pSrcByte;
-            ++pDstByte;
-        }
 
-        idByte >>= 1;
+            pDstByte += numRepeatedBytes;
+        }
     }
+
+    // Finish up near the end of the output buffer, where only the exact output bytes can be written
+    decompressLumpExact(pSrcByte, pDstByte);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -5,6 +5,7 @@
 BEGIN_NAMESPACE(WadUtils)
 
 void decompressLump(const void* const pSrc, void* const pDst) noexcept;
+void decompressLump(const void* const pSrc, void* const pDst, const size_t dstBufferSize) noexcept;
 int32_t getDecompressedLumpSize(const void* const pSrc) noexcept;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
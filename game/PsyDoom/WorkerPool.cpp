@@ -0,0 +1,175 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom worker pool: a small set of persistent background threads which can be used to split up independent pieces of work.
+// The calling thread always takes part in the work, and calls to 'parallelFor' do not return until all items have been processed.
+// If the pool is not initialized or there is only 1 CPU available then all work is simply done on the calling thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "WorkerPool.h"
+
+#include "Asserts.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+BEGIN_NAMESPACE(WorkerPool)
+
+// The maximum number of background threads to create
+static constexpr uint32_t MAX_BACKGROUND_THREADS = 15;
+
+// How many items a worker grabs at a time from the current job
+static constexpr uint32_t ITEMS_PER_GRAB = 4;
+
+static std::vector<std::thread>     gThreads;               // The background threads in the pool
+static std::mutex                   gMutex;                 // Mutex guarding the job start/finish signalling below
+static std::condition_variable      gJobStartCond;          // Signalled when a new job is available or when the pool is shutting down
+static std::condition_variable      gJobDoneCond;           // Signalled when the last background thread has finished its part of the current job
+static uint32_t                     gJobGeneration;         // Incremented every time a new job is started
+static uint32_t                     gNumThreadsBusy;        // How many background threads are still working on the current job
+static bool                         gbShutdown;             // Set when the pool is shutting down
+
+// The current job
+static const ItemFunc*              gpJobItemFunc;
+static uint32_t                     gJobNumItems;
+static std::atomic<uint32_t>        gJobNextItemIdx;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Process items in the current job until there are none left
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void doJobItems(const uint32_t workerIdx) noexcept {
+    const ItemFunc& itemFunc = *gpJobItemFunc;
+    const uint32_t numItems = gJobNumItems;
+
+    while (true) {
+        const uint32_t startItemIdx = gJobNextItemIdx.fetch_add(ITEMS_PER_GRAB, std::memory_order_relaxed);
+
+        if (startItemIdx >= numItems)
+            break;
+
+        const uint32_t endItemIdx = std::min(startItemIdx + ITEMS_PER_GRAB, numItems);
+
+        for (uint32_t itemIdx = startItemIdx; itemIdx < endItemIdx; ++itemIdx) {
+            itemFunc(itemIdx, workerIdx);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for a background thread in the pool
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void workerThreadMain(const uint32_t workerIdx) noexcept {
+    uint32_t lastJobGeneration = 0;
+
+    while (true) {
+        // Wait for a new job or shutdown
+        {
+            std::unique_lock lock(gMutex);
+            gJobStartCond.wait(lock, [&]() noexcept { return (gbShutdown || (gJobGeneration != lastJobGeneration)); });
+
+            if (gbShutdown)
+                return;
+
+            lastJobGeneration = gJobGeneration;
+        }
+
+        // Do our part of the job then signal if we were the last background thread to finish
+        doJobItems(workerIdx);
+
+        {
+            std::lock_guard lock(gMutex);
+            ASSERT(gNumThreadsBusy > 0);
+            gNumThreadsBusy--;
+
+            if (gNumThreadsBusy == 0) {
+                gJobDoneCond.notify_one();
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Start up the background threads in the pool: one less than the number of CPUs, since the calling thread also does work
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init() noexcept {
+    ASSERT(gThreads.empty());
+
+    const uint32_t numCpus = std::max(std::thread::hardware_concurrency(), 1u);
+    const uint32_t numBackgroundThreads = std::min(numCpus - 1, MAX_BACKGROUND_THREADS);
+    gbShutdown = false;
+    gJobGeneration = 0;
+    gNumThreadsBusy = 0;
+
+    try {
+        gThreads.reserve(numBackgroundThreads);
+
+        for (uint32_t i = 0; i < numBackgroundThreads; ++i) {
+            gThreads.emplace_back(workerThreadMain, i + 1);
+        }
+    } catch (...) {
+        // Couldn't create one or more threads: just make do with the threads we did manage to create
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stop and cleanup all background threads in the pool
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    {
+        std::lock_guard lock(gMutex);
+        gbShutdown = true;
+    }
+
+    gJobStartCond.notify_all();
+
+    for (std::thread& thread : gThreads) {
+        thread.join();
+    }
+
+    gThreads.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the number of workers that 'parallelFor' splits work across, including the calling thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t getNumWorkers() noexcept {
+    return (uint32_t) gThreads.size() + 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Calls the given function for every item index from '0' to 'numItems - 1', splitting the work across all the workers in the pool.
+// The order in which items are processed is undefined, so the function must not depend on it.
+// Returns once all items have been processed. Should only be called from one thread at a time and must not be called recursively.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void parallelFor(const uint32_t numItems, const ItemFunc& itemFunc) noexcept {
+    // If there are no background threads or not enough items to split up then just do the work on this thread
+    if (gThreads.empty() || (numItems <= ITEMS_PER_GRAB)) {
+        for (uint32_t itemIdx = 0; itemIdx < numItems; ++itemIdx) {
+            itemFunc(itemIdx, 0);
+        }
+
+        return;
+    }
+
+    // Kick off the job for the background threads
+    {
+        std::lock_guard lock(gMutex);
+        gpJobItemFunc = &itemFunc;
+        gJobNumItems = numItems;
+        gJobNextItemIdx.store(0, std::memory_order_relaxed);
+        gNumThreadsBusy = (uint32_t) gThreads.size();
+        gJobGeneration++;
+    }
+
+    gJobStartCond.notify_all();
+
+    // Do our share of the work and wait for the background threads to finish theirs
+    doJobItems(0);
+
+    std::unique_lock lock(gMutex);
+    gJobDoneCond.wait(lock, []() noexcept { return (gNumThreadsBusy == 0); });
+    gpJobItemFunc = nullptr;
+}
+
+END_NAMESPACE(WorkerPool)
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+#include <functional>
+
+BEGIN_NAMESPACE(WorkerPool)
+
+// Signature for a function which processes one item of a parallel job.
+// Receives the index of the item to process and the index of the worker processing it; the worker index is in the range
+// '0' to 'getNumWorkers() - 1' and can be used to index per-worker scratch data. Worker '0' is always the calling thread.
+typedef std::function<void (const uint32_t itemIdx, const uint32_t workerIdx)> ItemFunc;
+
+void init() noexcept;
+void shutdown() noexcept;
+uint32_t getNumWorkers() noexcept;
+void parallelFor(const uint32_t numItems, const ItemFunc& itemFunc) noexcept;
+
+END_NAMESPACE(WorkerPool)
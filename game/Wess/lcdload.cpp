@@ -9,6 +9,7 @@
 #include "Doom/Game/p_setup.h"
 #include "Finally.h"
 #include "psxspu.h"
+#include "PsyDoom/AsyncIo.h"
 #include "PsyDoom/ProgArgs.h"
 #include "PsyQ/LIBSPU.h"
 #include "wessapi.h"
@@ -16,6 +17,7 @@
 
 #include <cstdio>
 #include <cstring>
+#include <vector>
 
 // Maximum number of sounds that can be in an LCD file
 static constexpr uint32_t MAX_LCD_SOUNDS = 100;
@@ -264,16 +266,41 @@ int32_t wess_dig_lcd_load(
     // Clear this error flag
     gbWess_lcd_load_abort = false;
 
-    // Open the LCD file firstly and abort if that fails or the file handle returned is invalid
-    PsxCd_File* const pLcdFile = psxcd_open(lcdFileToLoad);
+    // If the LCD file was already preloaded in the background (e.g by the map prefetcher, or ahead of time by the sound loading code) then
+    // read from that data.
+    // Otherwise open the LCD file and abort if that fails or the file handle returned is invalid.
+    std::vector<std::byte> preloadedLcdData;
+    const bool bUsePreloadedData = AsyncIo::takePreloadedFile(lcdFileToLoad, preloadedLcdData);
+    PsxCd_File* pLcdFile = nullptr;
 
-    if (!pLcdFile)
-        return 0;
+    if (!bUsePreloadedData) {
+        pLcdFile = psxcd_open(lcdFileToLoad);
+
+        if (!pLcdFile)
+            return 0;
+    }
 
     auto closeLcdFileOnExit = finally([&]() noexcept {
-        psxcd_close(*pLcdFile);
+        if (pLcdFile) {
+            psxcd_close(*pLcdFile);
+        }
     });
 
+    const int32_t lcdFileSize = (bUsePreloadedData) ? (int32_t) preloadedLcdData.size() : pLcdFile->size;
+    int32_t preloadedLcdDataOffset = 0;
+
+    const auto readLcdData = [&](void* const pDest, const int32_t numBytes) noexcept {
+        if (!bUsePreloadedData)
+            return psxcd_read(pDest, numBytes, *pLcdFile);
+
+        if (preloadedLcdDataOffset + numBytes > lcdFileSize)
+            return -1;
+
+        std::memcpy(pDest, preloadedLcdData.data() + preloadedLcdDataOffset, (size_t) numBytes);
+        preloadedLcdDataOffset += numBytes;
+        return numBytes;
+    };
+
     // Read the LCD file header to sector buffer 1
     struct LCDHeader {
         uint16_t    numPatchSamples;
@@ -282,7 +309,7 @@ int32_t wess_dig_lcd_load(
 
     LCDHeader* const pLcdHeader = (LCDHeader*) gWess_sectorBuffer1;
 
-    if (psxcd_read(pLcdHeader, sizeof(LCDHeader), *pLcdFile) != sizeof(LCDHeader))
+    if (readLcdData(pLcdHeader, sizeof(LCDHeader)) != sizeof(LCDHeader))
         return 0;
 
     // If the number of sounds is not valid then abort
@@ -299,19 +326,23 @@ int32_t wess_dig_lcd_load(
     gWess_lcd_load_soundBytesLeft = 0;
 
     // Seek to the first sound data sector in the file and continue reading sound data until we are done
-    if (psxcd_seek(*pLcdFile, CDROM_SECTOR_SIZE, PsxCd_SeekMode::SET) != 0)
-        return 0;
+    if (bUsePreloadedData) {
+        preloadedLcdDataOffset = CDROM_SECTOR_SIZE;
+    } else {
+        if (psxcd_seek(*pLcdFile, CDROM_SECTOR_SIZE, PsxCd_SeekMode::SET) != 0)
+            return 0;
+    }
 
     // Read all of the sound data and upload to the SPU using sector buffer 2 as a temporary.
     // Note: we've already consumed 1 sector from the file, so the byte count left is adjusted accordingly.
-    int32_t lcdBytesLeft = pLcdFile->size - CDROM_SECTOR_SIZE;
+    int32_t lcdBytesLeft = lcdFileSize - CDROM_SECTOR_SIZE;
     int32_t numSpuBytesWritten = 0;
 
     while ((lcdBytesLeft > 0) && (!gbWess_lcd_load_abort)) {
         // Read this sector from the LCD file and the number of bytes left is smaller then read that amount instead
         uint8_t* const sectorBuffer = gWess_sectorBuffer2;
         const int32_t readSize = (lcdBytesLeft < CDROM_SECTOR_SIZE) ? lcdBytesLeft : CDROM_SECTOR_SIZE;
-        psxcd_read(sectorBuffer, readSize, *pLcdFile);
+        readLcdData(sectorBuffer, readSize);
 
         if (readSize < CDROM_SECTOR_SIZE) {
             // When we are not filling part of the buffer then zero it out just for consistency
@@ -18,8 +18,13 @@
 #include "PsyDoom/Utils.h"
 #include "Spu.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <mutex>
+#include <thread>
 
 // PsyDoom: raise the open file limit
 #if PSYDOOM_MODS
@@ -28,8 +33,14 @@
     static constexpr int32_t MAX_OPEN_FILES = 4;    // Maximum number of open files
 #endif
 
-static constexpr int32_t FADE_TIME_MS       = 250;      // Time it takes to fade out CD audio (milliseconds)
-static constexpr int32_t CDDA_SECTOR_SIZE   = 2352;     // Size of of a CD digital audio sector
+static constexpr int32_t FADE_TIME_MS           = 250;      // Time it takes to fade out CD audio (milliseconds)
+static constexpr int32_t CDDA_SECTOR_SIZE       = 2352;     // Size of of a CD digital audio sector
+static constexpr int32_t CDDA_SECTOR_SAMPLES    = CDDA_SECTOR_SIZE / sizeof(int16_t);   // Number of 16-bit samples (left + right) in a CD digital audio sector
+static constexpr uint32_t STREAM_NUM_SECTORS    = 32;       // How many CD audio sectors the streaming ring buffer holds (~0.43 seconds): must be a power of 2
+static constexpr uint32_t STREAM_PRIME_SECTORS  = 4;        // How many sectors to read synchronously when starting playback, so it can begin without a gap
+static constexpr uint32_t STREAM_GEN_MASK       = 0xFFFFFF; // Mask for the part of the stream generation which is packed into the playback position
+
+static_assert((STREAM_NUM_SECTORS & (STREAM_NUM_SECTORS - 1)) == 0);
 
 // If true then the 'psxcd' module has been initialized
 static bool gbPSXCD_IsCdInit;
@@ -38,29 +49,59 @@ static bool gbPSXCD_IsCdInit;
 static PsxCd_File gPSXCD_cdfile;
 
 // CD audio playback related state.
-// Access to all of this is controlled by the CD player mutex.
+// Access to all of this is controlled by the CD player mutex, which is never touched by the SPU audio thread.
 static struct {
     DiscReader  discReader          = { PsxVm::gDiscInfo };     // The disc reader used to stream the audio
-    bool        bPlay               = false;                    // If 'false' then playback is either paused or stopped (stopped if the disc reader doesn't have a track)
     bool        bLoop               = false;                    // If 'true' then playback is looped upon reaching the end
-    int32_t     bufferOffset        = 0;                        // Where we are in the audio buffer
     int32_t     loopTrack           = 0;                        // The track to play when looping
     int32_t     loopSectorOffset    = 0;                        // Offset (in sectors) to start at in the track when looping
-
-    // The CD audio buffer: we read CD audio in chunks
-    int16_t buffer[CDDA_SECTOR_SIZE / sizeof(int16_t)];
+    int32_t     startTrack          = -1;                       // The track that playback was started on or '-1' if no track is playing
+    int32_t     startSectorOffset   = 0;                        // The sector offset playback was started at
 } gCdPlayer;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A sector of CD audio which has been read ahead of playback and is waiting in the stream ring buffer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct CdStreamSector {
+    int16_t     samples[CDDA_SECTOR_SAMPLES];   // Interleaved left/right samples for the sector
+    uint32_t    generation;                     // Which playback generation this sector belongs to: stale sectors are discarded
+    int32_t     trackNum;                       // Which track the sector was read from
+    int32_t     endSectorOffset;                // Sector offset in the track after this sector is consumed
+};
+
+// CD audio streaming state.
+// The ring buffer is single producer (whoever holds the CD player lock) and single consumer (the SPU audio thread), and is lock free.
+// Whenever playback is started or stopped the generation is incremented, which causes the consumer to discard any previously buffered audio.
+static struct {
+    CdStreamSector          sectors[STREAM_NUM_SECTORS];    // The ring buffer of CD audio sectors
+    std::atomic<uint32_t>   readIdx;                        // Consumer index in the ring buffer (wraps, only written by the consumer)
+    std::atomic<uint32_t>   writeIdx;                       // Producer index in the ring buffer (wraps, only written by the producer)
+    std::atomic<uint32_t>   generation;                     // Current playback generation, only the lower 'STREAM_GEN_MASK' bits are meaningful
+    std::atomic<uint32_t>   endOfStreamGen;                 // Set to the current generation when the producer reaches the end of a non-looping track
+    std::atomic<uint32_t>   drainedGen;                     // Set to the current generation when the consumer plays all audio after the end of stream
+    std::atomic<uint64_t>   playbackPos;                    // Packed consumer playback position: generation (bits 40-63), track (bits 32-39) and end sector offset (bits 0-31)
+    std::atomic<bool>       bPlay;                          // If 'false' then playback is either paused or stopped (stopped if the disc reader doesn't have a track)
+    std::atomic<bool>       bQuitReader;                    // Set when the reader thread should exit
+} gCdStream;
+
+// Consumer (SPU audio thread) only state: where we are in the sector at the front of the ring buffer
+static uint32_t     gStreamConsumerSampleIdx;
+static uint32_t     gStreamConsumerGen;
+
 // The lock for the CD player and a helper to lock/unlock via RAII.
-// N.B: this *CANNOT* be held the same time as the SPU lock, otherwise deadlock MIGHT occur!
-// The SPU can request audio from the CD and thus needs access to the cd player lock also.
-static std::recursive_mutex gCdPlayerMutex;
+// The reader thread holds this while reading from the disc and the main thread holds it while changing the CD player state.
+// Whoever holds this lock is the producer for the CD audio stream ring buffer.
+static std::mutex gCdPlayerMutex;
 
 struct LockCdPlayer {
     LockCdPlayer() noexcept { gCdPlayerMutex.lock(); }
     ~LockCdPlayer() noexcept { gCdPlayerMutex.unlock(); }
 };
 
+// The CD audio reader thread and a condition variable used to wake it up when the CD player state changes
+static std::thread              gCdReaderThread;
+static std::condition_variable  gCdReaderWakeCond;
+
 // Disc readers used for each open file
 static DiscReader gFileDiscReaders[MAX_OPEN_FILES] = {
     PsxVm::gDiscInfo, PsxVm::gDiscInfo, PsxVm::gDiscInfo, PsxVm::gDiscInfo,
@@ -70,80 +111,199 @@ static DiscReader gFileDiscReaders[MAX_OPEN_FILES] = {
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// A callback invoked by the SPU when it wants audio from the CD player - returns a single sample.
+// Packs a playback position for the CD audio stream into a single value which can be atomically written
 //------------------------------------------------------------------------------------------------------------------------------------------
-static Spu::StereoSample SpuAudioCallback([[maybe_unused]] void* pUserData) noexcept {
-    // Lock the CD player while we are doing this.
-    // Note that this thread also has the SPU lock at this point too.
-    // Therefore the main thread must NOT lock both the CD player and the SPU at the same time, or otherwise a deadlock might occur.
-    LockCdPlayer cdPlayerLock;
-
-    // If the CD player is not currently active then return silence
-    if ((!gCdPlayer.bPlay) || (!gCdPlayer.discReader.isTrackOpen()))
-        return Spu::StereoSample{};
+static constexpr uint64_t packStreamPlaybackPos(const uint32_t generation, const int32_t trackNum, const int32_t sectorOffset) noexcept {
+    return (
+        ((uint64_t)(generation & STREAM_GEN_MASK) << 40) |
+        ((uint64_t)(trackNum & 0xFF) << 32) |
+        (uint64_t)(uint32_t) sectorOffset
+    );
+}
 
-    // Check if we have any data left in the buffer firstly
-    constexpr int16_t SAMPLE_SIZE = sizeof(int16_t);
-    constexpr int32_t NUM_BUFFER_SAMPLES = sizeof(gCdPlayer.buffer) / SAMPLE_SIZE;
-    static_assert(NUM_BUFFER_SAMPLES % 2 == 0);
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts a new generation of CD audio streaming, causing all previously buffered audio to be discarded by the consumer.
+// Returns the new generation. The CD player lock must be held when calling this.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t beginNewStreamGeneration() noexcept {
+    const uint32_t newGen = (gCdStream.generation.load(std::memory_order_relaxed) + 1) & STREAM_GEN_MASK;
+    gCdStream.generation.store(newGen, std::memory_order_release);
+    return newGen;
+}
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the next sector of CD audio into the streaming ring buffer, handling looping and track changes.
+// Returns 'false' if no sector could be read because the buffer is full or there is nothing left to stream.
+// The CD player lock must be held when calling this, since the caller acts as the ring buffer producer.
+//
+// Note: nothing is streamed while playback is paused or stopped. This is important while a new track is being setup, since the disc reader
+// must not be advanced (or switch to the loop track) until the start position for the new track has been set.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool streamCdAudioSector() noexcept {
+    // Is there anything to stream?
     DiscReader& disc = gCdPlayer.discReader;
-
-    if (gCdPlayer.bufferOffset + 1 >= NUM_BUFFER_SAMPLES) {
-        // Get the size of the track and where we are at in it
-        const DiscTrack* pTrack = disc.getOpenTrack();
-        int32_t trackSize = pTrack->trackPayloadSize;
-        int32_t trackOffset = disc.tell();
-
-        // See if there is any data left in the track to read
-        if (trackOffset >= trackSize) {
-            // We reached the end, do we loop back around again?
-            if (gCdPlayer.bLoop) {
-                // Looping: rewind back to the start plus any additional offset.
-                // Change tracks also if we need to.
-                if (disc.getTrackNum() != gCdPlayer.loopTrack) {
-                    disc.setTrackNum(gCdPlayer.loopTrack);
-
-                    // Need to re-fetch this info when changing tracks
-                    pTrack = disc.getOpenTrack();
-                    trackSize = pTrack->trackPayloadSize;
+    const uint32_t generation = gCdStream.generation.load(std::memory_order_relaxed);
+
+    if ((!gCdStream.bPlay.load(std::memory_order_relaxed)) || (!disc.isTrackOpen()) || (gCdStream.endOfStreamGen.load(std::memory_order_relaxed) == generation))
+        return false;
+
+    // Is there room in the ring buffer?
+    const uint32_t writeIdx = gCdStream.writeIdx.load(std::memory_order_relaxed);
+    const uint32_t readIdx = gCdStream.readIdx.load(std::memory_order_acquire);
+
+    if (writeIdx - readIdx >= STREAM_NUM_SECTORS)
+        return false;
+
+    // Get the size of the track and where we are at in it
+    const DiscTrack* pTrack = disc.getOpenTrack();
+    int32_t trackSize = pTrack->trackPayloadSize;
+    int32_t trackOffset = disc.tell();
+
+    // See if there is any data left in the track to read
+    if (trackOffset >= trackSize) {
+        // We reached the end, do we loop back around again?
+        if (gCdPlayer.bLoop) {
+            // Looping: rewind back to the start plus any additional offset.
+            // Change tracks also if we need to.
+            if (disc.getTrackNum() != gCdPlayer.loopTrack) {
+                if (!disc.setTrackNum(gCdPlayer.loopTrack)) {
+                    gCdStream.endOfStreamGen.store(generation, std::memory_order_release);
+                    return false;
                 }
 
-                if (gCdPlayer.loopSectorOffset > 0) {
-                    disc.trackSeekAbs(CDDA_SECTOR_SIZE * gCdPlayer.loopSectorOffset);
-                } else {
-                    disc.trackSeekAbs(0);
-                }
-
-                trackOffset = disc.tell();
+                // Need to re-fetch this info when changing tracks
+                pTrack = disc.getOpenTrack();
+                trackSize = pTrack->trackPayloadSize;
             }
-            else {
-                // No looping, mark the CD player as no longer playing and return an empty sample
-                gCdPlayer.bPlay = false;
-                return Spu::StereoSample{};
+
+            if (gCdPlayer.loopSectorOffset > 0) {
+                disc.trackSeekAbs(CDDA_SECTOR_SIZE * gCdPlayer.loopSectorOffset);
+            } else {
+                disc.trackSeekAbs(0);
             }
+
+            trackOffset = disc.tell();
+        }
+        else {
+            // No looping, tell the consumer that there is no more audio coming once the buffer is drained
+            gCdStream.endOfStreamGen.store(generation, std::memory_order_release);
+            return false;
         }
+    }
+
+    // Read what we can and zero anything we can't (in case the last sector is short for some reason, or if the read fails)
+    constexpr int32_t SAMPLE_SIZE = sizeof(int16_t);
+    CdStreamSector& sector = gCdStream.sectors[writeIdx % STREAM_NUM_SECTORS];
+
+    const int32_t samplesToRead = std::clamp<int32_t>((trackSize - trackOffset) / SAMPLE_SIZE, 0, CDDA_SECTOR_SAMPLES);
+    const int32_t samplesToZero = CDDA_SECTOR_SAMPLES - samplesToRead;
+
+    if (!disc.read(sector.samples, samplesToRead * SAMPLE_SIZE)) {
+        std::memset(sector.samples, 0, sizeof(sector.samples));
+    }
+
+    if (samplesToZero > 0) {
+        std::memset(sector.samples + samplesToRead, 0, (size_t) samplesToZero * SAMPLE_SIZE);
+    }
+
+    sector.generation = generation;
+    sector.trackNum = disc.getTrackNum();
+    sector.endSectorOffset = disc.tell() / CDDA_SECTOR_SIZE;
+
+    // Publish the sector to the consumer
+    gCdStream.writeIdx.store(writeIdx + 1, std::memory_order_release);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Thread which reads CD audio ahead of playback into the streaming ring buffer, so that the SPU audio thread never touches the disc.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void CdReaderThreadMain() noexcept {
+    while (!gCdStream.bQuitReader.load(std::memory_order_relaxed)) {
+        std::unique_lock<std::mutex> cdPlayerLock(gCdPlayerMutex);
+
+        // If nothing could be streamed then the buffer is full or there is nothing to stream: wait a while or until woken.
+        // Note: the consumer does not notify us when it frees up space, since it runs on the real-time audio thread.
+        // The wait time is a small fraction of the ring buffer's duration, so there is always plenty of audio buffered.
+        if (!streamCdAudioSector()) {
+            gCdReaderWakeCond.wait_for(cdPlayerLock, std::chrono::milliseconds(4));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A callback invoked by the SPU when it wants audio from the CD player - returns a single sample.
+// This runs on the SPU audio thread and only consumes audio which has been read ahead into the streaming ring buffer.
+// It never blocks or does any I/O.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static Spu::StereoSample SpuAudioCallback([[maybe_unused]] void* pUserData) noexcept {
+    // If the playback generation has changed then reset the consumer state
+    const uint32_t generation = gCdStream.generation.load(std::memory_order_acquire);
+
+    if (gStreamConsumerGen != generation) {
+        gStreamConsumerGen = generation;
+        gStreamConsumerSampleIdx = 0;
+    }
 
-        // Read what we can and zero anything we can't (in case the last sector is short for some reason)
-        const int32_t samplesToRead = std::min<int32_t>((trackSize - trackOffset) / SAMPLE_SIZE, NUM_BUFFER_SAMPLES);
-        const int32_t samplesToZero = NUM_BUFFER_SAMPLES - samplesToRead;
-        disc.read(gCdPlayer.buffer, samplesToRead * SAMPLE_SIZE);
+    // Discard any stale sectors left over from a previous generation
+    uint32_t readIdx = gCdStream.readIdx.load(std::memory_order_relaxed);
+    uint32_t writeIdx = gCdStream.writeIdx.load(std::memory_order_acquire);
 
-        if (samplesToZero > 0) {
-            std::memset(gCdPlayer.buffer + samplesToRead * SAMPLE_SIZE, 0, (size_t) samplesToZero * SAMPLE_SIZE);
+    while ((readIdx != writeIdx) && (gCdStream.sectors[readIdx % STREAM_NUM_SECTORS].generation != generation)) {
+        ++readIdx;
+        gCdStream.readIdx.store(readIdx, std::memory_order_release);
+        gStreamConsumerSampleIdx = 0;
+    }
+
+    // If the CD player is not currently active then return silence
+    if (!gCdStream.bPlay.load(std::memory_order_acquire))
+        return Spu::StereoSample{};
+
+    // If there is no audio available then either the stream has ended or we have an underrun: output silence in either case
+    if (readIdx == writeIdx) {
+        if (gCdStream.endOfStreamGen.load(std::memory_order_acquire) == generation) {
+            gCdStream.drainedGen.store(generation, std::memory_order_release);
         }
 
-        gCdPlayer.bufferOffset = 0;
+        return Spu::StereoSample{};
     }
 
-    // Should have samples in the buffer at this point, return the requested samples
-    ASSERT(gCdPlayer.bufferOffset + 2 <= NUM_BUFFER_SAMPLES);
+    // Update the playback position if starting a new sector
+    const CdStreamSector& sector = gCdStream.sectors[readIdx % STREAM_NUM_SECTORS];
+
+    if (gStreamConsumerSampleIdx == 0) {
+        gCdStream.playbackPos.store(
+            packStreamPlaybackPos(generation, sector.trackNum, sector.endSectorOffset),
+            std::memory_order_release
+        );
+    }
+
+    // Return the next sample and move onto the next sector if this one is consumed
+    ASSERT(gStreamConsumerSampleIdx + 2 <= CDDA_SECTOR_SAMPLES);
+    const Spu::StereoSample sample = { sector.samples[gStreamConsumerSampleIdx], sector.samples[gStreamConsumerSampleIdx + 1] };
+    gStreamConsumerSampleIdx += 2;
+
+    if (gStreamConsumerSampleIdx >= CDDA_SECTOR_SAMPLES) {
+        gStreamConsumerSampleIdx = 0;
+        gCdStream.readIdx.store(readIdx + 1, std::memory_order_release);
+    }
 
-    Spu::StereoSample sample = { gCdPlayer.buffer[gCdPlayer.bufferOffset], gCdPlayer.buffer[gCdPlayer.bufferOffset + 1] };
-    gCdPlayer.bufferOffset += 2;
     return sample;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the CD player is actively playing: the CD player lock must be held when calling this
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isCdPlayerPlaying() noexcept {
+    const uint32_t generation = gCdStream.generation.load(std::memory_order_relaxed);
+
+    return (
+        gCdPlayer.discReader.isTrackOpen() &&
+        gCdStream.bPlay.load(std::memory_order_relaxed) &&
+        (gCdStream.drainedGen.load(std::memory_order_acquire) != generation)
+    );
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initialize the WESS (Williams Entertainment Sound System) CD handling module.
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -162,18 +322,39 @@ void psxcd_init() noexcept {
         PsxVm::gSpu.pExtInputCallback = SpuAudioCallback;
         PsxVm::gSpu.pExtInputUserData = nullptr;
     }
+
+    // Start up the thread which reads CD audio ahead of playback.
+    // CD audio is never played in headless mode, so there is no need for it in that case.
+    if (!ProgArgs::gbHeadlessMode) {
+        gCdStream.bQuitReader = false;
+        gCdReaderThread = std::thread(CdReaderThreadMain);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Shut down the WESS (Williams Entertainment Sound System) CD handling module
 //------------------------------------------------------------------------------------------------------------------------------------------
 void psxcd_exit() noexcept {
+    // If the module was never initialized then there is nothing to do
+    if (!gbPSXCD_IsCdInit)
+        return;
+
+    gbPSXCD_IsCdInit = false;
+
     // Uninstall the CD player as an external input to the SPU
     {
         PsxVm::LockSpu spuLock;
         PsxVm::gSpu.pExtInputCallback = nullptr;
         PsxVm::gSpu.pExtInputUserData = nullptr;
     }
+
+    // Stop the CD audio reader thread
+    gCdStream.bQuitReader = true;
+    gCdReaderWakeCond.notify_all();
+
+    if (gCdReaderThread.joinable()) {
+        gCdReaderThread.join();
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -361,7 +542,8 @@ static void psxcd_play_internal(
     {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
-        gCdPlayer.bPlay = false;
+        gCdStream.bPlay = false;
+        beginNewStreamGeneration();
         setTrackOk = gCdPlayer.discReader.setTrackNum(track);
     }
 
@@ -386,17 +568,28 @@ static void psxcd_play_internal(
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
 
-        if (sectorOffset > 0) {
-            gCdPlayer.discReader.trackSeekAbs(CDDA_SECTOR_SIZE * sectorOffset);
-        }
+        // Note: always seek, so the start position is exact even if the reader thread moved the disc reader after the track was set
+        gCdPlayer.discReader.trackSeekAbs(CDDA_SECTOR_SIZE * std::max(sectorOffset, 0));
 
-        // Mark the player as playing and save loop parameters
-        gCdPlayer.bPlay = true;
-        gCdPlayer.bufferOffset = CDDA_SECTOR_SIZE / sizeof(int16_t);    // Need to read a sector
+        // Save loop parameters and the start position, and start a new generation of streaming (discards any previously buffered audio)
         gCdPlayer.bLoop = bLoop;
         gCdPlayer.loopTrack = loopTrack;
         gCdPlayer.loopSectorOffset = loopSectorOffset;
+        gCdPlayer.startTrack = track;
+        gCdPlayer.startSectorOffset = gCdPlayer.discReader.tell() / CDDA_SECTOR_SIZE;
+        beginNewStreamGeneration();
+
+        // Mark the player as playing and read the first few sectors immediately (if there is room), so playback can begin without waiting
+        // on the reader thread. Note: the player must be marked as playing first, since nothing is streamed otherwise.
+        gCdStream.bPlay = true;
+
+        for (uint32_t i = 0; i < STREAM_PRIME_SECTORS; ++i) {
+            if (!streamCdAudioSector())
+                break;
+        }
     }
+
+    gCdReaderWakeCond.notify_one();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -456,7 +649,7 @@ void psxcd_stop() noexcept {
     {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
-        bMightNeedFade = (gCdPlayer.discReader.isTrackOpen() && gCdPlayer.bPlay);
+        bMightNeedFade = isCdPlayerPlaying();
     }
 
     if (bMightNeedFade) {
@@ -474,10 +667,12 @@ void psxcd_stop() noexcept {
         LockCdPlayer cdPlayerLock;
 
         gCdPlayer.discReader.closeTrack();
-        gCdPlayer.bPlay = false;
         gCdPlayer.bLoop = false;
-        gCdPlayer.bufferOffset = 0;
         gCdPlayer.loopSectorOffset = 0;
+        gCdPlayer.startTrack = -1;
+        gCdPlayer.startSectorOffset = 0;
+        gCdStream.bPlay = false;
+        beginNewStreamGeneration();
     }
 }
 
@@ -491,7 +686,7 @@ void psxcd_pause() noexcept {
     {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
-        bMightNeedFade = (gCdPlayer.discReader.isTrackOpen() && gCdPlayer.bPlay);
+        bMightNeedFade = isCdPlayerPlaying();
     }
 
     if (bMightNeedFade) {
@@ -507,7 +702,7 @@ void psxcd_pause() noexcept {
     {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
-        gCdPlayer.bPlay = false;
+        gCdStream.bPlay = false;
     }
 }
 
@@ -524,7 +719,7 @@ void psxcd_restart(const int32_t vol) noexcept {
             return;
 
         // Begin playing again
-        gCdPlayer.bPlay = true;
+        gCdStream.bPlay = true;
     }
 
     // Set the audio volume
@@ -537,7 +732,19 @@ void psxcd_restart(const int32_t vol) noexcept {
 int32_t psxcd_elapsed_sectors() noexcept {
     // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
     LockCdPlayer cdPlayerLock;
-    return (gCdPlayer.discReader.isTrackOpen()) ? gCdPlayer.discReader.tell() / CDDA_SECTOR_SIZE : 0;
+
+    if (!gCdPlayer.discReader.isTrackOpen())
+        return 0;
+
+    // Report the position of the audio actually being played rather than where the reader thread is at.
+    // If nothing has been played yet since playback started then use the starting position.
+    const uint64_t playbackPos = gCdStream.playbackPos.load(std::memory_order_acquire);
+    const uint32_t generation = gCdStream.generation.load(std::memory_order_relaxed);
+
+    if ((playbackPos >> 40) != generation)
+        return gCdPlayer.startSectorOffset;
+
+    return (int32_t)(uint32_t) playbackPos;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -551,8 +758,21 @@ int32_t psxcd_get_file_size(const CdFileId discFile) noexcept {
     return CdMapTbl_GetEntry(discFile).size;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the track number of the CD audio currently being played, or '-1' if no track is playing
+//------------------------------------------------------------------------------------------------------------------------------------------
 int32_t psxcd_get_playing_track() noexcept {
     LockCdPlayer cdPlayerLock;
-    const DiscTrack* const pTrack = gCdPlayer.discReader.getOpenTrack();
-    return (pTrack) ? pTrack->trackNum : -1;
+
+    if (!gCdPlayer.discReader.isTrackOpen())
+        return -1;
+
+    // Report the track of the audio actually being played rather than the track the reader thread is at (may have looped to another)
+    const uint64_t playbackPos = gCdStream.playbackPos.load(std::memory_order_acquire);
+    const uint32_t generation = gCdStream.generation.load(std::memory_order_relaxed);
+
+    if ((playbackPos >> 40) != generation)
+        return gCdPlayer.startTrack;
+
+    return (int32_t)((playbackPos >> 32) & 0xFF);
 }
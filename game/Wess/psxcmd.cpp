@@ -436,9 +436,18 @@ void PSX_TrkOff(track_status& trackStat) noexcept {
         sequence_status& seqStat = gpWess_drv_sequenceStats[trackStat.seqstat_idx];
 
         if (bNeedToStopTrack) {
+            // PsyDoom: bring the track's timing up to date before it is paused, and stop scheduling it for sequencer updates after
+            #if PSYDOOM_MODS
+                SeqEngine_SyncTrack(trackStat);
+            #endif
+
             trackStat.stopped = true;
             WESS_ASSERT(seqStat.num_tracks_playing > 0);
             seqStat.num_tracks_playing--;
+
+            #if PSYDOOM_MODS
+                SeqEngine_ScheduleTrack(trackStat);
+            #endif
         }
 
         if (seqStat.num_tracks_playing == 0) {
@@ -946,6 +946,12 @@ int32_t wess_seq_structrig(
             seqStat.num_tracks_playing++;
         }
 
+        // PsyDoom: the track's timing starts from the current sequencer time, schedule it for sequencer updates (if playing)
+        #if PSYDOOM_MODS
+            SeqEngine_SyncTrack(trackStat);
+            SeqEngine_ScheduleTrack(trackStat);
+        #endif
+
         // There is one more track playing the sequence and globally
         WESS_ASSERT(seqStat.num_tracks_active < UINT8_MAX);
         seqStat.num_tracks_active++;
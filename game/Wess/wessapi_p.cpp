@@ -6,12 +6,18 @@
 
 #include "psxcmd.h"
 #include "wessapi.h"
+#include "wessseq.h"
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Unpause the specified track in the given sequence
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void trackstart(track_status& trackStat, sequence_status& seqStat) noexcept {
     if (trackStat.stopped) {
+        // PsyDoom: no time elapses for the track while paused, it resumes from the current sequencer time
+        #if PSYDOOM_MODS
+            SeqEngine_SyncTrack(trackStat);
+        #endif
+
         trackStat.stopped = false;
 
         WESS_ASSERT(seqStat.num_tracks_playing < UINT8_MAX);
@@ -20,6 +26,11 @@ static void trackstart(track_status& trackStat, sequence_status& seqStat) noexce
         if (seqStat.num_tracks_playing > 0) {
             seqStat.playmode = SEQ_STATE_PLAYING;
         }
+
+        // PsyDoom: schedule the track for sequencer updates again
+        #if PSYDOOM_MODS
+            SeqEngine_ScheduleTrack(trackStat);
+        #endif
     }
 }
 
@@ -28,6 +39,11 @@ static void trackstart(track_status& trackStat, sequence_status& seqStat) noexce
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void trackstop(track_status& trackStat, sequence_status& seqStat) noexcept {
     if (!trackStat.stopped) {
+        // PsyDoom: bring the track's timing up to date before it is paused
+        #if PSYDOOM_MODS
+            SeqEngine_SyncTrack(trackStat);
+        #endif
+
         trackStat.stopped = true;
 
         WESS_ASSERT(seqStat.num_tracks_playing > 0);
@@ -36,6 +52,11 @@ static void trackstop(track_status& trackStat, sequence_status& seqStat) noexcep
         if (seqStat.num_tracks_playing == 0) {
             seqStat.playmode = SEQ_STATE_STOPPED;
         }
+
+        // PsyDoom: the track no longer needs to be scheduled for sequencer updates
+        #if PSYDOOM_MODS
+            SeqEngine_ScheduleTrack(trackStat);
+        #endif
     }
 }
 
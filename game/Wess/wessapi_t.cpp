@@ -6,6 +6,7 @@
 
 #include "wessapi.h"
 #include "wessarc.h"
+#include "wessseq.h"
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Update one or more playback attributes for the given sequencer track
@@ -107,6 +108,16 @@ void updatetrackstat(track_status& trackStat, const TriggerPlayAttr* const pPlay
         }
     }
 
+    // PsyDoom: changing the tempo or end time affects track timing.
+    // Bring the track's timing up to date before doing that and reschedule it for sequencer updates afterwards.
+    #if PSYDOOM_MODS
+        const bool bTimingChanged = (attribsMask & (TRIGGER_TEMPO | TRIGGER_TIMED));
+
+        if (bTimingChanged) {
+            SeqEngine_SyncTrack(trackStat);
+        }
+    #endif
+
     if (attribsMask & TRIGGER_TEMPO) {
         trackStat.tempo_qpm = pPlayAttribs->tempo_qpm;
         trackStat.tempo_ppi_frac = CalcPartsPerInt(GetIntsPerSec(), trackStat.tempo_ppq, trackStat.tempo_qpm);
@@ -117,6 +128,12 @@ void updatetrackstat(track_status& trackStat, const TriggerPlayAttr* const pPlay
         trackStat.timed = true;
     }
 
+    #if PSYDOOM_MODS
+        if (bTimingChanged) {
+            SeqEngine_ScheduleTrack(trackStat);
+        }
+    #endif
+
     if (attribsMask & TRIGGER_LOOPED) {
         trackStat.looped = true;
     }
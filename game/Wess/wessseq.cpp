@@ -9,6 +9,8 @@
 
 #include <algorithm>
 #include <chrono>
+#include <functional>
+#include <vector>
 
 const WessDriverFunc gWess_DrvFunctions[36] = {
     // Manually called commands
@@ -107,6 +109,44 @@ static uint8_t                      gWess_eng_maxActiveTracks;      // The maxim
 #if PSYDOOM_MODS    
     typedef std::chrono::high_resolution_clock::time_point timepoint_t;     // Because typing this is a pain...
     static timepoint_t gLastSequencerUpdateTime = {};                       // When we last updated the sequencer
+
+    // PsyDoom: event scheduling for sequencer tracks.
+    //
+    // Rather than visiting every track slot on every sequencer update, active and playing tracks are grouped by tempo and only processed
+    // when their next command (or timed track end) is due. Each tempo group accumulates the elapsed fractional quarter note 'parts' (16.16
+    // fixed point) on every sequencer update, using exactly the same per-update truncation that the original per-track code used.
+    // A track's timing can then be brought up to date exactly and lazily, by applying the difference in its group's accumulated total
+    // since the track was last synchronized. Each group keeps an indexed binary min-heap of its tracks, keyed by the accumulated total at
+    // which the track becomes due. Tracks which are due on an update are still processed in order of track index, so command execution
+    // order is unchanged.
+    enum class TrackSchedState : uint8_t {
+        None,       // Track is not scheduled: inactive, paused, or currently being processed by the sequencer
+        InHeap,     // Track is waiting in its tempo group's event heap
+        Due         // Track is in the list of tracks to be processed for the current sequencer update
+    };
+
+    struct TrackSched {
+        uint64_t            syncQnpFrac;    // The tempo group's accumulated time that the track's timing fields were last brought up to date for
+        uint64_t            dueQnpFrac;     // The tempo group's accumulated time that the track next needs to be processed at
+        int32_t             groupIdx;       // Which tempo group the track belongs to (if scheduled)
+        int32_t             heapIdx;        // Index of the track in the tempo group's event heap (if in the heap)
+        TrackSchedState     state;          // Whether the track is scheduled and where
+    };
+
+    struct TempoGroup {
+        uint32_t                tempoPpiFrac;       // The tempo (quarter note parts per interrupt, 16.16 format) of tracks in this group
+        uint32_t                numTracks;          // How many scheduled tracks are using the group; unused groups may be reused for a new tempo
+        uint64_t                qnpFrac;            // Total elapsed quarter note parts (16.16 format) as of the last (or current) update
+        uint64_t                prevQnpFrac;        // Total elapsed quarter note parts (16.16 format) as of the previous update
+        std::vector<uint8_t>    trackEventHeap;     // Min-heap of track indexes ordered by due time and then track index
+    };
+
+    static double                   gSeqDeltaTicks;             // How many 120 Hz ticks elapsed for the last (or current) update
+    static bool                     gbSeqEngineUpdating;        // True while 'SeqEngine' is processing tracks
+    static int32_t                  gSeqEngineCurTrackIdx;      // Index of the track currently being processed by 'SeqEngine'
+    static std::vector<TrackSched>  gTrackScheds;               // Scheduling info for each track status
+    static std::vector<TempoGroup>  gTempoGroups;               // Groups of scheduled tracks which share the same tempo
+    static std::vector<uint8_t>     gDueTracks;                 // Min-heap of tracks due on the current update, ordered by track index
 #endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -192,6 +232,18 @@ void Eng_DriverInit(master_status_structure& mstat) noexcept {
     gpWess_eng_sequenceStats = mstat.psequence_stats;
     gpWess_eng_trackStats = mstat.ptrack_stats;
     gWess_eng_maxActiveTracks = mstat.pmodule->hdr.max_active_tracks;
+
+    // PsyDoom: reset track event scheduling
+    #if PSYDOOM_MODS
+        gSeqDeltaTicks = 0.0;
+        gbSeqEngineUpdating = false;
+        gSeqEngineCurTrackIdx = -1;
+        gTrackScheds.clear();
+        gTrackScheds.resize(gWess_eng_maxActiveTracks, TrackSched{ 0, 0, -1, -1, TrackSchedState::None });
+        gTempoGroups.clear();
+        gDueTracks.clear();
+        gDueTracks.reserve(gWess_eng_maxActiveTracks);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -222,6 +274,11 @@ void Eng_TrkOff(track_status& trackStat) noexcept {
     master_status_structure& mstat = *gpWess_eng_mstat;
     sequence_status& seqStat = mstat.psequence_stats[trackStat.seqstat_idx];
 
+    // PsyDoom: bring the track's timing up to date before it is paused, since it's timing will no longer advance after this
+    #if PSYDOOM_MODS
+        SeqEngine_SyncTrack(trackStat);
+    #endif
+
     // Mark the track as not playing anymore
     if (!trackStat.stopped) {
         trackStat.stopped = true;
@@ -271,6 +328,11 @@ void Eng_TrkOff(track_status& trackStat) noexcept {
 
     // If the track is being switched off then it is no longer on a manual time limit
     trackStat.timed = false;
+
+    // PsyDoom: the track no longer needs to be scheduled for sequencer updates
+    #if PSYDOOM_MODS
+        SeqEngine_ScheduleTrack(trackStat);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -533,11 +595,21 @@ void Eng_SeqTempo(track_status& trackStat) noexcept {
         if (trackStatIdx == 0xFF)
             continue;
 
-        // Update the quarter notes per minute and parts per interrupt (16.16) advancement for this track
+        // Update the quarter notes per minute and parts per interrupt (16.16) advancement for this track.
+        // PsyDoom: the track's timing must be brought up to date using the old tempo first, and the track rescheduled afterwards.
         track_status& thisTrackStat = gpWess_eng_trackStats[trackStatIdx];
+
+        #if PSYDOOM_MODS
+            SeqEngine_SyncTrack(thisTrackStat);
+        #endif
+
         thisTrackStat.tempo_qpm = newQpm;
         thisTrackStat.tempo_ppi_frac = CalcPartsPerInt(GetIntsPerSec(), thisTrackStat.tempo_ppq, thisTrackStat.tempo_qpm);
 
+        #if PSYDOOM_MODS
+            SeqEngine_ScheduleTrack(thisTrackStat);
+        #endif
+
         // If there are no more active tracks left to visit in the sequence then we are done
         activeTracksLeftToVisit--;
 
@@ -809,6 +881,369 @@ void Eng_NullEvent([[maybe_unused]] track_status& trackStat) noexcept {
     // This command does nothing...
 }
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: returns how many fractional quarter note 'parts' (16.16 fixed point format) a track with the given tempo advances by on the
+// current sequencer update. This is the same per-update calculation and truncation that the original per-track code did.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t getUpdateQnpFrac(const uint32_t tempoPpiFrac) noexcept {
+    return (uint32_t)(gSeqDeltaTicks * (double) tempoPpiFrac);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: helpers for the per tempo group track event heaps, which are ordered by due time and then by track index (for determinism)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool trackEventHeapLess(const uint8_t trackIdx1, const uint8_t trackIdx2) noexcept {
+    const uint64_t dueQnpFrac1 = gTrackScheds[trackIdx1].dueQnpFrac;
+    const uint64_t dueQnpFrac2 = gTrackScheds[trackIdx2].dueQnpFrac;
+    return ((dueQnpFrac1 < dueQnpFrac2) || ((dueQnpFrac1 == dueQnpFrac2) && (trackIdx1 < trackIdx2)));
+}
+
+static void trackEventHeapSet(std::vector<uint8_t>& heap, const int32_t heapIdx, const uint8_t trackIdx) noexcept {
+    heap[heapIdx] = trackIdx;
+    gTrackScheds[trackIdx].heapIdx = heapIdx;
+}
+
+static void trackEventHeapSiftUp(std::vector<uint8_t>& heap, int32_t heapIdx) noexcept {
+    const uint8_t trackIdx = heap[heapIdx];
+
+    while (heapIdx > 0) {
+        const int32_t parentIdx = (heapIdx - 1) / 2;
+        const uint8_t parentTrackIdx = heap[parentIdx];
+
+        if (!trackEventHeapLess(trackIdx, parentTrackIdx))
+            break;
+
+        trackEventHeapSet(heap, heapIdx, parentTrackIdx);
+        heapIdx = parentIdx;
+    }
+
+    trackEventHeapSet(heap, heapIdx, trackIdx);
+}
+
+static void trackEventHeapSiftDown(std::vector<uint8_t>& heap, int32_t heapIdx) noexcept {
+    const uint8_t trackIdx = heap[heapIdx];
+    const int32_t heapSize = (int32_t) heap.size();
+
+    while (true) {
+        const int32_t childIdx1 = heapIdx * 2 + 1;
+        const int32_t childIdx2 = childIdx1 + 1;
+
+        if (childIdx1 >= heapSize)
+            break;
+
+        int32_t minChildIdx = childIdx1;
+
+        if ((childIdx2 < heapSize) && trackEventHeapLess(heap[childIdx2], heap[childIdx1])) {
+            minChildIdx = childIdx2;
+        }
+
+        const uint8_t minChildTrackIdx = heap[minChildIdx];
+
+        if (!trackEventHeapLess(minChildTrackIdx, trackIdx))
+            break;
+
+        trackEventHeapSet(heap, heapIdx, minChildTrackIdx);
+        heapIdx = minChildIdx;
+    }
+
+    trackEventHeapSet(heap, heapIdx, trackIdx);
+}
+
+static void trackEventHeapAdd(const uint8_t trackIdx) noexcept {
+    TrackSched& sched = gTrackScheds[trackIdx];
+    std::vector<uint8_t>& heap = gTempoGroups[sched.groupIdx].trackEventHeap;
+
+    heap.push_back(trackIdx);
+    sched.heapIdx = (int32_t) heap.size() - 1;
+    trackEventHeapSiftUp(heap, sched.heapIdx);
+}
+
+static void trackEventHeapRemove(const uint8_t trackIdx) noexcept {
+    TrackSched& sched = gTrackScheds[trackIdx];
+    std::vector<uint8_t>& heap = gTempoGroups[sched.groupIdx].trackEventHeap;
+    const int32_t heapIdx = sched.heapIdx;
+    WESS_ASSERT((heapIdx >= 0) && (heap[heapIdx] == trackIdx));
+
+    const uint8_t lastTrackIdx = heap.back();
+    heap.pop_back();
+    sched.heapIdx = -1;
+
+    if (lastTrackIdx != trackIdx) {
+        trackEventHeapSet(heap, heapIdx, lastTrackIdx);
+        trackEventHeapSiftUp(heap, heapIdx);
+        trackEventHeapSiftDown(heap, gTrackScheds[lastTrackIdx].heapIdx);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: helpers for the list of tracks that are due on the current update, which is a min-heap ordered by track index
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void dueTracksAdd(const uint8_t trackIdx) noexcept {
+    gDueTracks.push_back(trackIdx);
+    std::push_heap(gDueTracks.begin(), gDueTracks.end(), std::greater<uint8_t>());
+}
+
+static void dueTracksRemove(const uint8_t trackIdx) noexcept {
+    // Note: this only happens when processing one track stops or changes the timing of another, so it's not worth optimizing
+    const auto iter = std::find(gDueTracks.begin(), gDueTracks.end(), trackIdx);
+    WESS_ASSERT(iter != gDueTracks.end());
+    gDueTracks.erase(iter);
+    std::make_heap(gDueTracks.begin(), gDueTracks.end(), std::greater<uint8_t>());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: returns the accumulated time of the given tempo group that a track's timing should be synchronized to, if synchronizing it now.
+// While the sequencer is updating, tracks after the one currently being processed have not yet had time advanced for the current update.
+// This mirrors the order that the original sequencer loop advanced track time in.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t getTrackSyncQnpFrac(const uint8_t trackIdx, const TempoGroup& group) noexcept {
+    return (gbSeqEngineUpdating && ((int32_t) trackIdx > gSeqEngineCurTrackIdx)) ? group.prevQnpFrac : group.qnpFrac;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: adds the given track to the tempo group for its current tempo, creating (or reusing) a group if required.
+// The track's timing is assumed to be up to date with the current time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void joinTempoGroup(const uint8_t trackIdx, const uint32_t tempoPpiFrac) noexcept {
+    // Try to find a group with this tempo, or otherwise an unused group
+    int32_t groupIdx = -1;
+    int32_t unusedGroupIdx = -1;
+
+    for (int32_t i = 0; i < (int32_t) gTempoGroups.size(); ++i) {
+        const TempoGroup& group = gTempoGroups[i];
+
+        if (group.tempoPpiFrac == tempoPpiFrac) {
+            groupIdx = i;
+            break;
+        }
+
+        if ((group.numTracks == 0) && (unusedGroupIdx < 0)) {
+            unusedGroupIdx = i;
+        }
+    }
+
+    // If there is no group with this tempo then setup a new one.
+    // If this is happening part way through an update then the group's time must also include the advancement for this update.
+    if (groupIdx < 0) {
+        if (unusedGroupIdx < 0) {
+            unusedGroupIdx = (int32_t) gTempoGroups.size();
+            gTempoGroups.emplace_back();
+        }
+
+        groupIdx = unusedGroupIdx;
+        TempoGroup& group = gTempoGroups[groupIdx];
+        group.tempoPpiFrac = tempoPpiFrac;
+        group.prevQnpFrac = 0;
+        group.qnpFrac = (gbSeqEngineUpdating) ? getUpdateQnpFrac(tempoPpiFrac) : 0;
+        WESS_ASSERT(group.trackEventHeap.empty());
+    }
+
+    TempoGroup& group = gTempoGroups[groupIdx];
+    group.numTracks++;
+
+    TrackSched& sched = gTrackScheds[trackIdx];
+    sched.groupIdx = groupIdx;
+    sched.syncQnpFrac = getTrackSyncQnpFrac(trackIdx, group);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: removes the given track from its tempo group.
+// The track must already have been removed from the group's event heap.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void leaveTempoGroup(const uint8_t trackIdx) noexcept {
+    TrackSched& sched = gTrackScheds[trackIdx];
+    WESS_ASSERT((sched.groupIdx >= 0) && (sched.heapIdx < 0));
+
+    TempoGroup& group = gTempoGroups[sched.groupIdx];
+    WESS_ASSERT(group.numTracks > 0);
+    group.numTracks--;
+    sched.groupIdx = -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: removes the given track from whatever schedule it is currently on (if any)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void unscheduleTrack(const uint8_t trackIdx) noexcept {
+    TrackSched& sched = gTrackScheds[trackIdx];
+
+    if (sched.state == TrackSchedState::InHeap) {
+        trackEventHeapRemove(trackIdx);
+    }
+    else if (sched.state == TrackSchedState::Due) {
+        dueTracksRemove(trackIdx);
+    }
+
+    if (sched.state != TrackSchedState::None) {
+        leaveTempoGroup(trackIdx);
+    }
+
+    sched.state = TrackSchedState::None;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: advances the timing for a track to the given accumulated time of its tempo group.
+// This is exactly equivalent to the original per-update advancement for all of the updates that elapsed since the track was last synced.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void advanceTrackTime(track_status& trackStat, const uint64_t syncQnpFrac) noexcept {
+    TrackSched& sched = gTrackScheds[trackStat.ref_idx];
+
+    if (syncQnpFrac <= sched.syncQnpFrac)
+        return;
+
+    const uint64_t elapsedQnpFrac = syncQnpFrac - sched.syncQnpFrac;
+    sched.syncQnpFrac = syncQnpFrac;
+
+    // Advance elapsed fractional quarter note 'parts' (16.16 fixed point format) and then the whole parts of the track time markers.
+    // Note: 64-bit math is used here since the elapsed time can be long if the track has been idle waiting for its next command.
+    const uint64_t deltaTimeQnpFrac = (uint64_t) trackStat.deltatime_qnp_frac + elapsedQnpFrac;
+
+    trackStat.abstime_qnp += (uint32_t)(deltaTimeQnpFrac >> 16);
+    trackStat.deltatime_qnp += (uint32_t)(deltaTimeQnpFrac >> 16);
+    trackStat.deltatime_qnp_frac = (uint32_t)(deltaTimeQnpFrac & 0xFFFF);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: computes the accumulated time of its tempo group at which the given track next needs processing, assuming it's timing is up
+// to date. This is when the next sequencer command for the track is due, or when the track ends (if timed) - whichever is first.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t computeTrackDueQnpFrac(const track_status& trackStat) noexcept {
+    const TrackSched& sched = gTrackScheds[trackStat.ref_idx];
+    const int64_t curQnpFrac = (int64_t) trackStat.deltatime_qnp_frac;
+    int64_t qnpFracTillDue = ((int64_t) trackStat.qnp_till_next_cmd - (int64_t) trackStat.deltatime_qnp) * 0x10000 - curQnpFrac;
+
+    if (trackStat.timed) {
+        const int64_t qnpFracTillEnd = ((int64_t) trackStat.end_abstime_qnp - (int64_t) trackStat.abstime_qnp) * 0x10000 - curQnpFrac;
+        qnpFracTillDue = std::min(qnpFracTillDue, qnpFracTillEnd);
+    }
+
+    return sched.syncQnpFrac + (uint64_t) std::max<int64_t>(qnpFracTillDue, 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: brings the timing fields for the given track up to date with the current sequencer time.
+// Must be called before anything outside of the sequencer reads or modifies a track's timing, tempo or paused state.
+// If the track is not currently scheduled (paused, inactive or currently being processed) then its timing is already up to date.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void SeqEngine_SyncTrack(track_status& trackStat) noexcept {
+    const uint8_t trackIdx = trackStat.ref_idx;
+    const TrackSched& sched = gTrackScheds[trackIdx];
+
+    if (sched.state != TrackSchedState::None) {
+        advanceTrackTime(trackStat, getTrackSyncQnpFrac(trackIdx, gTempoGroups[sched.groupIdx]));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: schedules the given track for processing by the sequencer at the time its next command (or timed end) is due.
+// If the track is inactive or paused then it is removed from scheduling instead.
+// Must be called after anything outside of the sequencer modifies a track's timing, tempo or paused/active state.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void SeqEngine_ScheduleTrack(track_status& trackStat) noexcept {
+    const uint8_t trackIdx = trackStat.ref_idx;
+    TrackSched& sched = gTrackScheds[trackIdx];
+
+    // Remove from the schedule if the track no longer needs updates, or if it's tempo changed and it needs to move to another group
+    if ((!trackStat.active) || trackStat.stopped) {
+        unscheduleTrack(trackIdx);
+        return;
+    }
+
+    if ((sched.state != TrackSchedState::None) && (gTempoGroups[sched.groupIdx].tempoPpiFrac != trackStat.tempo_ppi_frac)) {
+        unscheduleTrack(trackIdx);
+    }
+
+    if (sched.state == TrackSchedState::None) {
+        joinTempoGroup(trackIdx, trackStat.tempo_ppi_frac);
+    }
+
+    // If the sequencer is updating and the track is after the one currently being processed then it might need processing on this update.
+    // The original sequencer loop would have visited it later in the same update.
+    const TempoGroup& group = gTempoGroups[sched.groupIdx];
+    sched.dueQnpFrac = computeTrackDueQnpFrac(trackStat);
+    const bool bDueThisUpdate = (gbSeqEngineUpdating && ((int32_t) trackIdx > gSeqEngineCurTrackIdx) && (sched.dueQnpFrac <= group.qnpFrac));
+
+    if (bDueThisUpdate) {
+        if (sched.state == TrackSchedState::InHeap) {
+            trackEventHeapRemove(trackIdx);
+        }
+
+        if (sched.state != TrackSchedState::Due) {
+            dueTracksAdd(trackIdx);
+            sched.state = TrackSchedState::Due;
+        }
+    }
+    else {
+        if (sched.state == TrackSchedState::InHeap) {
+            // Already in the heap: just fix up its position
+            std::vector<uint8_t>& heap = gTempoGroups[sched.groupIdx].trackEventHeap;
+            trackEventHeapSiftUp(heap, sched.heapIdx);
+            trackEventHeapSiftDown(heap, sched.heapIdx);
+        } else {
+            if (sched.state == TrackSchedState::Due) {
+                dueTracksRemove(trackIdx);
+            }
+
+            trackEventHeapAdd(trackIdx);
+            sched.state = TrackSchedState::InHeap;
+        }
+    }
+}
+#endif  // #if PSYDOOM_MODS
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs all sequencer commands that are due for the given track.
+// PsyDoom: this was split out of 'SeqEngine' so it can be shared by the event scheduling code.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void SeqEngine_RunTrackCmds(track_status& trackStat) noexcept {
+    // Is it time to turn off a timed track?
+    if (trackStat.timed && (trackStat.abstime_qnp >= trackStat.end_abstime_qnp)) {
+        // Turn off the timed track
+        gWess_CmdFuncArr[trackStat.driver_id][TrkOff](trackStat);
+    }
+    else {
+        // Not a timed track or not reached the end. Continue executing sequencer commands while the track's time
+        // marker is >= to when the next command happens and while the track remains active and not stopped:
+        while ((trackStat.deltatime_qnp >= trackStat.qnp_till_next_cmd) && trackStat.active && (!trackStat.stopped)) {
+            // Time to execute a new sequencer command: read that command firstly
+            const uint8_t seqCmd = trackStat.pcur_cmd[0];
+
+            // We have passed the required amount of delay/time until this sequencer command executes.
+            // Do not count that elapsed amount towards the next command delay/delta-time:
+            trackStat.deltatime_qnp -= trackStat.qnp_till_next_cmd;
+
+            // Decide what executes this command, the sequencer engine or the hardware driver
+            if ((seqCmd >= PatchChg) && (seqCmd <= NoteOff)) {
+                // The hardware sound driver executes this command: do it!
+                gWess_CmdFuncArr[trackStat.driver_id][seqCmd](trackStat);
+
+                // Skip past the command bytes and read the delta time until the next command
+                trackStat.pcur_cmd += gWess_seq_CmdLength[seqCmd];
+                trackStat.pcur_cmd = Read_Vlq(trackStat.pcur_cmd, trackStat.qnp_till_next_cmd);
+            }
+            else if ((seqCmd >= StatusMark) && (seqCmd <= NullEvent)) {
+                // The sequencer executes this command: do it!
+                gWess_DrvFunctions[seqCmd](trackStat);
+
+                // Automatically go onto the next sequencer command unless we are instructed to skip doing that.
+                // Some commands which change the control flow will set the 'skip' flag so that they may set where to go to next.
+                if (trackStat.active && (!trackStat.skip)) {
+                    // Skip past the command bytes and read the delta time until the next command
+                    trackStat.pcur_cmd += gWess_seq_CmdLength[seqCmd];
+                    trackStat.pcur_cmd = Read_Vlq(trackStat.pcur_cmd, trackStat.qnp_till_next_cmd);
+                } else {
+                    // Clear this instruction: 'skip' is just done once when requested
+                    trackStat.skip = false;
+                }
+            } else {
+                // This is an unknown command or a command that should NOT be in a sequence.
+                // Since we don't know what to do, just stop the track.
+                Eng_SeqEnd(trackStat);
+            }
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // The main sequencer tick/update update function which was originally called approximately 120 times a second.
 // This is what drives sequencer timing and executes sequencer commands.
@@ -826,94 +1261,87 @@ void SeqEngine() noexcept {
     #endif
 
     // Some helper variables for the loop
-    master_status_structure& mstat = *gpWess_eng_mstat;
     track_status* const pTrackStats = gpWess_eng_trackStats;
-    const uint8_t maxTracks = gWess_eng_maxActiveTracks;
 
-    // Run through all of the active tracks and run sequencer commands for them
-    uint8_t numActiveTracksToVisit = mstat.num_active_tracks;
+    #if PSYDOOM_MODS
+        // PsyDoom: advance the accumulated time for each tempo group and gather up all the tracks which are due for processing on this update.
+        // These are processed in order of track index, which matches the order the original code executed commands in.
+        gSeqDeltaTicks = deltaTime120HzTicks;
+
+        for (TempoGroup& group : gTempoGroups) {
+            group.prevQnpFrac = group.qnpFrac;
+            group.qnpFrac += getUpdateQnpFrac(group.tempoPpiFrac);
+
+            while ((!group.trackEventHeap.empty()) && (gTrackScheds[group.trackEventHeap.front()].dueQnpFrac <= group.qnpFrac)) {
+                const uint8_t trackIdx = group.trackEventHeap.front();
+                trackEventHeapRemove(trackIdx);
+                gTrackScheds[trackIdx].state = TrackSchedState::Due;
+                gDueTracks.push_back(trackIdx);
+            }
+        }
+
+        std::make_heap(gDueTracks.begin(), gDueTracks.end(), std::greater<uint8_t>());
+
+        // Run sequencer commands for all the due tracks.
+        // Note that processing a track may cause other tracks later in the order to become due (or no longer due), so the list can change.
+        gbSeqEngineUpdating = true;
 
-    if (numActiveTracksToVisit > 0) {
-        for (uint8_t trackIdx = 0; trackIdx < maxTracks; ++trackIdx) {
+        while (!gDueTracks.empty()) {
+            std::pop_heap(gDueTracks.begin(), gDueTracks.end(), std::greater<uint8_t>());
+            const uint8_t trackIdx = gDueTracks.back();
+            gDueTracks.pop_back();
+            gSeqEngineCurTrackIdx = trackIdx;
+
+            // Bring the track's timing up to date for this update and take it out of its tempo group while it is processed
             track_status& trackStat = pTrackStats[trackIdx];
+            SeqEngine_SyncTrack(trackStat);
+            leaveTempoGroup(trackIdx);
+            gTrackScheds[trackIdx].state = TrackSchedState::None;
 
-            // Skip past tracks that are not playing
-            if (!trackStat.active)
-                continue;
+            if (trackStat.active && (!trackStat.stopped)) {
+                SeqEngine_RunTrackCmds(trackStat);
+            }
 
-            // Only run sequencer commands for the track if it isn't paused
-            if (!trackStat.stopped) {
-                // Advance the track's time markers.
-                // PsyDoom: this is now based on delta time rather than a fixed 120Hz interval.
-                // This allows us to update the sequencer at arbitrary times and still maintain most precision.
-                #if PSYDOOM_MODS
-                    const double elapsedQpnFracF = deltaTime120HzTicks * (double) trackStat.tempo_ppi_frac;
-                    const uint32_t elapsedQnpFrac = (uint32_t) elapsedQpnFracF;
-
-                    trackStat.deltatime_qnp_frac += elapsedQnpFrac;             // Advance elapsed fractional quarter note 'parts' (16.16 fixed point format)
-                #else
-                    trackStat.deltatime_qnp_frac += trackStat.tempo_ppi_frac;   // Advance elapsed fractional quarter note 'parts' (16.16 fixed point format)
-                #endif
-
-                trackStat.abstime_qnp += trackStat.deltatime_qnp_frac >> 16;        // Advance track total time in whole quarter note parts
-                trackStat.deltatime_qnp += trackStat.deltatime_qnp_frac >> 16;      // Advance track delta time till the next command in whole quarter note parts
-                trackStat.deltatime_qnp_frac &= 0xFFFF;                             // We've advanced time by the whole part of this number: discount that part
-
-                // Is it time to turn off a timed track?
-                if (trackStat.timed && (trackStat.abstime_qnp >= trackStat.end_abstime_qnp)) {
-                    // Turn off the timed track
-                    gWess_CmdFuncArr[trackStat.driver_id][TrkOff](trackStat);
-                }
-                else {
-                    // Not a timed track or not reached the end. Continue executing sequencer commands while the track's time
-                    // marker is >= to when the next command happens and while the track remains active and not stopped:
-                    while ((trackStat.deltatime_qnp >= trackStat.qnp_till_next_cmd) && trackStat.active && (!trackStat.stopped)) {
-                        // Time to execute a new sequencer command: read that command firstly
-                        const uint8_t seqCmd = trackStat.pcur_cmd[0];
-
-                        // We have passed the required amount of delay/time until this sequencer command executes.
-                        // Do not count that elapsed amount towards the next command delay/delta-time:
-                        trackStat.deltatime_qnp -= trackStat.qnp_till_next_cmd;
-
-                        // Decide what executes this command, the sequencer engine or the hardware driver
-                        if ((seqCmd >= PatchChg) && (seqCmd <= NoteOff)) {
-                            // The hardware sound driver executes this command: do it!
-                            gWess_CmdFuncArr[trackStat.driver_id][seqCmd](trackStat);
-
-                            // Skip past the command bytes and read the delta time until the next command
-                            trackStat.pcur_cmd += gWess_seq_CmdLength[seqCmd];
-                            trackStat.pcur_cmd = Read_Vlq(trackStat.pcur_cmd, trackStat.qnp_till_next_cmd);
-                        }
-                        else if ((seqCmd >= StatusMark) && (seqCmd <= NullEvent)) {
-                            // The sequencer executes this command: do it!
-                            gWess_DrvFunctions[seqCmd](trackStat);
-
-                            // Automatically go onto the next sequencer command unless we are instructed to skip doing that.
-                            // Some commands which change the control flow will set the 'skip' flag so that they may set where to go to next.
-                            if (trackStat.active && (!trackStat.skip)) {
-                                // Skip past the command bytes and read the delta time until the next command
-                                trackStat.pcur_cmd += gWess_seq_CmdLength[seqCmd];
-                                trackStat.pcur_cmd = Read_Vlq(trackStat.pcur_cmd, trackStat.qnp_till_next_cmd);
-                            } else {
-                                // Clear this instruction: 'skip' is just done once when requested
-                                trackStat.skip = false;
-                            }
-                        } else {
-                            // This is an unknown command or a command that should NOT be in a sequence.
-                            // Since we don't know what to do, just stop the track.
-                            Eng_SeqEnd(trackStat);
-                        }
-                    }
+            SeqEngine_ScheduleTrack(trackStat);
+        }
+
+        gbSeqEngineUpdating = false;
+        gSeqEngineCurTrackIdx = -1;
+    #else
+        master_status_structure& mstat = *gpWess_eng_mstat;
+        const uint8_t maxTracks = gWess_eng_maxActiveTracks;
+
+        // Run through all of the active tracks and run sequencer commands for them
+        uint8_t numActiveTracksToVisit = mstat.num_active_tracks;
+
+        if (numActiveTracksToVisit > 0) {
+            for (uint8_t trackIdx = 0; trackIdx < maxTracks; ++trackIdx) {
+                track_status& trackStat = pTrackStats[trackIdx];
+
+                // Skip past tracks that are not playing
+                if (!trackStat.active)
+                    continue;
+
+                // Only run sequencer commands for the track if it isn't paused
+                if (!trackStat.stopped) {
+                    // Advance the track's time markers
+                    trackStat.deltatime_qnp_frac += trackStat.tempo_ppi_frac;           // Advance elapsed fractional quarter note 'parts' (16.16 fixed point format)
+                    trackStat.abstime_qnp += trackStat.deltatime_qnp_frac >> 16;        // Advance track total time in whole quarter note parts
+                    trackStat.deltatime_qnp += trackStat.deltatime_qnp_frac >> 16;      // Advance track delta time till the next command in whole quarter note parts
+                    trackStat.deltatime_qnp_frac &= 0xFFFF;                             // We've advanced time by the whole part of this number: discount that part
+
+                    // Run any sequencer commands that are due
+                    SeqEngine_RunTrackCmds(trackStat);
                 }
-            }
 
-            // If there are no more tracks to process then stop now
-            numActiveTracksToVisit--;
+                // If there are no more tracks to process then stop now
+                numActiveTracksToVisit--;
 
-            if (numActiveTracksToVisit == 0)
-                break;
+                if (numActiveTracksToVisit == 0)
+                    break;
+            }
         }
-    }
+    #endif
 
     // Call the 'update' function for the sound driver: this does management, such as freeing up unused hardware voices
     track_status& firstTrack = pTrackStats[0];
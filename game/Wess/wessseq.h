@@ -61,3 +61,8 @@ void Eng_TrkRet(track_status& trackStat) noexcept;
 void Eng_TrkEnd(track_status& trackStat) noexcept;
 void Eng_NullEvent(track_status& trackStat) noexcept;
 void SeqEngine() noexcept;
+
+#if PSYDOOM_MODS
+    void SeqEngine_SyncTrack(track_status& trackStat) noexcept;
+    void SeqEngine_ScheduleTrack(track_status& trackStat) noexcept;
+#endif
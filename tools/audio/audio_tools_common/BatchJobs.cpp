@@ -0,0 +1,245 @@
+#include "BatchJobs.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
+BEGIN_NAMESPACE(AudioTools)
+BEGIN_NAMESPACE(BatchJobs)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the default number of threads to use for batch jobs: one per hardware thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t getDefaultNumThreads() noexcept {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Looks for a '-threads <NUM THREADS>' switch anywhere in the given argument list and removes it if found.
+// If the switch is not found then the default number of threads is returned.
+// Returns 'false' if the switch is malformed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool extractNumThreadsArg(std::vector<const char*>& args, uint32_t& numThreadsOut) noexcept {
+    numThreadsOut = getDefaultNumThreads();
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        if (std::strcmp(args[i], "-threads") != 0)
+            continue;
+
+        if (i + 1 >= args.size())
+            return false;
+
+        try {
+            const int numThreads = std::stoi(args[i + 1]);
+
+            if (numThreads < 1)
+                return false;
+
+            numThreadsOut = (uint32_t) numThreads;
+        } catch (...) {
+            return false;
+        }
+
+        args.erase(args.begin() + i, args.begin() + i + 2);
+        return true;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Looks for a '-stats' switch anywhere in the given argument list and removes it if found.
+// Returns 'true' if the switch was found, meaning that a throughput report should be printed after running jobs.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool extractStatsArg(std::vector<const char*>& args) noexcept {
+    const auto argIter = std::find_if(args.begin(), args.end(), [](const char* const arg) noexcept {
+        return (std::strcmp(arg, "-stats") == 0);
+    });
+
+    if (argIter == args.end())
+        return false;
+
+    args.erase(argIter);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get all of the files in the given directory (non recursive) with the specified extension (case insensitive, including the '.').
+// The file paths are sorted so that batch jobs always process files in the same order, regardless of the host file system.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool getFilesWithExtension(
+    const char* const dirPath,
+    const char* const extension,
+    std::vector<std::string>& filePathsOut,
+    std::string& errorMsgOut
+) noexcept {
+    filePathsOut.clear();
+
+    const auto toUpper = [](std::string str) noexcept {
+        std::transform(str.begin(), str.end(), str.begin(), [](const char c) noexcept { return (char) ::toupper(c); });
+        return str;
+    };
+
+    const std::string extensionUpper = toUpper(extension);
+
+    try {
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(dirPath)) {
+            if (!entry.is_regular_file())
+                continue;
+
+            const std::filesystem::path& path = entry.path();
+
+            if (toUpper(path.extension().string()) == extensionUpper) {
+                filePathsOut.push_back(path.string());
+            }
+        }
+    } catch (...) {
+        errorMsgOut = "Failed to list the contents of directory '";
+        errorMsgOut += dirPath;
+        errorMsgOut += "'! Does the directory exist and is it readable?";
+        return false;
+    }
+
+    std::sort(filePathsOut.begin(), filePathsOut.end());
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the name of the given file, minus the directory and extension
+//------------------------------------------------------------------------------------------------------------------------------------------
+std::string getFileNameWithoutExtension(const std::string& filePath) noexcept {
+    return std::filesystem::path(filePath).stem().string();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makeup a file path from the given directory and file name; the directory may be empty (current working directory)
+//------------------------------------------------------------------------------------------------------------------------------------------
+std::string makeFilePath(const char* const dirPath, const std::string& fileName) noexcept {
+    std::string filePath = dirPath;
+
+    if ((!filePath.empty()) && (filePath.back() != '/') && (filePath.back() != '\\')) {
+        filePath += '/';
+    }
+
+    filePath += fileName;
+    return filePath;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Format a string printf style.
+// The output is measured first so that the resulting string is never truncated, no matter how long it is.
+//------------------------------------------------------------------------------------------------------------------------------------------
+std::string stringPrintf(const char* const format, ...) noexcept {
+    va_list args;
+    va_start(args, format);
+    va_list argsCopy;
+    va_copy(argsCopy, args);
+    const int strLen = std::vsnprintf(nullptr, 0, format, argsCopy);
+    va_end(argsCopy);
+
+    std::string str;
+
+    if (strLen > 0) {
+        str.resize((size_t) strLen + 1);
+        std::vsnprintf(str.data(), str.size(), format, args);
+        str.resize((size_t) strLen);
+    }
+
+    va_end(args);
+    return str;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Run the given number of jobs across the specified number of threads.
+// Jobs are handed out to the threads in ascending order of job index as each thread becomes free.
+//
+// Once all jobs are done the messages for each job are printed in job index order (so the output is always the same regardless of
+// thread count or timing), followed by a throughput report if requested. Returns 'false' if any of the jobs failed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool runJobs(
+    const char* const jobsDescription,
+    const uint32_t numJobs,
+    const uint32_t numThreads,
+    const bool bPrintStats,
+    const JobFunc& jobFunc
+) noexcept {
+    // Run all the jobs and save their outputs
+    const auto startTime = std::chrono::steady_clock::now();
+
+    std::unique_ptr<JobOutput[]> jobOutputs(new JobOutput[numJobs]());
+    std::unique_ptr<bool[]> jobResults(new bool[numJobs]());
+    std::atomic<uint32_t> nextJobIdx = 0;
+
+    const auto workerMain = [&]() noexcept {
+        while (true) {
+            const uint32_t jobIdx = nextJobIdx.fetch_add(1, std::memory_order_relaxed);
+
+            if (jobIdx >= numJobs)
+                break;
+
+            jobResults[jobIdx] = jobFunc(jobIdx, jobOutputs[jobIdx]);
+        }
+    };
+
+    const uint32_t numWorkers = std::clamp(numThreads, 1u, std::max(numJobs, 1u));
+    std::vector<std::thread> workers;
+
+    try {
+        workers.reserve(numWorkers - 1);
+
+        for (uint32_t i = 1; i < numWorkers; ++i) {
+            workers.emplace_back(workerMain);
+        }
+    } catch (...) {
+        // Couldn't spawn one or more threads: just carry on with whatever threads we did manage to create
+    }
+
+    workerMain();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    const auto endTime = std::chrono::steady_clock::now();
+
+    // Print the output for each job in order and tally up the totals
+    uint32_t numFailedJobs = 0;
+    uint64_t totalBytesOut = 0;
+
+    for (uint32_t jobIdx = 0; jobIdx < numJobs; ++jobIdx) {
+        const JobOutput& jobOutput = jobOutputs[jobIdx];
+
+        if (!jobOutput.messages.empty()) {
+            std::printf("%s", jobOutput.messages.c_str());
+
+            if (jobOutput.messages.back() != '\n') {
+                std::printf("\n");
+            }
+        }
+
+        numFailedJobs += (jobResults[jobIdx]) ? 0 : 1;
+        totalBytesOut += jobOutput.numBytesOut;
+    }
+
+    // Print the throughput report, if wanted
+    if (bPrintStats) {
+        const double elapsedSecs = std::max(std::chrono::duration<double>(endTime - startTime).count(), 1.0e-9);
+
+        std::printf("\n%s: %u job(s) completed, %u failed, using %u thread(s).\n", jobsDescription, numJobs - numFailedJobs, numFailedJobs, (unsigned) workers.size() + 1);
+        std::printf("    Time taken:     %.3f seconds\n", elapsedSecs);
+        std::printf("    Output size:    %.3f MiB\n", (double) totalBytesOut / (1024.0 * 1024.0));
+        std::printf("    Throughput:     %.1f jobs/sec, %.3f MiB/sec\n", (double) numJobs / elapsedSecs, (double) totalBytesOut / (1024.0 * 1024.0) / elapsedSecs);
+    }
+
+    return (numFailedJobs == 0);
+}
+
+END_NAMESPACE(BatchJobs)
+END_NAMESPACE(AudioTools)
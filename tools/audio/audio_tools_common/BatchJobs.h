@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(AudioTools)
+BEGIN_NAMESPACE(BatchJobs)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Output from a single job executed by 'runJobs'.
+// Jobs run concurrently, so instead of printing directly they should put all of their messages here.
+// The messages are then printed in job order once all jobs have finished, so that the tool output is deterministic.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct JobOutput {
+    std::string     messages;           // Messages (errors, info) to print for this job, if any
+    uint64_t        numBytesOut;        // How many bytes of output data the job produced (used for the throughput report)
+};
+
+// Signature for a job function: receives the job index and its output, returns 'false' on failure
+typedef std::function<bool (const uint32_t jobIdx, JobOutput& jobOutput)> JobFunc;
+
+uint32_t getDefaultNumThreads() noexcept;
+bool extractNumThreadsArg(std::vector<const char*>& args, uint32_t& numThreadsOut) noexcept;
+bool extractStatsArg(std::vector<const char*>& args) noexcept;
+
+bool getFilesWithExtension(
+    const char* const dirPath,
+    const char* const extension,
+    std::vector<std::string>& filePathsOut,
+    std::string& errorMsgOut
+) noexcept;
+
+std::string getFileNameWithoutExtension(const std::string& filePath) noexcept;
+std::string makeFilePath(const char* const dirPath, const std::string& fileName) noexcept;
+std::string stringPrintf(const char* const format, ...) noexcept;
+
+bool runJobs(
+    const char* const jobsDescription,
+    const uint32_t numJobs,
+    const uint32_t numThreads,
+    const bool bPrintStats,
+    const JobFunc& jobFunc
+) noexcept;
+
+END_NAMESPACE(BatchJobs)
+END_NAMESPACE(AudioTools)
@@ -7,6 +7,7 @@
 #include "FileUtils.h"
 
 #include <algorithm>
+#include <cstring>
 
 BEGIN_NAMESPACE(AudioTools)
 BEGIN_NAMESPACE(VagUtils)
@@ -18,30 +19,6 @@ BEGIN_NAMESPACE(VagUtils)
 static constexpr int32_t ADPCM_PREDICT_COEF_POS[5] = { 0, 60, 115,  98, 122 };
 static constexpr int32_t ADPCM_PREDICT_COEF_NEG[5] = { 0,  0, -52, -55, -60 };
 
-//------------------------------------------------------------------------------------------------------------------------------------------
-// How much each nibble + shift combination contributes to the overall sound.
-// The 1st dimension is the shift and the 2nd dimension is the nibble value.
-// Precomputed to speed up encoding.
-//------------------------------------------------------------------------------------------------------------------------------------------
-struct ShiftNibbleEncodingTable {
-    int16_t values[13][16];
-};
-
-static constexpr ShiftNibbleEncodingTable buildShiftNibbleEncodingTable() noexcept {
-    ShiftNibbleEncodingTable table = {};
-
-    for (uint16_t shift = 0; shift <= 12; ++shift) {
-        for (uint16_t nibble = 0; nibble <= 15; ++nibble) {
-            // N.B: the arithmetic right shift here is important!
-            table.values[shift][nibble] = ((int16_t)(nibble << 12u)) >> shift;
-        }
-    }
-
-    return table;
-}
-
-constexpr ShiftNibbleEncodingTable SHIFT_NIBBLE_ENC_TABLE = buildShiftNibbleEncodingTable();
-
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Do byte swapping for little endian host CPUs.
 // The VAG header is stored in big endian format in the file.
@@ -441,61 +418,50 @@ void encodePcmSoundToPsxAdpcm(
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Evaluates a particular ADPCM encoding using the specified sample filter and sample shift.
-// Returns the encoded nibbles, previous 2 encoded samples and the error of this encoding.
+// The number of candidate encodings tried for each ADPCM block: every combination of the 5 sample filters and 13 sample shifts.
+// Candidates are numbered 'sampleFilter * 13 + sampleShift', which is the order the encoder prefers candidates in for equal error.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void tryPsxAdpcmEncoding(
-    const uint32_t sampleFilter,
-    const int32_t sampleShift,
-    const int16_t inSamples[ADPCM_BLOCK_NUM_SAMPLES],
-    const int16_t inPrevSample1,
-    const int16_t inPrevSample2,
-    uint8_t outNibbles[ADPCM_BLOCK_NUM_SAMPLES],
-    int16_t& outPrevSample1,
-    int16_t& outPrevSample2,
-    uint64_t& outError
-) noexcept {
-    // Get the prediction filter co-efficients and the correction step based on the sample shift
-    const int32_t predictCoefPos = ADPCM_PREDICT_COEF_POS[sampleFilter];
-    const int32_t predictCoefNeg = ADPCM_PREDICT_COEF_NEG[sampleFilter];
-    const int32_t adjustStep = 1 << std::clamp(12 - sampleShift, 0, 12);
+static constexpr uint32_t ADPCM_NUM_SHIFTS = 13;
+static constexpr uint32_t ADPCM_NUM_CANDIDATES = 5 * ADPCM_NUM_SHIFTS;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Per candidate encoding parameters, stored as separate arrays (one lane per candidate) so the search can be vectorized
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct AdpcmCandidateParams {
+    int32_t predictCoefPos[ADPCM_NUM_CANDIDATES];
+    int32_t predictCoefNeg[ADPCM_NUM_CANDIDATES];
+    int32_t adjustStepShift[ADPCM_NUM_CANDIDATES];      // log2 of the size of one nibble step: '12 - sampleShift'
+};
 
-    // Encode the nibbles attempting to correct the error for each sample and compute the error of this encoding as we go
-    outError = 0;
-    int16_t prevSamples[2] = { inPrevSample1, inPrevSample2 };
+static constexpr AdpcmCandidateParams buildAdpcmCandidateParams() noexcept {
+    AdpcmCandidateParams params = {};
 
-    for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_BLOCK_NUM_SAMPLES; ++sampleIdx) {
-        // Get the current sample, the prediction according to the filter and the error from the prediction
-        const int32_t realSample = inSamples[sampleIdx];
-        const int32_t predictedSample = (prevSamples[0] * predictCoefPos + prevSamples[1] * predictCoefNeg + 32) / 64;
-        const int32_t predictionError = realSample - predictedSample;
-
-        // Compute how many steps to adjust by to try and fix.
-        // Clamp to within range for a 4-bit signed integer: this is our sample nibble.
-        const int32_t adjustSteps = std::clamp(predictionError / adjustStep, -8, 7);
-        const uint8_t sampleNibble = ((uint8_t) adjustSteps) & 0x0Fu;
-        outNibbles[sampleIdx] = sampleNibble;
-
-        // Save the sample we just encoded and shuffle backwards the last previous sample
-        const int32_t encodedSampleUnclamped = predictedSample + (int32_t) SHIFT_NIBBLE_ENC_TABLE.values[sampleShift][sampleNibble];
-        const int16_t encodedSample = (int16_t) std::clamp<int32_t>(encodedSampleUnclamped, INT16_MIN, INT16_MAX);
-        prevSamples[1] = prevSamples[0];
-        prevSamples[0] = encodedSample;
-
-        // Update the error of this encoding: penalize heavily overflow
-        const uint32_t encodingError = (uint32_t) std::abs(encodedSample - realSample);
-        const uint32_t overflowError = (uint32_t) std::abs(encodedSampleUnclamped - encodedSample) * 64;
-        outError += (uint64_t) encodingError * encodingError;
-        outError += (uint64_t) overflowError * overflowError;
+    for (uint32_t sampleFilter = 0; sampleFilter <= 4; ++sampleFilter) {
+        for (uint32_t sampleShift = 0; sampleShift < ADPCM_NUM_SHIFTS; ++sampleShift) {
+            const uint32_t candidateIdx = sampleFilter * ADPCM_NUM_SHIFTS + sampleShift;
+            params.predictCoefPos[candidateIdx] = ADPCM_PREDICT_COEF_POS[sampleFilter];
+            params.predictCoefNeg[candidateIdx] = ADPCM_PREDICT_COEF_NEG[sampleFilter];
+            params.adjustStepShift[candidateIdx] = 12 - (int32_t) sampleShift;
+        }
     }
 
-    // Save the output previous samples
-    outPrevSample1 = prevSamples[0];
-    outPrevSample2 = prevSamples[1];
+    return params;
 }
 
+static constexpr AdpcmCandidateParams ADPCM_CANDIDATE_PARAMS = buildAdpcmCandidateParams();
+
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Encode the given samples in the PlayStation's ADPCM format
+// Encode the given samples in the PlayStation's ADPCM format.
+//
+// Every combination of sample filter and sample shift is evaluated and the one with the lowest error is used. Rather than trying each
+// combination in turn, all of them are evaluated at the same time: the outer loop is over samples and the inner loop is over the
+// candidate encodings, with the state for each candidate kept in separate arrays. The inner loop is branch free and has no dependencies
+// between candidates, so the compiler can vectorize it.
+//
+// Notes on how this matches the straightforward scalar version of the encoder exactly:
+//  (1) Since the nibble step size is a power of two, the (round towards zero) division by the step size is done with a bias and shift.
+//  (2) The value added for a nibble, '((int16_t)(nibble << 12)) >> sampleShift', is just the nibble step count times the step size.
+//  (3) Ties in the error are resolved in favor of the lowest candidate index, which is the first one the scalar search would find.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void encodePcmToPsxAdpcmBlock(
     const int16_t samples[ADPCM_BLOCK_NUM_SAMPLES],
@@ -508,46 +474,71 @@ void encodePcmToPsxAdpcmBlock(
     int16_t& prevEncSampleOut1,
     int16_t& prevEncSampleOut2
 ) noexcept {
-    // Try various combinations of ADPCM encoding and sample shift adjust to find the best one
-    uint64_t bestError = UINT64_MAX;
-    uint32_t bestSampleFilter = 0;
-    uint32_t bestSampleShift = 0;
-    uint8_t bestSampleNibbles[ADPCM_BLOCK_NUM_SAMPLES] = {};
+    // The state for each of the candidate encodings
+    int32_t prevSamples1[ADPCM_NUM_CANDIDATES];
+    int32_t prevSamples2[ADPCM_NUM_CANDIDATES];
+    uint64_t errors[ADPCM_NUM_CANDIDATES];
+    int8_t adjustStepCounts[ADPCM_BLOCK_NUM_SAMPLES][ADPCM_NUM_CANDIDATES];
+
+    for (uint32_t c = 0; c < ADPCM_NUM_CANDIDATES; ++c) {
+        prevSamples1[c] = prevSample1;
+        prevSamples2[c] = prevSample2;
+        errors[c] = 0;
+    }
 
-    for (uint32_t sampleFilter = 0; sampleFilter <= 4; ++sampleFilter) {
-        for (int32_t sampleShift = 0; sampleShift <= 12; ++sampleShift) {
-            // Evaluate this encoding
-            uint8_t sampleNibbles[ADPCM_BLOCK_NUM_SAMPLES];
-            int16_t lastEncSample1;
-            int16_t lastEncSample2;
-            uint64_t error;
-
-            tryPsxAdpcmEncoding(
-                sampleFilter,
-                sampleShift,
-                samples,
-                prevSample1,
-                prevSample2,
-                sampleNibbles,
-                lastEncSample1,
-                lastEncSample2,
-                error
-            );
-
-            // Is this a better one? If so then remember it...
-            if (error < bestError) {
-                bestError = error;
-                bestSampleFilter = sampleFilter;
-                bestSampleShift = sampleShift;
-                std::memcpy(bestSampleNibbles, sampleNibbles, sizeof(sampleNibbles));
-
-                // Save this for the caller, so it knows the last two encoded samples for the best encoding
-                prevEncSampleOut1 = lastEncSample1;
-                prevEncSampleOut2 = lastEncSample2;
-            }
+    // Encode each sample for all candidates, attempting to correct the error for each sample and computing the error of each encoding
+    const AdpcmCandidateParams& params = ADPCM_CANDIDATE_PARAMS;
+
+    for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_BLOCK_NUM_SAMPLES; ++sampleIdx) {
+        const int32_t realSample = samples[sampleIdx];
+        int8_t* const pStepCounts = adjustStepCounts[sampleIdx];
+
+        for (uint32_t c = 0; c < ADPCM_NUM_CANDIDATES; ++c) {
+            // Get the prediction according to the filter and the error from the prediction
+            const int32_t predictedSample = (prevSamples1[c] * params.predictCoefPos[c] + prevSamples2[c] * params.predictCoefNeg[c] + 32) / 64;
+            const int32_t predictionError = realSample - predictedSample;
+
+            // Compute how many steps to adjust by to try and fix, rounding towards zero.
+            // Clamp to within range for a 4-bit signed integer: this is our sample nibble.
+            const int32_t stepShift = params.adjustStepShift[c];
+            const int32_t roundBias = (predictionError >> 31) & ((1 << stepShift) - 1);
+            const int32_t adjustSteps = std::clamp((predictionError + roundBias) >> stepShift, -8, 7);
+            pStepCounts[c] = (int8_t) adjustSteps;
+
+            // Save the sample we just encoded and shuffle backwards the last previous sample
+            const int32_t encodedSampleUnclamped = predictedSample + adjustSteps * (1 << stepShift);
+            const int32_t encodedSample = std::clamp<int32_t>(encodedSampleUnclamped, INT16_MIN, INT16_MAX);
+            prevSamples2[c] = prevSamples1[c];
+            prevSamples1[c] = encodedSample;
+
+            // Update the error of this encoding: penalize heavily overflow
+            const uint32_t encodingError = (uint32_t) std::abs(encodedSample - realSample);
+            const uint32_t overflowError = (uint32_t) std::abs(encodedSampleUnclamped - encodedSample) * 64;
+            errors[c] += (uint64_t) encodingError * encodingError + (uint64_t) overflowError * overflowError;
         }
     }
 
+    // Pick the best encoding: the first one with the lowest error
+    uint32_t bestCandidateIdx = 0;
+
+    for (uint32_t c = 1; c < ADPCM_NUM_CANDIDATES; ++c) {
+        if (errors[c] < errors[bestCandidateIdx]) {
+            bestCandidateIdx = c;
+        }
+    }
+
+    const uint32_t bestSampleFilter = bestCandidateIdx / ADPCM_NUM_SHIFTS;
+    const uint32_t bestSampleShift = bestCandidateIdx % ADPCM_NUM_SHIFTS;
+    uint8_t bestSampleNibbles[ADPCM_BLOCK_NUM_SAMPLES];
+
+    for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_BLOCK_NUM_SAMPLES; ++sampleIdx) {
+        bestSampleNibbles[sampleIdx] = ((uint8_t) adjustStepCounts[sampleIdx][bestCandidateIdx]) & 0x0Fu;
+    }
+
+    // Save this for the caller, so it knows the last two encoded samples for the best encoding
+    prevEncSampleOut1 = (int16_t) prevSamples1[bestCandidateIdx];
+    prevEncSampleOut2 = (int16_t) prevSamples2[bestCandidateIdx];
+
     // Save the sample shift and the prediction filter
     adpcmDataOut[0] = (std::byte)(bestSampleShift | (bestSampleFilter << 4));
 
@@ -1,7 +1,10 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 // LcdTool:
-//      Dump, list, create or append to a .LCD samples file
+//      Dump, list, create or append to a .LCD samples file.
+//      Sounds are decoded/encoded in parallel, and whole directories of .LCD files can be dumped at once.
 //------------------------------------------------------------------------------------------------------------------------------------------
+#include "BatchJobs.h"
+#include "FileUtils.h"
 #include "Lcd.h"
 #include "Module.h"
 #include "ModuleFileUtils.h"
@@ -9,6 +12,7 @@
 #include "WavUtils.h"
 
 #include <algorithm>
+#include <filesystem>
 
 using namespace AudioTools;
 
@@ -30,7 +34,7 @@ struct PatchSampleFile {
 // Help/usage printing
 //------------------------------------------------------------------------------------------------------------------------------------------
 static const char* const HELP_STR = 
-R"(Usage: LcdTool <LCD FILE PATH> <BINARY|JSON WMD FILE PATH> <COMMAND-SWITCH> [COMMAND ARGS]
+R"(Usage: LcdTool <LCD FILE PATH> <BINARY|JSON WMD FILE PATH> <COMMAND-SWITCH> [COMMAND ARGS] [-threads <NUM THREADS>] [-stats]
 
 Command switches and arguments:
 
@@ -67,6 +71,20 @@ Command switches and arguments:
             (5) Loop points are rounded to the nearest 28 samples as required by the hardware. Ideally do this yourself.
         Example:
             LcdTool BLAH.LCD DOOMSND.WMD -append 101 SOUND101.WAV 102 SOUND102.VAG
+
+    -batch-dump [OUTPUT DIR PATH]
+        Same as the '-dump' command except the .LCD file path is a directory and ALL .LCD files in that directory are dumped.
+        Notes:
+            (1) The sounds for each .LCD file are output to a sub-directory named after the .LCD file (minus extension).
+            (2) The output directory is optional: the current working directory will be used if not specified.
+        Example:
+            LcdTool MyLcdDir DOOMSND.WMD -batch-dump MyDestDir
+
+Thread usage:
+    Sounds are decoded (-dump, -batch-dump) and encoded (-create, -append) in parallel.
+    By default one thread per CPU core is used; use the '-threads' switch to override this.
+    Output is the same regardless of the number of threads used.
+    Use the '-stats' switch to print a throughput report (jobs, output size and time taken) at the end.
 )";
 
 static void printHelp() noexcept {
@@ -147,7 +165,7 @@ static bool readInputLcdFile(const char* lcdFilePath) noexcept {
 // Gets ADPCM data from the specified file.
 // The file can either be a .vag or .wav file; if the file is in WAV format then it is encoded into the PSX ADPCM format.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static bool getSoundAdpcmData(const char* const soundFilePath, std::vector<std::byte>& adpcmData) noexcept {
+static bool getSoundAdpcmData(const char* const soundFilePath, std::vector<std::byte>& adpcmData, std::string& errorMsg) noexcept {
     // Uppercase the filename for case insensitivity
     std::string uppercaseName = soundFilePath;
     std::transform(
@@ -161,8 +179,6 @@ static bool getSoundAdpcmData(const char* const soundFilePath, std::vector<std::
     const bool bIsWavFile = ((uppercaseName.length() >= 4) && (uppercaseName.rfind(".WAV") == uppercaseName.length() - 4));
 
     // Read the .vag or .wav file
-    std::string errorMsg;
-
     if (bIsWavFile) {
         // Read the samples for the .wav
         std::vector<int16_t> pcmSamples;
@@ -171,14 +187,12 @@ static bool getSoundAdpcmData(const char* const soundFilePath, std::vector<std::
         uint32_t loopStartSamp = {};
         uint32_t loopEndSamp = {};
 
-        if (!WavUtils::readWavFile(soundFilePath, pcmSamples, numChannels, sampleRate, loopStartSamp, loopEndSamp, errorMsg)) {
-            std::printf("%s\n", errorMsg.c_str());
+        if (!WavUtils::readWavFile(soundFilePath, pcmSamples, numChannels, sampleRate, loopStartSamp, loopEndSamp, errorMsg))
             return false;
-        }
 
         // The .wav file must be mono to be used
         if (numChannels != 1) {
-            std::printf("Error! Input .wav file '%s' is stereo! Only mono .wav files must be supplied!\n", errorMsg.c_str());
+            errorMsg = BatchJobs::stringPrintf("Error! Input .wav file '%s' is stereo! Only mono .wav files must be supplied!", soundFilePath);
             return false;
         }
 
@@ -189,61 +203,130 @@ static bool getSoundAdpcmData(const char* const soundFilePath, std::vector<std::
         // Read the samples for the .vag file
         uint32_t sampleRate = {};
 
-        if (!VagUtils::readVagFile(soundFilePath, adpcmData, sampleRate, errorMsg)) {
-            std::printf("%s\n", errorMsg.c_str());
+        if (!VagUtils::readVagFile(soundFilePath, adpcmData, sampleRate, errorMsg))
             return false;
-        }
     }
 
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Dump a single sound from an LCD file in both .wav and .vag formats
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool dumpLcdSample(
+    const LcdSample& sample,
+    const PsxPatchGroup& patchGroup,
+    const char* const outputDir,
+    BatchJobs::JobOutput& jobOutput
+) noexcept {
+    // Guess the sample rate of this sample
+    const uint32_t sampleRate = patchGroup.guessSampleRateForPatchSample(sample.patchSampleIdx);
+
+    // Makeup the output file path without an extension in the form 'SAMP####' where '####' is the patch sample index
+    char sampleFileName[32];
+    std::snprintf(sampleFileName, sizeof(sampleFileName), "SAMP%04u", (unsigned) sample.patchSampleIdx);
+    const std::string outFilePathNoExt = BatchJobs::makeFilePath(outputDir, sampleFileName);
+
+    // Output to a .vag file and .wav file
+    std::string vagFilePath = outFilePathNoExt + ".vag";
+    std::string wavFilePath = outFilePathNoExt + ".wav";
+
+    if (!VagUtils::writePsxAdpcmSoundToVagFile(vagFilePath.c_str(), sample.adpcmData.data(), (uint32_t) sample.adpcmData.size(), sampleRate)) {
+        jobOutput.messages = BatchJobs::stringPrintf("Failed to write to output .vag file '%s'! Is the path writable?", vagFilePath.c_str());
+        return false;
+    }
+
+    if (!WavUtils::writePsxAdpcmSoundToWavFile(wavFilePath.c_str(), sample.adpcmData.data(), (uint32_t) sample.adpcmData.size(), sampleRate)) {
+        jobOutput.messages = BatchJobs::stringPrintf("Failed to write output .wav file '%s'! Is the path writable?", wavFilePath.c_str());
+        return false;
+    }
+
+    jobOutput.numBytesOut = (
+        (uint64_t) std::max<int64_t>(FileUtils::getFileSize(vagFilePath.c_str()), 0) +
+        (uint64_t) std::max<int64_t>(FileUtils::getFileSize(wavFilePath.c_str()), 0)
+    );
+
+    return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Dump the contents of the LCD file in both .wav and .vag formats
 //------------------------------------------------------------------------------------------------------------------------------------------
-static bool dumpLcd(const char* const lcdFilePath, const char* const wmdFilePath, const char* const outputDir) noexcept {
+static bool dumpLcd(const char* const lcdFilePath, const char* const wmdFilePath, const char* const outputDir, const uint32_t numThreads, const bool bPrintStats) noexcept {
     // Read the input files
     if ((!readInputWmdFile(wmdFilePath)) || (!readInputLcdFile(lcdFilePath)))
         return false;
 
-    // Save each of the lcd file sounds
-    const PsxPatchGroup& patchGroup = gModule.psxPatchGroup;
+    // Save each of the lcd file sounds, in parallel
+    const auto dumpSample = [&](const uint32_t jobIdx, BatchJobs::JobOutput& jobOutput) noexcept {
+        return dumpLcdSample(gLcd.samples[jobIdx], gModule.psxPatchGroup, outputDir, jobOutput);
+    };
 
-    for (const LcdSample& sample : gLcd.samples) {
-        // Guess the sample rate of this sample
-        const uint32_t sampleRate = patchGroup.guessSampleRateForPatchSample(sample.patchSampleIdx);
+    return BatchJobs::runJobs("Dump LCD", (uint32_t) gLcd.samples.size(), numThreads, bPrintStats, dumpSample);
+}
 
-        // Makeup the output file path without an extension in the form 'SAMP####' where '####' is the patch sample index
-        std::string outFilePathNoExt = outputDir;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Dump the contents of all LCD files in a directory in both .wav and .vag formats.
+// The sounds for each LCD file are saved to a sub-directory of the output directory named after the LCD file.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool batchDumpLcds(const char* const lcdDirPath, const char* const wmdFilePath, const char* const outputDir, const uint32_t numThreads, const bool bPrintStats) noexcept {
+    // Read the module file and get the list of LCD files to dump
+    if (!readInputWmdFile(wmdFilePath))
+        return false;
 
-        if ((!outFilePathNoExt.empty()) && (outFilePathNoExt.back() != '/') && (outFilePathNoExt.back() != '\\')) {
-            outFilePathNoExt += '/';
-        }
+    std::vector<std::string> lcdFilePaths;
+    std::string errorMsg;
 
-        outFilePathNoExt += "SAMP";
+    if (!BatchJobs::getFilesWithExtension(lcdDirPath, ".LCD", lcdFilePaths, errorMsg)) {
+        std::printf("%s\n", errorMsg.c_str());
+        return false;
+    }
 
-        {
-            char sampleIdxZeroPadded[32];
-            std::snprintf(sampleIdxZeroPadded, sizeof(sampleIdxZeroPadded), "%04u", (unsigned) sample.patchSampleIdx);
-            outFilePathNoExt += sampleIdxZeroPadded;
-        }
+    // Read all of the LCD files and make the output directory for each.
+    // This is quick compared to the conversion, so it's not worth doing in parallel.
+    struct LcdToDump {
+        Lcd             lcd;
+        std::string     outputDir;
+    };
+
+    struct SampleToDump {
+        uint32_t    lcdIdx;
+        uint32_t    sampleIdx;
+    };
+
+    std::vector<LcdToDump> lcdsToDump;
+    std::vector<SampleToDump> samplesToDump;
 
-        // Output to a .vag file and .wav file
-        std::string vagFilePath = outFilePathNoExt + ".vag";
-        std::string wavFilePath = outFilePathNoExt + ".wav";
+    for (const std::string& lcdFilePath : lcdFilePaths) {
+        LcdToDump& lcdToDump = lcdsToDump.emplace_back();
 
-        if (!VagUtils::writePsxAdpcmSoundToVagFile(vagFilePath.c_str(), sample.adpcmData.data(), (uint32_t) sample.adpcmData.size(), sampleRate)) {
-            std::printf("Failed to write to output .vag file '%s'! Is the path writable?\n", vagFilePath.c_str());
+        if (!lcdToDump.lcd.readFromLcdFile(lcdFilePath.c_str(), gModule.psxPatchGroup, errorMsg)) {
+            std::printf("%s\n", errorMsg.c_str());
             return false;
         }
 
-        if (!WavUtils::writePsxAdpcmSoundToWavFile(wavFilePath.c_str(), sample.adpcmData.data(), (uint32_t) sample.adpcmData.size(), sampleRate)) {
-            std::printf("Failed to write output .wav file '%s'! Is the path writable?\n", wavFilePath.c_str());
+        lcdToDump.outputDir = BatchJobs::makeFilePath(outputDir, BatchJobs::getFileNameWithoutExtension(lcdFilePath));
+
+        try {
+            std::filesystem::create_directories(lcdToDump.outputDir);
+        } catch (...) {
+            std::printf("Failed to create output directory '%s'! Is the path writable?\n", lcdToDump.outputDir.c_str());
             return false;
         }
+
+        for (uint32_t sampleIdx = 0; sampleIdx < (uint32_t) lcdToDump.lcd.samples.size(); ++sampleIdx) {
+            samplesToDump.push_back(SampleToDump{ (uint32_t) lcdsToDump.size() - 1, sampleIdx });
+        }
     }
 
-    return true;
+    // Save all of the sounds in all LCD files, in parallel
+    const auto dumpSample = [&](const uint32_t jobIdx, BatchJobs::JobOutput& jobOutput) noexcept {
+        const SampleToDump& sampleToDump = samplesToDump[jobIdx];
+        const LcdToDump& lcdToDump = lcdsToDump[sampleToDump.lcdIdx];
+        return dumpLcdSample(lcdToDump.lcd.samples[sampleToDump.sampleIdx], gModule.psxPatchGroup, lcdToDump.outputDir.c_str(), jobOutput);
+    };
+
+    return BatchJobs::runJobs("Batch dump LCD", (uint32_t) samplesToDump.size(), numThreads, bPrintStats, dumpSample);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -293,15 +376,25 @@ static bool buildLcd(
     const char* const lcdFilePath,
     const char* const wmdFilePath,
     const std::vector<PatchSampleFile>& patchSampleFiles,
-    const bool bAppend
+    const bool bAppend,
+    const uint32_t numThreads,
+    const bool bPrintStats
 ) noexcept {
-    // Firstly get the adpcm data for all of the input sounds specified
-    std::vector<std::vector<std::byte>> patchSamplesAdpcmData;
+    // Firstly get the adpcm data for all of the input sounds specified, reading and encoding them in parallel
+    std::vector<std::vector<std::byte>> patchSamplesAdpcmData(patchSampleFiles.size());
 
-    for (const PatchSampleFile& patchSampleFile : patchSampleFiles) {
-        if (!getSoundAdpcmData(patchSampleFile.filePath, patchSamplesAdpcmData.emplace_back()))
+    const auto getAdpcmData = [&](const uint32_t jobIdx, BatchJobs::JobOutput& jobOutput) noexcept {
+        std::vector<std::byte>& adpcmData = patchSamplesAdpcmData[jobIdx];
+
+        if (!getSoundAdpcmData(patchSampleFiles[jobIdx].filePath, adpcmData, jobOutput.messages))
             return false;
-    }
+
+        jobOutput.numBytesOut = adpcmData.size();
+        return true;
+    };
+
+    if (!BatchJobs::runJobs("Encode sounds", (uint32_t) patchSampleFiles.size(), numThreads, bPrintStats, getAdpcmData))
+        return false;
 
     // Need to read the input module file for verification purposes
     if (!readInputWmdFile(wmdFilePath))
@@ -345,7 +438,21 @@ static bool buildLcd(
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Program entrypoint
 //------------------------------------------------------------------------------------------------------------------------------------------
-int main(int argc, const char* const argv[]) noexcept {
+int main(int argc, const char* const argvIn[]) noexcept {
+    // Pull out the optional thread count and stats switches from the argument list, if present
+    std::vector<const char*> args(argvIn, argvIn + argc);
+    uint32_t numThreads = {};
+
+    if (!BatchJobs::extractNumThreadsArg(args, numThreads)) {
+        printHelp();
+        return 1;
+    }
+
+    const bool bPrintStats = BatchJobs::extractStatsArg(args);
+
+    argc = (int) args.size();
+    const char* const* const argv = args.data();
+
     // Not enough arguments?
     if (argc < 4) {
         printHelp();
@@ -367,7 +474,14 @@ int main(int argc, const char* const argv[]) noexcept {
         // Dump dir is optional
         if ((argc == 4) || (argc == 5)) {
             const char* const outputDir = (argc >= 5) ? argv[4] : "";
-            return (dumpLcd(lcdFilePath, wmdFilePath, outputDir)) ? 0 : 1;
+            return (dumpLcd(lcdFilePath, wmdFilePath, outputDir, numThreads, bPrintStats)) ? 0 : 1;
+        }
+    }
+    else if (std::strcmp(cmdSwitch, "-batch-dump") == 0) {
+        // Dump dir is optional
+        if ((argc == 4) || (argc == 5)) {
+            const char* const outputDir = (argc >= 5) ? argv[4] : "";
+            return (batchDumpLcds(lcdFilePath, wmdFilePath, outputDir, numThreads, bPrintStats)) ? 0 : 1;
         }
     }
     else if ((std::strcmp(cmdSwitch, "-create") == 0) || (std::strcmp(cmdSwitch, "-append") == 0)) {
@@ -398,7 +512,7 @@ int main(int argc, const char* const argv[]) noexcept {
         }
 
         // Build the LCD file
-        return (buildLcd(lcdFilePath, wmdFilePath, patchSampleFiles, bAppendMode)) ? 0 : 1;
+        return (buildLcd(lcdFilePath, wmdFilePath, patchSampleFiles, bAppendMode, numThreads, bPrintStats)) ? 0 : 1;
     }
 
     printHelp();
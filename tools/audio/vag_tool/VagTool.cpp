@@ -6,6 +6,8 @@
 #include "VagUtils.h"
 #include "WavUtils.h"
 
+#include <cstring>
+
 using namespace AudioTools;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -2,7 +2,10 @@
 // WmdTool:
 //      Utilities for converting .WMD files (Williams Module files) to JSON and visa versa.
 //      Also utilities for importing and exporting sequences from and to MIDI.
+//      Batch versions of the conversion commands process whole directories of files in parallel.
 //------------------------------------------------------------------------------------------------------------------------------------------
+#include "BatchJobs.h"
+#include "FileUtils.h"
 #include "MidiConvert.h"
 #include "MidiTypes.h"
 #include "MidiUtils.h"
@@ -94,6 +97,30 @@ Command switches and arguments:
         Example:
             WmdTool -copy-patches DOOMSND.WMD DOOMSND.json 0 1 2
             WmdTool -copy-patches DOOMSND.json DOOMSND.WMD 5
+
+    -batch-wmd-to-json <INPUT DIR PATH> <OUTPUT DIR PATH> [-threads <NUM THREADS>] [-stats]
+        Convert all .WMD files in the input directory to JSON text format, saving them to the output directory.
+        Notes:
+            (1) Files are converted in parallel. By default one thread per CPU core is used, use '-threads' to override.
+            (2) Output files have the same name as the input file but with a .json extension.
+            (3) Messages are printed in order of file name. Use '-stats' to also print a throughput report at the end.
+        Example:
+            WmdTool -batch-wmd-to-json MyWmdFiles MyJsonFiles -threads 8
+
+    -batch-json-to-wmd <INPUT DIR PATH> <OUTPUT DIR PATH> [-threads <NUM THREADS>] [-stats]
+        Convert all .json module files in the input directory to binary .WMD format, saving them to the output directory.
+        The same notes apply as for '-batch-wmd-to-json'.
+        Example:
+            WmdTool -batch-json-to-wmd MyJsonFiles MyWmdFiles
+
+    -batch-sequences-to-midi <INPUT JSON OR WMD FILE PATH> <OUTPUT DIR PATH> [-threads <NUM THREADS>] [-stats]
+        Convert all of the sequences in the given module to MIDI format, saving them to the output directory.
+        Notes:
+            (1) Sequences are converted in parallel. By default one thread per CPU core is used, use '-threads' to override.
+            (2) Output files are named 'SEQ####.MID' where '####' is the index of the sequence in the module.
+            (3) The same tempo assumptions apply as for '-sequence-to-midi'.
+        Example:
+            WmdTool -batch-sequences-to-midi DOOMSND.WMD MyMidiFiles
 )";
 
 static void printHelp() noexcept {
@@ -398,10 +425,98 @@ static bool copyPatchesOrSequences(
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Convert all of the modules in a directory from .WMD format to JSON or visa versa, in parallel
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool batchConvertModules(const char* const inputDir, const char* const outputDir, const bool bWmdToJson, const uint32_t numThreads, const bool bPrintStats) noexcept {
+    // Get the list of files to convert
+    std::vector<std::string> inputFiles;
+    std::string errorMsg;
+
+    if (!BatchJobs::getFilesWithExtension(inputDir, (bWmdToJson) ? ".WMD" : ".JSON", inputFiles, errorMsg)) {
+        std::printf("%s\n", errorMsg.c_str());
+        return false;
+    }
+
+    // Convert each file as a separate job
+    const auto convertModule = [&](const uint32_t jobIdx, BatchJobs::JobOutput& jobOutput) noexcept {
+        const std::string& inputFile = inputFiles[jobIdx];
+        const std::string outputFile = BatchJobs::makeFilePath(outputDir, BatchJobs::getFileNameWithoutExtension(inputFile) + ((bWmdToJson) ? ".json" : ".WMD"));
+
+        Module module = {};
+        std::string jobErrorMsg;
+        const bool bReadOk = (bWmdToJson) ?
+            ModuleFileUtils::readWmdFile(inputFile.c_str(), module, jobErrorMsg) :
+            ModuleFileUtils::readJsonFile(inputFile.c_str(), module, jobErrorMsg);
+
+        const bool bSuccess = bReadOk && ((bWmdToJson) ?
+            ModuleFileUtils::writeJsonFile(outputFile.c_str(), module, jobErrorMsg) :
+            ModuleFileUtils::writeWmdFile(outputFile.c_str(), module, jobErrorMsg)
+        );
+
+        if (bSuccess) {
+            jobOutput.numBytesOut = (uint64_t) std::max<int64_t>(FileUtils::getFileSize(outputFile.c_str()), 0);
+            jobOutput.messages = BatchJobs::stringPrintf("Converted '%s' -> '%s'", inputFile.c_str(), outputFile.c_str());
+        } else {
+            jobOutput.messages = BatchJobs::stringPrintf("Failed to convert '%s'! %s", inputFile.c_str(), jobErrorMsg.c_str());
+        }
+
+        return bSuccess;
+    };
+
+    return BatchJobs::runJobs((bWmdToJson) ? "WMD to JSON" : "JSON to WMD", (uint32_t) inputFiles.size(), numThreads, bPrintStats, convertModule);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Convert all of the sequences in a module to MIDI format, in parallel
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool batchConvertSequencesToMidi(const char* const moduleFilePath, const char* const outputDir, const uint32_t numThreads, const bool bPrintStats) noexcept {
+    // Read the input module file firstly: this is shared (read only) by all jobs
+    Module module = {};
+    bool bIsJsonModule = {};
+
+    if (!readModuleFile(moduleFilePath, bIsJsonModule, module))
+        return false;
+
+    // Convert each sequence as a separate job
+    const auto convertSequence = [&](const uint32_t jobIdx, BatchJobs::JobOutput& jobOutput) noexcept {
+        char midiFileName[32];
+        std::snprintf(midiFileName, sizeof(midiFileName), "SEQ%04u.MID", (unsigned) jobIdx);
+        const std::string midiFilePath = BatchJobs::makeFilePath(outputDir, midiFileName);
+
+        MidiFile midiFile = {};
+        MidiConvert::sequenceToMidi(module.sequences[jobIdx], midiFile);
+
+        if (!MidiUtils::writeMidiFile(midiFilePath.c_str(), midiFile)) {
+            jobOutput.messages = BatchJobs::stringPrintf("Error! Failed to write to the output .midi file '%s'! Is that file path writable or is the disk full?", midiFilePath.c_str());
+            return false;
+        }
+
+        jobOutput.numBytesOut = (uint64_t) std::max<int64_t>(FileUtils::getFileSize(midiFilePath.c_str()), 0);
+        return true;
+    };
+
+    return BatchJobs::runJobs("Sequences to MIDI", (uint32_t) module.sequences.size(), numThreads, bPrintStats, convertSequence);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Program entrypoint
 //------------------------------------------------------------------------------------------------------------------------------------------
-int main(int argc, const char* const argv[]) noexcept {
+int main(int argc, const char* const argvIn[]) noexcept {
+    // Pull out the optional thread count and stats switches (for batch commands) from the argument list, if present
+    std::vector<const char*> args(argvIn, argvIn + argc);
+    uint32_t numThreads = {};
+
+    if (!BatchJobs::extractNumThreadsArg(args, numThreads)) {
+        printHelp();
+        return 1;
+    }
+
+    const bool bPrintStats = BatchJobs::extractStatsArg(args);
+
+    argc = (int) args.size();
+    const char* const* const argv = args.data();
+
     // Not enough arguments?
     if (argc < 2) {
         printHelp();
@@ -499,6 +614,21 @@ int main(int argc, const char* const argv[]) noexcept {
             return (copyPatchesOrSequences(srcModuleFilePath, dstModuleFilePath, bCopySequences, elemIndexesToCopy)) ? 0 : 1;
         }
     }
+    else if ((std::strcmp(cmdSwitch, "-batch-wmd-to-json") == 0) || (std::strcmp(cmdSwitch, "-batch-json-to-wmd") == 0)) {
+        if (argc == 4) {
+            const bool bWmdToJson = (std::strcmp(cmdSwitch, "-batch-wmd-to-json") == 0);
+            const char* const inputDir = argv[2];
+            const char* const outputDir = argv[3];
+            return (batchConvertModules(inputDir, outputDir, bWmdToJson, numThreads, bPrintStats)) ? 0 : 1;
+        }
+    }
+    else if (std::strcmp(cmdSwitch, "-batch-sequences-to-midi") == 0) {
+        if (argc == 4) {
+            const char* const moduleFilePath = argv[2];
+            const char* const outputDir = argv[3];
+            return (batchConvertSequencesToMidi(moduleFilePath, outputDir, numThreads, bPrintStats)) ? 0 : 1;
+        }
+    }
 
     printHelp();
     return 1;
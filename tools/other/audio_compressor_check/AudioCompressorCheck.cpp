@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// AudioCompressorCheck:
+//      Verifies that the fast (polynomial) dB conversions used by the game's audio compressor are accurate to within their stated bounds.
+//      Sweeps the input ranges used by the compressor and compares against the exact 'log10' and 'pow' based conversions.
+//      Exits with a failure code if any error bound is exceeded, so it can be run as an automated check.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "AudioCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+// How many points in each input range to check
+static constexpr int32_t NUM_STEPS = 65536;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks the signal power to decibels conversion and returns 'true' if it is within the error bound.
+// The compressor clamps signal power to the range 1e-10 to 1e6 (-100 to +60 dB).
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool checkPowerToDB() noexcept {
+    double maxError = 0.0;
+    double maxErrorPower = 0.0;
+
+    for (int32_t i = 0; i <= NUM_STEPS; ++i) {
+        const float signalPower = (float) std::pow(10.0, -10.0 + 16.0 * (double) i / (double) NUM_STEPS);
+        const double exactDB = 10.0 * std::log10((double) signalPower);
+        const double error = std::abs((double) AudioCompressor::fastPowerToDB(signalPower) - exactDB);
+
+        if (error > maxError) {
+            maxError = error;
+            maxErrorPower = signalPower;
+        }
+    }
+
+    const bool bPassed = (maxError <= AudioCompressor::MAX_POWER_TO_DB_ERROR);
+    std::printf(
+        "fastPowerToDB:      max error %g dB at power %g (bound %g): %s\n",
+        maxError,
+        maxErrorPower,
+        (double) AudioCompressor::MAX_POWER_TO_DB_ERROR,
+        (bPassed) ? "OK" : "FAILED"
+    );
+
+    return bPassed;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks the decibels to linear gain conversion and returns 'true' if it is within the relative error bound.
+// The compressor gain is in the range -100 to 0 dB with the post gain added on top: allow for a generous range of post gains.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool checkDBToLinearGain() noexcept {
+    constexpr double MIN_GAIN_DB = -100.0 - 24.0;
+    constexpr double MAX_GAIN_DB = +24.0;
+
+    double maxRelError = 0.0;
+    double maxRelErrorGainDB = 0.0;
+
+    for (int32_t i = 0; i <= NUM_STEPS; ++i) {
+        const float gainDB = (float)(MIN_GAIN_DB + (MAX_GAIN_DB - MIN_GAIN_DB) * (double) i / (double) NUM_STEPS);
+        const double exactGain = std::pow(10.0, (double) gainDB / 20.0);
+        const double relError = std::abs((double) AudioCompressor::fastDBToLinearGain(gainDB) - exactGain) / exactGain;
+
+        if (relError > maxRelError) {
+            maxRelError = relError;
+            maxRelErrorGainDB = gainDB;
+        }
+    }
+
+    const bool bPassed = (maxRelError <= AudioCompressor::MAX_DB_TO_GAIN_REL_ERROR);
+    std::printf(
+        "fastDBToLinearGain: max relative error %g at %g dB (bound %g): %s\n",
+        maxRelError,
+        maxRelErrorGainDB,
+        (double) AudioCompressor::MAX_DB_TO_GAIN_REL_ERROR,
+        (bPassed) ? "OK" : "FAILED"
+    );
+
+    return bPassed;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Program entrypoint
+//------------------------------------------------------------------------------------------------------------------------------------------
+int main() noexcept {
+    const bool bPowerToDBOk = checkPowerToDB();
+    const bool bDBToLinearGainOk = checkDBToLinearGain();
+    return (bPowerToDBOk && bDBToLinearGainOk) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
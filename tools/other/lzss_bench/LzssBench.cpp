@@ -0,0 +1,231 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// LzssBench:
+//      Benchmarks the LZSS decompressor used for compressed lumps in PlayStation Doom WAD files against the original decompressor.
+//      Decompresses every compressed lump in a given WAD repeatedly with each decompressor, checking that the output is identical.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Endian.h"
+#include "FileUtils.h"
+#include "WadUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A compressed lump to benchmark decompressing
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct CompressedLump {
+    const std::byte*    pData;
+    int32_t             uncompressedSize;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Help/usage printing
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const char* const HELP_STR =
+R"(Usage: LzssBench <WAD FILE PATH> [NUM ITERATIONS]
+
+Decompresses all compressed lumps in the given PlayStation Doom format WAD file the specified number of times (default 20)
+with both the original and current LZSS decompressors, verifies the output matches and prints the throughput of each.
+Example:
+    LzssBench PSXDOOM.WAD 50
+)";
+
+static void printHelp() noexcept {
+    std::printf("%s\n", HELP_STR);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The original LZSS decompressor, as it was before optimization: used as the baseline for the benchmark
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decompressLump_Original(const void* const pSrc, void* const pDst) noexcept {
+    const uint8_t* pSrcByte = (const uint8_t*) pSrc;
+    uint8_t* pDstByte = (uint8_t*) pDst;
+
+    uint32_t idByte = 0;
+    uint32_t haveIdByte = 0;
+
+    while (true) {
+        if (haveIdByte == 0) {
+            idByte = *pSrcByte;
+            ++pSrcByte;
+        }
+
+        haveIdByte = (haveIdByte + 1) & 7;
+
+        if (idByte & 1) {
+            const uint32_t srcByte1 = pSrcByte[0];
+            const uint32_t srcByte2 = pSrcByte[1];
+            pSrcByte += 2;
+
+            const int32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
+            const int32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
+
+            if (numRepeatedBytes == 1)
+                break;
+
+            const uint8_t* const pRepeatedBytes = pDstByte - srcOffset;
+
+            for (int32_t i = 0; i < numRepeatedBytes; ++i) {
+                *pDstByte = pRepeatedBytes[i];
+                ++pDstByte;
+            }
+        } else {
+            *pDstByte = *pSrcByte;
+            ++pSrcByte;
+            ++pDstByte;
+        }
+
+        idByte >>= 1;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds all of the compressed lumps in the given WAD file data
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<CompressedLump> findCompressedLumps(const FileData& wadData) noexcept {
+    std::vector<CompressedLump> lumps;
+
+    if (wadData.size < 12)
+        return lumps;
+
+    int32_t numLumps;
+    int32_t lumpHdrsOffset;
+    std::memcpy(&numLumps, wadData.bytes.get() + 4, 4);
+    std::memcpy(&lumpHdrsOffset, wadData.bytes.get() + 8, 4);
+    numLumps = Endian::littleToHost(numLumps);
+    lumpHdrsOffset = Endian::littleToHost(lumpHdrsOffset);
+
+    if ((numLumps < 0) || (lumpHdrsOffset < 0) || ((size_t) lumpHdrsOffset + (size_t) numLumps * 16 > wadData.size))
+        return lumps;
+
+    for (int32_t i = 0; i < numLumps; ++i) {
+        const std::byte* const pLumpHdr = wadData.bytes.get() + lumpHdrsOffset + i * 16;
+
+        int32_t wadFileOffset;
+        int32_t uncompressedSize;
+        std::memcpy(&wadFileOffset, pLumpHdr, 4);
+        std::memcpy(&uncompressedSize, pLumpHdr + 4, 4);
+        wadFileOffset = Endian::littleToHost(wadFileOffset);
+        uncompressedSize = Endian::littleToHost(uncompressedSize);
+
+        // The highest bit of the first character in the lump name is set if the lump is compressed
+        const bool bIsCompressed = ((uint8_t) pLumpHdr[8] & 0x80);
+
+        if (bIsCompressed && (uncompressedSize > 0) && (wadFileOffset >= 0) && ((size_t) wadFileOffset < wadData.size)) {
+            lumps.push_back({ wadData.bytes.get() + wadFileOffset, uncompressedSize });
+        }
+    }
+
+    return lumps;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses all of the given lumps the specified number of times with the given decompressor and returns the time taken in seconds
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class DecompressFunc>
+static double timeDecompression(
+    const std::vector<CompressedLump>& lumps,
+    const int32_t numIterations,
+    std::vector<std::byte>& outputBuffer,
+    const DecompressFunc& decompress
+) noexcept {
+    const auto startTime = std::chrono::steady_clock::now();
+
+    for (int32_t iteration = 0; iteration < numIterations; ++iteration) {
+        for (const CompressedLump& lump : lumps) {
+            decompress(lump, outputBuffer.data());
+        }
+    }
+
+    const auto endTime = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(endTime - startTime).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Program entrypoint
+//------------------------------------------------------------------------------------------------------------------------------------------
+int main(int argc, const char* const argv[]) noexcept {
+    // Not enough arguments?
+    if ((argc != 2) && (argc != 3)) {
+        printHelp();
+        return 1;
+    }
+
+    const char* const wadFilePath = argv[1];
+    const int32_t numIterations = (argc == 3) ? std::atoi(argv[2]) : 20;
+
+    if (numIterations <= 0) {
+        printHelp();
+        return 1;
+    }
+
+    // Read the WAD and find all of the compressed lumps in it
+    const FileData wadData = FileUtils::getContentsOfFile(wadFilePath);
+
+    if (!wadData.bytes) {
+        std::printf("Failed to read input file '%s'! Is the path correct?\n", wadFilePath);
+        return 1;
+    }
+
+    const std::vector<CompressedLump> lumps = findCompressedLumps(wadData);
+    int64_t totalUncompressedSize = 0;
+    int32_t maxUncompressedSize = 0;
+
+    for (const CompressedLump& lump : lumps) {
+        totalUncompressedSize += lump.uncompressedSize;
+        maxUncompressedSize = std::max(maxUncompressedSize, lump.uncompressedSize);
+    }
+
+    if (lumps.empty()) {
+        std::printf("No compressed lumps found in '%s'!\n", wadFilePath);
+        return 1;
+    }
+
+    // Verify the output of the current decompressor matches the original for every lump
+    std::vector<std::byte> expectedOutput((size_t) maxUncompressedSize);
+    std::vector<std::byte> actualOutput((size_t) maxUncompressedSize);
+
+    for (const CompressedLump& lump : lumps) {
+        const size_t lumpSize = (size_t) lump.uncompressedSize;
+        decompressLump_Original(lump.pData, expectedOutput.data());
+        WadUtils::decompressLump(lump.pData, actualOutput.data());
+
+        if (std::memcmp(expectedOutput.data(), actualOutput.data(), lumpSize) != 0) {
+            std::printf("Output mismatch for the lump at WAD offset %d!\n", (int32_t)(lump.pData - wadData.bytes.get()));
+            return 1;
+        }
+
+        WadUtils::decompressLump(lump.pData, actualOutput.data(), lumpSize);
+
+        if (std::memcmp(expectedOutput.data(), actualOutput.data(), lumpSize) != 0) {
+            std::printf("Output mismatch (sized decompression) for the lump at WAD offset %d!\n", (int32_t)(lump.pData - wadData.bytes.get()));
+            return 1;
+        }
+    }
+
+    // Time each decompressor and print the results
+    const double originalTime = timeDecompression(lumps, numIterations, actualOutput, [](const CompressedLump& lump, std::byte* const pDst) noexcept {
+        decompressLump_Original(lump.pData, pDst);
+    });
+
+    const double currentTime = timeDecompression(lumps, numIterations, actualOutput, [](const CompressedLump& lump, std::byte* const pDst) noexcept {
+        WadUtils::decompressLump(lump.pData, pDst);
+    });
+
+    const double sizedTime = timeDecompression(lumps, numIterations, actualOutput, [](const CompressedLump& lump, std::byte* const pDst) noexcept {
+        WadUtils::decompressLump(lump.pData, pDst, (size_t) lump.uncompressedSize);
+    });
+
+    const double totalMiB = (double) totalUncompressedSize * numIterations / (1024.0 * 1024.0);
+
+    std::printf("Decompressed %d lumps (%.2f MiB) %d times each.\n", (int32_t) lumps.size(), (double) totalUncompressedSize / (1024.0 * 1024.0), numIterations);
+    std::printf("    Original decompressor:          %8.1f MiB/s\n", totalMiB / originalTime);
+    std::printf("    Current decompressor:           %8.1f MiB/s (%.2fx)\n", totalMiB / currentTime, originalTime / currentTime);
+    std::printf("    Current decompressor (sized):   %8.1f MiB/s (%.2fx)\n", totalMiB / sizedTime, originalTime / sizedTime);
+    return 0;
+}